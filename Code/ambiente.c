@@ -0,0 +1,44 @@
+/**
+ * @file ambiente.c
+ * @brief Implementação do ambiente por thread.
+ *
+ * @date 2025
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ambiente.h"
+
+extern char **environ;
+
+/// Ambiente da thread atual (NULL usa o do processo).
+static __thread char **ambiente_thread = NULL;
+
+/// @brief Define o ambiente da thread atual.
+/// @param variaveis Entradas "NOME=valor" terminadas em NULL, ou NULL.
+void ambiente_define(char **variaveis) {
+    ambiente_thread = variaveis;
+}
+
+/// @brief Ambiente da thread atual.
+/// @return Entradas terminadas em NULL.
+char **ambiente_atual(void) {
+    return ambiente_thread != NULL ? ambiente_thread : environ;
+}
+
+/// @brief Valor de uma variável no ambiente da thread atual.
+/// @param nome Nome da variável.
+/// @return Valor, ou NULL se não estiver definida.
+const char *ambiente_valor(const char *nome) {
+    size_t n = strlen(nome);
+
+    if (ambiente_thread == NULL) {
+        return getenv(nome);
+    }
+    for (char **v = ambiente_thread; *v != NULL; v++) {
+        if (strncmp(*v, nome, n) == 0 && (*v)[n] == '=') {
+            return *v + n + 1;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,37 @@
+/**
+ * @file ambiente.h
+ * @brief Variáveis de ambiente vistas pelos comandos da thread atual.
+ *
+ * Por omissão é o ambiente do processo (environ). O servidor (ver
+ * servidor.h) dá a cada pedido o ambiente do cliente que o fez, sem mexer no
+ * do processo, que é partilhado por todos: as variáveis expandidas pelo
+ * analisador, o PATH da cache de caminhos e o ambiente dos programas
+ * lançados vêm daqui.
+ *
+ * @date 2025
+ */
+
+#ifndef AMBIENTE_H
+#define AMBIENTE_H
+
+/**
+ * @brief Define o ambiente da thread atual.
+ * @param variaveis Entradas "NOME=valor" terminadas em NULL (têm de existir
+ * enquanto estiverem em uso), ou NULL para voltar ao ambiente do processo.
+ */
+void ambiente_define(char **variaveis);
+
+/**
+ * @brief Devolve o ambiente da thread atual (para o execve e o posix_spawn).
+ * @return Entradas "NOME=valor" terminadas em NULL.
+ */
+char **ambiente_atual(void);
+
+/**
+ * @brief Devolve o valor de uma variável no ambiente da thread atual.
+ * @param nome Nome da variável.
+ * @return Valor, ou NULL se não estiver definida.
+ */
+const char *ambiente_valor(const char *nome);
+
+#endif // AMBIENTE_H
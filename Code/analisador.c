@@ -0,0 +1,550 @@
+/**
+ * @file analisador.c
+ * @brief Implementação do analisador da linha de comandos.
+ *
+ * As palavras são escritas, à medida que o texto é lido, num só bloco da
+ * arena reservado no início com o tamanho máximo possível (3 bytes por
+ * carácter do texto): não há uma reserva por palavra. As variáveis não são substituídas durante a
+ * análise, porque $? só é conhecido quando o comando anterior terminar: a
+ * palavra guarda-as entre dois bytes MARCA e expande_argumentos substitui-as
+ * antes de executar o comando. Um byte MARCA que apareça no texto é guardado
+ * duplicado. As palavras sem variáveis (quase todas) são usadas tal como
+ * ficaram na arena.
+ *
+ * Numa palavra com '*', '?' ou '[' fora de aspas, os caracteres especiais
+ * que estavam entre aspas (ou protegidos com '\\') são guardados precedidos
+ * de '\\', como no padrão que é passado a expande_padrao; nas outras
+ * palavras essas proteções são retiradas no fim da palavra.
+ *
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "analisador.h"
+#include "padroes.h"
+#include "ambiente.h"
+
+/// Delimita o nome de uma variável dentro de uma palavra.
+#define MARCA '\x01'
+
+char operador_pipe[] = "|";
+char operador_entrada[] = "<";
+char operador_saida[] = ">";
+char operador_acrescenta[] = ">>";
+char operador_fundo[] = "&";
+
+/// @brief Estado da análise de um texto.
+typedef struct {
+    const char *p, *fim;            ///< posição atual e fim do texto
+    arena *a;
+    analise *res;
+    int linha;
+    comando_analisado *atual;       ///< comando em construção, ou NULL
+    palavra **fim_palavras;         ///< onde ligar a próxima palavra do comando atual
+    comando_analisado **fim_comandos;
+    int pendente;                   ///< 1 depois de '|', '&&' ou '||' (falta um comando)
+    char *livre;                    ///< onde escrever a próxima palavra
+} estado_analise;
+
+/// @brief Indica se um argumento é um dos operadores do analisador.
+int e_operador_analisador(const char *a) {
+    return a == operador_pipe || a == operador_entrada || a == operador_saida ||
+           a == operador_acrescenta || a == operador_fundo;
+}
+
+static int e_inicio_nome(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static int e_letra_nome(char c) {
+    return e_inicio_nome(c) || (c >= '0' && c <= '9');
+}
+
+/// @brief Indica se um carácter termina uma palavra (fora de aspas).
+static int termina_palavra(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' ||
+           c == ';' || c == '&' || c == '|' || c == '<' || c == '>';
+}
+
+/// @brief Regista um erro de sintaxe na linha atual.
+static resultado_analise erro_sintaxe(estado_analise *e, const char *mensagem) {
+    e->res->erro = mensagem;
+    e->res->linha_erro = e->linha;
+    return ANALISE_ERRO;
+}
+
+/// @brief Acrescenta uma palavra (ou operador) ao comando atual, criando-o se for preciso.
+static resultado_analise acrescenta_palavra(estado_analise *e, char *texto, int expande, int padrao) {
+    palavra *p = arena_aloca(e->a, sizeof(palavra));
+
+    if (p == NULL) {
+        return erro_sintaxe(e, "Memória insuficiente.");
+    }
+    if (e->atual == NULL) {
+        e->atual = arena_aloca(e->a, sizeof(comando_analisado));
+        if (e->atual == NULL) {
+            return erro_sintaxe(e, "Memória insuficiente.");
+        }
+        memset(e->atual, 0, sizeof(*e->atual));
+        e->atual->linha = e->linha;
+        e->fim_palavras = &e->atual->palavras;
+        *e->fim_comandos = e->atual;
+        e->fim_comandos = &e->atual->seguinte;
+    }
+    p->texto = texto;
+    p->expande = expande;
+    p->padrao = padrao;
+    p->seguinte = NULL;
+    *e->fim_palavras = p;
+    e->fim_palavras = &p->seguinte;
+    e->atual->num_palavras++;
+    e->res->num_tokens++;
+    e->pendente = texto == operador_pipe;
+    return ANALISE_OK;
+}
+
+/// @brief Termina o comando atual (se houver) com a ligação indicada.
+static void termina_comando(estado_analise *e, ligacao_comando liga) {
+    if (e->atual != NULL) {
+        e->atual->liga = liga;
+        e->atual = NULL;
+    }
+}
+
+/// @brief Trata um separador de comandos (';', '&&', '||' ou '&').
+/// @param tamanho Número de caracteres do separador.
+static resultado_analise separa(estado_analise *e, ligacao_comando liga, int tamanho, const char *mensagem) {
+    if (e->atual == NULL || e->pendente) {
+        return erro_sintaxe(e, mensagem);
+    }
+    if (tamanho == 1 && *e->p == '&') {
+        resultado_analise r = acrescenta_palavra(e, operador_fundo, 0, 0);
+        if (r != ANALISE_OK) {
+            return r;
+        }
+    }
+    termina_comando(e, liga);
+    e->pendente = liga != LIGACAO_SEQUENCIA;
+    e->res->num_tokens += liga != LIGACAO_SEQUENCIA || *e->p == ';';
+    e->p += tamanho;
+    return ANALISE_OK;
+}
+
+/// @brief Escreve um carácter de uma palavra, duplicando a MARCA.
+static void poe(char *buf, size_t *w, char c, int *expande) {
+    if (c == MARCA) {
+        buf[(*w)++] = MARCA;
+        *expande = 1;
+    }
+    buf[(*w)++] = c;
+}
+
+/// @brief Indica se um carácter tem significado num padrão.
+static int e_especial_padrao(char c) {
+    return c == '*' || c == '?' || c == '[' || c == ']' || c == '\\';
+}
+
+/// @brief Escreve um carácter que estava entre aspas ou protegido com '\\'.
+static void poe_protegido(char *buf, size_t *w, char c, int *expande, int *protegido) {
+    if (e_especial_padrao(c)) {
+        buf[(*w)++] = '\\';
+        *protegido = 1;
+    }
+    poe(buf, w, c, expande);
+}
+
+/// @brief Lê uma variável ($NOME, ${NOME} ou $?) a partir do '$'.
+/// @details Um '$' que não é seguido de um nome é literal. A variável é
+/// escrita como MARCA nome MARCA.
+static resultado_analise le_variavel(estado_analise *e, char *buf, size_t *w, int *expande) {
+    const char *p = e->p + 1, *nome, *fim_nome;
+    int chavetas = p < e->fim && *p == '{';
+
+    if (chavetas) {
+        p++;
+    }
+    nome = p;
+    if (p < e->fim && *p == '?') {
+        p++;
+    } else if (p < e->fim && e_inicio_nome(*p)) {
+        while (p < e->fim && e_letra_nome(*p)) {
+            p++;
+        }
+    }
+    fim_nome = p;
+
+    if (chavetas) {
+        if (p == e->fim) {
+            return ANALISE_INCOMPLETA;
+        }
+        if (*p != '}' || fim_nome == nome) {
+            return erro_sintaxe(e, "Substituição de variável inválida.");
+        }
+        p++;
+    } else if (fim_nome == nome) {
+        buf[(*w)++] = '$';
+        e->p++;
+        return ANALISE_OK;
+    }
+    buf[(*w)++] = MARCA;
+    memcpy(buf + *w, nome, fim_nome - nome);
+    *w += fim_nome - nome;
+    buf[(*w)++] = MARCA;
+    *expande = 1;
+    e->p = p;
+    return ANALISE_OK;
+}
+
+/// @brief Lê o conteúdo de umas aspas duplas, a partir da aspa inicial.
+static resultado_analise le_aspas(estado_analise *e, char *buf, size_t *w, int *expande, int *protegido) {
+    e->p++;
+    for (;;) {
+        char c;
+
+        if (e->p == e->fim) {
+            return ANALISE_INCOMPLETA;
+        }
+        c = *e->p;
+        if (c == '"') {
+            e->p++;
+            return ANALISE_OK;
+        }
+        if (c == '$') {
+            resultado_analise r = le_variavel(e, buf, w, expande);
+            if (r != ANALISE_OK) {
+                return r;
+            }
+            continue;
+        }
+        if (c == '\\') {
+            char s;
+
+            if (e->p + 1 == e->fim) {
+                return ANALISE_INCOMPLETA;
+            }
+            s = e->p[1];
+            if (s == '\n') {
+                e->linha++;
+                e->p += 2;
+                continue;
+            }
+            // Dentro de aspas duplas, '\' só protege estes caracteres
+            if (s == '"' || s == '\\' || s == '$' || s == '`') {
+                poe_protegido(buf, w, s, expande, protegido);
+                e->p += 2;
+                continue;
+            }
+        }
+        if (c == '\n') {
+            e->linha++;
+        }
+        poe_protegido(buf, w, c, expande, protegido);
+        e->p++;
+    }
+}
+
+/// @brief Lê uma palavra, com as aspas, escapes e variáveis que tiver.
+static resultado_analise le_palavra(estado_analise *e) {
+    char *buf = e->livre;
+    size_t w = 0;
+    int expande = 0, tem_palavra = 0, padrao = 0, protegido = 0;
+
+    while (e->p < e->fim && !termina_palavra(*e->p)) {
+        char c = *e->p;
+        resultado_analise r = ANALISE_OK;
+
+        if (c == '\\') {
+            if (e->p + 1 == e->fim) {
+                return ANALISE_INCOMPLETA;
+            }
+            if (e->p[1] == '\n') {
+                // Continuação de linha: não faz parte da palavra
+                e->linha++;
+                e->p += 2;
+                continue;
+            }
+            poe_protegido(buf, &w, e->p[1], &expande, &protegido);
+            e->p += 2;
+        } else if (c == '\'') {
+            const char *fecho = memchr(e->p + 1, '\'', e->fim - e->p - 1);
+
+            if (fecho == NULL) {
+                return ANALISE_INCOMPLETA;
+            }
+            for (const char *q = e->p + 1; q < fecho; q++) {
+                e->linha += *q == '\n';
+                poe_protegido(buf, &w, *q, &expande, &protegido);
+            }
+            e->p = fecho + 1;
+        } else if (c == '"') {
+            r = le_aspas(e, buf, &w, &expande, &protegido);
+        } else if (c == '$') {
+            r = le_variavel(e, buf, &w, &expande);
+        } else {
+            // Sequência de caracteres normais, copiada de uma vez
+            const char *inicio = e->p;
+
+            while (e->p < e->fim && !termina_palavra(*e->p) && *e->p != '\\' && *e->p != '\'' &&
+                   *e->p != '"' && *e->p != '$' && *e->p != MARCA) {
+                e->p++;
+            }
+            if (e->p == inicio) {
+                poe(buf, &w, c, &expande);      // MARCA
+                e->p++;
+            } else {
+                for (const char *q = inicio; q < e->p && !padrao; q++) {
+                    padrao = *q == '*' || *q == '?' || *q == '[';
+                }
+                memcpy(buf + w, inicio, e->p - inicio);
+                w += e->p - inicio;
+            }
+        }
+        if (r != ANALISE_OK) {
+            return r;
+        }
+        tem_palavra = 1;
+    }
+
+    if (!tem_palavra) {
+        return ANALISE_OK;      // só continuações de linha
+    }
+    if (protegido && !padrao) {
+        // Não é um padrão: as proteções já não são precisas
+        size_t r = 0, n = w;
+
+        for (w = 0; r < n; r++) {
+            if (buf[r] == '\\') {
+                r++;
+            }
+            buf[w++] = buf[r];
+        }
+    }
+    buf[w++] = '\0';
+    e->livre += w;
+    return acrescenta_palavra(e, buf, expande, padrao);
+}
+
+/// @brief Analisa um texto com uma ou mais linhas de comandos.
+/// @param texto Texto.
+/// @param n Tamanho do texto.
+/// @param a Arena.
+/// @param res Resultado.
+/// @return ANALISE_OK, ANALISE_INCOMPLETA ou ANALISE_ERRO.
+resultado_analise analisa_comandos(const char *texto, size_t n, arena *a, analise *res) {
+    estado_analise e;
+
+    memset(res, 0, sizeof(*res));
+    memset(&e, 0, sizeof(e));
+    e.p = texto;
+    e.fim = texto + n;
+    e.a = a;
+    e.res = res;
+    e.linha = 1;
+    e.fim_comandos = &res->comandos;
+    // Cada carácter dá no máximo dois na palavra ("$?" dá três), mais o '\0'
+    e.livre = arena_aloca(a, 3 * n + 1);
+    if (e.livre == NULL) {
+        return erro_sintaxe(&e, "Memória insuficiente.");
+    }
+
+    while (e.p < e.fim) {
+        char c = *e.p;
+        resultado_analise r = ANALISE_OK;
+
+        switch (c) {
+        case ' ': case '\t': case '\r':
+            e.p++;
+            break;
+        case '\n':
+            // Depois de '|', '&&' ou '||' o comando continua na linha seguinte
+            if (!e.pendente) {
+                termina_comando(&e, LIGACAO_SEQUENCIA);
+            }
+            e.linha++;
+            e.p++;
+            break;
+        case ';':
+            r = separa(&e, LIGACAO_SEQUENCIA, 1, "Sintaxe inválida perto de ';'.");
+            break;
+        case '&':
+            if (e.p + 1 < e.fim && e.p[1] == '&') {
+                r = separa(&e, LIGACAO_E, 2, "Sintaxe inválida perto de '&&'.");
+            } else {
+                r = separa(&e, LIGACAO_SEQUENCIA, 1, "Sintaxe inválida perto de '&'.");
+            }
+            break;
+        case '|':
+            if (e.p + 1 < e.fim && e.p[1] == '|') {
+                r = separa(&e, LIGACAO_OU, 2, "Sintaxe inválida perto de '||'.");
+            } else if (e.atual == NULL || e.pendente) {
+                r = erro_sintaxe(&e, "Sintaxe inválida perto de '|'.");
+            } else {
+                r = acrescenta_palavra(&e, operador_pipe, 0, 0);
+                e.p++;
+            }
+            break;
+        case '<':
+            r = acrescenta_palavra(&e, operador_entrada, 0, 0);
+            e.p++;
+            break;
+        case '>':
+            if (e.p + 1 < e.fim && e.p[1] == '>') {
+                r = acrescenta_palavra(&e, operador_acrescenta, 0, 0);
+                e.p += 2;
+            } else {
+                r = acrescenta_palavra(&e, operador_saida, 0, 0);
+                e.p++;
+            }
+            break;
+        case '#':
+            while (e.p < e.fim && *e.p != '\n') {
+                e.p++;
+            }
+            break;
+        default:
+            r = le_palavra(&e);
+            break;
+        }
+        if (r != ANALISE_OK) {
+            return r;
+        }
+    }
+    if (e.pendente) {
+        return ANALISE_INCOMPLETA;
+    }
+    termina_comando(&e, LIGACAO_SEQUENCIA);
+    return ANALISE_OK;
+}
+
+/// @brief Devolve o valor de uma variável (vazio se não existir).
+static const char *valor_variavel(const char *nome, size_t n, const char *codigo) {
+    char texto[256];
+    const char *valor;
+
+    if (n == 1 && nome[0] == '?') {
+        return codigo;
+    }
+    if (n >= sizeof(texto)) {
+        return "";
+    }
+    memcpy(texto, nome, n);
+    texto[n] = '\0';
+    valor = ambiente_valor(texto);
+    return valor != NULL ? valor : "";
+}
+
+/// @brief Substitui as variáveis de uma palavra (duas passagens: tamanho e cópia).
+/// @param protege Se diferente de 0 (a palavra é um padrão), os caracteres
+/// especiais dos valores são protegidos com '\\'.
+static char *expande_palavra(const char *texto, arena *a, const char *codigo, int protege) {
+    size_t tamanho = 0;
+    char *resultado = NULL, *w = NULL;
+
+    for (int passagem = 0; passagem < 2; passagem++) {
+        const char *q = texto;
+
+        if (passagem == 1) {
+            resultado = w = arena_aloca(a, tamanho + 1);
+            if (resultado == NULL) {
+                return NULL;
+            }
+        }
+        while (*q != '\0') {
+            const char *fim, *valor;
+            size_t n;
+
+            if (*q != MARCA || q[1] == MARCA) {
+                // Carácter normal ou MARCA literal (duplicada)
+                if (passagem == 1) {
+                    *w++ = *q;
+                } else {
+                    tamanho++;
+                }
+                q += *q == MARCA ? 2 : 1;
+                continue;
+            }
+            fim = strchr(q + 1, MARCA);
+            valor = valor_variavel(q + 1, fim - q - 1, codigo);
+            n = strlen(valor);
+            if (protege) {
+                for (const char *v = valor; *v != '\0'; v++) {
+                    if (passagem == 1) {
+                        if (e_especial_padrao(*v)) {
+                            *w++ = '\\';
+                        }
+                        *w++ = *v;
+                    } else {
+                        tamanho += 1 + e_especial_padrao(*v);
+                    }
+                }
+            } else if (passagem == 1) {
+                memcpy(w, valor, n);
+                w += n;
+            } else {
+                tamanho += n;
+            }
+            q = fim + 1;
+        }
+    }
+    *w = '\0';
+    return resultado;
+}
+
+/// @brief Constrói os argumentos de um comando, substituindo as variáveis e
+/// expandindo os padrões.
+/// @param c Comando.
+/// @param a Arena.
+/// @param ultimo_codigo Valor de $?.
+/// @return Argumentos terminados em NULL, ou NULL se faltar memória.
+char **expande_argumentos(const comando_analisado *c, arena *a, int ultimo_codigo) {
+    size_t capacidade = c->num_palavras + 1, n = 0;
+    char **args = arena_aloca(a, capacidade * sizeof(char *));
+    char codigo[16];
+    int restantes = c->num_palavras;
+
+    if (args == NULL) {
+        return NULL;
+    }
+    snprintf(codigo, sizeof(codigo), "%d", ultimo_codigo);
+    for (const palavra *p = c->palavras; p != NULL; p = p->seguinte) {
+        char *texto = p->expande ? expande_palavra(p->texto, a, codigo, p->padrao) : p->texto;
+        char **caminhos = &texto;
+        size_t num = 1;
+
+        if (texto == NULL) {
+            return NULL;
+        }
+        if (p->padrao) {
+            caminhos = expande_padrao(texto, a, &num);
+            if (caminhos == NULL) {
+                return NULL;
+            }
+            if (num == 0) {
+                // Sem correspondências: o argumento fica como foi escrito
+                if ((texto = desprotege_padrao(texto, a)) == NULL) {
+                    return NULL;
+                }
+                caminhos = &texto;
+                num = 1;
+            }
+        }
+        restantes--;
+
+        if (n + num + restantes + 1 > capacidade) {
+            char **maior;
+
+            capacidade = (n + num + restantes + 1) * 2;
+            if ((maior = arena_aloca(a, capacidade * sizeof(char *))) == NULL) {
+                return NULL;
+            }
+            memcpy(maior, args, n * sizeof(char *));
+            args = maior;
+        }
+        memcpy(args + n, caminhos, num * sizeof(char *));
+        n += num;
+    }
+    args[n] = NULL;
+    return args;
+}
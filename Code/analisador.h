@@ -0,0 +1,117 @@
+/**
+ * @file analisador.h
+ * @brief Análise da linha de comandos: aspas, escapes, variáveis e sequências.
+ *
+ * Gramática (numa só passagem pelo texto, sem limites de tamanho):
+ * - as palavras são separadas por espaços e tabs; '\\n' termina um comando;
+ * - '...' é literal; "..." aceita \\" \\\\ \\$ e variáveis; fora de aspas, '\\'
+ *   protege o carácter seguinte ('\\' no fim da linha continua-a);
+ * - $NOME, ${NOME} e $? (código de saída do comando anterior) são
+ *   substituídos quando o comando é executado;
+ * - `;` separa comandos, `a && b` só executa b se a tiver sucesso e
+ *   `a || b` só se a falhar; `&` lança o comando em fundo;
+ * - `|`, `<`, `>` e `>>` ficam nos argumentos para o pipeline;
+ * - '#' no início de uma palavra começa um comentário até ao fim da linha;
+ * - uma palavra com '*', '?' ou '[' fora de aspas é um padrão, substituído
+ *   pelos caminhos correspondentes (ou mantido, se não houver nenhum).
+ *
+ * Todos os tokens e nós ficam numa arena (ver arena.h): não há um malloc por
+ * token e tudo é libertado de uma vez quando a arena é reiniciada.
+ *
+ * @date 2025
+ */
+
+#ifndef ANALISADOR_H
+#define ANALISADOR_H
+
+#include <stddef.h>
+#include "arena.h"
+
+/**
+ * @brief Operadores que ficam nos argumentos de um comando.
+ *
+ * São comparados pelo endereço e não pelo texto: um "|" entre aspas é um
+ * argumento normal.
+ */
+extern char operador_pipe[], operador_entrada[], operador_saida[], operador_acrescenta[], operador_fundo[];
+
+/**
+ * @brief Indica se um argumento é um dos operadores do analisador.
+ * @param a Argumento.
+ * @return 1 se for um operador, 0 caso contrário.
+ */
+int e_operador_analisador(const char *a);
+
+/**
+ * @brief Como um comando se liga ao seguinte.
+ */
+typedef enum {
+    LIGACAO_SEQUENCIA,      ///< ';', '&' ou fim de linha: o seguinte é sempre executado
+    LIGACAO_E,              ///< '&&': o seguinte só é executado se este tiver sucesso
+    LIGACAO_OU              ///< '||': o seguinte só é executado se este falhar
+} ligacao_comando;
+
+/**
+ * @brief Palavra de um comando, ainda sem as variáveis substituídas.
+ */
+typedef struct palavra {
+    char *texto;                ///< texto (ou um dos operadores)
+    int expande;                ///< 1 se tem variáveis a substituir
+    int padrao;                 ///< 1 se tem '*', '?' ou '[' fora de aspas (ver padroes.h)
+    struct palavra *seguinte;
+} palavra;
+
+/**
+ * @brief Comando simples (ou pipeline) de uma lista de comandos.
+ */
+typedef struct comando_analisado {
+    palavra *palavras;
+    int num_palavras;
+    ligacao_comando liga;       ///< ligação ao comando seguinte
+    int linha;                  ///< linha onde o comando começa
+    struct comando_analisado *seguinte;
+} comando_analisado;
+
+/**
+ * @brief Resultado da análise.
+ */
+typedef enum {
+    ANALISE_OK,
+    ANALISE_INCOMPLETA,         ///< aspas por fechar, '\\' ou operador no fim do texto
+    ANALISE_ERRO                ///< erro de sintaxe (ver analise.erro)
+} resultado_analise;
+
+/**
+ * @brief Lista de comandos obtida da análise de um texto.
+ */
+typedef struct {
+    comando_analisado *comandos;    ///< primeiro comando (NULL se não houver)
+    size_t num_tokens;              ///< palavras e operadores encontrados
+    const char *erro;               ///< mensagem do erro de sintaxe
+    int linha_erro;                 ///< linha do erro de sintaxe
+} analise;
+
+/**
+ * @brief Analisa um texto com uma ou mais linhas de comandos.
+ * @param texto Texto a analisar (não precisa de terminar em '\\0').
+ * @param n Tamanho do texto.
+ * @param a Arena onde ficam os comandos e as palavras.
+ * @param res Resultado preenchido.
+ * @return ANALISE_OK, ANALISE_INCOMPLETA ou ANALISE_ERRO.
+ */
+resultado_analise analisa_comandos(const char *texto, size_t n, arena *a, analise *res);
+
+/**
+ * @brief Constrói os argumentos de um comando, substituindo as variáveis e
+ * expandindo os padrões.
+ *
+ * As variáveis vêm do ambiente; uma variável que não existe fica vazia. Os
+ * caminhos obtidos de um padrão ficam ordenados, no lugar do padrão.
+ * @param c Comando.
+ * @param a Arena onde ficam os argumentos.
+ * @param ultimo_codigo Valor de $?.
+ * @return Argumentos terminados em NULL, ou NULL se faltar memória.
+ */
+char **expande_argumentos(const comando_analisado *c, arena *a, int ultimo_codigo);
+
+#endif // ANALISADOR_H
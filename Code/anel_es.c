@@ -0,0 +1,505 @@
+/**
+ * @file anel_es.c
+ * @brief Implementação da camada de entrada/saída com io_uring.
+ *
+ * O io_uring é usado diretamente com as chamadas io_uring_setup,
+ * io_uring_enter e io_uring_register (sem a liburing). Cada thread tem o
+ * seu anel, guardado numa chave pthread e destruído quando a thread termina,
+ * por isso as threads do pool nunca partilham filas.
+ *
+ * Os pedidos são enviados em lotes de até `profundidade` pares: cada par usa
+ * o buffer registado com o mesmo índice, e o lote só é reutilizado depois de
+ * todas as conclusões chegarem. Uma leitura curta quebra a ligação com a
+ * escrita seguinte (o kernel cancela-a com -ECANCELED); esses blocos são
+ * terminados com pwrite/write, o que também trata o fim antecipado da origem.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include "anel_es.h"
+
+static modo_es modo_atual = ES_BLOQUEANTE;
+static int profundidade_atual = ES_PROFUNDIDADE_OMISSAO;
+
+/// 1 depois de o kernel recusar o io_uring (não voltar a tentar).
+static int sem_uring = 0;
+
+/// @brief Anel de uma thread: filas mapeadas do kernel e buffers registados.
+typedef struct {
+    int fd;
+    unsigned profundidade;          ///< pares leitura/escrita por lote
+    unsigned caracteristicas;       ///< IORING_FEAT_* do kernel
+    int registados;                 ///< 1 se os buffers estão registados (READ/WRITE_FIXED)
+    int avariado;                   ///< 1 se o estado das filas deixou de ser conhecido
+    unsigned por_enviar;            ///< pedidos preparados ainda não enviados ao kernel
+    unsigned *sq_cauda, *sq_mascara, *sq_indices;
+    unsigned *cq_cabeca, *cq_cauda, *cq_mascara;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *mapa_sq, *mapa_cq;
+    size_t tamanho_sq, tamanho_cq, tamanho_sqes;
+    unsigned char *buffers;         ///< profundidade * ES_BLOCO bytes
+} anel;
+
+static pthread_key_t chave_anel;
+static pthread_once_t chave_criada = PTHREAD_ONCE_INIT;
+
+/// @brief Obtém a hora atual em segundos (relógio monotónico).
+static double agora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/// @brief Liberta um anel (também usada como destrutor da chave pthread).
+static void destroi_anel(void *arg) {
+    anel *a = arg;
+
+    if (a == NULL) {
+        return;
+    }
+    if (a->sqes != NULL) {
+        munmap(a->sqes, a->tamanho_sqes);
+    }
+    if (a->mapa_cq != NULL && a->mapa_cq != a->mapa_sq) {
+        munmap(a->mapa_cq, a->tamanho_cq);
+    }
+    if (a->mapa_sq != NULL) {
+        munmap(a->mapa_sq, a->tamanho_sq);
+    }
+    if (a->fd != -1) {
+        close(a->fd);
+    }
+    free(a->buffers);
+    free(a);
+}
+
+static void cria_chave(void) {
+    pthread_key_create(&chave_anel, destroi_anel);
+}
+
+/// @brief Mapeia uma das regiões partilhadas do anel.
+/// @return Endereço, ou NULL em caso de erro.
+static void *mapeia(int fd, size_t tamanho, off_t regiao) {
+    void *p = mmap(NULL, tamanho, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, regiao);
+    return p == MAP_FAILED ? NULL : p;
+}
+
+/// @brief Cria um anel com espaço para `profundidade` pares leitura/escrita.
+/// @return Anel criado, ou NULL se o io_uring não estiver disponível.
+static anel *cria_anel(unsigned profundidade) {
+    struct io_uring_params p;
+    struct iovec iov[ES_PROFUNDIDADE_MAX];
+    anel *a = calloc(1, sizeof(anel));
+
+    if (a == NULL) {
+        return NULL;
+    }
+    memset(&p, 0, sizeof(p));
+    a->fd = syscall(__NR_io_uring_setup, 2 * profundidade, &p);
+    if (a->fd == -1) {
+        if (errno == ENOSYS || errno == EPERM || errno == EACCES) {
+            __atomic_store_n(&sem_uring, 1, __ATOMIC_RELAXED);
+        }
+        free(a);
+        return NULL;
+    }
+    a->profundidade = profundidade;
+    a->caracteristicas = p.features;
+
+    // Filas de pedidos (SQ) e de conclusões (CQ), e o vetor de pedidos
+    a->tamanho_sq = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    a->tamanho_cq = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (a->tamanho_cq > a->tamanho_sq) {
+            a->tamanho_sq = a->tamanho_cq;
+        }
+        a->mapa_sq = a->mapa_cq = mapeia(a->fd, a->tamanho_sq, IORING_OFF_SQ_RING);
+    } else {
+        a->mapa_sq = mapeia(a->fd, a->tamanho_sq, IORING_OFF_SQ_RING);
+        a->mapa_cq = mapeia(a->fd, a->tamanho_cq, IORING_OFF_CQ_RING);
+    }
+    a->tamanho_sqes = p.sq_entries * sizeof(struct io_uring_sqe);
+    a->sqes = mapeia(a->fd, a->tamanho_sqes, IORING_OFF_SQES);
+    if (posix_memalign((void **)&a->buffers, 4096, (size_t)profundidade * ES_BLOCO) != 0) {
+        a->buffers = NULL;
+    }
+    if (a->mapa_sq == NULL || a->mapa_cq == NULL || a->sqes == NULL || a->buffers == NULL) {
+        destroi_anel(a);
+        return NULL;
+    }
+    a->sq_cauda = (unsigned *)((char *)a->mapa_sq + p.sq_off.tail);
+    a->sq_mascara = (unsigned *)((char *)a->mapa_sq + p.sq_off.ring_mask);
+    a->sq_indices = (unsigned *)((char *)a->mapa_sq + p.sq_off.array);
+    a->cq_cabeca = (unsigned *)((char *)a->mapa_cq + p.cq_off.head);
+    a->cq_cauda = (unsigned *)((char *)a->mapa_cq + p.cq_off.tail);
+    a->cq_mascara = (unsigned *)((char *)a->mapa_cq + p.cq_off.ring_mask);
+    a->cqes = (struct io_uring_cqe *)((char *)a->mapa_cq + p.cq_off.cqes);
+
+    // Buffers registados: o kernel fixa as páginas uma vez, em vez de em
+    // cada pedido. Sem permissão (RLIMIT_MEMLOCK), usa pedidos normais.
+    for (unsigned i = 0; i < profundidade; i++) {
+        iov[i].iov_base = a->buffers + (size_t)i * ES_BLOCO;
+        iov[i].iov_len = ES_BLOCO;
+    }
+    a->registados = syscall(__NR_io_uring_register, a->fd, IORING_REGISTER_BUFFERS, iov, profundidade) == 0;
+    return a;
+}
+
+/// @brief Devolve o anel da thread, criando-o se for preciso.
+/// @return Anel, ou NULL se o modo for bloqueante ou o io_uring não estiver disponível.
+static anel *anel_da_thread(void) {
+    anel *a;
+
+    if (modo_atual != ES_URING || __atomic_load_n(&sem_uring, __ATOMIC_RELAXED)) {
+        return NULL;
+    }
+    pthread_once(&chave_criada, cria_chave);
+    a = pthread_getspecific(chave_anel);
+    if (a != NULL && (a->avariado || a->profundidade != (unsigned)profundidade_atual)) {
+        destroi_anel(a);
+        a = NULL;
+    }
+    if (a == NULL) {
+        a = cria_anel(profundidade_atual);
+    }
+    pthread_setspecific(chave_anel, a);
+    return a;
+}
+
+/// @brief Prepara um pedido de leitura ou escrita sobre o buffer `indice`.
+/// @param off Posição no ficheiro, ou -1 para a posição atual do descritor.
+static void prepara(anel *a, int leitura, int fd, unsigned indice, unsigned len, off_t off,
+                    unsigned char flags, uint64_t identificador) {
+    unsigned cauda = *a->sq_cauda;     // só esta thread escreve a cauda
+    unsigned i = cauda & *a->sq_mascara;
+    struct io_uring_sqe *sqe = &a->sqes[i];
+
+    memset(sqe, 0, sizeof(*sqe));
+    if (a->registados) {
+        sqe->opcode = leitura ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+        sqe->buf_index = indice;
+    } else {
+        sqe->opcode = leitura ? IORING_OP_READ : IORING_OP_WRITE;
+    }
+    sqe->fd = fd;
+    sqe->addr = (uintptr_t)(a->buffers + (size_t)indice * ES_BLOCO);
+    sqe->len = len;
+    sqe->off = (uint64_t)off;
+    sqe->flags = flags;
+    sqe->user_data = identificador;
+    a->sq_indices[i] = i;
+    __atomic_store_n(a->sq_cauda, cauda + 1, __ATOMIC_RELEASE);
+    a->por_enviar++;
+}
+
+/// @brief Envia os pedidos preparados e espera por n conclusões.
+/// @param resultados Resultado de cada pedido, indexado pelo identificador.
+/// @return 0 em caso de sucesso, -1 em caso de erro (o anel fica marcado como avariado).
+static int envia_e_espera(anel *a, unsigned n, int *resultados) {
+    unsigned recebidas = 0;
+
+    for (;;) {
+        unsigned cabeca = *a->cq_cabeca;
+        unsigned cauda = __atomic_load_n(a->cq_cauda, __ATOMIC_ACQUIRE);
+        long r;
+
+        while (cabeca != cauda && recebidas < n) {
+            const struct io_uring_cqe *cqe = &a->cqes[cabeca & *a->cq_mascara];
+            resultados[cqe->user_data] = cqe->res;
+            cabeca++;
+            recebidas++;
+        }
+        __atomic_store_n(a->cq_cabeca, cabeca, __ATOMIC_RELEASE);
+        if (recebidas == n) {
+            return 0;
+        }
+
+        r = syscall(__NR_io_uring_enter, a->fd, a->por_enviar, n - recebidas, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (r == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            a->avariado = 1;
+            return -1;
+        }
+        a->por_enviar -= (unsigned)r;
+    }
+}
+
+/// @brief Escreve n bytes com pwrite (ou write, se off for -1), tratando escritas parciais.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+static int escreve_tudo(int fd, const unsigned char *dados, size_t n, off_t off) {
+    while (n > 0) {
+        ssize_t w = off >= 0 ? pwrite(fd, dados, n, off) : write(fd, dados, n);
+
+        if (w < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        dados += w;
+        n -= w;
+        if (off >= 0) {
+            off += w;
+        }
+    }
+    return 0;
+}
+
+/// @brief Copia [posição atual, tamanho) da origem para o destino com pares ligados.
+/// @return 1 se chegou ao fim, 0 se não se aplica (nada foi copiado), -1 em erro.
+/// @details
+/// Variáveis:
+/// - origem: próximo byte da origem a copiar
+/// - posicionado: 1 se o destino aceita posições explícitas (pares independentes)
+static int copia_anel(anel *a, int fd_src, int fd_dest, off_t tamanho, unsigned long long *bytes) {
+    int resultados[2 * ES_PROFUNDIDADE_MAX];
+    struct stat st;
+    off_t inicio = lseek(fd_src, 0, SEEK_CUR), origem = inicio;
+    off_t destino = lseek(fd_dest, 0, SEEK_CUR);
+    int flags = fcntl(fd_dest, F_GETFL), fim = 0;
+    int posicionado = destino != -1 && flags != -1 && !(flags & O_APPEND) &&
+                      fstat(fd_dest, &st) == 0 && S_ISREG(st.st_mode);
+
+    // Sem posições, as escritas usam a posição atual (offset -1)
+    if (inicio == -1 || (!posicionado && !(a->caracteristicas & IORING_FEAT_RW_CUR_POS))) {
+        return 0;
+    }
+
+    while (origem < tamanho && !fim) {
+        off_t restante = tamanho - origem;
+        unsigned n = restante >= (off_t)a->profundidade * ES_BLOCO
+                     ? a->profundidade : (unsigned)((restante + ES_BLOCO - 1) / ES_BLOCO);
+        off_t lote = origem;
+
+        for (unsigned k = 0; k < n; k++) {
+            off_t pos = lote + (off_t)k * ES_BLOCO;
+            unsigned len = tamanho - pos < ES_BLOCO ? (unsigned)(tamanho - pos) : ES_BLOCO;
+            // Num destino sem posições todo o lote é uma cadeia, para manter a ordem
+            unsigned char liga = !posicionado && k + 1 < n ? IOSQE_IO_LINK : 0;
+
+            prepara(a, 1, fd_src, k, len, pos, IOSQE_IO_LINK, 2 * k);
+            prepara(a, 0, fd_dest, k, len, posicionado ? destino + (pos - inicio) : -1, liga, 2 * k + 1);
+        }
+        if (envia_e_espera(a, 2 * n, resultados) == -1) {
+            return -1;
+        }
+
+        for (unsigned k = 0; k < n; k++) {
+            off_t pos = lote + (off_t)k * ES_BLOCO;
+            int len = tamanho - pos < ES_BLOCO ? (int)(tamanho - pos) : ES_BLOCO;
+            int lidos = resultados[2 * k], escritos = resultados[2 * k + 1];
+
+            if (lidos == len && escritos == len) {
+                *bytes += len;
+                origem = pos + len;
+                continue;
+            }
+            if (lidos == -ECANCELED) {
+                break;      // a cadeia foi quebrada antes: repetir a partir daqui
+            }
+            if (lidos < 0 || (escritos < 0 && escritos != -ECANCELED)) {
+                errno = lidos < 0 ? -lidos : -escritos;
+                return -1;
+            }
+            // Leitura ou escrita curta: terminar o bloco sem o io_uring
+            if (escritos < 0) {
+                escritos = 0;
+            }
+            if (escreve_tudo(fd_dest, a->buffers + (size_t)k * ES_BLOCO + escritos, lidos - escritos,
+                             posicionado ? destino + (pos - inicio) + escritos : -1) == -1) {
+                return -1;
+            }
+            *bytes += lidos;
+            origem = pos + lidos;
+            if (lidos < len) {
+                fim = 1;    // a origem encolheu
+                break;
+            }
+        }
+    }
+
+    // Deixar as posições no fim, como o motor de cópia
+    lseek(fd_src, origem, SEEK_SET);
+    if (posicionado) {
+        lseek(fd_dest, destino + (origem - inicio), SEEK_SET);
+    }
+    return 1;
+}
+
+/// @brief Copia o resto de fd_src para fd_dest, com io_uring se estiver ativo.
+/// @param fd_src Descritor de origem.
+/// @param fd_dest Descritor de destino.
+/// @param res Resultado da cópia (pode ser NULL).
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+/// @details Só as origens regulares com dados depois da posição atual usam
+/// o anel: o tamanho de ficheiros como os de /proc é 0 e o motor de cópia
+/// lê-os até ao fim.
+int es_copia(int fd_src, int fd_dest, resultado_copia *res) {
+    anel *a = anel_da_thread();
+    struct stat st;
+    unsigned long long bytes = 0;
+    double inicio = agora();
+    int r;
+
+    if (a == NULL || fstat(fd_src, &st) == -1 || !S_ISREG(st.st_mode) ||
+        st.st_size <= lseek(fd_src, 0, SEEK_CUR)) {
+        return copia_descritores(fd_src, fd_dest, res);
+    }
+    r = copia_anel(a, fd_src, fd_dest, st.st_size, &bytes);
+    if (r == 0) {
+        return copia_descritores(fd_src, fd_dest, res);
+    }
+    if (res != NULL) {
+        res->metodo = COPIA_IO_URING;
+        res->bytes = bytes;
+        res->segundos = agora() - inicio;
+    }
+    return r == 1 ? 0 : -1;
+}
+
+/// @brief Lê [pos, tamanho) com até `profundidade` leituras em curso.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+static int le_anel(anel *a, int fd, off_t pos, off_t tamanho, consumidor_es consome, void *arg) {
+    int resultados[ES_PROFUNDIDADE_MAX];
+    int fim = 0;
+
+    while (pos < tamanho && !fim) {
+        off_t restante = tamanho - pos;
+        unsigned n = restante >= (off_t)a->profundidade * ES_BLOCO
+                     ? a->profundidade : (unsigned)((restante + ES_BLOCO - 1) / ES_BLOCO);
+
+        for (unsigned k = 0; k < n; k++) {
+            off_t p = pos + (off_t)k * ES_BLOCO;
+            prepara(a, 1, fd, k, tamanho - p < ES_BLOCO ? (unsigned)(tamanho - p) : ES_BLOCO, p, 0, k);
+        }
+        if (envia_e_espera(a, n, resultados) == -1) {
+            return -1;
+        }
+        // Entregar por ordem; uma leitura curta é o fim do ficheiro
+        for (unsigned k = 0; k < n && !fim; k++) {
+            off_t p = pos + (off_t)k * ES_BLOCO;
+            int len = tamanho - p < ES_BLOCO ? (int)(tamanho - p) : ES_BLOCO;
+
+            if (resultados[k] < 0) {
+                errno = -resultados[k];
+                return -1;
+            }
+            if (resultados[k] > 0) {
+                consome(a->buffers + (size_t)k * ES_BLOCO, resultados[k], arg);
+            }
+            fim = resultados[k] < len;
+        }
+        pos += (off_t)n * ES_BLOCO;
+    }
+    lseek(fd, pos < tamanho ? pos : tamanho, SEEK_SET);
+    return 0;
+}
+
+/// @brief Lê o resto de um descritor com read.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+static int le_bloqueante(int fd, consumidor_es consome, void *arg) {
+    unsigned char *buffer = malloc(ES_BLOCO);
+    ssize_t n;
+
+    if (buffer == NULL) {
+        return -1;
+    }
+    while ((n = read(fd, buffer, ES_BLOCO)) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            free(buffer);
+            return -1;
+        }
+        consome(buffer, n, arg);
+    }
+    free(buffer);
+    return 0;
+}
+
+/// @brief Lê o resto de um descritor, entregando os blocos por ordem.
+/// @param fd Descritor.
+/// @param consome Função chamada com cada bloco.
+/// @param arg Argumento de consome.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+int es_le(int fd, consumidor_es consome, void *arg) {
+    anel *a = anel_da_thread();
+    struct stat st;
+    off_t pos;
+
+    if (a != NULL && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+        (pos = lseek(fd, 0, SEEK_CUR)) != -1 && st.st_size > pos) {
+        return le_anel(a, fd, pos, st.st_size, consome, arg);
+    }
+    return le_bloqueante(fd, consome, arg);
+}
+
+/// @brief Indica se o kernel permite criar um io_uring (testado uma vez).
+int es_uring_disponivel(void) {
+    static int disponivel = -1;
+
+    if (disponivel == -1) {
+        anel *a = cria_anel(1);
+        disponivel = a != NULL;
+        destroi_anel(a);
+    }
+    return disponivel;
+}
+
+/// @brief Modo de entrada/saída atual.
+modo_es es_modo(void) {
+    return modo_atual;
+}
+
+/// @brief Muda o modo de entrada/saída.
+/// @param nome Nome do modo.
+/// @return 0 em caso de sucesso, -1 se o nome não for conhecido.
+int es_define(const char *nome) {
+    for (int m = ES_BLOQUEANTE; m <= ES_URING; m++) {
+        if (strcmp(nome, nome_modo_es((modo_es)m)) == 0) {
+            modo_atual = (modo_es)m;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/// @brief Nome de um modo de entrada/saída.
+const char *nome_modo_es(modo_es modo) {
+    return modo == ES_URING ? "uring" : "bloqueante";
+}
+
+/// @brief Profundidade atual da fila.
+int es_profundidade(void) {
+    return profundidade_atual;
+}
+
+/// @brief Muda a profundidade da fila.
+/// @param profundidade Pares leitura/escrita por lote.
+/// @return 0 em caso de sucesso, -1 se o valor for inválido.
+int es_define_profundidade(int profundidade) {
+    if (profundidade < 1 || profundidade > ES_PROFUNDIDADE_MAX) {
+        return -1;
+    }
+    profundidade_atual = profundidade;
+    return 0;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file anel_es.h
+ * @brief Camada de entrada/saída dos comandos de ficheiros, com io_uring opcional.
+ *
+ * No modo "bloqueante" (por omissão) as operações usam as chamadas de sempre
+ * (o motor de cópia e read). No modo "uring" usam um io_uring por thread,
+ * criado na primeira utilização, com buffers registados no kernel
+ * (IORING_REGISTER_BUFFERS): cada bloco é lido e escrito por um par de
+ * pedidos ligados (leitura → escrita, IOSQE_IO_LINK) e vários pares seguem
+ * numa só chamada a io_uring_enter, até à profundidade configurada. Se o
+ * kernel não suportar io_uring (ou o tiver desativado), as operações voltam
+ * às chamadas bloqueantes sem erro.
+ *
+ * @date 2025
+ */
+
+#ifndef ANEL_ES_H
+#define ANEL_ES_H
+
+#include <stddef.h>
+#include "motor_copia.h"
+
+/// Profundidade por omissão: pares leitura/escrita em curso.
+#define ES_PROFUNDIDADE_OMISSAO 32
+
+/// Profundidade máxima aceite por `set profundidade_io`.
+#define ES_PROFUNDIDADE_MAX 256
+
+/// Tamanho de cada buffer registado.
+#define ES_BLOCO (128 * 1024)
+
+/**
+ * @brief Mecanismo de entrada/saída dos comandos de ficheiros.
+ */
+typedef enum {
+    ES_BLOQUEANTE,
+    ES_URING
+} modo_es;
+
+/**
+ * @brief Função que recebe, por ordem, os blocos lidos por es_le.
+ * @param dados Bloco lido.
+ * @param n Tamanho do bloco.
+ * @param arg Argumento passado a es_le.
+ */
+typedef void (*consumidor_es)(const unsigned char *dados, size_t n, void *arg);
+
+/**
+ * @brief Copia tudo o que resta de fd_src (a partir da posição atual) para fd_dest.
+ *
+ * No modo "uring", com uma origem regular, a cópia é feita com pares
+ * leitura/escrita ligados; se o destino tiver posições (um ficheiro regular
+ * sem O_APPEND) os pares são independentes, caso contrário (pipe, terminal)
+ * formam uma só cadeia, para os dados saírem por ordem. Nos outros casos usa
+ * copia_descritores. As posições dos dois descritores ficam no fim, como no
+ * motor de cópia.
+ * @param fd_src Descritor de origem.
+ * @param fd_dest Descritor de destino.
+ * @param res Resultado da cópia (pode ser NULL).
+ * @return 0 em caso de sucesso, -1 em caso de erro (errno indica a causa).
+ */
+int es_copia(int fd_src, int fd_dest, resultado_copia *res);
+
+/**
+ * @brief Lê tudo o que resta de um descritor, entregando os blocos por ordem.
+ *
+ * No modo "uring", com um ficheiro regular, mantém até à profundidade
+ * configurada leituras em curso; nos outros casos usa read.
+ * @param fd Descritor a ler.
+ * @param consome Função chamada com cada bloco.
+ * @param arg Argumento de consome.
+ * @return 0 em caso de sucesso, -1 em caso de erro de leitura.
+ */
+int es_le(int fd, consumidor_es consome, void *arg);
+
+/**
+ * @brief Indica se o kernel permite criar um io_uring.
+ * @return 1 se sim, 0 se não.
+ */
+int es_uring_disponivel(void);
+
+/**
+ * @brief Devolve o modo de entrada/saída atual.
+ * @return Modo atual.
+ */
+modo_es es_modo(void);
+
+/**
+ * @brief Muda o modo de entrada/saída.
+ * @param nome "bloqueante" ou "uring".
+ * @return 0 em caso de sucesso, -1 se o nome não for conhecido.
+ */
+int es_define(const char *nome);
+
+/**
+ * @brief Devolve o nome de um modo de entrada/saída.
+ * @param modo Modo.
+ * @return String constante com o nome.
+ */
+const char *nome_modo_es(modo_es modo);
+
+/**
+ * @brief Devolve a profundidade da fila (pares leitura/escrita em curso).
+ * @return Profundidade atual.
+ */
+int es_profundidade(void);
+
+/**
+ * @brief Muda a profundidade da fila; os anéis existentes são recriados na
+ * próxima utilização.
+ * @param profundidade Valor entre 1 e ES_PROFUNDIDADE_MAX.
+ * @return 0 em caso de sucesso, -1 se o valor for inválido.
+ */
+int es_define_profundidade(int profundidade);
+
+#endif // ANEL_ES_H
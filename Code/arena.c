@@ -0,0 +1,91 @@
+/**
+ * @file arena.c
+ * @brief Implementação da arena de memória.
+ *
+ * Os blocos formam uma lista. Quando o bloco atual não chega, a arena passa
+ * ao bloco seguinte (já existente, de uma linha anterior) se for grande o
+ * suficiente, ou cria um novo logo a seguir ao atual.
+ *
+ * @date 2025
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include "arena.h"
+
+/// Alinhamento das reservas de arena_aloca.
+#define ALINHAMENTO _Alignof(max_align_t)
+
+struct bloco_arena {
+    bloco_arena *seguinte;
+    size_t tamanho;
+    _Alignas(max_align_t) unsigned char dados[];
+};
+
+/// @brief Passa para um bloco com pelo menos n bytes livres.
+/// @return 0 em caso de sucesso, -1 se faltar memória.
+static int avanca(arena *a, size_t n) {
+    bloco_arena *seguinte = a->atual != NULL ? a->atual->seguinte : a->primeiro;
+    bloco_arena *novo;
+    size_t tamanho;
+
+    if (seguinte != NULL && seguinte->tamanho >= n) {
+        a->atual = seguinte;
+        a->usado = 0;
+        return 0;
+    }
+
+    tamanho = n > ARENA_BLOCO ? n : ARENA_BLOCO;
+    novo = malloc(sizeof(bloco_arena) + tamanho);
+    if (novo == NULL) {
+        return -1;
+    }
+    novo->tamanho = tamanho;
+    novo->seguinte = seguinte;
+    if (a->atual != NULL) {
+        a->atual->seguinte = novo;
+    } else {
+        a->primeiro = novo;
+    }
+    a->atual = novo;
+    a->usado = 0;
+    return 0;
+}
+
+/// @brief Reserva n bytes alinhados.
+/// @param a Arena.
+/// @param n Número de bytes.
+/// @return Memória reservada, ou NULL se faltar memória.
+void *arena_aloca(arena *a, size_t n) {
+    size_t inicio = (a->usado + ALINHAMENTO - 1) & ~(ALINHAMENTO - 1);
+
+    if (a->atual == NULL || inicio + n > a->atual->tamanho) {
+        if (avanca(a, n) == -1) {
+            return NULL;
+        }
+        inicio = 0;
+    }
+    a->usado = inicio + n;
+    return a->atual->dados + inicio;
+}
+
+/// @brief Volta ao início do primeiro bloco (O(1)).
+/// @param a Arena.
+void arena_reinicia(arena *a) {
+    a->atual = a->primeiro;
+    a->usado = 0;
+}
+
+/// @brief Liberta todos os blocos.
+/// @param a Arena.
+void arena_liberta(arena *a) {
+    bloco_arena *b = a->primeiro;
+
+    while (b != NULL) {
+        bloco_arena *seguinte = b->seguinte;
+        free(b);
+        b = seguinte;
+    }
+    a->primeiro = a->atual = NULL;
+    a->usado = 0;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file arena.h
+ * @brief Arena de memória (bump allocator) para os dados de uma linha de comandos.
+ *
+ * As reservas avançam um ponteiro dentro de blocos grandes; nada é libertado
+ * individualmente. arena_reinicia volta ao primeiro bloco em O(1) e os
+ * blocos ficam guardados para as linhas seguintes, por isso, depois das
+ * primeiras linhas, o interpretador deixa de chamar o malloc.
+ *
+ * @date 2025
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/// Tamanho mínimo de cada bloco da arena.
+#define ARENA_BLOCO (64 * 1024)
+
+/**
+ * @brief Bloco de memória da arena (opaco).
+ */
+typedef struct bloco_arena bloco_arena;
+
+/**
+ * @brief Arena: lista de blocos e posição livre no bloco atual.
+ */
+typedef struct {
+    bloco_arena *primeiro;
+    bloco_arena *atual;
+    size_t usado;           ///< bytes usados no bloco atual
+} arena;
+
+/// Arena vazia (os blocos são criados na primeira reserva).
+#define ARENA_VAZIA { NULL, NULL, 0 }
+
+/**
+ * @brief Reserva memória alinhada para qualquer tipo.
+ * @param a Arena.
+ * @param n Número de bytes.
+ * @return Ponteiro para a memória, ou NULL se faltar memória.
+ */
+void *arena_aloca(arena *a, size_t n);
+
+/**
+ * @brief Liberta de uma vez tudo o que foi reservado, mantendo os blocos.
+ * @param a Arena.
+ */
+void arena_reinicia(arena *a);
+
+/**
+ * @brief Liberta todos os blocos da arena.
+ * @param a Arena.
+ */
+void arena_liberta(arena *a);
+
+#endif // ARENA_H
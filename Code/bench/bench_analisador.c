@@ -0,0 +1,89 @@
+/**
+ * @file bench_analisador.c
+ * @brief Mede o débito do analisador da linha de comandos (tokens/s).
+ *
+ * Compara analisa_comandos (com a arena reiniciada em cada linha, como no
+ * interpretador) com a divisão antiga em palavras por strtok numa cópia da
+ * linha, que não trata aspas nem variáveis. Mede linhas curtas, típicas do
+ * modo interativo, e uma linha muito longa.
+ *
+ * Utilização: bench_analisador [repetições]
+ *
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "analisador.h"
+
+static double agora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/// @brief Divisão por strtok (referência); devolve o número de tokens.
+static size_t divide_strtok(const char *linha, size_t n) {
+    char *copia = malloc(n + 1), *t;
+    size_t tokens = 0;
+
+    memcpy(copia, linha, n);
+    copia[n] = '\0';
+    for (t = strtok(copia, " \t\n"); t != NULL; t = strtok(NULL, " \t\n")) {
+        tokens++;
+    }
+    free(copia);
+    return tokens;
+}
+
+/// @brief Mede as duas versões numa linha e mostra os tokens/s.
+static void compara(const char *nome, const char *linha, long repeticoes) {
+    size_t n = strlen(linha), tokens_strtok = 0, tokens_analisador = 0;
+    arena a = ARENA_VAZIA;
+    analise res;
+    double t0, t1, t2;
+
+    t0 = agora();
+    for (long i = 0; i < repeticoes; i++) {
+        tokens_strtok += divide_strtok(linha, n);
+    }
+    t1 = agora();
+    for (long i = 0; i < repeticoes; i++) {
+        arena_reinicia(&a);
+        if (analisa_comandos(linha, n, &a, &res) != ANALISE_OK) {
+            fprintf(stderr, "Erro: %s\n", res.erro);
+            exit(1);
+        }
+        tokens_analisador += res.num_tokens;
+    }
+    t2 = agora();
+    arena_liberta(&a);
+
+    printf("%-26s %16.1f %16.1f\n", nome, tokens_strtok / (t1 - t0) / 1e6, tokens_analisador / (t2 - t1) / 1e6);
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+    long repeticoes = argc > 1 ? atol(argv[1]) : 1000000;
+    size_t palavras = 100000;
+    char *longa = malloc(palavras * 8 + 1), *p;
+
+    if (longa == NULL || repeticoes < 1) {
+        fprintf(stderr, "Utilização: bench_analisador [repetições]\n");
+        return 1;
+    }
+    p = longa;
+    for (size_t i = 0; i < palavras; i++) {
+        p += sprintf(p, "arg%04zu ", i % 10000);
+    }
+
+    printf("%-26s %16s %16s\n", "", "strtok Mtok/s", "analisador Mtok/s");
+    compara("linha curta", "mostra ficheiro.txt", repeticoes);
+    compara("linha com pipeline", "ls -l /tmp | wc -l > saida.txt", repeticoes);
+    compara("linha com aspas", "echo 'a b c' \"d e\" f\\ g h", repeticoes);
+    compara("linha de 100000 palavras", longa, repeticoes / 10000 > 0 ? repeticoes / 10000 : 1);
+    free(longa);
+    return 0;
+}
@@ -0,0 +1,537 @@
+/**
+ * @file bench_comandos.c
+ * @brief Compara os comandos internos com os equivalentes do coreutils,
+ * executados pelo próprio interpretador.
+ *
+ * Gera os dados (ficheiros de texto de 1 KiB a 64 MiB, ou até 2 GiB com -g,
+ * uma diretoria com 100000 entradas, ou 1 milhão com -g, árvores para o
+ * `apaga -r` e scripts compridos) e, para cada caso, escreve um script que
+ * alterna o comando interno e o do coreutils com `set perfil on` e lê os
+ * tempos de cada um com `perfil csv`. O despacho de comandos internos e o
+ * lançamento de processos são comparados com o sh, pelo tempo total de um
+ * script comprido.
+ *
+ * Os resultados (percentis 50, 90 e 99 e débito no percentil 50) podem ser
+ * gravados em CSV (-o) e comparados com uma execução anterior (-b). As
+ * mensagens do interpretador vão para <diretoria>/erros.log.
+ *
+ * Utilização: bench_comandos [-g] [-r repetições] [-d diretoria]
+ *                            [-i interpretador] [-o resultados.csv] [-b base.csv]
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <spawn.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+/// Número máximo de resultados (um por caso e por comando).
+#define MAX_RESULTADOS 64
+
+/// Amostras máximas por comando (o anel do perfil guarda 1024 medições).
+#define MAX_AMOSTRAS 500
+
+/// @brief Resultado de um comando num caso.
+typedef struct {
+    char caso[48];
+    char comando[16];
+    int n;                      ///< amostras
+    double p50, p90, p99;       ///< segundos
+    double debito;              ///< unidades por segundo, no percentil 50
+    const char *unidade;
+} resultado;
+
+extern char **environ;
+
+static resultado resultados[MAX_RESULTADOS];
+static int num_resultados = 0;
+static const char *interpretador = "./interpretador";
+static char dir[4096] = "/tmp/bench_comandos";
+
+/// @brief Instante atual em segundos.
+static double agora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int compara_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+/// @brief Percentil p (0 a 100) de amostras ordenadas, pelo método do rank mais próximo.
+static double percentil(const double *v, int n, double p) {
+    int k = (int)(p / 100.0 * n + 0.999999);
+
+    return v[k < 1 ? 0 : k > n ? n - 1 : k - 1];
+}
+
+/// @brief Guarda o resultado de um comando a partir das suas amostras.
+static void acrescenta_resultado(const char *caso, const char *comando, double *amostras, int n,
+                                 double quantidade, const char *unidade) {
+    resultado *r;
+
+    if (n == 0 || num_resultados == MAX_RESULTADOS) {
+        return;
+    }
+    r = &resultados[num_resultados++];
+    qsort(amostras, n, sizeof(double), compara_double);
+    snprintf(r->caso, sizeof(r->caso), "%s", caso);
+    snprintf(r->comando, sizeof(r->comando), "%s", comando);
+    r->n = n;
+    r->p50 = percentil(amostras, n, 50);
+    r->p90 = percentil(amostras, n, 90);
+    r->p99 = percentil(amostras, n, 99);
+    r->debito = r->p50 > 0 ? quantidade / r->p50 : 0;
+    r->unidade = unidade;
+}
+
+/// @brief Executa um programa com um script, com a saída em /dev/null e os erros em erros.log.
+/// @return Duração em segundos, ou -1 se não puder ser executado.
+static double executa(const char *programa, const char *opcao, const char *script) {
+    char *argv[] = { (char *)programa, (char *)opcao, (char *)script, NULL };
+    posix_spawn_file_actions_t acoes;
+    char erros[4200];
+    double inicio;
+    int estado;
+    pid_t pid;
+
+    if (opcao == NULL) {
+        argv[1] = (char *)script;
+        argv[2] = NULL;
+    }
+    posix_spawn_file_actions_init(&acoes);
+    posix_spawn_file_actions_addopen(&acoes, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    snprintf(erros, sizeof(erros), "%s/erros.log", dir);
+    posix_spawn_file_actions_addopen(&acoes, STDERR_FILENO, erros, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    inicio = agora();
+    if (posix_spawnp(&pid, programa, &acoes, NULL, argv, environ) != 0) {
+        posix_spawn_file_actions_destroy(&acoes);
+        fprintf(stderr, "Erro: Não foi possível executar '%s'.\n", programa);
+        return -1;
+    }
+    posix_spawn_file_actions_destroy(&acoes);
+    waitpid(pid, &estado, 0);
+    return agora() - inicio;
+}
+
+/// @brief Cria um ficheiro de texto (linhas de ~80 caracteres) com o tamanho indicado,
+/// se ainda não existir com esse tamanho.
+static int cria_texto(const char *caminho, unsigned long long tamanho) {
+    static char bloco[1 << 20];
+    unsigned int semente = 7;
+    struct stat st;
+    int fd;
+
+    if (stat(caminho, &st) == 0 && (unsigned long long)st.st_size == tamanho) {
+        return 0;
+    }
+    for (size_t i = 0; i < sizeof(bloco); i++) {
+        semente = semente * 1103515245 + 12345;
+        bloco[i] = (i % 80 == 79) ? '\n' : ((semente >> 16) % 7 == 0 ? ' ' : 'a' + (semente >> 16) % 26);
+    }
+    fd = open(caminho, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        perror(caminho);
+        return -1;
+    }
+    for (unsigned long long escrito = 0; escrito < tamanho; ) {
+        size_t n = tamanho - escrito < sizeof(bloco) ? tamanho - escrito : sizeof(bloco);
+
+        if (write(fd, bloco, n) != (ssize_t)n) {
+            perror(caminho);
+            close(fd);
+            return -1;
+        }
+        escrito += n;
+    }
+    close(fd);
+    return 0;
+}
+
+/// @brief Cria os ficheiros vazios dir/nome/f0000000... (com um marcador no fim,
+/// para não repetir o trabalho na execução seguinte).
+static int cria_entradas(const char *nome, int n) {
+    char caminho[4200], marcador[4200];
+    struct stat st;
+
+    snprintf(marcador, sizeof(marcador), "%s/%s.%d", dir, nome, n);
+    if (stat(marcador, &st) == 0) {
+        return 0;
+    }
+    snprintf(caminho, sizeof(caminho), "%s/%s", dir, nome);
+    mkdir(caminho, 0755);
+    for (int i = 0; i < n; i++) {
+        int fd;
+
+        snprintf(caminho, sizeof(caminho), "%s/%s/f%07d", dir, nome, i);
+        fd = open(caminho, O_WRONLY | O_CREAT, 0644);
+        if (fd == -1) {
+            perror(caminho);
+            return -1;
+        }
+        close(fd);
+    }
+    close(open(marcador, O_WRONLY | O_CREAT, 0644));
+    return 0;
+}
+
+/// @brief Cria a árvore dir/arvores/a<i> com subdiretorias × ficheiros (de 100 bytes).
+static int cria_arvore(int i, int subdiretorias, int ficheiros) {
+    static const char conteudo[100];
+    char caminho[4200];
+
+    snprintf(caminho, sizeof(caminho), "%s/arvores", dir);
+    mkdir(caminho, 0755);
+    snprintf(caminho, sizeof(caminho), "%s/arvores/a%d", dir, i);
+    mkdir(caminho, 0755);
+    for (int d = 0; d < subdiretorias; d++) {
+        snprintf(caminho, sizeof(caminho), "%s/arvores/a%d/d%d", dir, i, d);
+        mkdir(caminho, 0755);
+        for (int f = 0; f < ficheiros; f++) {
+            int fd;
+
+            snprintf(caminho, sizeof(caminho), "%s/arvores/a%d/d%d/f%d", dir, i, d, f);
+            fd = open(caminho, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd == -1 || write(fd, conteudo, sizeof(conteudo)) < 0) {
+                perror(caminho);
+                return -1;
+            }
+            close(fd);
+        }
+    }
+    return 0;
+}
+
+/// @brief Lê os tempos (coluna "real") e os códigos de um CSV do `perfil csv`.
+/// @return Número de medições lidas, ou -1 se o ficheiro não existir.
+static int le_perfil(const char *caminho, double *tempos, int *codigos, int max) {
+    char *linha = NULL;
+    size_t capacidade = 0;
+    int n = 0;
+    FILE *f = fopen(caminho, "r");
+
+    if (f == NULL) {
+        return -1;
+    }
+    if (getline(&linha, &capacidade, f) == -1) {  // cabeçalho
+        n = -1;
+    }
+    while (n >= 0 && n < max && getline(&linha, &capacidade, f) != -1) {
+        // instante,"comando",tipo,codigo,real,...: saltar o comando (aspas duplicadas)
+        char *p = strchr(linha, '"');
+
+        if (p == NULL) {
+            continue;
+        }
+        for (p++; *p != '\0' && !(p[0] == '"' && p[1] != '"'); p += p[0] == '"' ? 2 : 1) {
+        }
+        if (*p == '\0' || sscanf(p + 1, ",%*[^,],%d,%lf", &codigos[n], &tempos[n]) != 2) {
+            continue;
+        }
+        n++;
+    }
+    free(linha);
+    fclose(f);
+    return n;
+}
+
+/// @brief Mede um comando interno e o equivalente do coreutils, alternados, num só script.
+/// @param caso Nome do caso.
+/// @param interno Comando interno (formato com um %d opcional: 2 × repetição).
+/// @param externo Comando do coreutils (formato com um %d opcional: 2 × repetição + 1).
+/// @param aquece Se diferente de 0, cada comando corre uma vez antes das medições.
+/// @param repeticoes Repetições de cada comando.
+/// @param quantidade Quantidade processada por cada execução (para o débito).
+/// @param unidade Unidade do débito.
+/// @details O `set durabilidade nenhuma` põe o copia nas mesmas condições do cp,
+/// que também não sincroniza com o disco.
+static void mede_caso(const char *caso, const char *interno, const char *externo, int aquece,
+                      int repeticoes, double quantidade, const char *unidade) {
+    static double tempos[2 * MAX_AMOSTRAS + 2], amostras[2][MAX_AMOSTRAS];
+    static int codigos[2 * MAX_AMOSTRAS + 2];
+    char script[4200], csv[4200], nome_interno[16], nome_externo[16];
+    int n, falhas = 0;
+    FILE *f;
+
+    if (repeticoes > MAX_AMOSTRAS) {
+        repeticoes = MAX_AMOSTRAS;
+    }
+    snprintf(script, sizeof(script), "%s/caso.sh", dir);
+    snprintf(csv, sizeof(csv), "%s/perfil.csv", dir);
+    f = fopen(script, "w");
+    if (f == NULL) {
+        perror(script);
+        return;
+    }
+    fprintf(f, "set durabilidade nenhuma\n");
+    if (aquece) {
+        fprintf(f, interno, 0);
+        fprintf(f, "\n");
+        fprintf(f, externo, 1);
+        fprintf(f, "\n");
+    }
+    fprintf(f, "set perfil on\n");
+    for (int r = 0; r < repeticoes; r++) {
+        fprintf(f, interno, 2 * r);
+        fprintf(f, "\n");
+        fprintf(f, externo, 2 * r + 1);
+        fprintf(f, "\n");
+    }
+    fprintf(f, "set perfil off\nperfil csv > %s\n", csv);
+    fclose(f);
+
+    unlink(csv);
+    executa(interpretador, "-f", script);
+    n = le_perfil(csv, tempos, codigos, 2 * repeticoes);
+    if (n != 2 * repeticoes) {
+        fprintf(stderr, "Erro: O caso '%s' não produziu as medições esperadas (%d de %d).\n",
+                caso, n < 0 ? 0 : n, 2 * repeticoes);
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        amostras[i % 2][i / 2] = tempos[i];
+        falhas += codigos[i] != 0;
+    }
+    if (falhas > 0) {
+        fprintf(stderr, "Aviso: %d execuções do caso '%s' terminaram com erro (ver %s/erros.log).\n",
+                falhas, caso, dir);
+    }
+    sscanf(interno, "%15s", nome_interno);
+    sscanf(externo, "%15s", nome_externo);
+    acrescenta_resultado(caso, nome_interno, amostras[0], repeticoes, quantidade, unidade);
+    acrescenta_resultado(caso, nome_externo, amostras[1], repeticoes, quantidade, unidade);
+}
+
+/// @brief Escreve um script com a mesma linha repetida.
+static int escreve_script(const char *caminho, const char *linha, int n) {
+    FILE *f = fopen(caminho, "w");
+
+    if (f == NULL) {
+        perror(caminho);
+        return -1;
+    }
+    for (int i = 0; i < n; i++) {
+        fprintf(f, "%s\n", linha);
+    }
+    fclose(f);
+    return 0;
+}
+
+/// @brief Mede o tempo por comando de um script comprido, no interpretador e no sh.
+/// @param caso Nome do caso.
+/// @param linha_interpretador Linha repetida no script do interpretador.
+/// @param linha_sh Linha equivalente no script do sh.
+/// @param n Número de linhas.
+/// @param repeticoes Execuções de cada script.
+static void mede_script(const char *caso, const char *linha_interpretador, const char *linha_sh,
+                        int n, int repeticoes) {
+    static double amostras[2][MAX_AMOSTRAS];
+    char script[2][4200];
+
+    if (repeticoes > MAX_AMOSTRAS) {
+        repeticoes = MAX_AMOSTRAS;
+    }
+    snprintf(script[0], sizeof(script[0]), "%s/script_interpretador.sh", dir);
+    snprintf(script[1], sizeof(script[1]), "%s/script_sh.sh", dir);
+    if (escreve_script(script[0], linha_interpretador, n) == -1 || escreve_script(script[1], linha_sh, n) == -1) {
+        return;
+    }
+    for (int r = 0; r < repeticoes; r++) {
+        amostras[0][r] = executa(interpretador, "-f", script[0]) / n;
+        amostras[1][r] = executa("sh", NULL, script[1]) / n;
+    }
+    acrescenta_resultado(caso, "interpretador", amostras[0], repeticoes, 1, "comandos/s");
+    acrescenta_resultado(caso, "sh", amostras[1], repeticoes, 1, "comandos/s");
+}
+
+/// @brief Procura o p50 de um caso e comando num CSV de resultados anterior.
+/// @return p50 em segundos, ou -1 se não existir.
+static double p50_base(const char *base, const char *caso, const char *comando) {
+    char linha[512], c[64], m[32];
+    double p50, resultado = -1;
+    FILE *f = base != NULL ? fopen(base, "r") : NULL;
+
+    if (f == NULL) {
+        return -1;
+    }
+    while (fgets(linha, sizeof(linha), f) != NULL) {
+        if (sscanf(linha, "%63[^,],%31[^,],%*d,%lf", c, m, &p50) == 3 &&
+            strcmp(c, caso) == 0 && strcmp(m, comando) == 0) {
+            resultado = p50 / 1000;
+        }
+    }
+    fclose(f);
+    return resultado;
+}
+
+/// @brief Mostra os resultados (e a variação do p50 em relação à base) e grava-os em CSV.
+static void mostra_resultados(const char *base, const char *saida) {
+    FILE *f = saida != NULL ? fopen(saida, "w") : NULL;
+
+    if (saida != NULL && f == NULL) {
+        perror(saida);
+    }
+    if (f != NULL) {
+        fprintf(f, "caso,comando,n,p50_ms,p90_ms,p99_ms,debito,unidade\n");
+    }
+    // "débito" tem um carácter com dois bytes: mais um de largura para alinhar
+    printf("\n%-22s %-14s %5s %10s %10s %10s %15s %-11s%s\n", "caso", "comando", "n",
+           "p50 ms", "p90 ms", "p99 ms", "débito", "", base != NULL ? "  p50 vs base" : "");
+    for (int i = 0; i < num_resultados; i++) {
+        const resultado *r = &resultados[i];
+        double antes = p50_base(base, r->caso, r->comando);
+
+        printf("%-22s %-14s %5d %10.4f %10.4f %10.4f %14.1f %-11s", i > 0 && strcmp(r->caso, resultados[i - 1].caso) == 0 ? "" : r->caso,
+               r->comando, r->n, r->p50 * 1000, r->p90 * 1000, r->p99 * 1000, r->debito, r->unidade);
+        if (antes > 0) {
+            printf("  %+6.1f%%", (r->p50 - antes) / antes * 100);
+        }
+        printf("\n");
+        if (f != NULL) {
+            fprintf(f, "%s,%s,%d,%.6f,%.6f,%.6f,%.1f,%s\n", r->caso, r->comando, r->n,
+                    r->p50 * 1000, r->p90 * 1000, r->p99 * 1000, r->debito, r->unidade);
+        }
+    }
+    if (f != NULL) {
+        fclose(f);
+        printf("\nResultados gravados em %s.\n", saida);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    static const struct { const char *nome; unsigned long long tamanho; } textos[] = {
+        { "1 KiB", 1ULL << 10 }, { "1 MiB", 1ULL << 20 }, { "64 MiB", 64ULL << 20 }, { "2 GiB", 2ULL << 30 },
+    };
+    const char *base = NULL, *saida = NULL;
+    int grande = 0, repeticoes = 20, opcao, num_textos, entradas, subdiretorias, repeticoes_arvores;
+    char interno[8600], externo[8600], caso[48];
+
+    while ((opcao = getopt(argc, argv, "gr:d:i:o:b:")) != -1) {
+        switch (opcao) {
+            case 'g': grande = 1; break;
+            case 'r': repeticoes = atoi(optarg); break;
+            case 'd': snprintf(dir, sizeof(dir), "%s", optarg); break;
+            case 'i': interpretador = optarg; break;
+            case 'o': saida = optarg; break;
+            case 'b': base = optarg; break;
+            default:
+                fprintf(stderr, "Uso: %s [-g] [-r repetições] [-d diretoria] [-i interpretador] "
+                        "[-o resultados.csv] [-b base.csv]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (repeticoes < 1 || access(interpretador, X_OK) != 0) {
+        fprintf(stderr, "Erro: Repetições inválidas ou interpretador '%s' não encontrado (compile com make).\n", interpretador);
+        return 1;
+    }
+    num_textos = grande ? 4 : 3;
+    entradas = grande ? 1000000 : 100000;
+    subdiretorias = grande ? 100 : 10;
+    repeticoes_arvores = repeticoes < 5 ? repeticoes : 5;
+
+    // Dados
+    printf("A gerar os dados em %s...\n", dir);
+    fflush(stdout);
+    mkdir(dir, 0755);
+    for (int i = 0; i < num_textos; i++) {
+        snprintf(interno, sizeof(interno), "%s/texto_%d", dir, i);
+        if (cria_texto(interno, textos[i].tamanho) == -1) {
+            return 1;
+        }
+    }
+    if (cria_entradas("entradas", entradas) == -1) {
+        return 1;
+    }
+    for (int i = 0; i < 2 * repeticoes_arvores; i++) {
+        if (cria_arvore(i, subdiretorias, 1000) == -1) {
+            return 1;
+        }
+    }
+
+    snprintf(interno, sizeof(interno), "%s/erros.log", dir);
+    unlink(interno);
+
+    // Ficheiros: mostra/cat, conta/wc -l, copia/cp (os ficheiros de 2 GiB com 3 repetições).
+    // A saída do mostra e do cat vai para um ficheiro: para /dev/null, o
+    // sendfile do mostra não copiaria nada
+
+    for (int i = 0; i < num_textos; i++) {
+        double mib = textos[i].tamanho / 1048576.0;
+        int r = textos[i].tamanho >= (1ULL << 30) && repeticoes > 3 ? 3 : repeticoes;
+
+        printf("A medir os ficheiros de %s...\n", textos[i].nome);
+        fflush(stdout);
+        snprintf(caso, sizeof(caso), "mostra %s", textos[i].nome);
+        snprintf(interno, sizeof(interno), "mostra %s/texto_%d > %s/saida_mostra", dir, i, dir);
+        snprintf(externo, sizeof(externo), "cat %s/texto_%d > %s/saida_cat", dir, i, dir);
+        mede_caso(caso, interno, externo, 1, r, mib, "MiB/s");
+
+        snprintf(caso, sizeof(caso), "conta %s", textos[i].nome);
+        snprintf(interno, sizeof(interno), "conta %s/texto_%d", dir, i);
+        snprintf(externo, sizeof(externo), "wc -l %s/texto_%d", dir, i);
+        mede_caso(caso, interno, externo, 1, r, mib, "MiB/s");
+
+        snprintf(caso, sizeof(caso), "copia %s", textos[i].nome);
+        snprintf(interno, sizeof(interno), "copia %s/texto_%d", dir, i);
+        snprintf(externo, sizeof(externo), "cp %s/texto_%d %s/texto_%d.cp", dir, i, dir, i);
+        mede_caso(caso, interno, externo, 1, r, mib, "MiB/s");
+        snprintf(interno, sizeof(interno), "%s/texto_%d.copia", dir, i);
+        snprintf(externo, sizeof(externo), "%s/texto_%d.cp", dir, i);
+        unlink(interno);
+        unlink(externo);
+    }
+    snprintf(interno, sizeof(interno), "%s/saida_mostra", dir);
+    snprintf(externo, sizeof(externo), "%s/saida_cat", dir);
+    unlink(interno);
+    unlink(externo);
+
+    // acrescenta/cat >> (1 MiB de cada vez; o destino do acrescenta tem de existir)
+    printf("A medir o acrescenta...\n");
+    fflush(stdout);
+    snprintf(interno, sizeof(interno), "%s/destino_acrescenta", dir);
+    close(open(interno, O_WRONLY | O_CREAT | O_TRUNC, 0644));
+    snprintf(interno, sizeof(interno), "acrescenta %s/texto_1 %s/destino_acrescenta", dir, dir);
+    snprintf(externo, sizeof(externo), "cat %s/texto_1 >> %s/destino_cat", dir, dir);
+    mede_caso("acrescenta 1 MiB", interno, externo, 1, repeticoes, 1, "MiB/s");
+    snprintf(interno, sizeof(interno), "%s/destino_acrescenta", dir);
+    snprintf(externo, sizeof(externo), "%s/destino_cat", dir);
+    unlink(interno);
+    unlink(externo);
+
+    // Diretorias: lista/ls -f, informa/stat (1000 ficheiros), apaga -r/rm -rf
+    printf("A medir as diretorias...\n");
+    fflush(stdout);
+    snprintf(caso, sizeof(caso), "lista %d", entradas);
+    snprintf(interno, sizeof(interno), "lista %s/entradas > /dev/null", dir);
+    snprintf(externo, sizeof(externo), "ls -f %s/entradas > /dev/null", dir);
+    mede_caso(caso, interno, externo, 1, repeticoes, entradas, "entradas/s");
+
+    snprintf(interno, sizeof(interno), "informa %s/entradas/f0000??? > /dev/null", dir);
+    snprintf(externo, sizeof(externo), "stat %s/entradas/f0000??? > /dev/null", dir);
+    mede_caso("informa 1000", interno, externo, 1, repeticoes, 1000, "entradas/s");
+
+    snprintf(caso, sizeof(caso), "apaga -r %d", subdiretorias * 1000);
+    snprintf(interno, sizeof(interno), "apaga -r %s/arvores/a%%d", dir);
+    snprintf(externo, sizeof(externo), "rm -rf %s/arvores/a%%d", dir);
+    mede_caso(caso, interno, externo, 0, repeticoes_arvores, subdiretorias * 1000, "entradas/s");
+
+    // Despacho de um comando interno e lançamento de processos, em scripts compridos
+    printf("A medir o despacho e o lançamento...\n");
+    fflush(stdout);
+    mede_script(grande ? "despacho 1M linhas" : "despacho 100k linhas", "jobs", ":",
+                grande ? 1000000 : 100000, 5);
+    mede_script("processos 1000", "/bin/true", "/bin/true", 1000, 5);
+
+    mostra_resultados(base, saida);
+    return 0;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file bench_copia.c
+ * @brief Compara o motor de cópia com o ciclo read/write de 4 KiB original.
+ *
+ * Gera ficheiros de 1 KiB até ao tamanho máximo indicado (por omissão 1 GiB,
+ * use "10G" para chegar aos 10 GiB) e mede o débito de cada estratégia.
+ *
+ * Utilização: bench_copia [tamanho_maximo] [diretoria]
+ *
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "motor_copia.h"
+
+/// @brief Converte "64K", "1M", "10G" em bytes.
+static unsigned long long le_tamanho(const char *s) {
+    char *fim;
+    unsigned long long v = strtoull(s, &fim, 10);
+
+    switch (*fim) {
+        case 'K': case 'k': return v << 10;
+        case 'M': case 'm': return v << 20;
+        case 'G': case 'g': return v << 30;
+        default: return v;
+    }
+}
+
+/// @brief Cria um ficheiro com conteúdo pseudo-aleatório do tamanho pedido.
+static int gera_ficheiro(const char *caminho, unsigned long long tamanho) {
+    static char bloco[1 << 20];
+    unsigned int semente = 12345;
+    int fd = open(caminho, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd == -1) {
+        return -1;
+    }
+    for (size_t i = 0; i < sizeof(bloco); i++) {
+        semente = semente * 1103515245 + 12345;
+        bloco[i] = (i % 80 == 79) ? '\n' : 'a' + (semente >> 16) % 26;
+    }
+    while (tamanho > 0) {
+        size_t n = tamanho < sizeof(bloco) ? tamanho : sizeof(bloco);
+        if (write(fd, bloco, n) != (ssize_t)n) {
+            close(fd);
+            return -1;
+        }
+        tamanho -= n;
+    }
+    close(fd);
+    return 0;
+}
+
+/// @brief Copia origem para destino várias vezes e devolve o melhor débito (MiB/s).
+static double mede(const char *origem, const char *destino, int repeticoes, int usar_motor,
+                   metodo_copia *metodo) {
+    double melhor = 0;
+
+    for (int r = 0; r < repeticoes; r++) {
+        resultado_copia res;
+        int fd_src = open(origem, O_RDONLY);
+        int fd_dest = open(destino, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        int erro;
+
+        if (fd_src == -1 || fd_dest == -1) {
+            perror("open");
+            exit(1);
+        }
+        erro = usar_motor ? copia_descritores(fd_src, fd_dest, &res)
+                          : copia_descritores_buffer(fd_src, fd_dest, &res);
+        close(fd_src);
+        close(fd_dest);
+        if (erro == -1) {
+            perror("cópia");
+            exit(1);
+        }
+        if (res.segundos > 0) {
+            double debito = res.bytes / (1024.0 * 1024.0) / res.segundos;
+            if (debito > melhor) {
+                melhor = debito;
+            }
+        }
+        *metodo = res.metodo;
+    }
+    return melhor;
+}
+
+int main(int argc, char *argv[]) {
+    static const unsigned long long tamanhos[] = {
+        1ULL << 10, 64ULL << 10, 1ULL << 20, 64ULL << 20, 1ULL << 30, 10ULL << 30
+    };
+    unsigned long long maximo = argc > 1 ? le_tamanho(argv[1]) : 1ULL << 30;
+    const char *dir = argc > 2 ? argv[2] : "/tmp";
+    char origem[1024], destino[1024];
+
+    snprintf(origem, sizeof(origem), "%s/bench_copia.origem", dir);
+    snprintf(destino, sizeof(destino), "%s/bench_copia.destino", dir);
+
+    printf("%-12s %-20s %14s %14s %8s\n", "tamanho", "método do motor", "motor MiB/s",
+           "read/write MiB/s", "ganho");
+
+    for (size_t i = 0; i < sizeof(tamanhos) / sizeof(tamanhos[0]) && tamanhos[i] <= maximo; i++) {
+        unsigned long long t = tamanhos[i];
+        int repeticoes = t >= (1ULL << 30) ? 1 : (int)((256ULL << 20) / t > 200 ? 200 : (256ULL << 20) / t);
+        metodo_copia metodo, ignorado;
+        double motor, buffer;
+
+        if (gera_ficheiro(origem, t) == -1) {
+            perror("gerar ficheiro");
+            return 1;
+        }
+        motor = mede(origem, destino, repeticoes, 1, &metodo);
+        buffer = mede(origem, destino, repeticoes, 0, &ignorado);
+
+        printf("%-12llu %-20s %14.1f %14.1f %7.2fx\n", t, nome_metodo_copia(metodo), motor, buffer,
+               buffer > 0 ? motor / buffer : 0);
+        fflush(stdout);
+    }
+
+    unlink(origem);
+    unlink(destino);
+    return 0;
+}
@@ -0,0 +1,191 @@
+/**
+ * @file bench_es.c
+ * @brief Compara as chamadas bloqueantes com o io_uring na camada de entrada/saída.
+ *
+ * Mede a cópia (es_copia) e a leitura (es_le) de um ficheiro grande e de
+ * milhares de ficheiros pequenos, nos modos "bloqueante" e "uring", com a
+ * cache de páginas quente. Na cópia, o modo bloqueante usa o motor de cópia
+ * (copy_file_range, normalmente); na leitura, usa read com o mesmo buffer.
+ *
+ * Utilização: bench_es [tamanho_grande] [num_pequenos] [profundidade] [diretoria]
+ *
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "anel_es.h"
+
+/// Tamanho de cada ficheiro pequeno.
+#define TAMANHO_PEQUENO 4096
+
+/// @brief Converte "64K", "1M", "10G" em bytes.
+static unsigned long long le_tamanho(const char *s) {
+    char *fim;
+    unsigned long long v = strtoull(s, &fim, 10);
+
+    switch (*fim) {
+        case 'K': case 'k': return v << 10;
+        case 'M': case 'm': return v << 20;
+        case 'G': case 'g': return v << 30;
+        default: return v;
+    }
+}
+
+static double agora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/// @brief Cria um ficheiro com texto pseudo-aleatório do tamanho pedido.
+static int gera_ficheiro(const char *caminho, unsigned long long tamanho) {
+    static char bloco[1 << 20];
+    unsigned int semente = 12345;
+    int fd = open(caminho, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd == -1) {
+        return -1;
+    }
+    for (size_t i = 0; i < sizeof(bloco); i++) {
+        semente = semente * 1103515245 + 12345;
+        bloco[i] = (i % 80 == 79) ? '\n' : 'a' + (semente >> 16) % 26;
+    }
+    while (tamanho > 0) {
+        size_t n = tamanho < sizeof(bloco) ? tamanho : sizeof(bloco);
+        if (write(fd, bloco, n) != (ssize_t)n) {
+            close(fd);
+            return -1;
+        }
+        tamanho -= n;
+    }
+    close(fd);
+    return 0;
+}
+
+/// @brief Consumidor que só soma os bytes (o custo medido é o da leitura).
+static void soma_bytes(const unsigned char *dados, size_t n, void *arg) {
+    (void)dados;
+    *(unsigned long long *)arg += n;
+}
+
+/// @brief Copia (ou lê) n ficheiros e devolve o tempo gasto em segundos.
+static double mede(char nomes[][1024], int n, const char *sufixo, int copiar) {
+    char destino[1100];
+    double inicio = agora();
+
+    for (int i = 0; i < n; i++) {
+        int fd_src = open(nomes[i], O_RDONLY);
+        int erro;
+
+        if (fd_src == -1) {
+            perror("open");
+            exit(1);
+        }
+        if (copiar) {
+            int fd_dest;
+
+            snprintf(destino, sizeof(destino), "%s%s", nomes[i], sufixo);
+            fd_dest = open(destino, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd_dest == -1) {
+                perror("open");
+                exit(1);
+            }
+            erro = es_copia(fd_src, fd_dest, NULL);
+            close(fd_dest);
+        } else {
+            unsigned long long bytes = 0;
+            erro = es_le(fd_src, soma_bytes, &bytes);
+        }
+        close(fd_src);
+        if (erro == -1) {
+            perror(copiar ? "cópia" : "leitura");
+            exit(1);
+        }
+    }
+    return agora() - inicio;
+}
+
+/// @brief Mede uma operação nos dois modos (melhor de 3) e mostra uma linha.
+static void compara(const char *nome, char nomes[][1024], int n, unsigned long long bytes, int copiar) {
+    double melhor[2] = { 1e9, 1e9 };
+
+    for (int r = 0; r < 3; r++) {
+        for (int m = 0; m < 2; m++) {
+            double t;
+
+            es_define(m == 0 ? "bloqueante" : "uring");
+            t = mede(nomes, n, m == 0 ? ".b" : ".u", copiar);
+            if (t < melhor[m]) {
+                melhor[m] = t;
+            }
+        }
+    }
+    printf("%-28s %14.1f %14.1f %7.2fx\n", nome,
+           bytes / (1024.0 * 1024.0) / melhor[0], bytes / (1024.0 * 1024.0) / melhor[1],
+           melhor[1] > 0 ? melhor[0] / melhor[1] : 0);
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long long grande = argc > 1 ? le_tamanho(argv[1]) : 256ULL << 20;
+    int num_pequenos = argc > 2 ? atoi(argv[2]) : 2000;
+    int profundidade = argc > 3 ? atoi(argv[3]) : ES_PROFUNDIDADE_OMISSAO;
+    const char *dir = argc > 4 ? argv[4] : "/tmp";
+    char (*nomes)[1024] = calloc(num_pequenos > 1 ? num_pequenos : 1, sizeof(*nomes));
+    char caminho[1100];
+
+    if (nomes == NULL || num_pequenos < 1 || es_define_profundidade(profundidade) == -1) {
+        fprintf(stderr, "Utilização: bench_es [tamanho_grande] [num_pequenos] [profundidade 1-%d] [diretoria]\n",
+                ES_PROFUNDIDADE_MAX);
+        return 1;
+    }
+    if (!es_uring_disponivel()) {
+        fprintf(stderr, "O io_uring não está disponível neste kernel.\n");
+        return 1;
+    }
+
+    printf("profundidade %d, blocos de %d KiB\n", profundidade, ES_BLOCO / 1024);
+    printf("%-28s %14s %14s %8s\n", "", "bloqueante MiB/s", "uring MiB/s", "ganho");
+
+    // Um ficheiro grande
+    snprintf(nomes[0], sizeof(nomes[0]), "%s/bench_es.grande", dir);
+    if (gera_ficheiro(nomes[0], grande) == -1) {
+        perror("gerar ficheiro");
+        return 1;
+    }
+    compara("cópia, 1 ficheiro grande", nomes, 1, grande, 1);
+    compara("leitura, 1 ficheiro grande", nomes, 1, grande, 0);
+    unlink(nomes[0]);
+    for (int m = 0; m < 2; m++) {
+        snprintf(caminho, sizeof(caminho), "%s%s", nomes[0], m == 0 ? ".b" : ".u");
+        unlink(caminho);
+    }
+
+    // Milhares de ficheiros pequenos
+    for (int i = 0; i < num_pequenos; i++) {
+        snprintf(nomes[i], sizeof(nomes[i]), "%s/bench_es.%d", dir, i);
+        if (gera_ficheiro(nomes[i], TAMANHO_PEQUENO) == -1) {
+            perror("gerar ficheiro");
+            return 1;
+        }
+    }
+    snprintf(caminho, sizeof(caminho), "cópia, %d x %d KiB", num_pequenos, TAMANHO_PEQUENO / 1024);
+    compara(caminho, nomes, num_pequenos, (unsigned long long)num_pequenos * TAMANHO_PEQUENO, 1);
+    snprintf(caminho, sizeof(caminho), "leitura, %d x %d KiB", num_pequenos, TAMANHO_PEQUENO / 1024);
+    compara(caminho, nomes, num_pequenos, (unsigned long long)num_pequenos * TAMANHO_PEQUENO, 0);
+    for (int i = 0; i < num_pequenos; i++) {
+        unlink(nomes[i]);
+        for (int m = 0; m < 2; m++) {
+            snprintf(caminho, sizeof(caminho), "%s%s", nomes[i], m == 0 ? ".b" : ".u");
+            unlink(caminho);
+        }
+    }
+    free(nomes);
+    return 0;
+}
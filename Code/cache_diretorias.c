@@ -0,0 +1,153 @@
+/**
+ * @file cache_diretorias.c
+ * @brief Implementação da cache de diretorias.
+ *
+ * Tabela de dispersão por (dispositivo, i-node), com listas ligadas. Quando
+ * a data de modificação de uma diretoria muda, o conteúdo antigo não é
+ * libertado logo, porque a expansão em curso ainda pode estar a percorrê-lo
+ * (por exemplo, com uma ligação simbólica de volta para a mesma diretoria):
+ * fica numa lista de conteúdos substituídos até cache_diretorias_arruma.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "cache_diretorias.h"
+
+/// Número de listas da tabela (potência de 2).
+#define NUM_LISTAS 1024
+
+/// @brief Diretoria guardada na cache.
+typedef struct diretoria_guardada {
+    dev_t dev;
+    ino_t ino;
+    struct timespec mtime;
+    conteudo_diretoria conteudo;
+    size_t bytes;                       ///< memória usada pelo conteúdo
+    struct diretoria_guardada *seguinte;
+} diretoria_guardada;
+
+static diretoria_guardada *tabela[NUM_LISTAS];
+static diretoria_guardada *substituidas = NULL;   ///< à espera de cache_diretorias_arruma
+static size_t bytes_guardados = 0;
+
+static size_t lista_de(dev_t dev, ino_t ino) {
+    unsigned long long h = (unsigned long long)ino * 0x9E3779B97F4A7C15ULL ^ (unsigned long long)dev;
+    return (h >> 32) & (NUM_LISTAS - 1);
+}
+
+static void liberta_guardada(diretoria_guardada *d) {
+    liberta_diretoria(&d->conteudo);
+    free(d);
+}
+
+static int compara_entradas(const void *a, const void *b) {
+    return strcmp(((const entrada_diretoria *)a)->nome, ((const entrada_diretoria *)b)->nome);
+}
+
+/// @brief Lê a diretoria aberta em fd para uma nova entrada da cache.
+/// @details As entradas ficam ordenadas pelo nome: os resultados de um padrão
+/// numa só diretoria já saem ordenados.
+static diretoria_guardada *le_para_cache(int fd, const struct stat *st) {
+    diretoria_guardada *d = calloc(1, sizeof(diretoria_guardada));
+
+    if (d == NULL) {
+        return NULL;
+    }
+    if (le_diretoria(fd, &d->conteudo, NULL) == -1) {
+        liberta_guardada(d);
+        return NULL;
+    }
+    d->dev = st->st_dev;
+    d->ino = st->st_ino;
+    d->mtime = st->st_mtim;
+    d->conteudo.fd = -1;
+    qsort(d->conteudo.entradas, d->conteudo.num_entradas, sizeof(entrada_diretoria), compara_entradas);
+    d->bytes = sizeof(*d) + d->conteudo.num_entradas * sizeof(entrada_diretoria);
+    for (int i = 0; i < d->conteudo.num_entradas; i++) {
+        d->bytes += strlen(d->conteudo.entradas[i].nome) + 1;
+    }
+    return d;
+}
+
+/// @brief Devolve o conteúdo de uma diretoria, da cache ou lido agora.
+/// @param caminho Caminho da diretoria ("" é a diretoria atual).
+/// @return Conteúdo, ou NULL em caso de erro.
+const conteudo_diretoria *cache_diretorias_obtem(const char *caminho) {
+    const char *c = caminho[0] != '\0' ? caminho : ".";
+    diretoria_guardada **p, *d;
+    struct stat st;
+    int fd;
+
+    // Na cache e sem alterações: só o stat
+    if (stat(c, &st) == -1 || !S_ISDIR(st.st_mode)) {
+        return NULL;
+    }
+    p = &tabela[lista_de(st.st_dev, st.st_ino)];
+    for (d = *p; d != NULL; d = d->seguinte) {
+        if (d->dev == st.st_dev && d->ino == st.st_ino) {
+            if (d->mtime.tv_sec == st.st_mtim.tv_sec && d->mtime.tv_nsec == st.st_mtim.tv_nsec) {
+                return &d->conteudo;
+            }
+            break;
+        }
+    }
+
+    // Ler a diretoria (o fstat é o do descritor lido, não o do stat acima)
+    fd = open(c, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1) {
+        return NULL;
+    }
+    if (fstat(fd, &st) == -1 || (d = le_para_cache(fd, &st)) == NULL) {
+        close(fd);
+        return NULL;
+    }
+    close(fd);
+
+    // Substituir a versão antiga, se houver
+    for (diretoria_guardada **q = &tabela[lista_de(d->dev, d->ino)]; *q != NULL; q = &(*q)->seguinte) {
+        if ((*q)->dev == d->dev && (*q)->ino == d->ino) {
+            diretoria_guardada *antiga = *q;
+
+            *q = antiga->seguinte;
+            bytes_guardados -= antiga->bytes;
+            antiga->seguinte = substituidas;
+            substituidas = antiga;
+            break;
+        }
+    }
+    p = &tabela[lista_de(d->dev, d->ino)];
+    d->seguinte = *p;
+    *p = d;
+    bytes_guardados += d->bytes;
+    return &d->conteudo;
+}
+
+/// @brief Liberta os conteúdos substituídos e esvazia a cache se passar do limite.
+void cache_diretorias_arruma(void) {
+    while (substituidas != NULL) {
+        diretoria_guardada *seguinte = substituidas->seguinte;
+        liberta_guardada(substituidas);
+        substituidas = seguinte;
+    }
+    if (bytes_guardados > CACHE_DIRETORIAS_MAX_BYTES) {
+        cache_diretorias_limpa();
+    }
+}
+
+/// @brief Esvazia a cache.
+void cache_diretorias_limpa(void) {
+    for (size_t i = 0; i < NUM_LISTAS; i++) {
+        while (tabela[i] != NULL) {
+            diretoria_guardada *seguinte = tabela[i]->seguinte;
+            liberta_guardada(tabela[i]);
+            tabela[i] = seguinte;
+        }
+    }
+    bytes_guardados = 0;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file cache_diretorias.h
+ * @brief Cache do conteúdo das diretorias lidas pela expansão de padrões.
+ *
+ * Cada diretoria é identificada pelo par (dispositivo, i-node) e guardada
+ * com a sua data de modificação: enquanto esta não mudar (nenhuma entrada
+ * foi criada, removida ou renomeada), repetir um padrão sobre a mesma
+ * diretoria custa um stat em vez de a voltar a ler.
+ *
+ * A cache não é thread-safe: é usada com o trinco da expansão de padrões.
+ *
+ * @date 2025
+ */
+
+#ifndef CACHE_DIRETORIAS_H
+#define CACHE_DIRETORIAS_H
+
+#include "percurso.h"
+
+/// Memória máxima (nomes e entradas) das diretorias guardadas.
+#define CACHE_DIRETORIAS_MAX_BYTES (64 * 1024 * 1024)
+
+/**
+ * @brief Devolve o conteúdo de uma diretoria, da cache ou lido agora.
+ *
+ * O conteúdo não tem "." e "..", as entradas estão ordenadas pelo nome
+ * (strcmp) e o campo fd é -1.
+ * @param caminho Caminho da diretoria ("" é a diretoria atual).
+ * @return Conteúdo (válido até à próxima chamada a cache_diretorias_arruma),
+ * ou NULL se não for uma diretoria ou não puder ser lida.
+ */
+const conteudo_diretoria *cache_diretorias_obtem(const char *caminho);
+
+/**
+ * @brief Liberta os conteúdos substituídos e, se a cache passar do limite, esvazia-a.
+ *
+ * Deve ser chamada quando nenhum conteúdo devolvido antes está a ser usado.
+ */
+void cache_diretorias_arruma(void);
+
+/**
+ * @brief Esvazia a cache.
+ */
+void cache_diretorias_limpa(void);
+
+#endif // CACHE_DIRETORIAS_H
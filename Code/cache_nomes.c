@@ -0,0 +1,169 @@
+/**
+ * @file cache_nomes.c
+ * @brief Implementação da cache de nomes de utilizadores e grupos.
+ *
+ * Há uma tabela para utilizadores e outra para grupos, ambas com
+ * endereçamento aberto e sondagem linear. Os nomes nunca são removidos, por
+ * isso os ponteiros devolvidos continuam válidos mesmo depois de a tabela
+ * crescer.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <pwd.h>
+#include <grp.h>
+#include "cache_nomes.h"
+
+/// Capacidade inicial de cada tabela (potência de 2).
+#define CAPACIDADE_INICIAL 64
+
+/// Tamanho do buffer passado ao getpwuid_r/getgrgid_r quando o sistema não indica um.
+#define BUFFER_NSS 16384
+
+/// @brief Entrada da cache: identificador e nome.
+typedef struct {
+    unsigned int id;
+    char *nome;                 ///< NULL numa posição livre
+} entrada_nome;
+
+/// @brief Tabela de dispersão de identificadores.
+typedef struct {
+    entrada_nome *entradas;
+    size_t capacidade, ocupadas;
+} tabela_nomes;
+
+static pthread_mutex_t trinco = PTHREAD_MUTEX_INITIALIZER;
+static tabela_nomes utilizadores, grupos;
+
+/// @brief Dispersão de um inteiro (multiplicativa de Fibonacci).
+static size_t dispersao(unsigned int id, size_t capacidade) {
+    return (size_t)((id * 2654435769u) >> 7) & (capacidade - 1);
+}
+
+/// @brief Procura um identificador na tabela.
+static const char *procura(const tabela_nomes *t, unsigned int id) {
+    if (t->capacidade == 0) {
+        return NULL;
+    }
+    for (size_t i = dispersao(id, t->capacidade); t->entradas[i].nome != NULL;
+         i = (i + 1) & (t->capacidade - 1)) {
+        if (t->entradas[i].id == id) {
+            return t->entradas[i].nome;
+        }
+    }
+    return NULL;
+}
+
+/// @brief Insere um identificador na tabela (que não pode conter já esse identificador).
+static void insere(tabela_nomes *t, unsigned int id, char *nome) {
+    size_t i;
+
+    if ((t->ocupadas + 1) * 2 > t->capacidade) {
+        entrada_nome *antigas = t->entradas;
+        size_t antiga_capacidade = t->capacidade;
+        size_t capacidade = antiga_capacidade ? antiga_capacidade * 2 : CAPACIDADE_INICIAL;
+        entrada_nome *novas = calloc(capacidade, sizeof(entrada_nome));
+
+        if (novas == NULL) {
+            return;  // sem memória: o nome fica apenas por guardar
+        }
+        t->entradas = novas;
+        t->capacidade = capacidade;
+        t->ocupadas = 0;
+        for (size_t k = 0; k < antiga_capacidade; k++) {
+            if (antigas[k].nome != NULL) {
+                insere(t, antigas[k].id, antigas[k].nome);
+            }
+        }
+        free(antigas);
+    }
+
+    i = dispersao(id, t->capacidade);
+    while (t->entradas[i].nome != NULL) {
+        i = (i + 1) & (t->capacidade - 1);
+    }
+    t->entradas[i].id = id;
+    t->entradas[i].nome = nome;
+    t->ocupadas++;
+}
+
+/// @brief Consulta o sistema (passwd ou group) e devolve uma cópia do nome.
+/// @return Nome, ou o número em texto se não existir.
+static char *consulta(unsigned int id, int grupo) {
+    long sugerido = sysconf(grupo ? _SC_GETGR_R_SIZE_MAX : _SC_GETPW_R_SIZE_MAX);
+    size_t tamanho = sugerido > 0 ? (size_t)sugerido : BUFFER_NSS;
+    char *buffer = malloc(tamanho), *nome = NULL;
+
+    if (buffer != NULL) {
+        if (grupo) {
+            struct group gr, *res = NULL;
+            if (getgrgid_r(id, &gr, buffer, tamanho, &res) == 0 && res != NULL) {
+                nome = strdup(gr.gr_name);
+            }
+        } else {
+            struct passwd pw, *res = NULL;
+            if (getpwuid_r(id, &pw, buffer, tamanho, &res) == 0 && res != NULL) {
+                nome = strdup(pw.pw_name);
+            }
+        }
+        free(buffer);
+    }
+    if (nome == NULL && asprintf(&nome, "%u", id) == -1) {
+        nome = NULL;
+    }
+    return nome;
+}
+
+/// @brief Devolve o nome de um identificador, consultando o sistema só na primeira vez.
+static const char *nome_de(tabela_nomes *t, unsigned int id, int grupo) {
+    const char *nome;
+    char *novo;
+
+    pthread_mutex_lock(&trinco);
+    nome = procura(t, id);
+    pthread_mutex_unlock(&trinco);
+    if (nome != NULL) {
+        return nome;
+    }
+
+    // A consulta pode demorar (NSS, rede): é feita fora do mutex
+    novo = consulta(id, grupo);
+    if (novo == NULL) {
+        return "Desconhecido";
+    }
+
+    pthread_mutex_lock(&trinco);
+    nome = procura(t, id);  // outra thread pode ter chegado primeiro
+    if (nome == NULL) {
+        insere(t, id, novo);
+        nome = procura(t, id) != NULL ? novo : NULL;
+    }
+    pthread_mutex_unlock(&trinco);
+
+    if (nome != novo) {
+        // Já estava na tabela (ou não coube): não guardar a cópia
+        free(novo);
+        return nome != NULL ? nome : "Desconhecido";
+    }
+    return nome;
+}
+
+/// @brief Devolve o nome de um utilizador.
+/// @param uid Identificador do utilizador.
+/// @return Nome do utilizador.
+const char *nome_utilizador(uid_t uid) {
+    return nome_de(&utilizadores, uid, 0);
+}
+
+/// @brief Devolve o nome de um grupo.
+/// @param gid Identificador do grupo.
+/// @return Nome do grupo.
+const char *nome_grupo(gid_t gid) {
+    return nome_de(&grupos, gid, 1);
+}
@@ -0,0 +1,33 @@
+/**
+ * @file cache_nomes.h
+ * @brief Cache dos nomes de utilizadores e grupos (uid/gid → nome).
+ *
+ * O getpwuid/getgrgid pode ler /etc/passwd (ou consultar o NSS) em cada
+ * chamada. Os nomes encontrados ficam numa tabela de dispersão durante toda
+ * a execução do interpretador, por isso percorrer uma árvore com milhares de
+ * ficheiros do mesmo dono faz uma única consulta. As funções podem ser
+ * chamadas por várias threads.
+ *
+ * @date 2025
+ */
+
+#ifndef CACHE_NOMES_H
+#define CACHE_NOMES_H
+
+#include <sys/types.h>
+
+/**
+ * @brief Devolve o nome de um utilizador.
+ * @param uid Identificador do utilizador.
+ * @return Nome (válido até ao fim do programa); o número, se não tiver nome.
+ */
+const char *nome_utilizador(uid_t uid);
+
+/**
+ * @brief Devolve o nome de um grupo.
+ * @param gid Identificador do grupo.
+ * @return Nome (válido até ao fim do programa); o número, se não tiver nome.
+ */
+const char *nome_grupo(gid_t gid);
+
+#endif // CACHE_NOMES_H
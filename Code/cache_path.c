@@ -0,0 +1,305 @@
+/**
+ * @file cache_path.c
+ * @brief Implementação da cache de caminhos do PATH.
+ *
+ * Cada entrada guarda o índice da diretoria do PATH onde o comando foi
+ * encontrado. Uma entrada só pode ficar desatualizada se mudar essa
+ * diretoria ou uma anterior (um novo ficheiro pode tapar o encontrado), por
+ * isso numa utilização só se verificam as datas de modificação dessas.
+ *
+ * A cache é partilhada pelas threads do servidor (ver servidor.h) e
+ * protegida por um mutex; o caminho devolvido é copiado para um buffer da
+ * thread, porque outra thread pode mudar a tabela logo a seguir. O PATH é o
+ * do ambiente da thread (ver ambiente.h).
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "cache_path.h"
+#include "saida.h"
+#include "ambiente.h"
+
+/// PATH usado pelo execvp quando a variável não está definida.
+#define PATH_OMISSAO "/bin:/usr/bin"
+
+/// Capacidade inicial da tabela (potência de 2).
+#define CAPACIDADE_INICIAL 64
+
+/// @brief Diretoria do PATH e a sua data de modificação quando foi verificada.
+typedef struct {
+    char *caminho;
+    struct timespec mtime;
+} diretoria_path;
+
+/// @brief Entrada da cache: nome do comando e caminho resolvido.
+typedef struct {
+    char *nome;
+    char *caminho;
+    int diretoria;              ///< índice da diretoria no PATH
+    unsigned long utilizacoes;
+} entrada_cache;
+
+static pthread_mutex_t trinco = PTHREAD_MUTEX_INITIALIZER;
+
+/// Cópia do último caminho devolvido a esta thread.
+static __thread char resolvido[PATH_MAX];
+
+static char *path_atual = NULL;
+static diretoria_path *dirs = NULL;
+static int num_dirs = 0;
+
+static entrada_cache *entradas = NULL;
+static size_t capacidade = 0;
+static size_t ocupadas = 0;
+
+/// @brief Função de dispersão FNV-1a.
+static unsigned int dispersao(const char *s) {
+    unsigned int h = 2166136261u;
+
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/// @brief Obtém a data de modificação de uma diretoria (zero se não existir).
+static struct timespec mtime_diretoria(const char *caminho) {
+    struct stat st;
+    struct timespec zero = { 0, 0 };
+
+    return stat(caminho, &st) == 0 ? st.st_mtim : zero;
+}
+
+/// @brief Insere uma entrada na tabela (sem verificar duplicados).
+static void insere(entrada_cache e) {
+    size_t i;
+
+    if ((ocupadas + 1) * 2 > capacidade) {
+        entrada_cache *antigas = entradas;
+        size_t antiga_capacidade = capacidade;
+
+        capacidade = capacidade ? capacidade * 2 : CAPACIDADE_INICIAL;
+        entradas = calloc(capacidade, sizeof(entrada_cache));
+        ocupadas = 0;
+        for (size_t k = 0; k < antiga_capacidade; k++) {
+            if (antigas[k].nome != NULL) {
+                insere(antigas[k]);
+            }
+        }
+        free(antigas);
+    }
+
+    i = dispersao(e.nome) & (capacidade - 1);
+    while (entradas[i].nome != NULL) {
+        i = (i + 1) & (capacidade - 1);
+    }
+    entradas[i] = e;
+    ocupadas++;
+}
+
+/// @brief Procura a posição de um nome na tabela.
+static entrada_cache *procura(const char *nome) {
+    if (capacidade == 0) {
+        return NULL;
+    }
+    for (size_t i = dispersao(nome) & (capacidade - 1); entradas[i].nome != NULL;
+         i = (i + 1) & (capacidade - 1)) {
+        if (strcmp(entradas[i].nome, nome) == 0) {
+            return &entradas[i];
+        }
+    }
+    return NULL;
+}
+
+/// @brief Reconstrói a tabela mantendo só as entradas que satisfazem o critério.
+/// @param diretoria_limite Remove entradas encontradas nesta diretoria ou seguintes.
+/// @param nome_removido Remove também esta entrada (pode ser NULL).
+static void reconstroi(int diretoria_limite, const char *nome_removido) {
+    entrada_cache *antigas = entradas;
+    size_t antiga_capacidade = capacidade;
+
+    entradas = antiga_capacidade ? calloc(antiga_capacidade, sizeof(entrada_cache)) : NULL;
+    ocupadas = 0;
+    for (size_t k = 0; k < antiga_capacidade; k++) {
+        entrada_cache *e = &antigas[k];
+        if (e->nome == NULL) {
+            continue;
+        }
+        if (e->diretoria >= diretoria_limite ||
+            (nome_removido != NULL && strcmp(e->nome, nome_removido) == 0)) {
+            free(e->nome);
+            free(e->caminho);
+        } else {
+            insere(*e);
+        }
+    }
+    free(antigas);
+}
+
+/// @brief Atualiza a lista de diretorias se o PATH mudou (esvaziando a cache).
+static void atualiza_path(void) {
+    const char *path = ambiente_valor("PATH");
+    char *copia, *inicio;
+
+    if (path == NULL) {
+        path = PATH_OMISSAO;
+    }
+    if (path_atual != NULL && strcmp(path, path_atual) == 0) {
+        return;
+    }
+
+    reconstroi(-1, NULL);
+    for (int i = 0; i < num_dirs; i++) {
+        free(dirs[i].caminho);
+    }
+    free(dirs);
+    free(path_atual);
+
+    path_atual = strdup(path);
+    num_dirs = 1;
+    for (const char *p = path; *p; p++) {
+        num_dirs += *p == ':';
+    }
+    dirs = calloc(num_dirs, sizeof(diretoria_path));
+
+    // Separar por ':' (um componente vazio é a diretoria atual)
+    copia = strdup(path);
+    inicio = copia;
+    for (int i = 0; i < num_dirs; i++) {
+        char *fim = strchr(inicio, ':');
+        if (fim != NULL) {
+            *fim = '\0';
+        }
+        dirs[i].caminho = strdup(*inicio ? inicio : ".");
+        dirs[i].mtime = mtime_diretoria(dirs[i].caminho);
+        inicio = fim != NULL ? fim + 1 : inicio + strlen(inicio);
+    }
+    free(copia);
+}
+
+/// @brief Verifica as diretorias 0..limite e invalida as entradas afetadas.
+/// @return 1 se alguma diretoria mudou, 0 caso contrário.
+static int verifica_diretorias(int limite) {
+    int primeira_alterada = -1;
+
+    for (int i = 0; i <= limite && i < num_dirs; i++) {
+        struct timespec m = mtime_diretoria(dirs[i].caminho);
+        if (m.tv_sec != dirs[i].mtime.tv_sec || m.tv_nsec != dirs[i].mtime.tv_nsec) {
+            dirs[i].mtime = m;
+            if (primeira_alterada == -1) {
+                primeira_alterada = i;
+            }
+        }
+    }
+    if (primeira_alterada >= 0) {
+        reconstroi(primeira_alterada, NULL);
+        return 1;
+    }
+    return 0;
+}
+
+/// @brief Resolve um nome sem '/' pela cache ou pelo PATH (com o mutex fechado).
+/// @param nome Nome do comando.
+/// @return Caminho do executável (na tabela), ou NULL se não existir.
+/// @details
+/// Variáveis:
+/// - e: entrada da cache (se o comando já foi resolvido)
+/// - candidato: caminho testado em cada diretoria do PATH
+static const char *resolve(const char *nome) {
+    entrada_cache *e;
+    char *candidato;
+
+    atualiza_path();
+
+    // Acerto na cache: confirmar que nenhuma diretoria relevante mudou
+    e = procura(nome);
+    if (e != NULL && !verifica_diretorias(e->diretoria)) {
+        e->utilizacoes++;
+        return e->caminho;
+    }
+    if (e == NULL) {
+        verifica_diretorias(num_dirs - 1);
+    }
+
+    // Falha: percorrer as diretorias do PATH
+    for (int i = 0; i < num_dirs; i++) {
+        struct stat st;
+
+        if (asprintf(&candidato, "%s/%s", dirs[i].caminho, nome) == -1) {
+            return NULL;
+        }
+        if (stat(candidato, &st) == 0 && S_ISREG(st.st_mode) && access(candidato, X_OK) == 0) {
+            entrada_cache nova = { strdup(nome), candidato, i, 1 };
+            insere(nova);
+            return procura(nome)->caminho;
+        }
+        free(candidato);
+    }
+    return NULL;
+}
+
+/// @brief Resolve o nome de um comando para um caminho absoluto.
+/// @param nome Nome do comando.
+/// @return Caminho do executável (no buffer da thread), ou NULL se não existir.
+const char *cache_path_procura(const char *nome) {
+    const char *caminho;
+
+    if (strchr(nome, '/') != NULL) {
+        return nome;
+    }
+    pthread_mutex_lock(&trinco);
+    caminho = resolve(nome);
+    if (caminho != NULL) {
+        snprintf(resolvido, sizeof(resolvido), "%s", caminho);
+        caminho = resolvido;
+    }
+    pthread_mutex_unlock(&trinco);
+    return caminho;
+}
+
+/// @brief Remove um comando da cache.
+/// @param nome Nome do comando.
+/// @return 0 se foi removido, -1 se não estava na cache.
+int cache_path_esquece(const char *nome) {
+    int r = -1;
+
+    pthread_mutex_lock(&trinco);
+    if (procura(nome) != NULL) {
+        reconstroi(num_dirs + 1, nome);
+        r = 0;
+    }
+    pthread_mutex_unlock(&trinco);
+    return r;
+}
+
+/// @brief Esvazia a cache.
+void cache_path_limpa(void) {
+    pthread_mutex_lock(&trinco);
+    reconstroi(-1, NULL);
+    pthread_mutex_unlock(&trinco);
+}
+
+/// @brief Mostra as entradas da cache no formato do hash do bash.
+void cache_path_mostra(void) {
+    pthread_mutex_lock(&trinco);
+    if (ocupadas == 0) {
+        saida_printf("hash: a cache está vazia\n");
+    } else {
+        saida_printf("utilizações\tcomando\n");
+    }
+    for (size_t i = 0; i < capacidade; i++) {
+        if (entradas[i].nome != NULL) {
+            saida_printf("%11lu\t%s\n", entradas[i].utilizacoes, entradas[i].caminho);
+        }
+    }
+    pthread_mutex_unlock(&trinco);
+}
@@ -0,0 +1,41 @@
+/**
+ * @file cache_path.h
+ * @brief Cache de caminhos absolutos dos comandos encontrados no PATH.
+ *
+ * Evita percorrer as diretorias do PATH em cada comando externo. A cache é
+ * invalidada quando o PATH muda ou quando a data de modificação de uma das
+ * diretorias muda (foi criado ou removido um ficheiro).
+ *
+ * @date 2025
+ */
+
+#ifndef CACHE_PATH_H
+#define CACHE_PATH_H
+
+/**
+ * @brief Resolve o nome de um comando para um caminho absoluto.
+ *
+ * Nomes que contêm '/' são devolvidos sem alterações.
+ * @param nome Nome do comando.
+ * @return Caminho do executável (válido até à próxima procura na mesma thread), ou NULL se não existir.
+ */
+const char *cache_path_procura(const char *nome);
+
+/**
+ * @brief Remove um comando da cache.
+ * @param nome Nome do comando.
+ * @return 0 se foi removido, -1 se não estava na cache.
+ */
+int cache_path_esquece(const char *nome);
+
+/**
+ * @brief Esvazia a cache.
+ */
+void cache_path_limpa(void);
+
+/**
+ * @brief Mostra o conteúdo da cache (número de utilizações e caminho), como o hash do bash.
+ */
+void cache_path_mostra(void);
+
+#endif // CACHE_PATH_H
@@ -0,0 +1,332 @@
+/**
+ * @file cache_resumos.c
+ * @brief Implementação da cache persistente de resumos.
+ *
+ * Em memória, os registos ficam numa tabela de dispersão com endereçamento
+ * aberto por (dispositivo, inode), com pelo menos metade das posições livres;
+ * uma posição livre tem dispositivo e inode a 0. Os registos guardados desde
+ * a última gravação ficam também numa lista de pendentes, que é acrescentada
+ * ao ficheiro por cache_resumos_grava.
+ *
+ * A reescrita não faz fsync: depois de uma falha de energia a cache pode
+ * ficar vazia ou truncada, o que só obriga a recalcular os resumos.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cache_resumos.h"
+#include "saida.h"
+
+/// Início do ficheiro da cache (muda se o formato dos registos mudar).
+#define ASSINATURA "RESUMOS1"
+
+/// Tamanho da assinatura no ficheiro (sem o '\0').
+#define TAMANHO_ASSINATURA 8
+
+/// Com mais registos substituídos do que vivos (além desta folga), a cache é reescrita.
+#define FOLGA_REESCRITA 1024
+
+/// @brief Registo da cache, tal como fica no ficheiro.
+typedef struct {
+    uint64_t dev;
+    uint64_t ino;
+    uint64_t tamanho;
+    int64_t mtime_seg;
+    int64_t mtime_nseg;
+    uint64_t resumo;
+} registo_resumo;
+
+static pthread_mutex_t trinco = PTHREAD_MUTEX_INITIALIZER;
+static int carregada = 0;
+static int reescrever = 0;              ///< o ficheiro deve ser reescrito na próxima gravação
+static registo_resumo *tabela = NULL;
+static size_t capacidade = 0;           ///< posições da tabela (potência de 2)
+static size_t ocupadas = 0;
+static registo_resumo *pendentes = NULL;
+static size_t num_pendentes = 0, cap_pendentes = 0;
+
+/// @brief Devolve a posição de um inode na tabela, ou a posição livre onde ficaria.
+static registo_resumo *posicao(uint64_t dev, uint64_t ino) {
+    uint64_t h = ino * 0x9E3779B97F4A7C15ULL ^ dev;
+    size_t i = (h ^ (h >> 32)) & (capacidade - 1);
+
+    while ((tabela[i].dev != 0 || tabela[i].ino != 0) && (tabela[i].dev != dev || tabela[i].ino != ino)) {
+        i = (i + 1) & (capacidade - 1);
+    }
+    return &tabela[i];
+}
+
+/// @brief Duplica a capacidade da tabela.
+/// @return 0 em caso de sucesso, -1 se faltar memória.
+static int cresce(void) {
+    registo_resumo *antiga = tabela;
+    size_t cap_antiga = capacidade;
+
+    capacidade = capacidade == 0 ? 1024 : capacidade * 2;
+    tabela = calloc(capacidade, sizeof(registo_resumo));
+    if (tabela == NULL) {
+        tabela = antiga;
+        capacidade = cap_antiga;
+        return -1;
+    }
+    for (size_t i = 0; i < cap_antiga; i++) {
+        if (antiga[i].dev != 0 || antiga[i].ino != 0) {
+            *posicao(antiga[i].dev, antiga[i].ino) = antiga[i];
+        }
+    }
+    free(antiga);
+    return 0;
+}
+
+/// @brief Insere um registo na tabela, substituindo o do mesmo inode.
+/// @return 0 em caso de sucesso, -1 se faltar memória.
+static int insere(const registo_resumo *r) {
+    registo_resumo *p;
+
+    if ((ocupadas + 1) * 2 > capacidade && cresce() == -1) {
+        return -1;
+    }
+    p = posicao(r->dev, r->ino);
+    if (p->dev == 0 && p->ino == 0) {
+        ocupadas++;
+    }
+    *p = *r;
+    return 0;
+}
+
+/// @brief Escreve a diretoria da cache em buf.
+/// @return 0 em caso de sucesso, -1 se não houver XDG_CACHE_HOME nem HOME.
+static int diretoria_cache(char *buf, size_t tamanho) {
+    const char *xdg = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    int n;
+
+    // Como na especificação XDG, um caminho relativo é ignorado
+    if (xdg != NULL && xdg[0] == '/') {
+        n = snprintf(buf, tamanho, "%s/interpretador", xdg);
+    } else if (home != NULL && home[0] != '\0') {
+        n = snprintf(buf, tamanho, "%s/.cache/interpretador", home);
+    } else {
+        return -1;
+    }
+    return n > 0 && (size_t)n < tamanho ? 0 : -1;
+}
+
+/// @brief Lê o ficheiro da cache para a tabela (com o trinco fechado).
+static void carrega(void) {
+    char caminho[PATH_MAX];
+    struct stat st;
+    const unsigned char *mapa;
+    size_t num_registos;
+    int fd;
+
+    carregada = 1;
+    if (diretoria_cache(caminho, sizeof(caminho) - sizeof("/resumos")) == -1) {
+        return;
+    }
+    strcat(caminho, "/resumos");
+    fd = open(caminho, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return;
+    }
+    if (fstat(fd, &st) == -1 || st.st_size < TAMANHO_ASSINATURA) {
+        reescrever = 1;
+        close(fd);
+        return;
+    }
+    mapa = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapa == MAP_FAILED) {
+        return;
+    }
+    madvise((void *)mapa, st.st_size, MADV_SEQUENTIAL);
+
+    num_registos = (st.st_size - TAMANHO_ASSINATURA) / sizeof(registo_resumo);
+    if (memcmp(mapa, ASSINATURA, TAMANHO_ASSINATURA) != 0) {
+        num_registos = 0;
+        reescrever = 1;
+    } else if ((st.st_size - TAMANHO_ASSINATURA) % sizeof(registo_resumo) != 0) {
+        // Uma gravação interrompida: os registos completos servem
+        reescrever = 1;
+    }
+    for (size_t i = 0; i < num_registos; i++) {
+        registo_resumo r;
+
+        memcpy(&r, mapa + TAMANHO_ASSINATURA + i * sizeof(registo_resumo), sizeof(r));
+        if ((r.dev != 0 || r.ino != 0) && insere(&r) == -1) {
+            break;
+        }
+    }
+    if (num_registos > 2 * ocupadas + FOLGA_REESCRITA) {
+        reescrever = 1;
+    }
+    munmap((void *)mapa, st.st_size);
+}
+
+/// @brief Procura o resumo de um ficheiro.
+/// @param st Informação atual do ficheiro.
+/// @param resumo Resumo encontrado.
+/// @return 1 se o ficheiro está na cache sem alterações, 0 caso contrário.
+int cache_resumos_procura(const struct stat *st, uint64_t *resumo) {
+    const registo_resumo *p;
+    int encontrado = 0;
+
+    pthread_mutex_lock(&trinco);
+    if (!carregada) {
+        carrega();
+    }
+    if (capacidade > 0) {
+        p = posicao(st->st_dev, st->st_ino);
+        if ((p->dev != 0 || p->ino != 0) && p->tamanho == (uint64_t)st->st_size &&
+            p->mtime_seg == st->st_mtim.tv_sec && p->mtime_nseg == st->st_mtim.tv_nsec) {
+            *resumo = p->resumo;
+            encontrado = 1;
+        }
+    }
+    pthread_mutex_unlock(&trinco);
+    return encontrado;
+}
+
+/// @brief Guarda o resumo de um ficheiro (em memória, até cache_resumos_grava).
+/// @param st Informação do ficheiro antes de ser lido.
+/// @param resumo Resumo do conteúdo.
+void cache_resumos_guarda(const struct stat *st, uint64_t resumo) {
+    registo_resumo r = { st->st_dev, st->st_ino, st->st_size, st->st_mtim.tv_sec, st->st_mtim.tv_nsec, resumo };
+
+    if (time(NULL) - st->st_mtim.tv_sec < CACHE_RESUMOS_RECENTE || (r.dev == 0 && r.ino == 0)) {
+        return;
+    }
+    pthread_mutex_lock(&trinco);
+    if (!carregada) {
+        carrega();
+    }
+    if (num_pendentes == cap_pendentes) {
+        size_t cap = cap_pendentes == 0 ? 64 : cap_pendentes * 2;
+        registo_resumo *novos = realloc(pendentes, cap * sizeof(registo_resumo));
+
+        if (novos == NULL) {
+            pthread_mutex_unlock(&trinco);
+            return;
+        }
+        pendentes = novos;
+        cap_pendentes = cap;
+    }
+    if (insere(&r) == 0) {
+        pendentes[num_pendentes++] = r;
+    }
+    pthread_mutex_unlock(&trinco);
+}
+
+/// @brief Reescreve a cache inteira num temporário e dá-lhe o nome final.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+static int reescreve(const char *diretoria, const char *caminho) {
+    char temporario[PATH_MAX + 32];
+    registo_resumo *vivos;
+    size_t n = 0;
+    int fd, r;
+
+    snprintf(temporario, sizeof(temporario), "%s/.resumos.XXXXXX", diretoria);
+    vivos = malloc((ocupadas > 0 ? ocupadas : 1) * sizeof(registo_resumo));
+    if (vivos == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < capacidade; i++) {
+        if (tabela[i].dev != 0 || tabela[i].ino != 0) {
+            vivos[n++] = tabela[i];
+        }
+    }
+    fd = mkostemp(temporario, O_CLOEXEC);
+    if (fd == -1) {
+        free(vivos);
+        return -1;
+    }
+    r = escreve_tudo(fd, ASSINATURA, TAMANHO_ASSINATURA) == 0 &&
+        escreve_tudo(fd, vivos, n * sizeof(registo_resumo)) == 0 ? 0 : -1;
+    close(fd);
+    free(vivos);
+    if (r == -1 || rename(temporario, caminho) == -1) {
+        unlink(temporario);
+        return -1;
+    }
+    return 0;
+}
+
+/// @brief Acrescenta os registos pendentes ao fim do ficheiro da cache.
+/// @return 0 em caso de sucesso, 1 se o ficheiro tiver de ser reescrito, -1 em caso de erro.
+static int acrescenta_pendentes(const char *caminho) {
+    struct stat st;
+    int fd, r;
+
+    fd = open(caminho, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+    if (fd == -1 || fstat(fd, &st) == -1) {
+        if (fd != -1) {
+            close(fd);
+        }
+        return -1;
+    }
+    // Outro interpretador pode ter deixado um registo a meio
+    if (st.st_size != 0 && (st.st_size < TAMANHO_ASSINATURA ||
+                            (st.st_size - TAMANHO_ASSINATURA) % sizeof(registo_resumo) != 0)) {
+        close(fd);
+        return 1;
+    }
+    r = (st.st_size == 0 && escreve_tudo(fd, ASSINATURA, TAMANHO_ASSINATURA) == -1) ||
+        escreve_tudo(fd, pendentes, num_pendentes * sizeof(registo_resumo)) == -1 ? -1 : 0;
+    close(fd);
+    return r;
+}
+
+/// @brief Escreve no disco os resumos guardados desde a última gravação.
+/// @return 0 em caso de sucesso, -1 se a cache não puder ser escrita.
+/// @details Normalmente os registos novos são acrescentados com um só write;
+/// a cache só é reescrita quando carrega() ou a gravação o pedem.
+int cache_resumos_grava(void) {
+    char diretoria[PATH_MAX], caminho[PATH_MAX + 16];
+    int r = 0;
+
+    pthread_mutex_lock(&trinco);
+    if (num_pendentes == 0 && !reescrever) {
+        pthread_mutex_unlock(&trinco);
+        return 0;
+    }
+    if (diretoria_cache(diretoria, sizeof(diretoria)) == -1) {
+        num_pendentes = 0;
+        pthread_mutex_unlock(&trinco);
+        return -1;
+    }
+    snprintf(caminho, sizeof(caminho), "%s/resumos", diretoria);
+
+    // Criar ~/.cache e a diretoria do interpretador, se ainda não existirem
+    if (mkdir(diretoria, 0700) == -1 && errno == ENOENT) {
+        char *barra = strrchr(diretoria, '/');
+
+        *barra = '\0';
+        mkdir(diretoria, 0700);
+        *barra = '/';
+        mkdir(diretoria, 0700);
+    }
+
+    if (!reescrever) {
+        r = acrescenta_pendentes(caminho);
+        reescrever = r == 1;
+    }
+    if (reescrever) {
+        r = reescreve(diretoria, caminho);
+        reescrever = 0;
+    }
+    num_pendentes = 0;
+    pthread_mutex_unlock(&trinco);
+    return r == 0 ? 0 : -1;
+}
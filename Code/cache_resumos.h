@@ -0,0 +1,54 @@
+/**
+ * @file cache_resumos.h
+ * @brief Cache persistente dos resumos de ficheiros, indexada por
+ * (dispositivo, inode, tamanho, mtime).
+ *
+ * A cache fica em $XDG_CACHE_HOME/interpretador/resumos (ou em
+ * ~/.cache/interpretador/resumos): um cabeçalho seguido de registos de
+ * tamanho fixo, na ordem de bytes da máquina. É lida para uma tabela de
+ * dispersão na primeira utilização; os registos novos são acrescentados ao
+ * fim do ficheiro com um único write em O_APPEND. Um registo de um inode
+ * substitui os anteriores do mesmo inode, por isso, quando os registos
+ * substituídos passam a ser a maioria (ou o ficheiro está corrompido), a
+ * cache é reescrita num ficheiro temporário e renomeada.
+ *
+ * Um ficheiro alterado há menos de CACHE_RESUMOS_RECENTE segundos não é
+ * guardado: uma escrita no mesmo instante do resumo poderia não alterar o
+ * mtime, e o resumo ficaria errado sem que a chave mudasse.
+ *
+ * Todas as funções podem ser chamadas de várias threads.
+ *
+ * @date 2025
+ */
+
+#ifndef CACHE_RESUMOS_H
+#define CACHE_RESUMOS_H
+
+#include <stdint.h>
+#include <sys/stat.h>
+
+/// Ficheiros alterados há menos do que isto (em segundos) não são guardados.
+#define CACHE_RESUMOS_RECENTE 2
+
+/**
+ * @brief Procura o resumo de um ficheiro.
+ * @param st Informação atual do ficheiro.
+ * @param resumo Resumo encontrado.
+ * @return 1 se o ficheiro está na cache sem alterações, 0 caso contrário.
+ */
+int cache_resumos_procura(const struct stat *st, uint64_t *resumo);
+
+/**
+ * @brief Guarda o resumo de um ficheiro (em memória, até cache_resumos_grava).
+ * @param st Informação do ficheiro antes de ser lido.
+ * @param resumo Resumo do conteúdo.
+ */
+void cache_resumos_guarda(const struct stat *st, uint64_t resumo);
+
+/**
+ * @brief Escreve no disco os resumos guardados desde a última gravação.
+ * @return 0 em caso de sucesso, -1 se a cache não puder ser escrita.
+ */
+int cache_resumos_grava(void);
+
+#endif // CACHE_RESUMOS_H
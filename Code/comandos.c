@@ -0,0 +1,675 @@
+/**
+ * @file comandos.c
+ * @brief Implementação das operações da biblioteca de comandos.
+ *
+ * Nenhuma função escreve na saída ou nos erros: as falhas ficam em cada
+ * pedido. As tarefas do pool só escrevem nos seus próprios pedidos (ou
+ * pedaços), por isso não são precisos locks.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "comandos.h"
+#include "cache_nomes.h"
+#include "anel_es.h"
+#include "durabilidade.h"
+#include "copia_paralela.h"
+
+/// Ficheiros maiores do que isto são divididos em pedaços deste tamanho.
+#define PEDACO_CONTA (16UL << 20)
+
+/// Campos pedidos ao statx.
+#define CAMPOS_STATX (STATX_TYPE | STATX_MODE | STATX_INO | STATX_UID | STATX_GID | STATX_SIZE | \
+                      STATX_ATIME | STATX_MTIME | STATX_CTIME | STATX_BTIME)
+
+/// @brief Estado da contagem de um ficheiro.
+typedef struct {
+    pedido_conta *p;
+    unsigned char *mapa;          ///< ficheiro mapeado (NULL se contado pelo descritor)
+    size_t tamanho;
+    int num_pedacos;
+    contagem_parcial *pedacos;    ///< um resultado por pedaço, escrito só pela sua tarefa
+} ficheiro_conta;
+
+/// @brief Tarefa de contagem: um pedaço de um ficheiro mapeado ou um ficheiro inteiro.
+typedef struct {
+    ficheiro_conta *f;
+    int pedaco;                   ///< índice do pedaço, ou -1 para o ficheiro inteiro
+    unsigned long long *bytes_worker;
+} tarefa_conta;
+
+/// @brief Estado da contagem de um ficheiro lido por blocos com es_le.
+typedef struct {
+    contagem *c;
+    int em_palavra;
+} contagem_blocos;
+
+/// @brief Diferença entre dois instantes em segundos.
+static double segundos_entre(const struct timespec *inicio, const struct timespec *fim) {
+    return (fim->tv_sec - inicio->tv_sec) + (fim->tv_nsec - inicio->tv_nsec) / 1e9;
+}
+
+/// @brief Conta um bloco entregue por es_le.
+static void conta_bloco(const unsigned char *dados, size_t n, void *arg) {
+    contagem_blocos *cb = arg;
+    contagem_bloco(dados, n, cb->c, &cb->em_palavra);
+}
+
+/// @brief Conta um ficheiro inteiro a partir do descritor.
+/// @return 0 em caso de sucesso, -1 em caso de erro de leitura.
+/// @details Com `set io uring` as leituras passam pelo io_uring da thread;
+/// caso contrário o ficheiro é mapeado (ou lido) por contagem_descritor.
+static int conta_descritor(int fd, contagem *c) {
+    contagem_blocos cb = { c, 0 };
+
+    if (es_modo() != ES_URING) {
+        return contagem_descritor(fd, c);
+    }
+    memset(c, 0, sizeof(*c));
+    return es_le(fd, conta_bloco, &cb);
+}
+
+/// @brief Executa uma tarefa de contagem num worker do pool.
+/// @param arg Tarefa (tarefa_conta).
+/// @details Cada tarefa só escreve no seu próprio pedaço (ou pedido) e na
+/// entrada do seu worker em bytes_worker.
+static void executa_tarefa_conta(void *arg) {
+    tarefa_conta *t = arg;
+    ficheiro_conta *f = t->f;
+    pedido_conta *p = f->p;
+    unsigned long long bytes;
+
+    if (t->pedaco >= 0) {
+        size_t inicio = (size_t)t->pedaco * PEDACO_CONTA;
+        size_t n = f->tamanho - inicio < PEDACO_CONTA ? f->tamanho - inicio : PEDACO_CONTA;
+        contagem_pedaco(f->mapa + inicio, n, &f->pedacos[t->pedaco]);
+        bytes = n;
+    } else {
+        int fd = open(p->nome, O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            p->codigo = COMANDO_ERRO_ABRIR;
+            p->erro = errno;
+            return;
+        }
+        if (conta_descritor(fd, &p->total) == -1) {
+            p->codigo = COMANDO_ERRO_LER;
+            p->erro = errno;
+        }
+        close(fd);
+        bytes = p->total.bytes;
+    }
+    t->bytes_worker[pool_worker_atual()] += bytes;
+}
+
+/// @brief Prepara a contagem de um ficheiro grande: mapeia-o e divide-o em pedaços.
+/// @return Número de pedaços, ou 0 se o ficheiro deve ser contado por inteiro.
+static int divide_ficheiro(ficheiro_conta *f) {
+    struct stat st;
+    int fd;
+
+    if (stat(f->p->nome, &st) == -1 || !S_ISREG(st.st_mode) || (size_t)st.st_size <= PEDACO_CONTA) {
+        return 0;
+    }
+    fd = open(f->p->nome, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return 0;
+    }
+    f->mapa = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (f->mapa == MAP_FAILED) {
+        f->mapa = NULL;
+        return 0;
+    }
+    madvise(f->mapa, st.st_size, MADV_SEQUENTIAL);
+    f->tamanho = st.st_size;
+    f->num_pedacos = (int)((f->tamanho + PEDACO_CONTA - 1) / PEDACO_CONTA);
+    f->pedacos = calloc(f->num_pedacos, sizeof(contagem_parcial));
+    if (f->pedacos == NULL) {
+        munmap(f->mapa, f->tamanho);
+        f->mapa = NULL;
+        return 0;
+    }
+    return f->num_pedacos;
+}
+
+/// @brief Conta as linhas, palavras e bytes de vários ficheiros.
+/// @param pedidos Pedidos (com nome preenchido).
+/// @param n Número de pedidos.
+/// @param num_threads Threads do pool (0 usa o número de CPUs).
+/// @param est Estatísticas do lote (preenchidas), ou NULL.
+/// @return Número de pedidos que falharam, ou -1 se o pool não puder ser criado.
+/// @details
+/// Conta os caracteres '\n', as palavras e os bytes com o kernel SIMD
+/// escolhido para o processador. Todas as tarefas correm num pool de threads
+/// com roubo de tarefas; os resultados dos pedaços são juntos no fim.
+/// Variáveis:
+/// - fich: estado de cada ficheiro
+/// - tarefas: tarefas submetidas ao pool
+/// - bytes_worker: bytes contados por cada thread
+int comandos_conta(pedido_conta pedidos[], int n, int num_threads, estatisticas_lote *est) {
+    ficheiro_conta *fich = calloc(n > 0 ? n : 1, sizeof(ficheiro_conta));
+    pool_threads *pool = pool_cria(num_threads);
+    tarefa_conta *tarefas = NULL;
+    unsigned long long *bytes_worker = NULL;
+    int num_tarefas = 0, t = 0, falhas = 0, threads = 0;
+    struct timespec inicio, fim;
+
+    for (int i = 0; i < n; i++) {
+        memset(&pedidos[i].total, 0, sizeof(contagem));
+        pedidos[i].codigo = COMANDO_OK;
+        pedidos[i].erro = 0;
+    }
+    if (pool != NULL) {
+        threads = pool_num_threads(pool);
+        bytes_worker = calloc(threads, sizeof(unsigned long long));
+    }
+    if (fich == NULL || pool == NULL || bytes_worker == NULL) {
+        for (int i = 0; i < n; i++) {
+            pedidos[i].codigo = COMANDO_ERRO_MEMORIA;
+            pedidos[i].erro = ENOMEM;
+        }
+        if (pool != NULL) {
+            pool_destroi(pool);
+        }
+        free(bytes_worker);
+        free(fich);
+        return -1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+
+    // Dividir os ficheiros grandes em pedaços
+    for (int i = 0; i < n; i++) {
+        fich[i].p = &pedidos[i];
+        num_tarefas += divide_ficheiro(&fich[i]) > 0 ? fich[i].num_pedacos : 1;
+    }
+
+    // Submeter uma tarefa por pedaço (ou por ficheiro pequeno)
+    tarefas = calloc(num_tarefas > 0 ? num_tarefas : 1, sizeof(tarefa_conta));
+    for (int i = 0; i < n; i++) {
+        int pedacos = fich[i].mapa != NULL ? fich[i].num_pedacos : 1;
+
+        if (tarefas == NULL) {
+            pedidos[i].codigo = COMANDO_ERRO_MEMORIA;
+            pedidos[i].erro = ENOMEM;
+            continue;
+        }
+        for (int k = 0; k < pedacos; k++, t++) {
+            tarefas[t].f = &fich[i];
+            tarefas[t].pedaco = fich[i].mapa != NULL ? k : -1;
+            tarefas[t].bytes_worker = bytes_worker;
+            pool_submete(pool, executa_tarefa_conta, &tarefas[t]);
+        }
+    }
+    pool_espera(pool);
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+
+    // Juntar os pedaços
+    for (int i = 0; i < n; i++) {
+        ficheiro_conta *f = &fich[i];
+
+        if (f->mapa != NULL) {
+            contagem_junta(f->pedacos, f->num_pedacos, &f->p->total);
+            munmap(f->mapa, f->tamanho);
+            free(f->pedacos);
+        }
+        falhas += f->p->codigo != COMANDO_OK;
+    }
+
+    if (est != NULL) {
+        est->threads = threads;
+        est->tarefas = num_tarefas;
+        est->segundos = segundos_entre(&inicio, &fim);
+        for (int w = 0; w < threads && w < est->max_workers; w++) {
+            if (est->workers != NULL) {
+                pool_estatisticas(pool, w, &est->workers[w]);
+            }
+            if (est->bytes_worker != NULL) {
+                est->bytes_worker[w] = bytes_worker[w];
+            }
+        }
+    }
+
+    pool_destroi(pool);
+    free(bytes_worker);
+    free(tarefas);
+    free(fich);
+    return falhas;
+}
+
+/// @brief Obtém a informação de um caminho relativo a uma diretoria (um statx).
+/// @param diretoria Descritor da diretoria, ou AT_FDCWD.
+/// @param caminho Caminho.
+/// @param seguir Se diferente de 0, segue uma ligação simbólica no fim do caminho.
+/// @param p Pedido preenchido.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+/// @details Os nomes do dono e do grupo vêm da cache de nomes.
+int comandos_informa_em(int diretoria, const char *caminho, int seguir, pedido_informa *p) {
+    if (statx(diretoria, caminho, seguir ? 0 : AT_SYMLINK_NOFOLLOW, CAMPOS_STATX, &p->stx) == -1) {
+        p->codigo = COMANDO_ERRO_ABRIR;
+        p->erro = errno;
+        p->utilizador = p->grupo = NULL;
+        return -1;
+    }
+    p->codigo = COMANDO_OK;
+    p->erro = 0;
+    p->utilizador = nome_utilizador(p->stx.stx_uid);
+    p->grupo = nome_grupo(p->stx.stx_gid);
+    return 0;
+}
+
+/// @brief Lote de caminhos tratado por uma tarefa do comandos_informa.
+typedef struct {
+    pedido_informa *pedidos;
+    int n;
+    int falhas;
+} lote_informa;
+
+/// @brief Obtém a informação de um lote de caminhos (tarefa do pool).
+static void executa_lote_informa(void *arg) {
+    lote_informa *l = arg;
+
+    for (int i = 0; i < l->n; i++) {
+        l->falhas += comandos_informa_em(AT_FDCWD, l->pedidos[i].nome, 1, &l->pedidos[i]) == -1;
+    }
+}
+
+/// @brief Obtém a informação de vários caminhos.
+/// @param pedidos Pedidos (com nome preenchido).
+/// @param n Número de pedidos.
+/// @param num_threads Threads do pool (0 usa o número de CPUs).
+/// @return Número de pedidos que falharam.
+/// @details Um statx por caminho; com muitos caminhos, em lotes no pool de
+/// threads (sem pool, ou se não puder ser criado, na thread atual).
+int comandos_informa(pedido_informa pedidos[], int n, int num_threads) {
+    int num_lotes = (n + COMANDOS_CAMINHOS_TAREFA - 1) / COMANDOS_CAMINHOS_TAREFA, falhas = 0;
+    lote_informa *lotes = NULL;
+    pool_threads *pool = NULL;
+
+    if (n >= COMANDOS_MIN_PARALELO) {
+        lotes = calloc(num_lotes, sizeof(lote_informa));
+        pool = lotes != NULL ? pool_cria(num_threads) : NULL;
+    }
+    if (pool == NULL) {
+        lote_informa todos = { pedidos, n, 0 };
+
+        free(lotes);
+        executa_lote_informa(&todos);
+        return todos.falhas;
+    }
+    for (int l = 0; l < num_lotes; l++) {
+        lotes[l].pedidos = &pedidos[l * COMANDOS_CAMINHOS_TAREFA];
+        lotes[l].n = n - l * COMANDOS_CAMINHOS_TAREFA < COMANDOS_CAMINHOS_TAREFA ?
+                     n - l * COMANDOS_CAMINHOS_TAREFA : COMANDOS_CAMINHOS_TAREFA;
+        pool_submete(pool, executa_lote_informa, &lotes[l]);
+    }
+    pool_espera(pool);
+    pool_destroi(pool);
+    for (int l = 0; l < num_lotes; l++) {
+        falhas += lotes[l].falhas;
+    }
+    free(lotes);
+    return falhas;
+}
+
+/// Sufixo do ficheiro parcial de uma cópia grande com retoma (escondido, na diretoria do destino).
+#define SUFIXO_PARCIAL ".parcial"
+
+/// Sufixo do ponto de controlo de uma cópia grande com retoma.
+#define SUFIXO_PONTO ".parcial.ponto"
+
+/// @brief Marca os pedidos cujo destino já é igual à origem (mesmo tamanho e resumo).
+/// @param pedidos Pedidos.
+/// @param n Número de pedidos.
+/// @param num_threads Threads dos resumos.
+/// @param usa_cache Se diferente de 0, os resumos vêm da cache persistente.
+/// @details Só os pares com o mesmo tamanho são resumidos, todos de uma vez;
+/// se faltar memória, tudo é copiado.
+static void marca_iguais(pedido_copia pedidos[], int n, int num_threads, int usa_cache) {
+    pedido_resumo *resumos = calloc(n > 0 ? 2 * n : 1, sizeof(pedido_resumo));
+    int *origens = calloc(n > 0 ? n : 1, sizeof(int));
+    int pares = 0;
+
+    if (resumos == NULL || origens == NULL) {
+        free(resumos);
+        free(origens);
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        struct stat so, sd;
+
+        if (stat(pedidos[i].origem, &so) == -1 || stat(pedidos[i].destino, &sd) == -1 ||
+            !S_ISREG(so.st_mode) || !S_ISREG(sd.st_mode) || so.st_size != sd.st_size) {
+            continue;
+        }
+        resumos[2 * pares].nome = pedidos[i].origem;
+        resumos[2 * pares + 1].nome = pedidos[i].destino;
+        origens[pares++] = i;
+    }
+
+    resumo_ficheiros(resumos, 2 * pares, num_threads, usa_cache);
+    for (int k = 0; k < pares; k++) {
+        const pedido_resumo *o = &resumos[2 * k], *d = &resumos[2 * k + 1];
+
+        pedidos[origens[k]].igual = o->origem != RESUMO_ERRO && d->origem != RESUMO_ERRO &&
+                                    o->tamanho == d->tamanho && o->resumo == d->resumo;
+    }
+    free(resumos);
+    free(origens);
+}
+
+/// @brief Copia um ficheiro grande em pedaços paralelos, com ponto de controlo.
+/// @param p Pedido.
+/// @param fd_src Descritor da origem (não é fechado).
+/// @param num_threads Threads da cópia.
+/// @param mostra Se diferente de 0, mostra o progresso.
+/// @param lote Lote de escritas.
+/// @return 1 se o lote foi sincronizado, -1 se essa sincronização falhou
+/// (as escritas pendentes do lote também se perderam), 0 caso contrário.
+/// @details A cópia é escrita em ".<destino>.parcial" e os pedaços
+/// concluídos em ".<destino>.parcial.ponto". Se falhar ou for interrompida,
+/// os dois ficheiros ficam (p->parcial) e o mesmo pedido continua a partir
+/// do último ponto de controlo. O ponto de controlo só é apagado depois de
+/// a cópia ter o nome final, por isso no modo lote o lote é sincronizado já
+/// (o que pesa pouco ao lado de uma cópia destas).
+static int copia_retomavel(pedido_copia *p, int fd_src, int num_threads, int mostra, lote_escritas *lote) {
+    escrita_atomica destino;
+    char *ponto;
+    int fd_ponto, dirfd, r;
+
+    if (escrita_inicia_nomeada(&destino, p->destino, SUFIXO_PARCIAL) == -1) {
+        p->codigo = COMANDO_ERRO_ESCREVER;
+        p->erro = errno;
+        return 0;
+    }
+    if (asprintf(&ponto, ".%s%s", destino.nome, SUFIXO_PONTO) == -1) {
+        p->codigo = COMANDO_ERRO_MEMORIA;
+        p->erro = ENOMEM;
+        p->parcial = 1;
+        escrita_suspende(&destino);
+        return 0;
+    }
+    // Se o ficheiro parcial teve de ser criado, um ponto de controlo antigo
+    // marcaria como feitos pedaços que não estão nele: é descartado
+    fd_ponto = openat(destino.dirfd, ponto, O_RDWR | O_CREAT | O_CLOEXEC | (destino.criado ? O_TRUNC : 0), 0644);
+    if (fd_ponto == -1) {
+        p->erro_ponto = errno;
+    }
+
+    r = copia_paralela(fd_src, destino.fd, fd_ponto, num_threads, mostra, &p->res);
+    if (fd_ponto != -1) {
+        close(fd_ponto);
+    }
+    if (r == -1) {
+        p->codigo = COMANDO_ERRO_ESCREVER;
+        p->erro = errno;
+        p->parcial = 1;
+        escrita_suspende(&destino);
+        free(ponto);
+        return 0;
+    }
+
+    dirfd = dup(destino.dirfd);
+    if (lote_conclui(lote, &destino) == -1) {
+        p->codigo = COMANDO_ERRO_ESCREVER;
+        p->erro = errno;
+        r = 0;
+    } else if (lote_sincroniza(lote) == -1) {
+        p->codigo = COMANDO_ERRO_ESCREVER;
+        p->erro = errno;
+        r = -1;
+    } else {
+        unlinkat(dirfd, ponto, 0);
+        r = 1;
+    }
+    close(dirfd);
+    free(ponto);
+    return r;
+}
+
+/// @brief Copia o ficheiro de um pedido para um temporário e conclui-o no lote.
+/// @param p Pedido.
+/// @param num_threads Threads das cópias grandes.
+/// @param opcoes Opções COPIA_*.
+/// @param lote Lote de escritas.
+/// @return 1 se o lote foi sincronizado, -1 se essa sincronização falhou, 0 caso contrário.
+static int copia_pedido(pedido_copia *p, int num_threads, int opcoes, lote_escritas *lote) {
+    escrita_atomica destino;
+    struct stat st;
+    int fd_src = open(p->origem, O_RDONLY | O_CLOEXEC), r;
+
+    if (fd_src == -1 || fstat(fd_src, &st) == -1) {
+        p->codigo = COMANDO_ERRO_ABRIR;
+        p->erro = errno;
+        if (fd_src != -1) {
+            close(fd_src);
+        }
+        return 0;
+    }
+    if (S_ISREG(st.st_mode) && (unsigned long long)st.st_size >= COPIA_PARALELA_MINIMO &&
+        (opcoes & COPIA_RETOMA)) {
+        r = copia_retomavel(p, fd_src, num_threads, (opcoes & COPIA_PROGRESSO) != 0, lote);
+        close(fd_src);
+        return r;
+    }
+    if (escrita_inicia(&destino, p->destino, S_ISREG(st.st_mode) ? st.st_size : 0) == -1) {
+        p->codigo = COMANDO_ERRO_ESCREVER;
+        p->erro = errno;
+        close(fd_src);
+        return 0;
+    }
+
+    // Sem retoma, os ficheiros grandes vão em pedaços paralelos sem ponto de controlo
+    if (S_ISREG(st.st_mode) && (unsigned long long)st.st_size >= COPIA_PARALELA_MINIMO) {
+        r = copia_paralela(fd_src, destino.fd, -1, num_threads, (opcoes & COPIA_PROGRESSO) != 0, &p->res);
+    } else {
+        r = es_copia(fd_src, destino.fd, &p->res);
+    }
+    if (r == -1) {
+        p->codigo = COMANDO_ERRO_ESCREVER;
+        p->erro = errno;
+        close(fd_src);
+        escrita_cancela(&destino);
+        return 0;
+    }
+    close(fd_src);
+    if (lote_conclui(lote, &destino) == -1) {
+        p->codigo = COMANDO_ERRO_ESCREVER;
+        p->erro = errno;
+    }
+    return 0;
+}
+
+/// @brief Marca como falhadas as cópias pendentes de um lote cuja sincronização falhou.
+/// @param pedidos Pedidos.
+/// @param inicio Primeiro pedido do lote.
+/// @param fim Pedido a seguir ao último do lote.
+/// @param erro errno da falha.
+static void falha_lote(pedido_copia pedidos[], int inicio, int fim, int erro) {
+    // Não se sabe que escritas do lote falharam: nenhuma conta como gravada
+    for (int i = inicio; i < fim; i++) {
+        if (!pedidos[i].igual && pedidos[i].codigo == COMANDO_OK) {
+            pedidos[i].codigo = COMANDO_ERRO_ESCREVER;
+            pedidos[i].erro = erro;
+        }
+    }
+}
+
+/// @brief Copia vários ficheiros, cada um para o destino do seu pedido.
+/// @param pedidos Pedidos (com origem e destino preenchidos).
+/// @param n Número de pedidos.
+/// @param num_threads Threads das cópias grandes e dos resumos (0 usa o número de CPUs).
+/// @param opcoes Opções COPIA_* combinadas com |.
+/// @return Número de pedidos que falharam.
+/// @details As cópias são feitas uma a uma (as grandes já usam o pool de
+/// threads) e partilham um lote de escritas, sincronizado no fim (ou antes,
+/// por uma cópia com retoma).
+/// Variáveis:
+/// - inicio: primeiro pedido com a escrita ainda pendente no lote
+int comandos_copia(pedido_copia pedidos[], int n, int num_threads, int opcoes) {
+    lote_escritas lote = LOTE_ESCRITAS_VAZIO;
+    int falhas = 0, inicio = 0;
+
+    for (int i = 0; i < n; i++) {
+        memset(&pedidos[i].res, 0, sizeof(resultado_copia));
+        pedidos[i].igual = 0;
+        pedidos[i].parcial = 0;
+        pedidos[i].erro_ponto = 0;
+        pedidos[i].codigo = COMANDO_OK;
+        pedidos[i].erro = 0;
+    }
+    if (opcoes & COPIA_SE_ALTERADO) {
+        marca_iguais(pedidos, n, num_threads, (opcoes & COPIA_CACHE) != 0);
+    }
+    for (int i = 0; i < n; i++) {
+        int r;
+
+        if (pedidos[i].igual) {
+            continue;
+        }
+        r = copia_pedido(&pedidos[i], num_threads, opcoes, &lote);
+        if (r == -1) {
+            falha_lote(pedidos, inicio, i, pedidos[i].erro);
+        }
+        if (r != 0) {
+            inicio = i + 1;
+        }
+    }
+    if (lote_sincroniza(&lote) == -1) {
+        falha_lote(pedidos, inicio, n, errno);
+    }
+    for (int i = 0; i < n; i++) {
+        falhas += pedidos[i].codigo != COMANDO_OK;
+    }
+    return falhas;
+}
+
+/// @brief Acrescenta a origem de um pedido ao fim do destino.
+/// @param p Pedido.
+/// @details Como o copy_file_range, o sendfile e o splice recusam destinos
+/// com O_APPEND, a cópia usa o ciclo read/write. O espaço é reservado com
+/// fallocate antes de copiar.
+/// Variáveis:
+/// - st_src, st_dest: origem e destino antes da cópia
+/// - st_fim: tamanho do destino depois de uma falha
+static void acrescenta_pedido(pedido_acrescenta *p) {
+    struct stat st_src, st_dest, st_fim;
+    int fd_src, fd_dest;
+
+    fd_src = open(p->origem, O_RDONLY | O_CLOEXEC);
+    if (fd_src == -1) {
+        p->codigo = COMANDO_ERRO_ABRIR;
+        p->erro = errno;
+        return;
+    }
+    fd_dest = open(p->destino, O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (fd_dest == -1) {
+        p->codigo = COMANDO_ERRO_DESTINO;
+        p->erro = errno;
+        close(fd_src);
+        return;
+    }
+    if (fstat(fd_src, &st_src) == -1 || fstat(fd_dest, &st_dest) == -1) {
+        p->codigo = COMANDO_ERRO_LER;
+        p->erro = errno;
+    } else if (st_src.st_ino == st_dest.st_ino && st_src.st_dev == st_dest.st_dev) {
+        p->codigo = COMANDO_ERRO_MESMO;
+        p->erro = EINVAL;
+    }
+    if (p->codigo != COMANDO_OK) {
+        close(fd_src);
+        close(fd_dest);
+        return;
+    }
+
+    // Reservar o espaço do que vai ser acrescentado (sem mudar o tamanho)
+    if (S_ISREG(st_src.st_mode) && st_src.st_size > 0) {
+        fallocate(fd_dest, FALLOC_FL_KEEP_SIZE, st_dest.st_size, st_src.st_size);
+    }
+
+    // Se a cópia falhar a meio, o destino volta ao tamanho original em vez
+    // de ficar com metade dos dados, mas só se mais ninguém acrescentou
+    // entretanto (senão cortava os dados dos outros)
+    if (copia_descritores_buffer(fd_src, fd_dest, &p->res) == -1) {
+        p->codigo = COMANDO_ERRO_ESCREVER;
+        p->erro = errno;
+        p->parcial = fstat(fd_dest, &st_fim) == -1 ||
+                     st_fim.st_size != st_dest.st_size + (off_t)p->res.bytes ||
+                     ftruncate(fd_dest, st_dest.st_size) == -1;
+    } else if (durabilidade_acrescento(fd_dest) == -1) {
+        p->codigo = COMANDO_ERRO_ESCREVER;
+        p->erro = errno;
+    }
+    close(fd_src);
+    close(fd_dest);
+}
+
+/// @brief Acrescenta cada origem ao fim do seu destino.
+/// @param pedidos Pedidos (com origem e destino preenchidos).
+/// @param n Número de pedidos.
+/// @return Número de pedidos que falharam.
+/// @details Os pedidos são tratados um a um, pela ordem do array, por isso
+/// vários pedidos com o mesmo destino acrescentam por essa ordem.
+int comandos_acrescenta(pedido_acrescenta pedidos[], int n) {
+    int falhas = 0;
+
+    for (int i = 0; i < n; i++) {
+        memset(&pedidos[i].res, 0, sizeof(resultado_copia));
+        pedidos[i].parcial = 0;
+        pedidos[i].codigo = COMANDO_OK;
+        pedidos[i].erro = 0;
+        acrescenta_pedido(&pedidos[i]);
+        falhas += pedidos[i].codigo != COMANDO_OK;
+    }
+    return falhas;
+}
+
+/// @brief Remove vários caminhos, guardando o resultado de cada um no seu pedido.
+/// @param pedidos Pedidos (com nome preenchido).
+/// @param n Número de pedidos.
+/// @param recursivo Se diferente de 0, remove também as diretorias.
+/// @param num_threads Threads do pool (0 usa o número de CPUs).
+/// @param est Estatísticas da remoção (preenchidas), ou NULL.
+/// @return Número de pedidos que falharam.
+int comandos_apaga(pedido_apaga pedidos[], int n, int recursivo, int num_threads, estatisticas_remocao *est) {
+    char **caminhos = malloc((n > 0 ? n : 1) * sizeof(char *));
+    resultado_remocao *resultados = malloc((n > 0 ? n : 1) * sizeof(resultado_remocao));
+    estatisticas_remocao local;
+    int falhas = 0;
+
+    if (caminhos == NULL || resultados == NULL) {
+        for (int i = 0; i < n; i++) {
+            memset(&pedidos[i].remocao, 0, sizeof(resultado_remocao));
+            pedidos[i].codigo = COMANDO_ERRO_MEMORIA;
+            pedidos[i].erro = ENOMEM;
+        }
+        free(caminhos);
+        free(resultados);
+        return n;
+    }
+    for (int i = 0; i < n; i++) {
+        caminhos[i] = (char *)pedidos[i].nome;      // remove_caminhos não altera os caminhos
+    }
+    remove_caminhos(caminhos, n, recursivo, num_threads, resultados, est != NULL ? est : &local);
+
+    for (int i = 0; i < n; i++) {
+        pedido_apaga *p = &pedidos[i];
+
+        p->remocao = resultados[i];
+        p->erro = resultados[i].erro;
+        p->codigo = p->remocao.erros == 0 ? COMANDO_OK : p->erro == ENOMEM ? COMANDO_ERRO_MEMORIA : COMANDO_ERRO_REMOVER;
+        falhas += p->codigo != COMANDO_OK;
+    }
+    free(caminhos);
+    free(resultados);
+    return falhas;
+}
@@ -0,0 +1,220 @@
+/**
+ * @file comandos.h
+ * @brief Operações dos comandos de ficheiros como biblioteca (libcomandos).
+ *
+ * As funções não escrevem nada (só o comandos_copia, com COPIA_PROGRESSO,
+ * mostra o progresso das cópias grandes): cada caminho tem um pedido, num
+ * array do chamador, onde ficam o resultado, um código de erro (erro_comando)
+ * e o errno da falha. As entradas recebem arrays de caminhos (lotes) e usam o
+ * pool de threads quando compensa. Os comandos do interpretador
+ * (comandos_ficheiros.c) só formatam estes resultados.
+ *
+ * Os resumos seguem o mesmo modelo em resumo.h (resumo_ficheiros), que faz
+ * parte da biblioteca; a cache persistente dos resumos só é usada se o
+ * chamador a pedir (o interpretador pede, a biblioteca não).
+ *
+ * @date 2025
+ */
+
+#ifndef COMANDOS_H
+#define COMANDOS_H
+
+#include <linux/stat.h>
+#include "contagem.h"
+#include "pool_threads.h"
+#include "resumo.h"
+#include "motor_copia.h"
+#include "remocao.h"
+
+/// Com menos caminhos do que isto, o comandos_informa corre na thread atual.
+#define COMANDOS_MIN_PARALELO 1024
+
+/// Caminhos tratados por cada tarefa do pool no comandos_informa.
+#define COMANDOS_CAMINHOS_TAREFA 256
+
+/**
+ * @brief Motivo da falha de um pedido.
+ */
+typedef enum {
+    COMANDO_OK,             ///< sem erro
+    COMANDO_ERRO_ABRIR,     ///< o caminho não existe ou não pode ser aberto (ver erro)
+    COMANDO_ERRO_LER,       ///< falha de leitura a meio (ver erro)
+    COMANDO_ERRO_MEMORIA,   ///< memória ou threads insuficientes
+    COMANDO_ERRO_ESCREVER,  ///< o destino não pode ser criado, escrito ou gravado (ver erro)
+    COMANDO_ERRO_REMOVER,   ///< o caminho, ou algo dentro dele, não foi removido (ver erro)
+    COMANDO_ERRO_DESTINO,   ///< o destino não existe ou não pode ser aberto (ver erro)
+    COMANDO_ERRO_MESMO      ///< a origem e o destino são o mesmo ficheiro
+} erro_comando;
+
+/**
+ * @brief Estatísticas de um lote (opcionais).
+ *
+ * Os arrays são do chamador, com max_workers posições; os workers a mais
+ * não são preenchidos.
+ */
+typedef struct {
+    int threads;                        ///< workers do pool
+    int tarefas;                        ///< tarefas submetidas ao pool
+    double segundos;                    ///< duração do lote
+    int max_workers;                    ///< posições de workers e bytes_worker
+    estatisticas_worker *workers;       ///< estatísticas de cada worker (pode ser NULL)
+    unsigned long long *bytes_worker;   ///< bytes tratados por cada worker (pode ser NULL)
+} estatisticas_lote;
+
+/**
+ * @brief Pedido de contagem de um ficheiro.
+ */
+typedef struct {
+    const char *nome;       ///< caminho do ficheiro (preenchido pelo chamador)
+    contagem total;         ///< linhas, palavras e bytes
+    erro_comando codigo;
+    int erro;               ///< errno da falha
+} pedido_conta;
+
+/**
+ * @brief Conta as linhas, palavras e bytes de vários ficheiros (como o wc).
+ *
+ * Os ficheiros grandes são mapeados e divididos em pedaços de 16 MiB; todos
+ * os ficheiros e pedaços são tarefas do mesmo pool de threads.
+ * @param pedidos Pedidos (com nome preenchido).
+ * @param n Número de pedidos.
+ * @param num_threads Threads do pool (0 usa o número de CPUs).
+ * @param est Estatísticas do lote (preenchidas), ou NULL.
+ * @return Número de pedidos que falharam, ou -1 se o pool não puder ser
+ * criado (todos os pedidos ficam com COMANDO_ERRO_MEMORIA).
+ */
+int comandos_conta(pedido_conta pedidos[], int n, int num_threads, estatisticas_lote *est);
+
+/**
+ * @brief Pedido de informação sobre um caminho.
+ */
+typedef struct {
+    const char *nome;       ///< caminho (preenchido pelo chamador)
+    struct statx stx;       ///< tipo, i-node, dono, grupo e datas (STATX_BTIME só se existir)
+    const char *utilizador; ///< nome do dono (válido até ao fim do programa)
+    const char *grupo;      ///< nome do grupo (válido até ao fim do programa)
+    erro_comando codigo;
+    int erro;               ///< errno da falha
+} pedido_informa;
+
+/**
+ * @brief Obtém a informação de um caminho relativo a uma diretoria (um statx).
+ * @param diretoria Descritor da diretoria, ou AT_FDCWD.
+ * @param caminho Caminho (relativo à diretoria, se não for absoluto).
+ * @param seguir Se diferente de 0, segue uma ligação simbólica no fim do caminho.
+ * @param p Pedido preenchido (o nome não é alterado).
+ * @return 0 em caso de sucesso, -1 em caso de erro (ver p->erro).
+ */
+int comandos_informa_em(int diretoria, const char *caminho, int seguir, pedido_informa *p);
+
+/**
+ * @brief Obtém a informação de vários caminhos (seguindo as ligações simbólicas).
+ *
+ * Com COMANDOS_MIN_PARALELO caminhos ou mais, os statx são feitos no pool de
+ * threads, em tarefas de COMANDOS_CAMINHOS_TAREFA caminhos.
+ * @param pedidos Pedidos (com nome preenchido).
+ * @param n Número de pedidos.
+ * @param num_threads Threads do pool (0 usa o número de CPUs).
+ * @return Número de pedidos que falharam.
+ */
+int comandos_informa(pedido_informa pedidos[], int n, int num_threads);
+
+/// Opção do comandos_copia: não copia quando o destino já tem o mesmo tamanho e o mesmo resumo.
+#define COPIA_SE_ALTERADO 1
+
+/// Opção do comandos_copia: com COPIA_SE_ALTERADO, usa a cache persistente dos resumos.
+#define COPIA_CACHE 2
+
+/// Opção do comandos_copia: as cópias grandes têm um temporário com nome e um ponto de controlo.
+#define COPIA_RETOMA 4
+
+/// Opção do comandos_copia: mostra o progresso das cópias grandes no STDERR (ver copia_paralela.h).
+#define COPIA_PROGRESSO 8
+
+/**
+ * @brief Pedido de cópia de um ficheiro.
+ */
+typedef struct {
+    const char *origem;     ///< ficheiro de origem (preenchido pelo chamador)
+    const char *destino;    ///< caminho da cópia (preenchido pelo chamador)
+    resultado_copia res;    ///< método usado, bytes copiados e tempo gasto
+    int igual;              ///< 1 se o destino já era igual (com COPIA_SE_ALTERADO) e não foi copiado
+    int parcial;            ///< 1 se a cópia falhou e o mesmo pedido a retoma (com COPIA_RETOMA)
+    int erro_ponto;         ///< errno se o ponto de controlo não pôde ser aberto (a cópia não é retomável)
+    erro_comando codigo;
+    int erro;               ///< errno da falha (EINTR: cópia grande interrompida com Ctrl-C)
+} pedido_copia;
+
+/**
+ * @brief Copia vários ficheiros, cada um para o destino do seu pedido (como o copia).
+ *
+ * Cada cópia é escrita num temporário e só recebe o nome do destino quando
+ * está completa, segundo o modo de durabilidade atual (ver durabilidade.h):
+ * no modo lote, as cópias são sincronizadas todas juntas no fim e, se essa
+ * sincronização falhar, todas as do lote ficam com COMANDO_ERRO_ESCREVER. Os
+ * ficheiros com COPIA_PARALELA_MINIMO bytes ou mais são copiados em pedaços
+ * paralelos; sem COPIA_RETOMA, uma cópia destas interrompida recomeça do
+ * início. Com COPIA_RETOMA, é escrita em ".<destino>.parcial" com os pedaços
+ * concluídos em ".<destino>.parcial.ponto", que ficam se a cópia falhar ou
+ * for interrompida, e o mesmo pedido continua a partir daí.
+ * @param pedidos Pedidos (com origem e destino preenchidos).
+ * @param n Número de pedidos.
+ * @param num_threads Threads das cópias grandes e dos resumos (0 usa o número de CPUs).
+ * @param opcoes Opções COPIA_* combinadas com |, ou 0. Sem COPIA_CACHE, os
+ * resumos do COPIA_SE_ALTERADO leem sempre os dois ficheiros.
+ * @return Número de pedidos que falharam.
+ */
+int comandos_copia(pedido_copia pedidos[], int n, int num_threads, int opcoes);
+
+/**
+ * @brief Pedido para acrescentar um ficheiro a outro.
+ */
+typedef struct {
+    const char *origem;     ///< ficheiro a acrescentar (preenchido pelo chamador)
+    const char *destino;    ///< ficheiro que recebe os dados (preenchido pelo chamador)
+    resultado_copia res;    ///< método usado, bytes acrescentados e tempo gasto
+    int parcial;            ///< 1 se a cópia falhou a meio e o destino ficou com parte dos dados
+    erro_comando codigo;
+    int erro;               ///< errno da falha
+} pedido_acrescenta;
+
+/**
+ * @brief Acrescenta cada origem ao fim do seu destino (como o acrescenta).
+ *
+ * O destino é aberto com O_APPEND, por isso as escritas vão para o fim mesmo
+ * que outro processo esteja a acrescentar ao mesmo tempo. Se a cópia falhar
+ * a meio, o destino volta ao tamanho original (se mais ninguém acrescentou
+ * entretanto; senão fica parcial). No fim, os dados são sincronizados
+ * segundo o modo de durabilidade atual.
+ * @param pedidos Pedidos (com origem e destino preenchidos).
+ * @param n Número de pedidos.
+ * @return Número de pedidos que falharam.
+ */
+int comandos_acrescenta(pedido_acrescenta pedidos[], int n);
+
+/**
+ * @brief Pedido de remoção de um caminho.
+ */
+typedef struct {
+    const char *nome;           ///< caminho (preenchido pelo chamador)
+    resultado_remocao remocao;  ///< entradas removidas e falhas dentro do caminho
+    erro_comando codigo;
+    int erro;                   ///< errno da primeira falha (EINVAL: ".", ".." ou "/")
+} pedido_apaga;
+
+/**
+ * @brief Remove vários caminhos (como o apaga), sem escrever os erros.
+ *
+ * Com recursivo, as diretorias são removidas com todo o conteúdo, em
+ * paralelo (ver remocao.h); uma falha dentro de uma árvore fica no pedido
+ * do caminho indicado.
+ * @param pedidos Pedidos (com nome preenchido).
+ * @param n Número de pedidos.
+ * @param recursivo Se diferente de 0, remove também as diretorias.
+ * @param num_threads Threads do pool (0 usa o número de CPUs).
+ * @param est Estatísticas da remoção (preenchidas), ou NULL.
+ * @return Número de pedidos que falharam.
+ */
+int comandos_apaga(pedido_apaga pedidos[], int n, int recursivo, int num_threads, estatisticas_remocao *est);
+
+#endif // COMANDOS_H
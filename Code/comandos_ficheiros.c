@@ -1,395 +1,1472 @@
-/**
- * @file comandos_ficheiros.c
- * @brief Implementação de comandos para manipulação de ficheiros usando system calls.
- * 
- * Este ficheiro contém funções para mostrar, copiar, acrescentar, contar linhas,
- * apagar, informar e listar ficheiros e diretórios, utilizando chamadas de sistema POSIX.
- * 
- * @author Gonçalo e Rodrigo
- * @date 2025
- */
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <unistd.h>
-#include <fcntl.h>
-#include <sys/stat.h>
-#include <sys/types.h>
-#include <dirent.h>
-#include <string.h>
-#include <time.h>
-#include <pwd.h>
-
-/// @brief Mostra o conteúdo de um ficheiro no terminal.
-/// @author Gonçalo 
-/// @param filename Nome do ficheiro a ser mostrado.
-/// @return 0 em caso de sucesso, 1 em caso de erro.
-/// @details
-/// Abre o ficheiro especificado em modo leitura e escreve o seu conteúdo no STDOUT.
-/// Utiliza as variáveis:
-/// - fd: descritor do ficheiro aberto
-/// - n: número de bytes lidos
-/// - buffer: buffer temporário para leitura
-int mostra(const char *filename) {
-    int fd, n;
-    char buffer[4096];
-    
-    // Abrir o ficheiro para leitura
-    fd = open(filename, O_RDONLY);
-    if (fd == -1) {
-        fprintf(stderr, "Erro: O ficheiro '%s' não existe ou não pode ser aberto.\n", filename);
-        return 1;
-    }
-    
-    // Ler e mostrar o conteúdo do ficheiro
-    while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
-        write(STDOUT_FILENO, buffer, n);
-    }
-    
-    // Fechar o ficheiro
-    close(fd);
-
-    printf("\n\nFicheiro mostrado com sucesso.\n");
-
-    return 0;
-}
-
-/// @brief Copia um ficheiro para um novo ficheiro com extensão ".copia".
-/// @author Rodrigo
-/// @param filename Nome do ficheiro de origem.
-/// @return 0 em caso de sucesso, 1 em caso de erro.
-/// @details
-/// Cria um novo ficheiro com o mesmo nome acrescido de ".copia" e copia o conteúdo.
-/// Variáveis:
-/// - fd_src: descritor do ficheiro de origem
-/// - fd_dest: descritor do ficheiro de destino
-/// - n: número de bytes lidos
-/// - buffer: buffer temporário
-/// - dest_filename: nome do ficheiro de destino
-int copia(const char *filename) {
-    int fd_src, fd_dest, n;
-    char buffer[4096];
-    char dest_filename[1024];
-    
-    // Verificar se o ficheiro de origem existe
-    if (access(filename, F_OK) != 0) {
-        fprintf(stderr, "Erro: O ficheiro '%s' não existe.\n", filename);
-        return 1;
-    }
-
-    // Construir nome do ficheiro de destino
-    snprintf(dest_filename, sizeof(dest_filename), "%s.copia", filename);
-    
-    // Abrir o ficheiro de origem
-    fd_src = open(filename, O_RDONLY);
-    if (fd_src == -1) {
-        fprintf(stderr, "Erro: O ficheiro '%s' não existe ou não pode ser aberto.\n", filename);
-        return 1;
-    }
-    
-    // Criar ficheiro de destino
-    fd_dest = open(dest_filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-    if (fd_dest == -1) {
-        fprintf(stderr, "Erro: Não foi possível criar o ficheiro '%s'.\n", dest_filename);
-        close(fd_src);
-        return 1;
-    }
-    
-    // Copiar conteúdo
-    while ((n = read(fd_src, buffer, sizeof(buffer))) > 0) {
-        write(fd_dest, buffer, n);
-    }
-    
-    // Fechar ficheiros
-    close(fd_src);
-    close(fd_dest);
-    
-    printf("\n\nFicheiro copiado com sucesso para '%s'.\n", dest_filename);
-    return 0;
-}
-
-/// @brief Acrescenta o conteúdo de um ficheiro ao final de outro ficheiro.
-/// @author Gonçalo
-/// @param origem Nome do ficheiro de origem.
-/// @param destino Nome do ficheiro de destino.
-/// @return 0 em caso de sucesso, 1 em caso de erro.
-/// @details
-/// Abre ambos os ficheiros, verifica se são diferentes, e acrescenta o conteúdo.
-/// Variáveis:
-/// - fd_src: descritor do ficheiro de origem
-/// - fd_dest: descritor do ficheiro de destino
-/// - n: número de bytes lidos
-/// - buffer: buffer temporário
-/// - stat_src, stat_dest: estruturas stat para verificação de ficheiros
-int acrescenta(const char *origem, const char *destino) {
-    int fd_src, fd_dest, n;
-    char buffer[4096];
-    struct stat stat_src, stat_dest;
-
-    // Verificar se ficheiro de origem existe
-    if (access(origem, F_OK) != 0) {
-        fprintf(stderr, "Erro: O ficheiro de origem '%s' não existe.\n", origem);
-        return 1;
-    }
-
-    // Verificar se ficheiro de destino existe
-    if (access(destino, F_OK) != 0) {
-        fprintf(stderr, "Erro: O ficheiro de destino '%s' não existe.\n", destino);
-        return 1;
-    }
-
-    // Abrir ficheiro de origem
-    fd_src = open(origem, O_RDONLY);
-    if (fd_src == -1) {
-        fprintf(stderr, "Erro: Não foi possível abrir o ficheiro de origem '%s'.\n", origem);
-        return 1;
-    }
-
-    // Abrir ficheiro de destino para acrescentar
-    fd_dest = open(destino, O_WRONLY | O_APPEND);
-    if (fd_dest == -1) {
-        fprintf(stderr, "Erro: Não foi possível abrir o ficheiro de destino '%s'.\n", destino);
-        close(fd_src);
-        return 1;
-    }
-
-    // Verificar se ficheiros são o mesmo (inode e device)
-    if (fstat(fd_src, &stat_src) == -1 || fstat(fd_dest, &stat_dest) == -1) {
-        fprintf(stderr, "Erro: Falha ao obter informações dos ficheiros.\n");
-        close(fd_src);
-        close(fd_dest);
-        return 1;
-    }
-
-    if (stat_src.st_ino == stat_dest.st_ino && stat_src.st_dev == stat_dest.st_dev) {
-        fprintf(stderr, "Erro: Os ficheiros de origem e destino são o mesmo. Operação cancelada.\n");
-        close(fd_src);
-        close(fd_dest);
-        return 1;
-    }
-
-    // Copiar conteúdo
-    while ((n = read(fd_src, buffer, sizeof(buffer))) > 0) {
-        if (write(fd_dest, buffer, n) != n) {
-            fprintf(stderr, "Erro: Falha ao escrever no ficheiro de destino.\n");
-            close(fd_src);
-            close(fd_dest);
-            return 1;
-        }
-    }
-
-    if (n < 0) {
-        fprintf(stderr, "Erro: Falha ao ler o ficheiro de origem.\n");
-    }
-
-    // Fechar ficheiros
-    close(fd_src);
-    close(fd_dest);
-
-    printf("\n\nConteúdo de '%s' acrescentado com sucesso a '%s'.\n", origem, destino);
-    return 0;
-}
-
-/// @brief Conta o número de linhas de um ficheiro.
-/// @author Rodrigo
-/// @param filename Nome do ficheiro.
-/// @return 0 em caso de sucesso, 1 em caso de erro.
-/// @details
-/// Lê o ficheiro e conta o número de caracteres '\n'.
-/// Variáveis:
-/// - fd: descritor do ficheiro
-/// - n: número de bytes lidos
-/// - buffer: buffer temporário
-/// - line_count: contador de linhas
-int conta(const char *filename) {
-    int fd, n;
-    char buffer[4096];
-    int line_count = 0;
-    
-    // Abrir o ficheiro
-    fd = open(filename, O_RDONLY);
-    if (fd == -1) {
-        fprintf(stderr, "Erro: O ficheiro '%s' não existe ou não pode ser aberto.\n", filename);
-        return 1;
-    }
-    
-    // Ler e contar linhas
-    while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
-        for (int i = 0; i < n; i++) {
-            if (buffer[i] == '\n') {
-                line_count++;
-            }
-        }
-    }
-
-    if (n < 0) {
-    fprintf(stderr, "Erro: Falha ao ler o ficheiro '%s'.\n", filename);
-    close(fd);
-    return 1;
-    }
-    
-    // Fechar ficheiro
-    close(fd);
-    
-    printf("\n\nO ficheiro '%s' tem %d linhas.\n", filename, line_count);
-    return 0;
-}
-
-/// @brief Apaga (remove) um ficheiro do sistema de ficheiros.
-/// @author Gonçalo
-/// @param filename Nome do ficheiro a remover.
-/// @return 0 em caso de sucesso, 1 em caso de erro.
-/// @details
-/// Verifica se o ficheiro existe e tenta removê-lo.
-/// Variáveis:
-/// - st: estrutura stat para verificar existência
-int apaga(const char *filename) {
-    struct stat st;
-
-    // Verificar se o ficheiro existe
-    if (stat(filename, &st) != 0) {
-        fprintf(stderr, "Erro: O ficheiro '%s' não existe.\n", filename);
-        return 1;
-    }
-
-    // Tentar apagar o ficheiro
-    if (unlink(filename) != 0) {
-        fprintf(stderr, "Erro: Não foi possível remover o ficheiro '%s'.\n", filename);
-        return 1;
-    }
-    
-    printf("\n\nFicheiro '%s' removido com sucesso.\n", filename);
-    return 0;
-}
-
-/// @brief Mostra informações detalhadas sobre um ficheiro.
-/// @author Rodrigo
-/// @param filename Nome do ficheiro.
-/// @return 0 em caso de sucesso, 1 em caso de erro.
-/// @details
-/// Mostra tipo, inode, dono, datas de criação, acesso e modificação.
-/// Variáveis:
-/// - file_stat: estrutura stat com informações do ficheiro
-/// - pw: estrutura passwd para obter nome do dono
-/// - time_str: buffer para datas formatadas
-int informa(const char *filename) {
-    struct stat file_stat;
-    struct passwd *pw;
-    char time_str[100];
-    
-    // Verificar se o ficheiro existe
-    if (access(filename, F_OK) == -1) {
-        fprintf(stderr, "Erro: O ficheiro '%s' não existe.\n", filename);
-        return 1;
-    }
-
-    if (stat(filename, &file_stat) == -1) {
-        fprintf(stderr, "Erro: Não foi possível obter informações do ficheiro '%s'.\n", filename);
-        return 1;
-    }
-    
-    // Tipo de ficheiro
-    printf("Tipo de ficheiro: ");
-    if (S_ISREG(file_stat.st_mode))
-        printf("Ficheiro regular\n");
-    else if (S_ISDIR(file_stat.st_mode))
-        printf("Diretoria\n");
-    else if (S_ISLNK(file_stat.st_mode))
-        printf("Link simbólico\n");
-    else if (S_ISFIFO(file_stat.st_mode))
-        printf("FIFO/pipe\n");
-    else if (S_ISSOCK(file_stat.st_mode))
-        printf("Socket\n");
-    else if (S_ISCHR(file_stat.st_mode))
-        printf("Dispositivo de caracteres\n");
-    else if (S_ISBLK(file_stat.st_mode))
-        printf("Dispositivo de blocos\n");
-    else
-        printf("Tipo desconhecido\n");
-    
-    // Número i-node
-    printf("i-node: %lu\n", (unsigned long)file_stat.st_ino);
-    
-    // Nome do dono
-    pw = getpwuid(file_stat.st_uid);
-    printf("Utilizador dono: %s\n", pw ? pw->pw_name : "Desconhecido");
-    
-    // Data de criação
-    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", localtime(&file_stat.st_ctime));
-    printf("Data de criação: %s\n", time_str);
-    
-    // Data de último acesso
-    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", localtime(&file_stat.st_atime));
-    printf("Data do último acesso: %s\n", time_str);
-    
-    // Data de última modificação
-    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", localtime(&file_stat.st_mtime));
-    printf("Data da última modificação: %s\n", time_str);
-    
-    printf("\n\nInformações do ficheiro '%s' mostradas com sucesso.\n", filename);
-
-    return 0;
-}
-
-/// @brief Lista o conteúdo de uma diretoria, mostrando o tipo de cada entrada.
-/// @author Gonçalo
-/// @param path Caminho da diretoria (se NULL, usa a atual).
-/// @return 0 em caso de sucesso, 1 em caso de erro.
-/// @details
-/// Percorre a diretoria e mostra o nome e tipo de cada entrada.
-/// Variáveis:
-/// - dir: ponteiro para a diretoria aberta
-/// - entry: entrada lida da diretoria
-/// - file_stat: estrutura stat para obter tipo
-/// - full_path: caminho completo para cada entrada
-int lista(const char *path) {
-    DIR *dir;
-    struct dirent *entry;
-    struct stat file_stat;
-    char full_path[1024];
-    
-    // Se path é NULL, usar diretoria atual
-    if (path == NULL) {
-        path = ".";
-    }
-    
-    // Abrir diretoria
-    dir = opendir(path);
-    if (dir == NULL) {
-        fprintf(stderr, "Erro: Não foi possível abrir a diretoria '%s'.\n", path);
-        return 1;
-    }
-    
-    printf("Conteúdo da diretoria '%s':\n", path);
-    
-    // Ler entradas da diretoria
-    // Ler cada entrada da diretoria
-    while ((entry = readdir(dir)) != NULL) {
-        // Ignorar "." e ".."
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-            continue;
-        }
-
-        // Construir caminho completo para obter tipo
-        snprintf(full_path, sizeof(full_path), "%s/%s", path, entry->d_name);
-
-        if (stat(full_path, &file_stat) == -1) {
-            fprintf(stderr, "Erro: Não foi possível aceder a '%s'.\n", full_path);
-            continue;
-        }
-
-        // Mostrar nome com tipo textual
-        if (S_ISDIR(file_stat.st_mode)) {
-            printf("[Diretoria] %s\n", entry->d_name);
-        } else if (S_ISREG(file_stat.st_mode)) {
-            printf("[Ficheiro]  %s\n", entry->d_name);
-        } else {
-            printf("[Outro]     %s\n", entry->d_name);
-        }
-    }
-    
-    // Fechar diretoria
-    closedir(dir);
-    printf("\n\nConteúdo da diretoria listado com sucesso.\n");
-    return 0;
+/**
+ * @file comandos_ficheiros.c
+ * @brief Implementação de comandos para manipulação de ficheiros usando system calls.
+ * 
+ * Este ficheiro contém funções para mostrar, copiar, acrescentar, contar linhas,
+ * apagar, informar e listar ficheiros e diretórios, utilizando chamadas de sistema POSIX.
+ * 
+ * @author Gonçalo e Rodrigo
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <pthread.h>
+#include "comandos_ficheiros.h"
+#include "comandos.h"
+#include "motor_copia.h"
+#include "contagem.h"
+#include "pool_threads.h"
+#include "percurso.h"
+#include "indice_linhas.h"
+#include "seguimento.h"
+#include "anel_es.h"
+#include "remocao.h"
+#include "resumo.h"
+#include "pesquisa.h"
+#include "saida.h"
+
+/// @brief Calcula as posições de um intervalo num ficheiro mapeado.
+/// @param st Informação do ficheiro.
+/// @param mapa Conteúdo do ficheiro.
+/// @param intervalo Intervalo pedido.
+/// @param inicio Primeiro byte a mostrar.
+/// @param fim Byte a seguir ao último a mostrar.
+static void calcula_intervalo(const struct stat *st, const unsigned char *mapa,
+                              const intervalo_mostra *intervalo, size_t *inicio, size_t *fim) {
+    size_t tamanho = st->st_size;
+
+    switch (intervalo->modo) {
+    case MOSTRA_LINHAS:
+        *inicio = indice_linhas_procura(st, mapa, intervalo->inicio);
+        *fim = intervalo->fim == ULLONG_MAX ? tamanho : indice_linhas_procura(st, mapa, intervalo->fim + 1);
+        break;
+    case MOSTRA_BYTES:
+        *inicio = intervalo->inicio < tamanho ? intervalo->inicio : tamanho;
+        *fim = intervalo->fim < tamanho ? intervalo->fim : tamanho;
+        break;
+    case MOSTRA_FIM:
+        *inicio = indice_linhas_fim(mapa, tamanho, intervalo->inicio);
+        *fim = tamanho;
+        break;
+    default:
+        *inicio = 0;
+        *fim = tamanho;
+        break;
+    }
+    if (*fim < *inicio) {
+        *fim = *inicio;
+    }
+}
+
+/// @brief Mostra uma parte de um ficheiro regular, mapeado em memória.
+/// @param fd Descritor do ficheiro.
+/// @param st Informação do ficheiro.
+/// @param intervalo Parte a mostrar.
+/// @return 0 em caso de sucesso, -1 em caso de erro (errno indica a causa).
+/// @details Só as páginas do intervalo são lidas do disco: as linhas são
+/// localizadas com o índice esparso e o fim do ficheiro é procurado para trás.
+/// O intervalo é escrito sem cópias com writev, diretamente a partir do mapa.
+static int mostra_intervalo(int fd, const struct stat *st, const intervalo_mostra *intervalo) {
+    unsigned char *mapa;
+    size_t inicio, fim;
+    long pagina = sysconf(_SC_PAGESIZE);
+    int r;
+
+    if (st->st_size == 0) {
+        return 0;
+    }
+    mapa = mmap(NULL, st->st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapa == MAP_FAILED) {
+        return -1;
+    }
+    calcula_intervalo(st, mapa, intervalo, &inicio, &fim);
+    if (fim > inicio) {
+        size_t alinhado = inicio & ~(size_t)(pagina - 1);
+        madvise(mapa + alinhado, fim - alinhado, MADV_SEQUENTIAL);
+    }
+    r = saida_escreve(mapa + inicio, fim - inicio);
+    munmap(mapa, st->st_size);
+    return r;
+}
+
+/// @brief Mostra uma parte de uma entrada que não é um ficheiro regular (um pipe, por exemplo).
+/// @param fd Descritor de entrada.
+/// @param intervalo Parte a mostrar.
+/// @return 0 em caso de sucesso, -1 em caso de erro (errno indica a causa).
+/// @details Os intervalos de linhas e de bytes são escritos à medida que os
+/// dados chegam e a leitura pára logo a seguir ao fim do intervalo. Para as
+/// últimas linhas é preciso ler tudo: os dados ficam em memória até ao fim.
+static int mostra_intervalo_fluxo(int fd, const intervalo_mostra *intervalo) {
+    unsigned char *buffer = NULL, *novo;
+    size_t capacidade = 64 * 1024, usado = 0, bloco_inicio = 0;
+    unsigned long long linha = 1, byte = 0;
+    int r = 0;
+
+    buffer = malloc(capacidade);
+    if (buffer == NULL) {
+        return -1;
+    }
+    for (;;) {
+        ssize_t n;
+
+        // Para as últimas linhas o buffer cresce; nos outros casos é reutilizado
+        if (intervalo->modo == MOSTRA_FIM && usado == capacidade) {
+            novo = realloc(buffer, capacidade * 2);
+            if (novo == NULL) {
+                r = -1;
+                break;
+            }
+            buffer = novo;
+            capacidade *= 2;
+        }
+        n = read(fd, buffer + usado, capacidade - usado);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            r = n < 0 ? -1 : 0;
+            break;
+        }
+        if (intervalo->modo == MOSTRA_FIM) {
+            usado += n;
+            continue;
+        }
+
+        if (intervalo->modo == MOSTRA_BYTES) {
+            // Parte do bloco [byte, byte + n) dentro do intervalo
+            unsigned long long ini = intervalo->inicio > byte ? intervalo->inicio : byte;
+            unsigned long long fim = intervalo->fim < byte + n ? intervalo->fim : byte + n;
+            if (fim > ini && saida_escreve(buffer + (ini - byte), fim - ini) == -1) {
+                r = -1;
+                break;
+            }
+            byte += n;
+            if (byte >= intervalo->fim) {
+                break;
+            }
+            continue;
+        }
+
+        // Intervalo de linhas: percorrer as quebras de linha do bloco
+        {
+            size_t pos = 0, escreve_de = linha >= intervalo->inicio ? 0 : (size_t)n;
+            int terminou = 0;
+
+            while (pos < (size_t)n) {
+                unsigned char *q = memchr(buffer + pos, '\n', n - pos);
+                if (q == NULL) {
+                    break;
+                }
+                pos = q - buffer + 1;
+                if (linha == intervalo->fim) {
+                    terminou = 1;
+                    break;
+                }
+                if (++linha == intervalo->inicio) {
+                    escreve_de = pos;
+                }
+            }
+            if (!terminou) {
+                pos = n;
+            }
+            if (escreve_de < pos && saida_escreve(buffer + escreve_de, pos - escreve_de) == -1) {
+                r = -1;
+                break;
+            }
+            if (terminou) {
+                break;
+            }
+        }
+    }
+    if (r == 0 && intervalo->modo == MOSTRA_FIM) {
+        bloco_inicio = indice_linhas_fim(buffer, usado, intervalo->inicio);
+        r = saida_escreve(buffer + bloco_inicio, usado - bloco_inicio);
+    }
+    free(buffer);
+    return r;
+}
+
+/// @brief Mostra o fim de um ficheiro (ou o intervalo pedido) e depois tudo
+/// o que lhe for acrescentado, como o `tail -F`.
+/// @param filename Nome do ficheiro.
+/// @param intervalo Parte a mostrar antes de começar a seguir (por omissão,
+/// as últimas 10 linhas).
+/// @return 0 em caso de sucesso, 1 em caso de erro.
+static int mostra_e_segue(const char *filename, const intervalo_mostra *intervalo) {
+    intervalo_mostra inicial = *intervalo;
+    struct stat st;
+    int fd;
+
+    if (filename == NULL) {
+        saida_erro("Erro: A opção '-f' precisa de um ficheiro.\n");
+        return 1;
+    }
+    fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        saida_erro("Erro: O ficheiro '%s' não existe ou não pode ser aberto.\n", filename);
+        return 1;
+    }
+    if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode)) {
+        saida_erro("Erro: A opção '-f' só pode ser usada com ficheiros regulares.\n");
+        close(fd);
+        return 1;
+    }
+
+    if (inicial.modo == MOSTRA_TUDO) {
+        inicial.modo = MOSTRA_FIM;
+        inicial.inicio = 10;
+    }
+    if (mostra_intervalo(fd, &st, &inicial) == -1) {
+        if (errno != EPIPE) {
+            saida_erro("Erro: Falha ao escrever o conteúdo de '%s'.\n", filename);
+        }
+        close(fd);
+        return 1;
+    }
+    saida_flush();
+
+    // A partir daqui o descritor pertence ao seguimento
+    if (segue_ficheiro(filename, fd, st.st_size) != 0) {
+        return 1;
+    }
+    saida_info("\n\nFicheiro mostrado com sucesso.\n");
+    return 0;
+}
+
+/// @brief Mostra o conteúdo de um ficheiro no terminal.
+/// @author Gonçalo 
+/// @param filename Nome do ficheiro a ser mostrado, ou NULL para mostrar a entrada.
+/// @param intervalo Parte a mostrar, ou NULL para mostrar tudo.
+/// @return 0 em caso de sucesso, 1 em caso de erro.
+/// @details
+/// Sem intervalo, copia o ficheiro para a saída da thread (STDOUT, um pipe ou
+/// um ficheiro) com o motor de cópia, que usa sendfile/splice e evita passar
+/// os dados pelo espaço de utilizador (ou com o io_uring, com `set io uring`).
+/// Sem ficheiro, copia a entrada da thread (por exemplo, a etapa anterior de
+/// um pipeline).
+/// Com um intervalo de linhas ou de bytes, um ficheiro regular é mapeado em
+/// memória e só é lida a parte necessária; outras entradas são lidas em fluxo.
+/// As linhas vão de inicio a fim, os dois incluídos; os bytes vão de inicio
+/// (incluído) a fim (excluído), por isso `mostra -c N` pede o intervalo N a
+/// N + 1 (ver cmd_mostra).
+/// Utiliza as variáveis:
+/// - fd: descritor do ficheiro aberto
+/// - st: informação do ficheiro
+/// - res: resultado da cópia
+int mostra(const char *filename, const intervalo_mostra *intervalo) {
+    resultado_copia res;
+    struct stat st;
+    int fd, r;
+    
+    // O seguimento abre o ficheiro ele próprio
+    if (intervalo != NULL && intervalo->segue) {
+        return mostra_e_segue(filename, intervalo);
+    }
+
+    // Abrir o ficheiro para leitura
+    fd = filename != NULL ? open(filename, O_RDONLY | O_CLOEXEC) : entrada_fd();
+    if (fd == -1) {
+        saida_erro("Erro: O ficheiro '%s' não existe ou não pode ser aberto.\n", filename);
+        return 1;
+    }
+
+    if (intervalo != NULL && intervalo->modo != MOSTRA_TUDO) {
+        // Mostrar só uma parte: mapeando o ficheiro ou lendo a entrada em fluxo
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            r = mostra_intervalo(fd, &st, intervalo);
+        } else {
+            r = mostra_intervalo_fluxo(fd, intervalo);
+        }
+    } else {
+        // Copiar o conteúdo para a saída, depois do que já estiver no buffer
+        saida_flush();
+        r = es_copia(fd, saida_fd(), &res);
+    }
+    if (r == -1 && errno != EPIPE) {
+        // EPIPE: quem lia a saída terminou (por exemplo "mostra x | head")
+        saida_erro("Erro: Falha ao escrever o conteúdo de '%s'.\n", filename != NULL ? filename : "entrada");
+    }
+    
+    // Fechar o ficheiro
+    if (filename != NULL) {
+        close(fd);
+    }
+    if (r == -1) {
+        return 1;
+    }
+
+    saida_info("\n\nFicheiro mostrado com sucesso.\n");
+
+    return 0;
+}
+
+/// @brief Escreve o erro de um pedido de cópia.
+/// @param p Pedido que falhou.
+static void mostra_erro_copia(const pedido_copia *p) {
+    switch (p->codigo) {
+    case COMANDO_ERRO_ABRIR:
+        if (p->erro == ENOENT) {
+            saida_erro("Erro: O ficheiro '%s' não existe.\n", p->origem);
+        } else {
+            saida_erro("Erro: Não foi possível abrir o ficheiro '%s': %s.\n", p->origem, strerror(p->erro));
+        }
+        break;
+    case COMANDO_ERRO_MEMORIA:
+        saida_erro("Erro: Memória insuficiente para copiar '%s'.\n", p->origem);
+        break;
+    default:
+        if (p->erro == EINTR) {
+            saida_erro("\nErro: Cópia de '%s' interrompida; repita o comando para a retomar.\n", p->origem);
+        } else if (p->parcial) {
+            saida_erro("Erro: Falha ao copiar '%s' para '%s' (%s); repita o comando para retomar a cópia.\n",
+                       p->origem, p->destino, strerror(p->erro));
+        } else {
+            saida_erro("Erro: Falha ao copiar '%s' para '%s': %s.\n", p->origem, p->destino, strerror(p->erro));
+        }
+        break;
+    }
+}
+
+/// @brief Copia cada um dos ficheiros para um novo ficheiro com extensão ".copia".
+/// @author Rodrigo
+/// @param ficheiros Nomes dos ficheiros de origem.
+/// @param n Número de ficheiros.
+/// @param num_threads Threads para as cópias grandes e os resumos (0 usa o número de CPUs).
+/// @param se_alterado Se diferente de 0, não copia os ficheiros cujo ".copia" já é igual.
+/// @return 0 em caso de sucesso, 1 se alguma cópia falhar.
+/// @details
+/// As cópias são feitas pela biblioteca (comandos_copia), com progresso e
+/// retoma das cópias grandes; aqui só se formatam os resultados, pela ordem
+/// original, depois de o lote estar gravado. Com se_alterado, os resumos
+/// vêm da cache (ver resumo.h): uma sincronização repetida sem alterações
+/// só faz stat aos ficheiros.
+/// Variáveis:
+/// - pedidos: um pedido de cópia por ficheiro
+/// - destinos: nomes "<ficheiro>.copia"
+int copia(char *ficheiros[], int n, int num_threads, int se_alterado) {
+    pedido_copia *pedidos = calloc(n, sizeof(pedido_copia));
+    char **destinos = calloc(n, sizeof(char *));
+    int resultado = 0, opcoes = COPIA_RETOMA | COPIA_PROGRESSO;
+
+    if (pedidos == NULL || destinos == NULL) {
+        saida_erro("Erro: Memória insuficiente.\n");
+        free(pedidos);
+        free(destinos);
+        return 1;
+    }
+    for (int i = 0; i < n; i++) {
+        if (asprintf(&destinos[i], "%s.copia", ficheiros[i]) == -1) {
+            saida_erro("Erro: Memória insuficiente.\n");
+            for (int j = 0; j < i; j++) {
+                free(destinos[j]);
+            }
+            free(pedidos);
+            free(destinos);
+            return 1;
+        }
+        pedidos[i].origem = ficheiros[i];
+        pedidos[i].destino = destinos[i];
+    }
+    if (se_alterado) {
+        opcoes |= COPIA_SE_ALTERADO | COPIA_CACHE;
+    }
+    comandos_copia(pedidos, n, num_threads, opcoes);
+
+    for (int i = 0; i < n; i++) {
+        const pedido_copia *p = &pedidos[i];
+
+        if (p->erro_ponto != 0) {
+            saida_erro("Aviso: Não foi possível abrir o ponto de controlo de '%s' (%s); "
+                       "a cópia não pode ser retomada.\n", p->destino, strerror(p->erro_ponto));
+        }
+        if (p->igual) {
+            saida_info("\n\n'%s' já é igual a '%s': nada a copiar.\n", p->destino, p->origem);
+        } else if (p->codigo != COMANDO_OK) {
+            mostra_erro_copia(p);
+            resultado = 1;
+        } else {
+            saida_info("\n\nFicheiro copiado com sucesso para '%s'.\n", p->destino);
+            mostra_resultado_copia(&p->res);
+        }
+        free(destinos[i]);
+    }
+    free(pedidos);
+    free(destinos);
+    return resultado;
+}
+
+/// @brief Acrescenta o conteúdo de um ficheiro ao final de outro ficheiro.
+/// @author Gonçalo
+/// @param origem Nome do ficheiro de origem.
+/// @param destino Nome do ficheiro de destino.
+/// @return 0 em caso de sucesso, 1 em caso de erro.
+/// @details
+/// A cópia é feita pela biblioteca (comandos_acrescenta): o destino é aberto
+/// com O_APPEND, para que cada escrita vá para o fim do ficheiro mesmo que
+/// outro processo esteja a acrescentar ao mesmo tempo (por exemplo, a um
+/// log), o espaço é reservado com fallocate e, no fim, os dados são
+/// sincronizados com o disco (exceto com `set durabilidade nenhuma`). Aqui
+/// só se formata o resultado.
+int acrescenta(const char *origem, const char *destino) {
+    pedido_acrescenta p = { .origem = origem, .destino = destino };
+
+    if (comandos_acrescenta(&p, 1) == 0) {
+        saida_info("\n\nConteúdo de '%s' acrescentado com sucesso a '%s'.\n", origem, destino);
+        mostra_resultado_copia(&p.res);
+        return 0;
+    }
+    switch (p.codigo) {
+    case COMANDO_ERRO_ABRIR:
+        if (p.erro == ENOENT) {
+            saida_erro("Erro: O ficheiro de origem '%s' não existe.\n", origem);
+        } else {
+            saida_erro("Erro: Não foi possível abrir o ficheiro de origem '%s': %s.\n", origem, strerror(p.erro));
+        }
+        break;
+    case COMANDO_ERRO_DESTINO:
+        if (p.erro == ENOENT) {
+            saida_erro("Erro: O ficheiro de destino '%s' não existe.\n", destino);
+        } else {
+            saida_erro("Erro: Não foi possível abrir o ficheiro de destino '%s': %s.\n", destino, strerror(p.erro));
+        }
+        break;
+    case COMANDO_ERRO_MESMO:
+        saida_erro("Erro: Os ficheiros de origem e destino são o mesmo. Operação cancelada.\n");
+        break;
+    case COMANDO_ERRO_LER:
+        saida_erro("Erro: Falha ao obter informações dos ficheiros: %s.\n", strerror(p.erro));
+        break;
+    default:
+        saida_erro("Erro: Falha ao acrescentar '%s' a '%s': %s.\n", origem, destino, strerror(p.erro));
+        if (p.parcial) {
+            saida_erro("Erro: Não foi possível repor o tamanho original de '%s'.\n", destino);
+        }
+        break;
+    }
+    return 1;
+}
+
+/// @brief Conta as linhas, palavras e bytes da entrada da thread (por exemplo, um pipe).
+/// @return 0 em caso de sucesso, 1 em caso de erro.
+static int conta_entrada(void) {
+    contagem c;
+
+    if (contagem_descritor(entrada_fd(), &c) == -1) {
+        saida_erro("Erro: Falha ao ler a entrada.\n");
+        return 1;
+    }
+    saida_printf("\n\nA entrada tem %llu linhas, %llu palavras e %llu bytes.\n", c.linhas, c.palavras, c.bytes);
+    return 0;
+}
+
+/// @brief Conta o número de linhas, palavras e bytes de um ou mais ficheiros.
+/// @author Rodrigo
+/// @param ficheiros Nomes dos ficheiros.
+/// @param n Número de ficheiros.
+/// @param num_threads Número de threads (0 usa o número de CPUs).
+/// @param estatisticas Se diferente de 0, mostra bytes e tempo de cada thread.
+/// @return 0 em caso de sucesso, 1 se algum ficheiro falhar.
+/// @details
+/// A contagem é feita pela biblioteca (comandos_conta, em paralelo e com
+/// os kernels SIMD); aqui só se formatam os resultados, pela ordem original.
+/// Variáveis:
+/// - pedidos: um pedido de contagem por ficheiro
+/// - est: threads, tarefas e trabalho de cada worker (com --stats)
+/// - soma: totais de todos os ficheiros
+int conta(char *ficheiros[], int n, int num_threads, int estatisticas) {
+    if (n == 0) {
+        return conta_entrada();
+    }
+
+    pedido_conta *pedidos = calloc(n, sizeof(pedido_conta));
+    estatisticas_lote est = { 0 };
+    contagem soma = { 0, 0, 0 };
+    int resultado = 0;
+
+    est.max_workers = num_threads > 0 ? num_threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    est.workers = calloc(est.max_workers > 0 ? est.max_workers : 1, sizeof(estatisticas_worker));
+    est.bytes_worker = calloc(est.max_workers > 0 ? est.max_workers : 1, sizeof(unsigned long long));
+    if (pedidos != NULL) {
+        for (int i = 0; i < n; i++) {
+            pedidos[i].nome = ficheiros[i];
+        }
+    }
+    if (pedidos == NULL || est.workers == NULL || est.bytes_worker == NULL ||
+        comandos_conta(pedidos, n, num_threads, &est) == -1) {
+        saida_erro("Erro: Não foi possível criar as threads de contagem.\n");
+        free(est.workers);
+        free(est.bytes_worker);
+        free(pedidos);
+        return 1;
+    }
+
+    // Mostrar pela ordem dos ficheiros
+    saida_printf("\n\n");
+    for (int i = 0; i < n; i++) {
+        const pedido_conta *p = &pedidos[i];
+
+        if (p->codigo == COMANDO_ERRO_ABRIR) {
+            saida_erro("Erro: O ficheiro '%s' não existe ou não pode ser aberto.\n", p->nome);
+            resultado = 1;
+            continue;
+        }
+        if (p->codigo != COMANDO_OK) {
+            saida_erro("Erro: Falha ao ler o ficheiro '%s'.\n", p->nome);
+            resultado = 1;
+            continue;
+        }
+        saida_printf("O ficheiro '%s' tem %llu linhas, %llu palavras e %llu bytes.\n",
+               p->nome, p->total.linhas, p->total.palavras, p->total.bytes);
+        soma.linhas += p->total.linhas;
+        soma.palavras += p->total.palavras;
+        soma.bytes += p->total.bytes;
+    }
+    if (n > 1) {
+        saida_printf("Total: %llu linhas, %llu palavras e %llu bytes em %d ficheiros.\n",
+               soma.linhas, soma.palavras, soma.bytes, n);
+    }
+
+    if (estatisticas) {
+        saida_printf("Kernel %s, %d threads, %d tarefas, %.6f s (%.1f MB/s)\n", contagem_kernel(),
+               est.threads, est.tarefas, est.segundos,
+               est.segundos > 0 ? soma.bytes / est.segundos / 1e6 : 0);
+        for (int w = 0; w < est.threads && w < est.max_workers; w++) {
+            const estatisticas_worker *e = &est.workers[w];
+            saida_printf("  Thread %d: %llu bytes, %llu tarefas (%llu roubadas), %.6f s ocupada\n",
+                   w, est.bytes_worker[w], e->tarefas, e->roubos, e->segundos_ocupado);
+        }
+    }
+
+    free(est.workers);
+    free(est.bytes_worker);
+    free(pedidos);
+    return resultado;
+}
+
+/// Bytes lidos de cada vez quando a procura não pode mapear o ficheiro.
+#define BLOCO_PROCURA (1UL << 20)
+
+/// Um ficheiro com um byte nulo nos primeiros bytes é tratado como binário.
+#define AMOSTRA_BINARIO 8192
+
+/// @brief Texto produzido pela procura de um ficheiro.
+typedef struct {
+    char *dados;
+    size_t tamanho;
+    size_t capacidade;
+    int direto;                   ///< escrever logo na saída (só na thread principal)
+    int falhou;                   ///< faltou memória ou a escrita falhou
+} texto_procura;
+
+/// @brief Estado da procura num ficheiro.
+typedef struct {
+    const char *nome;             ///< NULL para a entrada da thread
+    texto_procura texto;
+    unsigned long long selecionadas;
+    unsigned long long bytes;
+    unsigned long long linha;     ///< número da linha que começa em marca (com -n)
+    size_t marca;
+    int binario;
+    int erro;                     ///< 0 ou o errno
+    int pronto;                   ///< protegido pelo trinco do contexto
+} ficheiro_procura;
+
+/// @brief Estado partilhado por todas as tarefas de uma procura.
+typedef struct {
+    pesquisa *p;
+    const opcoes_procura *o;
+    int com_nome;                 ///< prefixar as linhas com o nome do ficheiro
+    automato **automatos;         ///< um por worker, criado na primeira tarefa
+    ficheiro_procura *fich;
+    pthread_mutex_t trinco;
+    pthread_cond_t terminou;
+} contexto_procura;
+
+/// @brief Tarefa de procura: um ficheiro inteiro.
+typedef struct {
+    contexto_procura *c;
+    ficheiro_procura *f;
+} tarefa_procura;
+
+/// @brief Acrescenta bytes ao texto de um ficheiro (ou escreve-os logo).
+static void texto_acrescenta(texto_procura *t, const void *dados, size_t n) {
+    if (t->falhou) {
+        return;
+    }
+    if (t->direto) {
+        t->falhou = saida_escreve(dados, n) == -1;
+        return;
+    }
+    if (t->tamanho + n > t->capacidade) {
+        size_t capacidade = t->capacidade == 0 ? 4096 : t->capacidade;
+        char *novo;
+
+        while (capacidade < t->tamanho + n) {
+            capacidade *= 2;
+        }
+        novo = realloc(t->dados, capacidade);
+        if (novo == NULL) {
+            t->falhou = 1;
+            return;
+        }
+        t->dados = novo;
+        t->capacidade = capacidade;
+    }
+    memcpy(t->dados + t->tamanho, dados, n);
+    t->tamanho += n;
+}
+
+/// @brief Acrescenta texto formatado (como printf) ao texto de um ficheiro.
+__attribute__((format(printf, 2, 3)))
+static void texto_printf(texto_procura *t, const char *formato, ...) {
+    char linha[PATH_MAX + 64];
+    va_list ap;
+    int n;
+
+    va_start(ap, formato);
+    n = vsnprintf(linha, sizeof(linha), formato, ap);
+    va_end(ap);
+    if (n > 0) {
+        texto_acrescenta(t, linha, (size_t)n < sizeof(linha) ? (size_t)n : sizeof(linha) - 1);
+    }
+}
+
+/// @brief Avança o número de linha de f até à posição ate do bloco (só com -n).
+static void avanca_linhas(const contexto_procura *c, ficheiro_procura *f, const unsigned char *dados, size_t ate) {
+    const unsigned char *q = dados + f->marca, *fim = dados + ate;
+
+    if (!c->o->numeros) {
+        return;
+    }
+    while (q < fim && (q = memchr(q, '\n', fim - q)) != NULL) {
+        f->linha++;
+        q++;
+    }
+    f->marca = ate;
+}
+
+/// @brief Regista uma linha selecionada.
+/// @return 1 se a procura neste ficheiro pode parar, 0 caso contrário.
+static int seleciona(const contexto_procura *c, ficheiro_procura *f, const unsigned char *dados,
+                     size_t inicio, size_t fim) {
+    const opcoes_procura *o = c->o;
+
+    f->selecionadas++;
+    if (o->so_nomes) {
+        return 1;
+    }
+    if (o->so_contagem) {
+        return 0;
+    }
+    if (f->binario) {
+        return 1;
+    }
+    if (c->com_nome) {
+        texto_printf(&f->texto, "%s:", f->nome);
+    }
+    if (o->numeros) {
+        avanca_linhas(c, f, dados, inicio);
+        texto_printf(&f->texto, "%llu:", f->linha + 1);
+    }
+    texto_acrescenta(&f->texto, dados + inicio, fim - inicio);
+    texto_acrescenta(&f->texto, "\n", 1);
+    return f->texto.falhou;
+}
+
+/// @brief Procura num bloco de linhas completas (a última pode não ter '\n').
+/// @return 1 se a procura neste ficheiro pode parar, 0 caso contrário, -1 se faltar memória.
+/// @details Com -v, as linhas selecionadas são as que ficam entre duas correspondências.
+static int procura_bloco(const contexto_procura *c, automato *a, ficheiro_procura *f,
+                         const unsigned char *dados, size_t n) {
+    size_t pos = 0, inicio, fim;
+
+    while (pos < n) {
+        int r = pesquisa_proxima(c->p, a, dados, n, pos, &inicio, &fim);
+
+        if (r == -1) {
+            return -1;
+        }
+        if (r == 0) {
+            inicio = fim = n;
+        }
+        if (c->o->inverte) {
+            while (pos < inicio) {
+                const unsigned char *nl = memchr(dados + pos, '\n', inicio - pos);
+                size_t f_linha = nl != NULL ? (size_t)(nl - dados) : inicio;
+
+                if (seleciona(c, f, dados, pos, f_linha)) {
+                    return 1;
+                }
+                pos = f_linha + 1;
+            }
+        } else if (r == 1 && seleciona(c, f, dados, inicio, fim)) {
+            return 1;
+        }
+        pos = fim + 1;
+    }
+    return 0;
+}
+
+/// @brief Procura num ficheiro lido pelo descritor (pipes, /proc, a entrada).
+/// @details As linhas incompletas no fim de um bloco passam para o seguinte;
+/// o bloco cresce se uma linha não couber nele.
+static void procura_descritor(const contexto_procura *c, automato *a, ficheiro_procura *f, int fd) {
+    size_t capacidade = BLOCO_PROCURA, usado = 0;
+    unsigned char *bloco = malloc(capacidade);
+    int primeiro = 1, r = 0;
+
+    if (bloco == NULL) {
+        f->erro = ENOMEM;
+        return;
+    }
+    for (;;) {
+        ssize_t lidos = read(fd, bloco + usado, capacidade - usado);
+        unsigned char *nl;
+        size_t completo;
+
+        if (lidos == -1 && errno == EINTR) {
+            continue;
+        }
+        if (lidos == -1) {
+            f->erro = errno;
+            break;
+        }
+        if (lidos == 0) {
+            if (usado > 0) {
+                r = procura_bloco(c, a, f, bloco, usado);
+            }
+            break;
+        }
+        if (primeiro) {
+            f->binario = memchr(bloco, '\0', lidos < AMOSTRA_BINARIO ? (size_t)lidos : AMOSTRA_BINARIO) != NULL;
+            primeiro = 0;
+        }
+        f->bytes += lidos;
+        usado += lidos;
+        nl = memrchr(bloco, '\n', usado);
+        if (nl == NULL) {
+            if (usado == capacidade) {
+                unsigned char *maior = realloc(bloco, capacidade * 2);
+
+                if (maior == NULL) {
+                    r = -1;
+                    break;
+                }
+                bloco = maior;
+                capacidade *= 2;
+            }
+            continue;
+        }
+        completo = (size_t)(nl - bloco) + 1;
+        r = procura_bloco(c, a, f, bloco, completo);
+        if (r != 0) {
+            break;
+        }
+        avanca_linhas(c, f, bloco, completo);
+        f->marca = 0;
+        memmove(bloco, bloco + completo, usado - completo);
+        usado -= completo;
+    }
+    if (r == -1) {
+        f->erro = ENOMEM;
+    }
+    free(bloco);
+}
+
+/// @brief Procura num ficheiro (ou na entrada) e escreve o resultado no seu texto.
+static void procura_ficheiro(const contexto_procura *c, automato *a, ficheiro_procura *f) {
+    const opcoes_procura *o = c->o;
+    struct stat st;
+    int fd = f->nome != NULL ? open(f->nome, O_RDONLY) : entrada_fd();
+
+    if (a == NULL) {
+        f->erro = ENOMEM;
+        return;
+    }
+    if (fd == -1) {
+        f->erro = errno;
+        return;
+    }
+    if (fstat(fd, &st) == 0 && S_ISDIR(st.st_mode)) {
+        f->erro = EISDIR;
+    } else if (f->nome != NULL && S_ISREG(st.st_mode) && st.st_size > 0) {
+        unsigned char *mapa = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (mapa == MAP_FAILED) {
+            procura_descritor(c, a, f, fd);
+        } else {
+            madvise(mapa, st.st_size, MADV_SEQUENTIAL);
+            f->binario = memchr(mapa, '\0', st.st_size < AMOSTRA_BINARIO ? (size_t)st.st_size : AMOSTRA_BINARIO) != NULL;
+            f->bytes = st.st_size;
+            if (procura_bloco(c, a, f, mapa, st.st_size) == -1) {
+                f->erro = ENOMEM;
+            }
+            munmap(mapa, st.st_size);
+        }
+    } else {
+        procura_descritor(c, a, f, fd);
+    }
+    if (f->nome != NULL) {
+        close(fd);
+    }
+    if (f->erro != 0) {
+        return;
+    }
+
+    // Resultado por ficheiro das opções que não mostram linhas
+    if (o->so_nomes) {
+        if (f->selecionadas > 0) {
+            texto_printf(&f->texto, "%s\n", f->nome != NULL ? f->nome : "(entrada)");
+        }
+    } else if (o->so_contagem) {
+        if (c->com_nome) {
+            texto_printf(&f->texto, "%s:", f->nome);
+        }
+        texto_printf(&f->texto, "%llu\n", f->selecionadas);
+    } else if (f->binario && f->selecionadas > 0) {
+        texto_printf(&f->texto, "O ficheiro binário '%s' corresponde.\n", f->nome != NULL ? f->nome : "(entrada)");
+    }
+}
+
+/// @brief Executa uma tarefa de procura num worker do pool.
+/// @param arg Tarefa (tarefa_procura).
+/// @details Cada worker usa o seu próprio autómato; no fim, a tarefa marca o
+/// ficheiro como pronto e acorda a thread principal, que escreve a saída.
+static void executa_tarefa_procura(void *arg) {
+    tarefa_procura *t = arg;
+    contexto_procura *c = t->c;
+    automato **a = &c->automatos[pool_worker_atual()];
+
+    if (*a == NULL) {
+        *a = pesquisa_automato(c->p);
+    }
+    procura_ficheiro(c, *a, t->f);
+
+    pthread_mutex_lock(&c->trinco);
+    t->f->pronto = 1;
+    pthread_cond_broadcast(&c->terminou);
+    pthread_mutex_unlock(&c->trinco);
+}
+
+/// @brief Mostra o erro da procura num ficheiro.
+static void mostra_erro_procura(const ficheiro_procura *f) {
+    const char *nome = f->nome != NULL ? f->nome : "(entrada)";
+
+    if (f->erro == ENOENT) {
+        saida_erro("Erro: O ficheiro '%s' não existe.\n", nome);
+    } else if (f->erro == EISDIR) {
+        saida_erro("Erro: '%s' é uma diretoria.\n", nome);
+    } else {
+        saida_erro("Erro: Não foi possível procurar em '%s': %s.\n", nome, strerror(f->erro));
+    }
+}
+
+/// @brief Mostra as linhas de um ou mais ficheiros que correspondem aos padrões.
+/// @param padroes Padrões.
+/// @param num_padroes Número de padrões.
+/// @param ficheiros Nomes dos ficheiros.
+/// @param n Número de ficheiros (0 procura na entrada).
+/// @param o Opções.
+/// @return 0 se alguma linha foi selecionada, 1 se nenhuma, 2 em caso de erro.
+/// @details
+/// Com um só ficheiro (ou a entrada), a procura corre na thread atual e
+/// escreve diretamente na saída. Com vários, cada ficheiro é uma tarefa do
+/// pool que guarda o seu resultado num texto próprio; a thread principal
+/// espera pelos ficheiros pela ordem original e escreve cada texto assim que
+/// ele fica pronto, por isso a saída vai aparecendo sem se misturar.
+/// Variáveis:
+/// - c: estado partilhado (pesquisa, opções, autómatos por worker)
+/// - fich: estado de cada ficheiro
+/// - tarefas: tarefas submetidas ao pool
+int procura(char *padroes[], int num_padroes, char *ficheiros[], int n, const opcoes_procura *o) {
+    contexto_procura c = { .o = o, .com_nome = n > 1 };
+    ficheiro_procura *fich = calloc(n > 0 ? n : 1, sizeof(ficheiro_procura));
+    tarefa_procura *tarefas = NULL;
+    pool_threads *pool = NULL;
+    unsigned long long selecionadas = 0, bytes = 0;
+    int erros = 0, threads = 1;
+    struct timespec inicio, fim;
+    char erro[256];
+
+    if (fich == NULL) {
+        saida_erro("Erro: Memória insuficiente.\n");
+        return 2;
+    }
+    c.p = pesquisa_compila(padroes, num_padroes, o->opcoes, erro, sizeof(erro));
+    if (c.p == NULL) {
+        saida_erro("Erro: Padrão inválido: %s.\n", erro);
+        free(fich);
+        return 2;
+    }
+    c.fich = fich;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+
+    if (n <= 1) {
+        // Um ficheiro ou a entrada: na thread atual, a escrever diretamente
+        automato *a = pesquisa_automato(c.p);
+
+        fich[0].nome = n == 1 ? ficheiros[0] : NULL;
+        fich[0].texto.direto = 1;
+        procura_ficheiro(&c, a, &fich[0]);
+        automato_liberta(a);
+        if (fich[0].erro != 0) {
+            mostra_erro_procura(&fich[0]);
+            erros++;
+        }
+        selecionadas = fich[0].selecionadas;
+        bytes = fich[0].bytes;
+    } else {
+        pool = pool_cria(o->num_threads);
+        tarefas = calloc(n, sizeof(tarefa_procura));
+        if (pool != NULL) {
+            c.automatos = calloc(pool_num_threads(pool), sizeof(automato *));
+        }
+        if (pool == NULL || tarefas == NULL || c.automatos == NULL) {
+            saida_erro("Erro: Não foi possível criar as threads de procura.\n");
+            if (pool != NULL) {
+                pool_destroi(pool);
+            }
+            free(c.automatos);
+            free(tarefas);
+            free(fich);
+            pesquisa_liberta(c.p);
+            return 2;
+        }
+        threads = pool_num_threads(pool);
+        pthread_mutex_init(&c.trinco, NULL);
+        pthread_cond_init(&c.terminou, NULL);
+        for (int i = 0; i < n; i++) {
+            fich[i].nome = ficheiros[i];
+            tarefas[i].c = &c;
+            tarefas[i].f = &fich[i];
+            pool_submete(pool, executa_tarefa_procura, &tarefas[i]);
+        }
+
+        // Escrever pela ordem dos ficheiros, à medida que ficam prontos
+        for (int i = 0; i < n; i++) {
+            ficheiro_procura *f = &fich[i];
+
+            pthread_mutex_lock(&c.trinco);
+            while (!f->pronto) {
+                pthread_cond_wait(&c.terminou, &c.trinco);
+            }
+            pthread_mutex_unlock(&c.trinco);
+            if (f->erro != 0) {
+                mostra_erro_procura(f);
+                erros++;
+            } else if (f->texto.falhou) {
+                saida_erro("Erro: Memória insuficiente ao procurar em '%s'.\n", f->nome);
+                erros++;
+            }
+            if (f->texto.tamanho > 0) {
+                saida_escreve(f->texto.dados, f->texto.tamanho);
+            }
+            free(f->texto.dados);
+            selecionadas += f->selecionadas;
+            bytes += f->bytes;
+        }
+        pool_espera(pool);
+        pool_destroi(pool);
+        for (int w = 0; w < threads; w++) {
+            automato_liberta(c.automatos[w]);
+        }
+        pthread_cond_destroy(&c.terminou);
+        pthread_mutex_destroy(&c.trinco);
+        free(c.automatos);
+        free(tarefas);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+
+    if (o->estatisticas) {
+        double segundos = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+
+        saida_info("\n\nFiltro %s, %d threads, %d ficheiros, %llu linhas, %.6f s (%.1f MB/s)\n",
+                   pesquisa_filtro(c.p), threads, n, selecionadas, segundos,
+                   segundos > 0 ? bytes / segundos / 1e6 : 0);
+    }
+    pesquisa_liberta(c.p);
+    free(fich);
+    return erros > 0 ? 2 : selecionadas > 0 ? 0 : 1;
+}
+
+/// @brief Mostra o resumo (XXH64) do conteúdo de um ou mais ficheiros.
+/// @param ficheiros Nomes dos ficheiros.
+/// @param n Número de ficheiros.
+/// @param num_threads Número de threads (0 usa o número de CPUs).
+/// @return 0 em caso de sucesso, 1 se algum ficheiro falhar.
+/// @details
+/// Cada linha tem o resumo em hexadecimal e o nome, como o xxhsum. Os
+/// resumos são calculados pelo módulo de resumos, em paralelo e com a
+/// cache persistente; no fim é mostrado quantos vieram da cache e quantos
+/// bytes foram lidos.
+/// Variáveis:
+/// - pedidos: um pedido de resumo por ficheiro
+/// - lidos: bytes dos ficheiros que não estavam na cache
+int resume(char *ficheiros[], int n, int num_threads) {
+    pedido_resumo *pedidos = calloc(n, sizeof(pedido_resumo));
+    unsigned long long lidos = 0;
+    int da_cache = 0, falhas;
+    struct timespec inicio, fim;
+    double segundos;
+
+    if (pedidos == NULL) {
+        saida_erro("Erro: Memória insuficiente.\n");
+        return 1;
+    }
+    for (int i = 0; i < n; i++) {
+        pedidos[i].nome = ficheiros[i];
+    }
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    falhas = resumo_ficheiros(pedidos, n, num_threads, 1);
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+
+    for (int i = 0; i < n; i++) {
+        const pedido_resumo *p = &pedidos[i];
+
+        if (p->origem == RESUMO_ERRO) {
+            if (p->erro == EINVAL) {
+                saida_erro("Erro: '%s' não é um ficheiro regular.\n", p->nome);
+            } else if (p->erro == ENOENT) {
+                saida_erro("Erro: O ficheiro '%s' não existe.\n", p->nome);
+            } else {
+                saida_erro("Erro: Não foi possível ler o ficheiro '%s': %s.\n", p->nome, strerror(p->erro));
+            }
+            continue;
+        }
+        saida_printf("%016llx  %s\n", (unsigned long long)p->resumo, p->nome);
+        if (p->origem == RESUMO_CACHE) {
+            da_cache++;
+        } else {
+            lidos += p->tamanho;
+        }
+    }
+
+    segundos = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+    saida_info("\n\n%d ficheiros resumidos (%d da cache), %.1f MiB lidos em %.3f s.\n",
+               n - falhas, da_cache, lidos / 1048576.0, segundos);
+    free(pedidos);
+    return falhas == 0 ? 0 : 1;
+}
+
+/// @brief Apaga (remove) um ou mais ficheiros do sistema de ficheiros.
+/// @author Gonçalo
+/// @param ficheiros Nomes dos ficheiros (ou diretorias, com recursivo) a remover.
+/// @param n Número de ficheiros.
+/// @param recursivo Se diferente de 0, remove as diretorias com todo o conteúdo.
+/// @param num_threads Threads usadas (0 usa o número de CPUs).
+/// @return 0 em caso de sucesso, 1 se algum ficheiro falhar.
+/// @details
+/// A remoção é feita pelo módulo de remoção: um único unlink por ficheiro
+/// (o errno distingue o ficheiro que não existe) e, com muitos ficheiros ou
+/// com recursivo, em paralelo no pool de threads.
+/// Variáveis:
+/// - est: ficheiros e diretorias removidos e tempo gasto
+int apaga(char *ficheiros[], int n, int recursivo, int num_threads) {
+    estatisticas_remocao est;
+    int resultado = remove_caminhos(ficheiros, n, recursivo, num_threads, NULL, &est);
+
+    if (n == 1 && est.ficheiros == 1) {
+        saida_info("\n\nFicheiro '%s' removido com sucesso.\n", ficheiros[0]);
+    } else if (est.ficheiros + est.diretorias > 0) {
+        saida_info("\n\n%llu ficheiros e %llu diretorias removidos em %.3f s (%.0f ficheiros/s).\n",
+                   est.ficheiros, est.diretorias, est.segundos,
+                   est.segundos > 0 ? (est.ficheiros + est.diretorias) / est.segundos : 0.0);
+    }
+    return resultado == 0 ? 0 : 1;
+}
+
+/// @brief Diretoria já formatada, à espera de ser escrita.
+typedef struct {
+    char *caminho;
+    char *texto;
+    size_t tamanho;
+} bloco_lista;
+
+/// @brief Contexto do 'lista': blocos produzidos pelas threads do percurso.
+typedef struct {
+    pthread_mutex_t trinco;
+    bloco_lista *blocos;
+    int num_blocos, capacidade;
+    int recursivo, ordena;
+    int sem_memoria;            ///< 1 se algum bloco não pôde ser guardado
+} contexto_lista;
+
+/// @brief Compara duas entradas pelo nome (para qsort).
+static int compara_entradas(const void *a, const void *b) {
+    return strcmp(((const entrada_diretoria *)a)->nome, ((const entrada_diretoria *)b)->nome);
+}
+
+/// @brief Compara dois blocos pelo caminho da diretoria (para qsort).
+static int compara_blocos(const void *a, const void *b) {
+    return strcmp(((const bloco_lista *)a)->caminho, ((const bloco_lista *)b)->caminho);
+}
+
+/// @brief Carrega a informação do fuso horário (executado uma vez).
+static void carrega_fuso_horario(void) {
+    tzset();
+}
+
+/// @brief Formata uma data do statx em hora local.
+/// @details O localtime_r, ao contrário do localtime, não volta a ler
+/// /etc/localtime em cada chamada; o tzset é feito uma única vez.
+static void formata_data(const struct statx_timestamp *t, char *texto, size_t tamanho) {
+    static pthread_once_t fuso_once = PTHREAD_ONCE_INIT;
+    time_t segundos = t->tv_sec;
+    struct tm tm;
+
+    pthread_once(&fuso_once, carrega_fuso_horario);
+    strftime(texto, tamanho, "%Y-%m-%d %H:%M:%S", localtime_r(&segundos, &tm));
+}
+
+/// @brief Nome do tipo de ficheiro.
+static const char *nome_tipo(mode_t modo) {
+    if (S_ISREG(modo))  return "Ficheiro regular";
+    if (S_ISDIR(modo))  return "Diretoria";
+    if (S_ISLNK(modo))  return "Link simbólico";
+    if (S_ISFIFO(modo)) return "FIFO/pipe";
+    if (S_ISSOCK(modo)) return "Socket";
+    if (S_ISCHR(modo))  return "Dispositivo de caracteres";
+    if (S_ISBLK(modo))  return "Dispositivo de blocos";
+    return "Tipo desconhecido";
+}
+
+/// @brief Escreve a informação de um ficheiro obtida pela biblioteca.
+/// @param f Destino do texto.
+/// @param caminho Caminho a mostrar no cabeçalho, ou NULL para não o mostrar.
+/// @param p Resultado do comandos_informa.
+static void escreve_informacao(FILE *f, const char *caminho, const pedido_informa *p) {
+    const struct statx *stx = &p->stx;
+    char time_str[100];
+
+    if (caminho != NULL) {
+        fprintf(f, "Ficheiro: %s\n", caminho);
+    }
+    fprintf(f, "Tipo de ficheiro: %s\n", nome_tipo(stx->stx_mode));
+    fprintf(f, "i-node: %llu\n", (unsigned long long)stx->stx_ino);
+    fprintf(f, "Utilizador dono: %s\n", p->utilizador);
+    fprintf(f, "Grupo dono: %s\n", p->grupo);
+
+    // Data de criação: só existe se o sistema de ficheiros a guardar (alguns devolvem 0)
+    if ((stx->stx_mask & STATX_BTIME) && stx->stx_btime.tv_sec != 0) {
+        formata_data(&stx->stx_btime, time_str, sizeof(time_str));
+        fprintf(f, "Data de criação: %s\n", time_str);
+    } else {
+        fprintf(f, "Data de criação: indisponível\n");
+    }
+    formata_data(&stx->stx_atime, time_str, sizeof(time_str));
+    fprintf(f, "Data do último acesso: %s\n", time_str);
+    formata_data(&stx->stx_mtime, time_str, sizeof(time_str));
+    fprintf(f, "Data da última modificação: %s\n", time_str);
+    formata_data(&stx->stx_ctime, time_str, sizeof(time_str));
+    fprintf(f, "Data da última alteração de estado: %s\n", time_str);
+}
+
+/// @brief Contexto do 'informa -R': blocos de cada diretoria e número de ficheiros.
+typedef struct {
+    pthread_mutex_t trinco;
+    bloco_lista *blocos;
+    int num_blocos, capacidade;
+    unsigned long long ficheiros;
+    int sem_memoria;            ///< 1 se algum bloco não pôde ser guardado
+} contexto_informa;
+
+/// @brief Acrescenta um bloco de texto ao contexto (com o mutex).
+/// @return 0 em caso de sucesso, -1 se faltar memória (o bloco é libertado
+/// e os que já estavam guardados ficam intactos).
+static int guarda_bloco(pthread_mutex_t *trinco, bloco_lista **blocos, int *num, int *capacidade,
+                        bloco_lista bloco) {
+    int resultado = bloco.caminho != NULL ? 0 : -1;
+
+    pthread_mutex_lock(trinco);
+    if (resultado == 0 && *num == *capacidade) {
+        int nova = *capacidade ? *capacidade * 2 : 64;
+        bloco_lista *maior = realloc(*blocos, nova * sizeof(bloco_lista));
+
+        if (maior == NULL) {
+            resultado = -1;
+        } else {
+            *blocos = maior;
+            *capacidade = nova;
+        }
+    }
+    if (resultado == 0) {
+        (*blocos)[(*num)++] = bloco;
+    }
+    pthread_mutex_unlock(trinco);
+    if (resultado == -1) {
+        free(bloco.texto);
+        free(bloco.caminho);
+    }
+    return resultado;
+}
+
+/// @brief Escreve a informação de todas as entradas de uma diretoria (chamada pelo percurso).
+/// @details Um statx por entrada, relativo ao descritor da diretoria e sem
+/// seguir ligações simbólicas.
+static void informa_diretoria(const conteudo_diretoria *d, void *arg) {
+    contexto_informa *ctx = arg;
+    bloco_lista bloco = { NULL, NULL, 0 };
+    FILE *f = open_memstream(&bloco.texto, &bloco.tamanho);
+    unsigned long long ficheiros = 0;
+
+    if (f == NULL) {
+        return;
+    }
+    for (int i = 0; i < d->num_entradas; i++) {
+        pedido_informa p;
+        char *caminho;
+
+        if (asprintf(&caminho, "%s/%s", d->caminho, d->entradas[i].nome) == -1) {
+            continue;
+        }
+        if (comandos_informa_em(d->fd, d->entradas[i].nome, 0, &p) == -1) {
+            saida_erro("Erro: Não foi possível obter informações do ficheiro '%s'.\n", caminho);
+        } else {
+            fprintf(f, "\n");
+            escreve_informacao(f, caminho, &p);
+            ficheiros++;
+        }
+        free(caminho);
+    }
+    fclose(f);
+
+    bloco.caminho = strdup(d->caminho);
+    if (guarda_bloco(&ctx->trinco, &ctx->blocos, &ctx->num_blocos, &ctx->capacidade, bloco) == -1) {
+        __atomic_store_n(&ctx->sem_memoria, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    __atomic_fetch_add(&ctx->ficheiros, ficheiros, __ATOMIC_RELAXED);
+}
+
+/// @brief Mostra a informação de um caminho indicado pelo utilizador.
+/// @return 0 em caso de sucesso, 1 em caso de erro.
+static int informa_caminho(const pedido_informa *p, int com_nome) {
+    char *texto = NULL;
+    size_t tamanho = 0;
+    FILE *f;
+
+    if (p->codigo != COMANDO_OK) {
+        if (p->erro == ENOENT) {
+            saida_erro("Erro: O ficheiro '%s' não existe.\n", p->nome);
+        } else {
+            saida_erro("Erro: Não foi possível obter informações do ficheiro '%s'.\n", p->nome);
+        }
+        return 1;
+    }
+
+    f = open_memstream(&texto, &tamanho);
+    if (f == NULL) {
+        return 1;
+    }
+    escreve_informacao(f, com_nome ? p->nome : NULL, p);
+    fclose(f);
+    saida_escreve(texto, tamanho);
+    free(texto);
+    return 0;
+}
+
+/// @brief Mostra informações detalhadas sobre um ou mais ficheiros.
+/// @author Rodrigo
+/// @param ficheiros Caminhos dos ficheiros.
+/// @param n Número de caminhos.
+/// @param recursivo Se diferente de 0, mostra também todas as entradas das diretorias.
+/// @param num_threads Threads usadas no modo recursivo e com muitos caminhos (0 usa o número de CPUs).
+/// @return 0 em caso de sucesso, 1 em caso de erro.
+/// @details
+/// Mostra tipo, inode, dono, grupo e as datas de criação (birth time),
+/// acesso, modificação e alteração de estado. Cada ficheiro custa um único
+/// statx, feito pela biblioteca (comandos_informa); os nomes do dono e do
+/// grupo vêm da cache de nomes.
+/// Variáveis:
+/// - pedidos: resultado do statx de cada caminho
+/// - ctx: blocos de texto de cada diretoria (modo recursivo)
+/// - est: estatísticas do percurso
+int informa(char *ficheiros[], int n, int recursivo, int num_threads) {
+    contexto_informa ctx = { PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0, 0, 0 };
+    pedido_informa *pedidos = calloc(n, sizeof(pedido_informa));
+    struct timespec inicio, fim;
+    int resultado = 0, com_nome = n > 1 || recursivo;
+    unsigned long long mostrados = 0;
+    double segundos;
+
+    if (pedidos == NULL) {
+        saida_erro("Erro: Memória insuficiente.\n");
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    for (int i = 0; i < n; i++) {
+        pedidos[i].nome = ficheiros[i];
+    }
+    comandos_informa(pedidos, n, num_threads);
+
+    for (int i = 0; i < n; i++) {
+        if (i > 0) {
+            saida_printf("\n");
+        }
+        if (informa_caminho(&pedidos[i], com_nome) != 0) {
+            resultado = 1;
+            continue;
+        }
+        mostrados++;
+
+        // Modo recursivo: todas as entradas da diretoria, em paralelo
+        if (recursivo && S_ISDIR(pedidos[i].stx.stx_mode)) {
+            estatisticas_percurso est;
+
+            ctx.ficheiros = 0;
+            if (percorre_diretorias(ficheiros[i], 1, num_threads, informa_diretoria, &ctx, &est) == -1 ||
+                est.erros > 0) {
+                resultado = 1;
+            }
+            qsort(ctx.blocos, ctx.num_blocos, sizeof(bloco_lista), compara_blocos);
+            for (int b = 0; b < ctx.num_blocos; b++) {
+                saida_escreve(ctx.blocos[b].texto, ctx.blocos[b].tamanho);
+                free(ctx.blocos[b].texto);
+                free(ctx.blocos[b].caminho);
+            }
+            ctx.num_blocos = 0;
+            mostrados += ctx.ficheiros;
+        }
+    }
+    if (ctx.sem_memoria) {
+        saida_erro("Erro: Memória insuficiente; faltam diretorias na informação mostrada.\n");
+        resultado = 1;
+    }
+    free(ctx.blocos);
+    free(pedidos);
+    pthread_mutex_destroy(&ctx.trinco);
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+
+    if (!com_nome) {
+        if (resultado == 0) {
+            saida_info("\n\nInformações do ficheiro '%s' mostradas com sucesso.\n", ficheiros[0]);
+        }
+        return resultado;
+    }
+    segundos = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+    saida_info("\n\nInformações de %llu ficheiros mostradas em %.6f s (%.0f ficheiros/s).\n",
+               mostrados, segundos, segundos > 0 ? mostrados / segundos : 0.0);
+    return resultado;
+}
+
+/// @brief Formata o conteúdo de uma diretoria num bloco de texto (chamada pelo percurso).
+/// @details
+/// O tipo vem do d_type; só as ligações simbólicas precisam de um fstatat
+/// (relativo ao descritor da diretoria), para mostrar o tipo do destino
+/// como fazia o stat original. Os blocos são escritos no fim pela thread
+/// do comando, porque as threads do pool não partilham a saída dela.
+static void lista_diretoria(const conteudo_diretoria *d, void *arg) {
+    contexto_lista *ctx = arg;
+    bloco_lista bloco = { NULL, NULL, 0 };
+    FILE *f = open_memstream(&bloco.texto, &bloco.tamanho);
+
+    if (f == NULL) {
+        return;
+    }
+    if (ctx->ordena) {
+        qsort(d->entradas, d->num_entradas, sizeof(entrada_diretoria), compara_entradas);
+    }
+    if (ctx->recursivo) {
+        fprintf(f, "Conteúdo da diretoria '%s':\n", d->caminho);
+    }
+
+    for (int i = 0; i < d->num_entradas; i++) {
+        const entrada_diretoria *e = &d->entradas[i];
+        unsigned char tipo = e->tipo;
+
+        if (tipo == DT_LNK) {
+            struct stat st;
+
+            if (fstatat(d->fd, e->nome, &st, 0) == -1) {
+                saida_erro("Erro: Não foi possível aceder a '%s/%s'.\n", d->caminho, e->nome);
+                continue;
+            }
+            tipo = IFTODT(st.st_mode);
+        }
+
+        // Mostrar nome com tipo textual
+        if (tipo == DT_DIR) {
+            fprintf(f, "[Diretoria] %s\n", e->nome);
+        } else if (tipo == DT_REG) {
+            fprintf(f, "[Ficheiro]  %s\n", e->nome);
+        } else {
+            fprintf(f, "[Outro]     %s\n", e->nome);
+        }
+    }
+    fclose(f);
+
+    bloco.caminho = strdup(d->caminho);
+    if (guarda_bloco(&ctx->trinco, &ctx->blocos, &ctx->num_blocos, &ctx->capacidade, bloco) == -1) {
+        __atomic_store_n(&ctx->sem_memoria, 1, __ATOMIC_RELAXED);
+    }
+}
+
+/// @brief Lista o conteúdo de uma diretoria, mostrando o tipo de cada entrada.
+/// @author Gonçalo
+/// @param path Caminho da diretoria (se NULL, usa a atual).
+/// @param recursivo Se diferente de 0, lista também todas as subdiretorias.
+/// @param ordena Se diferente de 0, ordena as entradas (e as diretorias) pelo nome.
+/// @param num_threads Threads usadas no modo recursivo (0 usa o número de CPUs).
+/// @return 0 em caso de sucesso, 1 em caso de erro.
+/// @details
+/// Percorre a diretoria com o motor de percurso (getdents64 e d_type, sem
+/// um stat por entrada) e mostra o nome e tipo de cada entrada, seguidos do
+/// número de entradas por segundo.
+/// Variáveis:
+/// - ctx: blocos de texto de cada diretoria
+/// - est: estatísticas do percurso
+int lista(const char *path, int recursivo, int ordena, int num_threads) {
+    contexto_lista ctx = { PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0, recursivo, ordena, 0 };
+    estatisticas_percurso est;
+    int r;
+    
+    // Se path é NULL, usar diretoria atual
+    if (path == NULL) {
+        path = ".";
+    }
+    
+    if (!recursivo) {
+        saida_printf("Conteúdo da diretoria '%s':\n", path);
+    }
+    r = percorre_diretorias(path, recursivo, num_threads, lista_diretoria, &ctx, &est);
+    
+    // Escrever os blocos (pelo caminho, se pedido)
+    if (ordena && ctx.num_blocos > 1) {
+        qsort(ctx.blocos, ctx.num_blocos, sizeof(bloco_lista), compara_blocos);
+    }
+    for (int i = 0; i < ctx.num_blocos; i++) {
+        if (i > 0) {
+            saida_printf("\n");
+        }
+        saida_escreve(ctx.blocos[i].texto, ctx.blocos[i].tamanho);
+        free(ctx.blocos[i].texto);
+        free(ctx.blocos[i].caminho);
+    }
+    free(ctx.blocos);
+    pthread_mutex_destroy(&ctx.trinco);
+    if (ctx.sem_memoria) {
+        saida_erro("Erro: Memória insuficiente; faltam diretorias na listagem.\n");
+        return 1;
+    }
+    if (r == -1) {
+        return 1;
+    }
+
+    saida_info("\n\nConteúdo da diretoria listado com sucesso.\n");
+    saida_info("%llu entradas em %llu diretorias, %.6f s (%.0f entradas/s)\n", est.entradas,
+               est.diretorias, est.segundos, est.segundos > 0 ? est.entradas / est.segundos : 0.0);
+    return est.erros > 0 ? 1 : 0;
 }
\ No newline at end of file
@@ -1,65 +1,161 @@
-/**
- * @file comandos_ficheiros.h
- * @brief Declaração de funções para manipulação de ficheiros e diretórios.
- *
- * Este ficheiro contém as declarações das funções que permitem mostrar, copiar,
- * acrescentar, contar linhas, apagar, informar e listar ficheiros e diretórios.
- *
- * @author Goncalo e Rodrigo
- * @date 2025
- */
-
-#ifndef COMANDOS_FICHEIROS_H
-#define COMANDOS_FICHEIROS_H
-
-/**
- * @brief Mostra o conteúdo de um ficheiro no terminal.
- * @param filename Nome do ficheiro a ser mostrado.
- * @return 0 em caso de sucesso, 1 em caso de erro.
- */
-int mostra(const char *filename);
-
-/**
- * @brief Copia o conteúdo de um ficheiro para um novo ficheiro com extensão .copia.
- * @param filename Nome do ficheiro de origem.
- * @return 0 em caso de sucesso, 1 em caso de erro.
- */
-int copia(const char *filename);
-
-/**
- * @brief Acrescenta o conteúdo de um ficheiro no final de outro.
- * @param origem Nome do ficheiro de origem.
- * @param destino Nome do ficheiro de destino.
- * @return 0 em caso de sucesso, 1 em caso de erro.
- */
-int acrescenta(const char *origem, const char *destino);
-
-/**
- * @brief Conta o número de linhas de um ficheiro.
- * @param filename Nome do ficheiro.
- * @return 0 em caso de sucesso, 1 em caso de erro.
- */
-int conta(const char *filename);
-
-/**
- * @brief Apaga um ficheiro.
- * @param filename Nome do ficheiro a remover.
- * @return 0 em caso de sucesso, 1 em caso de erro.
- */
-int apaga(const char *filename);
-
-/**
- * @brief Apresenta informações de um ficheiro.
- * @param filename Nome do ficheiro.
- * @return 0 em caso de sucesso, 1 em caso de erro.
- */
-int informa(const char *filename);
-
-/**
- * @brief Lista o conteúdo de uma diretoria.
- * @param path Caminho da diretoria (se NULL, usa a atual).
- * @return 0 em caso de sucesso, 1 em caso de erro.
- */
-int lista(const char *path);
-
+/**
+ * @file comandos_ficheiros.h
+ * @brief Declaração de funções para manipulação de ficheiros e diretórios.
+ *
+ * Este ficheiro contém as declarações das funções que permitem mostrar, copiar,
+ * acrescentar, contar linhas, apagar, informar e listar ficheiros e diretórios.
+ * Estas funções escrevem os resultados para o utilizador; as operações sem
+ * escrita, para usar a partir de outros programas, estão em comandos.h.
+ *
+ * @author Goncalo e Rodrigo
+ * @date 2025
+ */
+
+#ifndef COMANDOS_FICHEIROS_H
+#define COMANDOS_FICHEIROS_H
+
+/**
+ * @brief Parte de um ficheiro a mostrar.
+ */
+typedef enum {
+    MOSTRA_TUDO,        ///< todo o conteúdo
+    MOSTRA_LINHAS,      ///< linhas inicio a fim (a primeira é a 1, fim incluído)
+    MOSTRA_BYTES,       ///< bytes inicio a fim (o primeiro é o 0, fim excluído)
+    MOSTRA_FIM          ///< as últimas inicio linhas
+} modo_mostra;
+
+/**
+ * @brief Intervalo a mostrar (fim pode ser ULLONG_MAX para ir até ao fim).
+ */
+typedef struct {
+    modo_mostra modo;
+    unsigned long long inicio;
+    unsigned long long fim;
+    int segue;          ///< continuar a mostrar o que for acrescentado (-f)
+} intervalo_mostra;
+
+/**
+ * @brief Mostra o conteúdo de um ficheiro no terminal (ou na saída redirecionada).
+ *
+ * Um intervalo de linhas inclui as duas pontas (inicio == fim é uma linha);
+ * um de bytes exclui o fim, por isso um só byte N é o intervalo N a N + 1.
+ * @param filename Nome do ficheiro a ser mostrado, ou NULL para mostrar a entrada.
+ * @param intervalo Parte a mostrar, ou NULL para mostrar tudo.
+ * @return 0 em caso de sucesso, 1 em caso de erro.
+ */
+int mostra(const char *filename, const intervalo_mostra *intervalo);
+
+/**
+ * @brief Copia o conteúdo de cada ficheiro para um novo ficheiro com extensão
+ * .copia, de forma atómica (ver durabilidade.h). Os ficheiros grandes são
+ * copiados em pedaços paralelos e a cópia pode ser retomada.
+ *
+ * Com se_alterado (`copia --if-changed`), um ".copia" que já tem o mesmo
+ * conteúdo (o mesmo tamanho e o mesmo resumo, ver resumo.h) não é copiado.
+ * @param ficheiros Nomes dos ficheiros de origem.
+ * @param n Número de ficheiros.
+ * @param num_threads Threads para as cópias grandes e os resumos (0 usa o número de CPUs).
+ * @param se_alterado Se diferente de 0, só copia os ficheiros que mudaram.
+ * @return 0 em caso de sucesso, 1 se alguma cópia falhar.
+ */
+int copia(char *ficheiros[], int n, int num_threads, int se_alterado);
+
+/**
+ * @brief Acrescenta o conteúdo de um ficheiro no final de outro.
+ * @param origem Nome do ficheiro de origem.
+ * @param destino Nome do ficheiro de destino.
+ * @return 0 em caso de sucesso, 1 em caso de erro.
+ */
+int acrescenta(const char *origem, const char *destino);
+
+/**
+ * @brief Conta o número de linhas, palavras e bytes de um ou mais ficheiros.
+ *
+ * Os ficheiros grandes são divididos em pedaços contados em paralelo. Sem
+ * ficheiros (n igual a 0) conta a entrada da thread, por exemplo um pipe.
+ * @param ficheiros Nomes dos ficheiros.
+ * @param n Número de ficheiros.
+ * @param num_threads Número de threads (0 usa o número de CPUs).
+ * @param estatisticas Se diferente de 0, mostra bytes e tempo de cada thread.
+ * @return 0 em caso de sucesso, 1 se algum ficheiro falhar.
+ */
+int conta(char *ficheiros[], int n, int num_threads, int estatisticas);
+
+/**
+ * @brief Opções do comando procura.
+ */
+typedef struct {
+    int opcoes;             ///< EXPRESSAO_LITERAL (-F) e/ou EXPRESSAO_SEM_MAIUSCULAS (-i)
+    int inverte;            ///< mostrar as linhas que não correspondem (-v)
+    int so_contagem;        ///< mostrar só o número de linhas de cada ficheiro (-c)
+    int so_nomes;           ///< mostrar só os nomes dos ficheiros com correspondências (-l)
+    int numeros;            ///< mostrar o número de cada linha (-n)
+    int estatisticas;       ///< mostrar o pré-filtro, as threads e o débito (--stats)
+    int num_threads;        ///< threads para vários ficheiros (0 usa o número de CPUs)
+} opcoes_procura;
+
+/**
+ * @brief Mostra as linhas de um ou mais ficheiros que correspondem a um
+ * ou mais padrões (como o grep -E).
+ *
+ * Os ficheiros são mapeados e percorridos com um pré-filtro de literais
+ * vetorizado à frente de um autómato (ver pesquisa.h). Vários ficheiros são
+ * procurados em paralelo, mas a saída sai pela ordem dos ficheiros. Sem
+ * ficheiros (n igual a 0) procura na entrada da thread, por exemplo um pipe.
+ * @param padroes Padrões.
+ * @param num_padroes Número de padrões.
+ * @param ficheiros Nomes dos ficheiros.
+ * @param n Número de ficheiros.
+ * @param o Opções.
+ * @return 0 se alguma linha foi selecionada, 1 se nenhuma, 2 em caso de erro.
+ */
+int procura(char *padroes[], int num_padroes, char *ficheiros[], int n, const opcoes_procura *o);
+
+/**
+ * @brief Mostra o resumo (XXH64) do conteúdo de um ou mais ficheiros.
+ *
+ * Os ficheiros grandes são resumidos em pedaços paralelos e os resumos ficam
+ * numa cache persistente (ver resumo.h), por isso um ficheiro que não mudou
+ * não volta a ser lido.
+ * @param ficheiros Nomes dos ficheiros.
+ * @param n Número de ficheiros.
+ * @param num_threads Número de threads (0 usa o número de CPUs).
+ * @return 0 em caso de sucesso, 1 se algum ficheiro falhar.
+ */
+int resume(char *ficheiros[], int n, int num_threads);
+
+/**
+ * @brief Apaga um ou mais ficheiros e, com recursivo, diretorias inteiras.
+ *
+ * Com vários ficheiros (por exemplo, os de um padrão como "*.tmp") ou com
+ * recursivo, os erros são reportados um a um e no fim é mostrado o número de
+ * ficheiros e diretorias removidos e o débito (ficheiros/s).
+ * @param ficheiros Nomes dos ficheiros a remover.
+ * @param n Número de ficheiros.
+ * @param recursivo Se diferente de 0, remove as diretorias com todo o conteúdo.
+ * @param num_threads Threads usadas (0 usa o número de CPUs).
+ * @return 0 em caso de sucesso, 1 se algum ficheiro falhar.
+ */
+int apaga(char *ficheiros[], int n, int recursivo, int num_threads);
+
+/**
+ * @brief Apresenta informações de um ou mais ficheiros (um statx por ficheiro).
+ * @param ficheiros Caminhos dos ficheiros.
+ * @param n Número de caminhos.
+ * @param recursivo Se diferente de 0, mostra também o conteúdo das diretorias.
+ * @param num_threads Threads usadas no modo recursivo e com muitos caminhos (0 usa o número de CPUs).
+ * @return 0 em caso de sucesso, 1 em caso de erro.
+ */
+int informa(char *ficheiros[], int n, int recursivo, int num_threads);
+
+/**
+ * @brief Lista o conteúdo de uma diretoria.
+ * @param path Caminho da diretoria (se NULL, usa a atual).
+ * @param recursivo Se diferente de 0, lista também as subdiretorias, em paralelo.
+ * @param ordena Se diferente de 0, ordena as entradas pelo nome.
+ * @param num_threads Threads usadas no modo recursivo (0 usa o número de CPUs).
+ * @return 0 em caso de sucesso, 1 em caso de erro.
+ */
+int lista(const char *path, int recursivo, int ordena, int num_threads);
+
 #endif // COMANDOS_FICHEIROS_H
\ No newline at end of file
@@ -0,0 +1,304 @@
+/**
+ * @file contagem.c
+ * @brief Implementação dos kernels de contagem de linhas, palavras e bytes.
+ *
+ * Todos os kernels vetoriais trabalham em blocos de 64 bytes e produzem duas
+ * máscaras de 64 bits: uma com os '\\n' e outra com os bytes que não são
+ * espaço. As linhas são o popcount da primeira; as palavras são o popcount
+ * dos inícios de palavra, isto é, bytes não-espaço precedidos de espaço.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "contagem.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CONTAGEM_X86 1
+#endif
+
+/// Tamanho de cada janela de mmap (limita a memória mapeada de uma vez).
+#define JANELA_MMAP (64UL << 20)
+
+/// Tamanho do buffer alinhado usado para pipes e ficheiros não mapeáveis.
+#define BUFFER_LEITURA (1UL << 20)
+
+typedef void (*kernel_contagem)(const unsigned char *, size_t, contagem *, int *);
+
+/// @brief Indica se um byte é espaço em branco no sentido do wc (locale C).
+static inline int e_espaco(unsigned char c) {
+    return c == ' ' || (unsigned char)(c - '\t') <= '\r' - '\t';
+}
+
+/// @brief Kernel escalar, usado para as caudas dos blocos e sem SIMD.
+static void conta_escalar(const unsigned char *p, size_t n, contagem *c, int *em_palavra) {
+    unsigned long long linhas = 0, palavras = 0;
+    int anterior = *em_palavra;
+
+    for (size_t i = 0; i < n; i++) {
+        int palavra = !e_espaco(p[i]);
+        linhas += p[i] == '\n';
+        palavras += palavra & !anterior;
+        anterior = palavra;
+    }
+    c->linhas += linhas;
+    c->palavras += palavras;
+    c->bytes += n;
+    *em_palavra = anterior;
+}
+
+/// @brief Acumula as máscaras de um bloco de 64 bytes nos contadores.
+/// @param nl Bits a 1 nas posições com '\\n'.
+/// @param ns Bits a 1 nas posições que não são espaço.
+/// @param anterior Bit do último byte do bloco anterior (atualizado).
+static inline void acumula(uint64_t nl, uint64_t ns, uint64_t *anterior,
+                           unsigned long long *linhas, unsigned long long *palavras) {
+    uint64_t inicios = ns & ~((ns << 1) | *anterior);
+
+    *linhas += __builtin_popcountll(nl);
+    *palavras += __builtin_popcountll(inicios);
+    *anterior = ns >> 63;
+}
+
+#ifdef CONTAGEM_X86
+
+/// @brief Kernel SSE2: quatro vetores de 16 bytes por bloco.
+__attribute__((target("sse2")))
+static void conta_sse2(const unsigned char *p, size_t n, contagem *c, int *em_palavra) {
+    const __m128i v_nl = _mm_set1_epi8('\n');
+    const __m128i v_sp = _mm_set1_epi8(' ');
+    const __m128i v_tab = _mm_set1_epi8('\t');
+    const __m128i v_4 = _mm_set1_epi8('\r' - '\t');
+    unsigned long long linhas = 0, palavras = 0;
+    uint64_t anterior = *em_palavra;
+    size_t i = 0;
+
+    for (; i + 64 <= n; i += 64) {
+        uint64_t nl = 0, ns = 0;
+        for (int k = 0; k < 4; k++) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(p + i + 16 * k));
+            __m128i d = _mm_sub_epi8(v, v_tab);
+            __m128i esp = _mm_or_si128(_mm_cmpeq_epi8(v, v_sp),
+                                       _mm_cmpeq_epi8(_mm_min_epu8(d, v_4), d));
+            nl |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, v_nl)) << (16 * k);
+            ns |= (uint64_t)(uint16_t)~_mm_movemask_epi8(esp) << (16 * k);
+        }
+        acumula(nl, ns, &anterior, &linhas, &palavras);
+    }
+
+    c->linhas += linhas;
+    c->palavras += palavras;
+    c->bytes += i;
+    *em_palavra = (int)anterior;
+    conta_escalar(p + i, n - i, c, em_palavra);
+}
+
+/// @brief Kernel AVX2: dois vetores de 32 bytes por bloco.
+__attribute__((target("avx2,popcnt")))
+static void conta_avx2(const unsigned char *p, size_t n, contagem *c, int *em_palavra) {
+    const __m256i v_nl = _mm256_set1_epi8('\n');
+    const __m256i v_sp = _mm256_set1_epi8(' ');
+    const __m256i v_tab = _mm256_set1_epi8('\t');
+    const __m256i v_4 = _mm256_set1_epi8('\r' - '\t');
+    unsigned long long linhas = 0, palavras = 0;
+    uint64_t anterior = *em_palavra;
+    size_t i = 0;
+
+    for (; i + 64 <= n; i += 64) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(p + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(p + i + 32));
+        __m256i da = _mm256_sub_epi8(a, v_tab);
+        __m256i db = _mm256_sub_epi8(b, v_tab);
+        __m256i ea = _mm256_or_si256(_mm256_cmpeq_epi8(a, v_sp),
+                                     _mm256_cmpeq_epi8(_mm256_min_epu8(da, v_4), da));
+        __m256i eb = _mm256_or_si256(_mm256_cmpeq_epi8(b, v_sp),
+                                     _mm256_cmpeq_epi8(_mm256_min_epu8(db, v_4), db));
+        uint64_t nl = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, v_nl)) |
+                      (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, v_nl)) << 32;
+        uint64_t ns = ~((uint32_t)_mm256_movemask_epi8(ea) |
+                        (uint64_t)(uint32_t)_mm256_movemask_epi8(eb) << 32);
+        acumula(nl, ns, &anterior, &linhas, &palavras);
+    }
+
+    c->linhas += linhas;
+    c->palavras += palavras;
+    c->bytes += i;
+    *em_palavra = (int)anterior;
+    conta_escalar(p + i, n - i, c, em_palavra);
+}
+
+/// @brief Kernel AVX-512BW: um vetor de 64 bytes por bloco, comparações para máscara.
+__attribute__((target("avx512f,avx512bw,popcnt")))
+static void conta_avx512(const unsigned char *p, size_t n, contagem *c, int *em_palavra) {
+    const __m512i v_nl = _mm512_set1_epi8('\n');
+    const __m512i v_sp = _mm512_set1_epi8(' ');
+    const __m512i v_tab = _mm512_set1_epi8('\t');
+    const __m512i v_4 = _mm512_set1_epi8('\r' - '\t');
+    unsigned long long linhas = 0, palavras = 0;
+    uint64_t anterior = *em_palavra;
+    size_t i = 0;
+
+    for (; i + 64 <= n; i += 64) {
+        __m512i v = _mm512_loadu_si512((const void *)(p + i));
+        uint64_t nl = _mm512_cmpeq_epi8_mask(v, v_nl);
+        uint64_t esp = _mm512_cmpeq_epi8_mask(v, v_sp) |
+                       _mm512_cmple_epu8_mask(_mm512_sub_epi8(v, v_tab), v_4);
+        acumula(nl, ~esp, &anterior, &linhas, &palavras);
+    }
+
+    c->linhas += linhas;
+    c->palavras += palavras;
+    c->bytes += i;
+    *em_palavra = (int)anterior;
+    conta_escalar(p + i, n - i, c, em_palavra);
+}
+
+#endif // CONTAGEM_X86
+
+static kernel_contagem kernel_escolhido = conta_escalar;
+static const char *nome_kernel = "escalar";
+static pthread_once_t kernel_once = PTHREAD_ONCE_INIT;
+
+/// @brief Escolhe o melhor kernel suportado pelo processador (executado uma vez).
+static void escolhe_kernel(void) {
+#ifdef CONTAGEM_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("popcnt")) {
+        kernel_escolhido = conta_avx512;
+        nome_kernel = "avx512";
+    } else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+        kernel_escolhido = conta_avx2;
+        nome_kernel = "avx2";
+    } else if (__builtin_cpu_supports("sse2")) {
+        kernel_escolhido = conta_sse2;
+        nome_kernel = "sse2";
+    }
+#endif
+}
+
+/// @brief Conta um bloco de memória com o kernel escolhido.
+/// @param dados Início do bloco.
+/// @param n Tamanho em bytes.
+/// @param c Contagem a atualizar.
+/// @param em_palavra Estado entre blocos.
+void contagem_bloco(const unsigned char *dados, size_t n, contagem *c, int *em_palavra) {
+    pthread_once(&kernel_once, escolhe_kernel);
+    kernel_escolhido(dados, n, c, em_palavra);
+}
+
+/// @brief Devolve o nome do kernel escolhido.
+/// @return Nome do kernel.
+const char *contagem_kernel(void) {
+    pthread_once(&kernel_once, escolhe_kernel);
+    return nome_kernel;
+}
+
+/// @brief Conta um pedaço de ficheiro como se fosse independente.
+/// @param dados Início do pedaço.
+/// @param n Tamanho do pedaço.
+/// @param p Contagem parcial.
+void contagem_pedaco(const unsigned char *dados, size_t n, contagem_parcial *p) {
+    int em_palavra = 0;
+
+    p->c.linhas = p->c.palavras = p->c.bytes = 0;
+    contagem_bloco(dados, n, &p->c, &em_palavra);
+    p->comeca_em_palavra = n > 0 && !e_espaco(dados[0]);
+    p->termina_em_palavra = em_palavra;
+}
+
+/// @brief Junta pedaços consecutivos, descontando palavras cortadas nas fronteiras.
+/// @param pedacos Pedaços por ordem.
+/// @param n Número de pedaços.
+/// @param total Contagem resultante.
+void contagem_junta(const contagem_parcial *pedacos, int n, contagem *total) {
+    total->linhas = total->palavras = total->bytes = 0;
+    for (int i = 0; i < n; i++) {
+        total->linhas += pedacos[i].c.linhas;
+        total->palavras += pedacos[i].c.palavras;
+        total->bytes += pedacos[i].c.bytes;
+        if (i > 0 && pedacos[i - 1].termina_em_palavra && pedacos[i].comeca_em_palavra) {
+            total->palavras--;
+        }
+    }
+}
+
+/// @brief Conta um ficheiro regular mapeando-o em janelas com MADV_SEQUENTIAL.
+/// @return 0 em sucesso, -1 se o mmap falhar (o chamador usa a leitura normal).
+static int conta_mapeado(int fd, off_t inicio, off_t tamanho, contagem *c) {
+    long pagina = sysconf(_SC_PAGESIZE);
+    int em_palavra = 0;
+    off_t pos = inicio;
+
+    while (pos < tamanho) {
+        off_t base = pos - pos % pagina;
+        size_t comprimento = tamanho - base < (off_t)JANELA_MMAP ? (size_t)(tamanho - base) : JANELA_MMAP;
+        unsigned char *mapa = mmap(NULL, comprimento, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, base);
+
+        if (mapa == MAP_FAILED) {
+            return pos == inicio ? -1 : -2;
+        }
+        madvise(mapa, comprimento, MADV_SEQUENTIAL);
+        contagem_bloco(mapa + (pos - base), comprimento - (pos - base), c, &em_palavra);
+        munmap(mapa, comprimento);
+        pos = base + comprimento;
+    }
+    lseek(fd, tamanho, SEEK_SET);
+    return 0;
+}
+
+/// @brief Conta o conteúdo de um descritor a partir da posição atual.
+/// @param fd Descritor a contar.
+/// @param c Contagem preenchida com o resultado.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+/// @details
+/// Ficheiros regulares são mapeados com mmap; os restantes (pipes, terminais,
+/// ficheiros especiais) são lidos para um buffer alinhado de 1 MiB.
+/// Variáveis:
+/// - st: informação do descritor, para decidir entre mmap e leitura
+/// - buffer: buffer alinhado para leitura
+/// - em_palavra: estado de palavra entre blocos
+int contagem_descritor(int fd, contagem *c) {
+    struct stat st;
+    unsigned char *buffer;
+    int em_palavra = 0;
+    ssize_t n;
+
+    c->linhas = c->palavras = c->bytes = 0;
+
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        off_t inicio = lseek(fd, 0, SEEK_CUR);
+        if (inicio >= 0) {
+            int r = conta_mapeado(fd, inicio, st.st_size, c);
+            if (r == 0) {
+                return 0;
+            }
+            if (r == -2) {
+                return -1;
+            }
+        }
+    }
+
+    if (posix_memalign((void **)&buffer, 4096, BUFFER_LEITURA) != 0) {
+        return -1;
+    }
+    while ((n = read(fd, buffer, BUFFER_LEITURA)) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            free(buffer);
+            return -1;
+        }
+        contagem_bloco(buffer, n, c, &em_palavra);
+    }
+    free(buffer);
+    return 0;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file contagem.h
+ * @brief Contagem de linhas, palavras e bytes (como o wc) com kernels SIMD.
+ *
+ * O kernel (AVX-512, AVX2, SSE2 ou escalar) é escolhido em tempo de execução
+ * consoante o processador. Os ficheiros regulares são lidos com mmap; pipes e
+ * outros descritores são lidos para um buffer grande e alinhado.
+ *
+ * @date 2025
+ */
+
+#ifndef CONTAGEM_H
+#define CONTAGEM_H
+
+#include <stddef.h>
+
+/**
+ * @brief Totais de uma contagem, com contadores de 64 bits.
+ */
+typedef struct {
+    unsigned long long linhas;
+    unsigned long long palavras;
+    unsigned long long bytes;
+} contagem;
+
+/**
+ * @brief Acrescenta a c a contagem de um bloco de memória.
+ *
+ * As palavras são sequências de caracteres que não são espaço em branco
+ * (espaço, \\t, \\n, \\v, \\f, \\r). Como uma palavra pode atravessar blocos,
+ * em_palavra guarda se o último byte do bloco anterior pertencia a uma palavra.
+ * @param dados Início do bloco.
+ * @param n Tamanho do bloco em bytes.
+ * @param c Contagem a atualizar.
+ * @param em_palavra Estado entre blocos (iniciar a 0).
+ */
+void contagem_bloco(const unsigned char *dados, size_t n, contagem *c, int *em_palavra);
+
+/**
+ * @brief Contagem parcial de um pedaço de ficheiro, para contagens em paralelo.
+ *
+ * Guarda também se o pedaço começa e termina dentro de uma palavra, para que
+ * a junção não conte duas vezes uma palavra cortada na fronteira.
+ */
+typedef struct {
+    contagem c;
+    int comeca_em_palavra;
+    int termina_em_palavra;
+} contagem_parcial;
+
+/**
+ * @brief Conta um pedaço independente de um ficheiro.
+ * @param dados Início do pedaço.
+ * @param n Tamanho do pedaço (maior que 0).
+ * @param p Contagem parcial preenchida.
+ */
+void contagem_pedaco(const unsigned char *dados, size_t n, contagem_parcial *p);
+
+/**
+ * @brief Junta pedaços consecutivos de um ficheiro num total.
+ * @param pedacos Pedaços pela ordem em que aparecem no ficheiro.
+ * @param n Número de pedaços.
+ * @param total Contagem resultante.
+ */
+void contagem_junta(const contagem_parcial *pedacos, int n, contagem *total);
+
+/**
+ * @brief Conta todo o conteúdo de um descritor a partir da posição atual.
+ * @param fd Descritor a contar (ficheiro regular, pipe, etc.).
+ * @param c Contagem preenchida com o resultado.
+ * @return 0 em caso de sucesso, -1 em caso de erro de leitura.
+ */
+int contagem_descritor(int fd, contagem *c);
+
+/**
+ * @brief Devolve o nome do kernel escolhido para este processador.
+ * @return "avx512", "avx2", "sse2" ou "escalar".
+ */
+const char *contagem_kernel(void);
+
+#endif // CONTAGEM_H
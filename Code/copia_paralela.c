@@ -0,0 +1,428 @@
+/**
+ * @file copia_paralela.c
+ * @brief Implementação da cópia em pedaços paralelos.
+ *
+ * A thread que chama a função não copia: submete os pedaços ao pool e fica
+ * a mostrar o progresso e a gravar o ponto de controlo até todos terminarem.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "copia_paralela.h"
+#include "pool_threads.h"
+#include "durabilidade.h"
+#include "saida.h"
+
+/// Intervalo entre atualizações do progresso (ms).
+#define INTERVALO_PROGRESSO_MS 250
+
+/// Atualizações do progresso entre duas gravações do ponto de controlo.
+#define ATUALIZACOES_POR_PONTO 4
+
+/// Tamanho do buffer do pread/pwrite.
+#define BUFFER_PEDACO (1 << 20)
+
+/// Identificação do formato do ponto de controlo.
+static const char MAGIA_PONTO[8] = { 'C', 'O', 'P', 'I', 'A', 'P', 'C', '2' };
+
+/// @brief Cabeçalho do ponto de controlo, seguido de um bit por pedaço.
+/// @details A origem é identificada pelo i-node, tamanho e data de
+/// modificação: se mudar, a cópia recomeça do início. O destino (o ficheiro
+/// parcial) é identificado pelo dispositivo e i-node: se for outro ficheiro,
+/// os pedaços marcados não estão nele e a cópia também recomeça.
+typedef struct {
+    char magia[8];
+    uint64_t dispositivo;
+    uint64_t inode;
+    uint64_t destino_dispositivo;
+    uint64_t destino_inode;
+    uint64_t tamanho;
+    int64_t modificacao_seg;
+    int64_t modificacao_nseg;
+    uint64_t pedaco;
+    uint64_t num_pedacos;
+} cabecalho_ponto;
+
+/// @brief Estado partilhado da cópia.
+typedef struct {
+    int fd_src, fd_dest;
+    uint64_t tamanho, num_pedacos;
+    unsigned char *feitos;          ///< um bit por pedaço concluído
+    uint64_t pedacos_feitos;        ///< atómico
+    uint64_t bytes_feitos;          ///< atómico: bytes de dados copiados nesta execução
+    int erro;                       ///< atómico: primeiro errno, ou 0
+    int cancelada;                  ///< atómico: Ctrl-C ou erro noutro pedaço
+    int usa_buffer;                 ///< atómico: copy_file_range não suportado
+    pthread_mutex_t trinco;
+    pthread_cond_t terminou;        ///< sinalizada quando o último pedaço termina
+} copia_em_pedacos;
+
+/// @brief Pedaço a copiar por uma tarefa do pool.
+typedef struct {
+    copia_em_pedacos *c;
+    uint64_t indice;
+} tarefa_pedaco;
+
+/// @brief Copia uma zona com dados com copy_file_range ou, se não for
+/// suportado, com pread/pwrite.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+static int copia_zona(copia_em_pedacos *c, off_t inicio, off_t n, char **buffer) {
+    while (n > 0 && !__atomic_load_n(&c->usa_buffer, __ATOMIC_RELAXED)) {
+        loff_t in = inicio, out = inicio;
+        ssize_t r = copy_file_range(c->fd_src, &in, c->fd_dest, &out, n, 0);
+
+        if (r > 0) {
+            inicio += r;
+            n -= r;
+            __atomic_fetch_add(&c->bytes_feitos, r, __ATOMIC_RELAXED);
+            continue;
+        }
+        if (r == 0) {
+            return 0;   // a origem encolheu
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EXDEV && errno != EINVAL && errno != ENOSYS && errno != EOPNOTSUPP) {
+            return -1;
+        }
+        __atomic_store_n(&c->usa_buffer, 1, __ATOMIC_RELAXED);
+    }
+
+    if (n > 0 && *buffer == NULL && (*buffer = malloc(BUFFER_PEDACO)) == NULL) {
+        return -1;
+    }
+    while (n > 0) {
+        ssize_t lidos = pread(c->fd_src, *buffer, n < BUFFER_PEDACO ? n : BUFFER_PEDACO, inicio);
+
+        if (lidos <= 0) {
+            if (lidos < 0 && errno == EINTR) {
+                continue;
+            }
+            return lidos == 0 ? 0 : -1;
+        }
+        for (ssize_t escritos = 0; escritos < lidos; ) {
+            ssize_t w = pwrite(c->fd_dest, *buffer + escritos, lidos - escritos, inicio + escritos);
+            if (w < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return -1;
+            }
+            escritos += w;
+        }
+        inicio += lidos;
+        n -= lidos;
+        __atomic_fetch_add(&c->bytes_feitos, lidos, __ATOMIC_RELAXED);
+    }
+    return 0;
+}
+
+/// @brief Copia um pedaço, saltando os buracos da origem (tarefa do pool).
+static void copia_pedaco(void *arg) {
+    tarefa_pedaco *t = arg;
+    copia_em_pedacos *c = t->c;
+    off_t pos = t->indice * COPIA_PEDACO;
+    off_t fim = pos + (off_t)COPIA_PEDACO;
+    char *buffer = NULL;
+    int r = 0;
+
+    if (fim > (off_t)c->tamanho) {
+        fim = c->tamanho;
+    }
+
+    while (pos < fim && !__atomic_load_n(&c->cancelada, __ATOMIC_RELAXED)) {
+        // O lseek com SEEK_DATA/SEEK_HOLE muda a posição partilhada do
+        // descritor, mas as cópias usam sempre posições explícitas
+        off_t dados = lseek(c->fd_src, pos, SEEK_DATA);
+        off_t buraco;
+
+        if (dados == -1) {
+            if (errno == ENXIO) {
+                break;          // só buracos até ao fim do ficheiro
+            }
+            dados = pos;        // sem suporte: tratar tudo como dados
+            buraco = fim;
+        } else {
+            buraco = lseek(c->fd_src, dados, SEEK_HOLE);
+            if (buraco == -1) {
+                buraco = fim;
+            }
+        }
+        if (dados >= fim) {
+            break;
+        }
+        if (buraco > fim) {
+            buraco = fim;
+        }
+        r = copia_zona(c, dados, buraco - dados, &buffer);
+        if (r == -1) {
+            break;
+        }
+        pos = buraco;
+    }
+    free(buffer);
+
+    if (r == -1) {
+        int zero = 0;
+        __atomic_compare_exchange_n(&c->erro, &zero, errno, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        __atomic_store_n(&c->cancelada, 1, __ATOMIC_RELAXED);
+    } else if (pos >= fim || !__atomic_load_n(&c->cancelada, __ATOMIC_RELAXED)) {
+        __atomic_fetch_or(&c->feitos[t->indice / 8], (unsigned char)(1u << (t->indice % 8)), __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_lock(&c->trinco);
+    if (++c->pedacos_feitos == c->num_pedacos) {
+        pthread_cond_signal(&c->terminou);
+    }
+    pthread_mutex_unlock(&c->trinco);
+}
+
+/// @brief Preenche o cabeçalho do ponto de controlo para a origem e o destino.
+static void preenche_cabecalho(cabecalho_ponto *h, const struct stat *st, const struct stat *st_dest,
+                               uint64_t num_pedacos) {
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magia, MAGIA_PONTO, sizeof(MAGIA_PONTO));
+    h->dispositivo = st->st_dev;
+    h->inode = st->st_ino;
+    h->destino_dispositivo = st_dest->st_dev;
+    h->destino_inode = st_dest->st_ino;
+    h->tamanho = st->st_size;
+    h->modificacao_seg = st->st_mtim.tv_sec;
+    h->modificacao_nseg = st->st_mtim.tv_nsec;
+    h->pedaco = COPIA_PEDACO;
+    h->num_pedacos = num_pedacos;
+}
+
+/// @brief Lê o ponto de controlo, se corresponder à mesma origem e ao mesmo destino.
+/// @return 1 se os pedaços feitos foram carregados, 0 se a cópia começa do início.
+static int le_ponto(int fd_ponto, const cabecalho_ponto *esperado, unsigned char *feitos, size_t bytes_mapa) {
+    cabecalho_ponto h;
+
+    if (pread(fd_ponto, &h, sizeof(h), 0) != sizeof(h) || memcmp(&h, esperado, sizeof(h)) != 0) {
+        return 0;
+    }
+    if (pread(fd_ponto, feitos, bytes_mapa, sizeof(h)) != (ssize_t)bytes_mapa) {
+        memset(feitos, 0, bytes_mapa);
+        return 0;
+    }
+    return 1;
+}
+
+/// @brief Grava o ponto de controlo.
+/// @details Os dados do destino são sincronizados antes (exceto com
+/// durabilidade "nenhuma"): um pedaço só fica marcado como feito quando os
+/// seus dados já estão no disco. Como os bits só passam de 0 para 1, uma
+/// gravação interrompida a meio nunca marca um pedaço por copiar.
+static void grava_ponto(int fd_ponto, int fd_dest, const cabecalho_ponto *h,
+                        const unsigned char *feitos, size_t bytes_mapa) {
+    unsigned char *copia_mapa = malloc(bytes_mapa);
+
+    if (copia_mapa == NULL) {
+        return;
+    }
+    // Fotografia dos bits antes do fdatasync: só esses ficam garantidos
+    for (size_t i = 0; i < bytes_mapa; i++) {
+        copia_mapa[i] = __atomic_load_n(&feitos[i], __ATOMIC_RELAXED);
+    }
+    // Se a gravação falhar, a retoma apenas repete mais pedaços
+    if ((durabilidade_atual() == DURABILIDADE_NENHUMA || fdatasync(fd_dest) == 0) &&
+        pwrite(fd_ponto, h, sizeof(*h), 0) == sizeof(*h)) {
+        pwrite(fd_ponto, copia_mapa, bytes_mapa, sizeof(*h));
+    }
+    free(copia_mapa);
+}
+
+/// @brief Verifica (sem esperar) se há um Ctrl-C pendente e consome-o.
+static int interrompida(void) {
+    sigset_t pendentes, interrupcao;
+
+    if (sigpending(&pendentes) == -1 || !sigismember(&pendentes, SIGINT)) {
+        return 0;
+    }
+    sigemptyset(&interrupcao);
+    sigaddset(&interrupcao, SIGINT);
+    sigtimedwait(&interrupcao, NULL, &(struct timespec){ 0, 0 });
+    return 1;
+}
+
+/// @brief Mostra a linha de progresso no STDERR.
+static void mostra_progresso(uint64_t feitos, uint64_t total, uint64_t copiados, double segundos) {
+    double debito = segundos > 0 ? copiados / segundos : 0;
+    double restante = debito > 0 ? (total - feitos) / debito : 0;
+    int eta = (int)restante;
+
+    saida_erro("\r%5.1f%%  %llu/%llu MiB  %.1f MiB/s  ETA %d:%02d   ",
+               total > 0 ? 100.0 * feitos / total : 100.0,
+               (unsigned long long)(feitos >> 20), (unsigned long long)(total >> 20),
+               debito / (1024 * 1024), eta / 60, eta % 60);
+}
+
+/// @brief Soma o tamanho dos pedaços marcados como feitos.
+static uint64_t bytes_marcados(const copia_em_pedacos *c) {
+    uint64_t bytes = 0;
+
+    for (uint64_t i = 0; i < c->num_pedacos; i++) {
+        if (__atomic_load_n(&c->feitos[i / 8], __ATOMIC_RELAXED) & (1u << (i % 8))) {
+            uint64_t inicio = i * COPIA_PEDACO;
+            bytes += c->tamanho - inicio < COPIA_PEDACO ? c->tamanho - inicio : COPIA_PEDACO;
+        }
+    }
+    return bytes;
+}
+
+/// @brief Copia um ficheiro regular em pedaços paralelos.
+/// @param fd_src Origem.
+/// @param fd_dest Destino.
+/// @param fd_ponto Ponto de controlo, ou -1.
+/// @param num_threads Número de threads (0 usa o número de CPUs).
+/// @param mostra Se diferente de 0, escreve o progresso e a retoma.
+/// @param res Resultado.
+/// @return 0 em caso de sucesso, -1 em caso de erro ou interrupção.
+/// @details
+/// Variáveis:
+/// - c: estado partilhado pelos pedaços
+/// - h: cabeçalho do ponto de controlo
+/// - anteriores: bytes dos pedaços já copiados numa execução anterior
+int copia_paralela(int fd_src, int fd_dest, int fd_ponto, int num_threads, int mostra, resultado_copia *res) {
+    copia_em_pedacos c;
+    cabecalho_ponto h;
+    struct stat st, st_dest;
+    struct timespec inicio, agora;
+    tarefa_pedaco *tarefas;
+    pool_threads *pool;
+    size_t bytes_mapa;
+    uint64_t anteriores, pendentes = 0;
+    int progresso = mostra && isatty(saida_erro_fd()), atualizacoes = 0, resultado = 0;
+
+    if (fstat(fd_src, &st) == -1 || fstat(fd_dest, &st_dest) == -1) {
+        return -1;
+    }
+    memset(&c, 0, sizeof(c));
+    c.fd_src = fd_src;
+    c.fd_dest = fd_dest;
+    c.tamanho = st.st_size;
+    c.num_pedacos = (c.tamanho + COPIA_PEDACO - 1) / COPIA_PEDACO;
+    bytes_mapa = (c.num_pedacos + 7) / 8;
+    c.feitos = calloc(bytes_mapa ? bytes_mapa : 1, 1);
+    tarefas = malloc((c.num_pedacos ? c.num_pedacos : 1) * sizeof(tarefa_pedaco));
+    if (c.feitos == NULL || tarefas == NULL) {
+        free(c.feitos);
+        free(tarefas);
+        errno = ENOMEM;
+        return -1;
+    }
+    pthread_mutex_init(&c.trinco, NULL);
+    pthread_cond_init(&c.terminou, NULL);
+
+    // Retomar a partir do ponto de controlo ou começar do início
+    preenche_cabecalho(&h, &st, &st_dest, c.num_pedacos);
+    if (fd_ponto != -1 && le_ponto(fd_ponto, &h, c.feitos, bytes_mapa)) {
+        anteriores = bytes_marcados(&c);
+        if (mostra) {
+            saida_info("A retomar a cópia: %.1f%% já estava copiado.\n",
+                       c.tamanho > 0 ? 100.0 * anteriores / c.tamanho : 100.0);
+        }
+    } else {
+        anteriores = 0;
+        if (ftruncate(fd_dest, 0) == -1) {
+            resultado = -1;
+        }
+        if (fd_ponto != -1) {
+            grava_ponto(fd_ponto, fd_dest, &h, c.feitos, bytes_mapa);
+        }
+    }
+    // O tamanho final de uma vez: as zonas não escritas ficam buracos
+    if (resultado == -1 || ftruncate(fd_dest, c.tamanho) == -1) {
+        resultado = -1;
+        c.num_pedacos = 0;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    pool = c.num_pedacos > 0 ? pool_cria(num_threads) : NULL;
+    for (uint64_t i = 0; pool != NULL && i < c.num_pedacos; i++) {
+        if (c.feitos[i / 8] & (1u << (i % 8))) {
+            c.pedacos_feitos++;
+            continue;
+        }
+        tarefas[pendentes].c = &c;
+        tarefas[pendentes].indice = i;
+        pendentes++;
+    }
+    for (uint64_t i = 0; i < pendentes; i++) {
+        pool_submete(pool, copia_pedaco, &tarefas[i]);
+    }
+    if (c.num_pedacos > 0 && pool == NULL) {
+        resultado = -1;
+        c.erro = ENOMEM;
+    }
+
+    // Esperar pelos pedaços, mostrando o progresso e gravando o ponto de controlo
+    pthread_mutex_lock(&c.trinco);
+    while (pool != NULL && c.pedacos_feitos < c.num_pedacos) {
+        struct timespec limite;
+
+        clock_gettime(CLOCK_REALTIME, &limite);
+        limite.tv_nsec += INTERVALO_PROGRESSO_MS * 1000000L;
+        if (limite.tv_nsec >= 1000000000L) {
+            limite.tv_sec++;
+            limite.tv_nsec -= 1000000000L;
+        }
+        if (pthread_cond_timedwait(&c.terminou, &c.trinco, &limite) != ETIMEDOUT) {
+            continue;
+        }
+        pthread_mutex_unlock(&c.trinco);
+
+        if (interrompida()) {
+            __atomic_store_n(&c.cancelada, 1, __ATOMIC_RELAXED);
+            __atomic_store_n(&c.erro, EINTR, __ATOMIC_RELAXED);
+        }
+        if (progresso) {
+            clock_gettime(CLOCK_MONOTONIC, &agora);
+            mostra_progresso(bytes_marcados(&c), c.tamanho, __atomic_load_n(&c.bytes_feitos, __ATOMIC_RELAXED),
+                             (agora.tv_sec - inicio.tv_sec) + (agora.tv_nsec - inicio.tv_nsec) / 1e9);
+        }
+        if (fd_ponto != -1 && ++atualizacoes % ATUALIZACOES_POR_PONTO == 0) {
+            grava_ponto(fd_ponto, fd_dest, &h, c.feitos, bytes_mapa);
+        }
+        pthread_mutex_lock(&c.trinco);
+    }
+    pthread_mutex_unlock(&c.trinco);
+    if (pool != NULL) {
+        pool_destroi(pool);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    if (progresso && atualizacoes > 0) {
+        saida_erro("\r%60s\r", "");
+    }
+
+    if (c.erro != 0) {
+        // Guardar o que já foi feito para a próxima tentativa
+        if (fd_ponto != -1) {
+            grava_ponto(fd_ponto, fd_dest, &h, c.feitos, bytes_mapa);
+        }
+        errno = c.erro;
+        resultado = -1;
+    }
+    if (res != NULL) {
+        res->metodo = COPIA_PARALELA;
+        res->bytes = c.bytes_feitos;
+        res->segundos = (agora.tv_sec - inicio.tv_sec) + (agora.tv_nsec - inicio.tv_nsec) / 1e9;
+    }
+    pthread_cond_destroy(&c.terminou);
+    pthread_mutex_destroy(&c.trinco);
+    free(c.feitos);
+    free(tarefas);
+    return resultado;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file copia_paralela.h
+ * @brief Cópia de ficheiros grandes em pedaços paralelos, com progresso e retoma.
+ *
+ * O ficheiro de origem é dividido em pedaços de tamanho fixo, copiados em
+ * simultâneo pelo pool de threads com copy_file_range (ou pread/pwrite)
+ * com posições explícitas. Dentro de cada pedaço só as zonas com dados
+ * (SEEK_DATA/SEEK_HOLE) são copiadas, por isso os buracos de um ficheiro
+ * esparso continuam buracos no destino. Os pedaços concluídos são marcados
+ * num ficheiro de ponto de controlo: uma cópia interrompida continua a
+ * partir daí em vez de recomeçar.
+ *
+ * @date 2025
+ */
+
+#ifndef COPIA_PARALELA_H
+#define COPIA_PARALELA_H
+
+#include "motor_copia.h"
+
+/// Ficheiros a partir deste tamanho são copiados em pedaços paralelos.
+#define COPIA_PARALELA_MINIMO (64ULL << 20)
+
+/// Tamanho de cada pedaço.
+#define COPIA_PEDACO (8ULL << 20)
+
+/**
+ * @brief Copia um ficheiro regular em pedaços paralelos.
+ *
+ * Com mostra, enquanto copia, mostra o progresso (percentagem, MiB/s e tempo
+ * restante) no STDERR, se for um terminal, e avisa quando retoma. Um Ctrl-C (SIGINT bloqueado e pendente)
+ * interrompe a cópia, deixando o ponto de controlo atualizado.
+ * @param fd_src Ficheiro de origem.
+ * @param fd_dest Ficheiro de destino (o tamanho é ajustado ao da origem).
+ * @param fd_ponto Ficheiro do ponto de controlo, ou -1 para não usar. Só é
+ * usado para retomar se corresponder à mesma origem e ao mesmo fd_dest (o
+ * chamador deve esvaziá-lo se o destino acabou de ser criado).
+ * @param num_threads Número de threads (0 usa o número de CPUs).
+ * @param mostra Se diferente de 0, escreve o progresso e a retoma; senão não escreve nada.
+ * @param res Resultado (bytes copiados nesta execução e tempo).
+ * @return 0 em caso de sucesso, -1 em caso de erro ou interrupção (errno EINTR).
+ */
+int copia_paralela(int fd_src, int fd_dest, int fd_ponto, int num_threads, int mostra, resultado_copia *res);
+
+#endif // COPIA_PARALELA_H
@@ -0,0 +1,334 @@
+/**
+ * @file durabilidade.c
+ * @brief Implementação da escrita atómica com O_TMPFILE e da sincronização em lote.
+ *
+ * Um ficheiro O_TMPFILE não tem nome até ser ligado com linkat. Como o
+ * linkat não substitui um nome existente, o ficheiro é ligado a um nome
+ * temporário único e depois renomeado para o destino (o renameat substitui
+ * de forma atómica). Nos sistemas de ficheiros sem O_TMPFILE é criado logo
+ * um ficheiro com um nome temporário na mesma diretoria.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "durabilidade.h"
+
+/// Máximo de escritas pendentes num lote (cada uma mantém dois descritores abertos).
+#define LOTE_MAX 128
+
+static modo_durabilidade modo_atual = DURABILIDADE_LOTE;
+
+/// Contador para gerar nomes temporários únicos.
+static unsigned long contador_temporarios = 0;
+
+/// @brief Gera um nome temporário escondido na mesma diretoria do destino.
+static void nome_temporario(char *texto, size_t tamanho, const char *nome) {
+    unsigned long n = __atomic_fetch_add(&contador_temporarios, 1, __ATOMIC_RELAXED);
+
+    snprintf(texto, tamanho, ".%s.%d.%lu.tmp", nome, (int)getpid(), n);
+}
+
+/// @brief Fecha os descritores e liberta os nomes de uma escrita.
+static void liberta_escrita(escrita_atomica *e) {
+    if (e->fd != -1) {
+        close(e->fd);
+    }
+    if (e->dirfd != -1) {
+        close(e->dirfd);
+    }
+    free(e->nome);
+    free(e->temporario);
+    e->fd = e->dirfd = -1;
+    e->nome = e->temporario = NULL;
+}
+
+/// @brief Abre a diretoria do destino e separa o nome do ficheiro.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+static int abre_diretoria(escrita_atomica *e, const char *destino) {
+    const char *barra = strrchr(destino, '/');
+    char *diretoria;
+
+    if (barra == NULL) {
+        diretoria = strdup(".");
+        e->nome = strdup(destino);
+    } else {
+        diretoria = strndup(destino, barra == destino ? 1 : (size_t)(barra - destino));
+        e->nome = strdup(barra + 1);
+    }
+    e->temporario = NULL;
+    e->fd = -1;
+    e->criado = 1;
+    e->dirfd = diretoria != NULL ? open(diretoria, O_RDONLY | O_DIRECTORY | O_CLOEXEC) : -1;
+    free(diretoria);
+    if (e->dirfd == -1 || e->nome == NULL) {
+        escrita_cancela(e);
+        return -1;
+    }
+    return 0;
+}
+
+/// @brief Começa a escrita de um ficheiro num temporário da diretoria do destino.
+/// @param e Escrita a preencher.
+/// @param destino Caminho final.
+/// @param tamanho Tamanho previsto (reservado sem alterar o tamanho do ficheiro).
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+int escrita_inicia(escrita_atomica *e, const char *destino, off_t tamanho) {
+    if (abre_diretoria(e, destino) == -1) {
+        return -1;
+    }
+
+    e->fd = openat(e->dirfd, ".", O_TMPFILE | O_WRONLY | O_CLOEXEC, 0644);
+    if (e->fd == -1) {
+        // Sem O_TMPFILE: um ficheiro normal com um nome temporário
+        char temporario[512];
+
+        do {
+            nome_temporario(temporario, sizeof(temporario), e->nome);
+            e->fd = openat(e->dirfd, temporario, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        } while (e->fd == -1 && errno == EEXIST);
+        if (e->fd == -1) {
+            escrita_cancela(e);
+            return -1;
+        }
+        e->temporario = strdup(temporario);
+    }
+
+    // Reservar o espaço de uma vez evita a fragmentação e falha cedo se o
+    // disco estiver cheio (o tamanho do ficheiro não é alterado)
+    if (tamanho > 0) {
+        fallocate(e->fd, FALLOC_FL_KEEP_SIZE, 0, tamanho);
+    }
+    return 0;
+}
+
+/// @brief Começa ou continua uma escrita num temporário com nome fixo.
+/// @param e Escrita a preencher.
+/// @param destino Caminho final.
+/// @param sufixo Sufixo do nome temporário.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+int escrita_inicia_nomeada(escrita_atomica *e, const char *destino, const char *sufixo) {
+    if (abre_diretoria(e, destino) == -1) {
+        return -1;
+    }
+    if (asprintf(&e->temporario, ".%s%s", e->nome, sufixo) == -1) {
+        e->temporario = NULL;
+        escrita_cancela(e);
+        return -1;
+    }
+    // Criar só se não existir, para saber se há uma escrita para retomar
+    do {
+        e->fd = openat(e->dirfd, e->temporario, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        e->criado = e->fd != -1;
+        if (e->fd == -1 && errno == EEXIST) {
+            e->fd = openat(e->dirfd, e->temporario, O_RDWR | O_CLOEXEC);
+        }
+    } while (e->fd == -1 && errno == ENOENT);
+    if (e->fd == -1) {
+        liberta_escrita(e);
+        return -1;
+    }
+    return 0;
+}
+
+/// @brief Fecha uma escrita, mantendo o temporário para uma retoma.
+void escrita_suspende(escrita_atomica *e) {
+    liberta_escrita(e);
+}
+
+/// @brief Abandona uma escrita, apagando o temporário se tiver nome.
+void escrita_cancela(escrita_atomica *e) {
+    if (e->temporario != NULL && e->dirfd != -1) {
+        unlinkat(e->dirfd, e->temporario, 0);
+    }
+    liberta_escrita(e);
+}
+
+/// @brief Dá o nome final ao ficheiro escrito, substituindo o destino.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+static int da_nome(escrita_atomica *e) {
+    char temporario[512];
+
+    if (e->temporario == NULL) {
+        char proc[64];
+        int r;
+
+        // Ligar o O_TMPFILE a um nome temporário (sem privilégios, através do /proc)
+        snprintf(proc, sizeof(proc), "/proc/self/fd/%d", e->fd);
+        do {
+            nome_temporario(temporario, sizeof(temporario), e->nome);
+            r = linkat(AT_FDCWD, proc, e->dirfd, temporario, AT_SYMLINK_FOLLOW);
+            if (r == -1 && errno == ENOENT) {
+                r = linkat(e->fd, "", e->dirfd, temporario, AT_EMPTY_PATH);
+            }
+        } while (r == -1 && errno == EEXIST);
+        if (r == -1) {
+            return -1;
+        }
+        e->temporario = strdup(temporario);
+        if (e->temporario == NULL) {
+            unlinkat(e->dirfd, temporario, 0);
+            return -1;
+        }
+    }
+
+    if (renameat(e->dirfd, e->temporario, e->dirfd, e->nome) == -1) {
+        unlinkat(e->dirfd, e->temporario, 0);
+        return -1;
+    }
+    free(e->temporario);
+    e->temporario = NULL;
+    return 0;
+}
+
+/// @brief Conclui uma escrita de acordo com o modo de durabilidade.
+/// @param l Lote do comando.
+/// @param e Escrita completa.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+int lote_conclui(lote_escritas *l, escrita_atomica *e) {
+    int r = 0;
+
+    switch (modo_atual) {
+    case DURABILIDADE_LOTE:
+        if (l->num == l->capacidade) {
+            int capacidade = l->capacidade ? l->capacidade * 2 : 16;
+            escrita_atomica *novas = realloc(l->pendentes, capacidade * sizeof(escrita_atomica));
+            if (novas == NULL) {
+                escrita_cancela(e);
+                return -1;
+            }
+            l->pendentes = novas;
+            l->capacidade = capacidade;
+        }
+        l->pendentes[l->num++] = *e;
+        return l->num >= LOTE_MAX ? lote_sincroniza(l) : 0;
+
+    case DURABILIDADE_TOTAL:
+        // Os dados antes do nome, e o nome (a diretoria) depois
+        if (fdatasync(e->fd) == -1 || da_nome(e) == -1 || fsync(e->dirfd) == -1) {
+            r = -1;
+        }
+        break;
+
+    default:
+        r = da_nome(e);
+        break;
+    }
+    if (r == -1) {
+        escrita_cancela(e);
+    } else {
+        liberta_escrita(e);
+    }
+    return r;
+}
+
+/// @brief Sincroniza o lote: os dados, depois os nomes, depois as diretorias.
+/// @param l Lote.
+/// @return 0 em caso de sucesso, -1 se alguma escrita falhar.
+/// @details A escrita para o disco de todos os ficheiros do lote é iniciada
+/// de uma só vez (sync_file_range), antes do primeiro fdatasync: os
+/// fdatasync seguintes só esperam por dados que já estão a caminho do
+/// disco. Só os ficheiros do lote são sincronizados (um syncfs esperaria
+/// também pelos dados de outros processos no mesmo sistema de ficheiros).
+/// No fim é feito um fsync por diretoria de destino.
+int lote_sincroniza(lote_escritas *l) {
+    struct stat st, *vistos;
+    int num_vistos = 0, r = 0;
+
+    if (l->num == 0) {
+        return 0;
+    }
+    vistos = malloc(l->num * sizeof(struct stat));
+    if (vistos == NULL) {
+        r = -1;
+    }
+
+    // 1. Dados de todos os ficheiros: iniciar a escrita de todos e depois
+    // esperar por cada um (uma falha do sync_file_range fica para o fdatasync)
+    for (int i = 0; i < l->num && r == 0; i++) {
+        sync_file_range(l->pendentes[i].fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+    }
+    for (int i = 0; i < l->num && r == 0; i++) {
+        if (fdatasync(l->pendentes[i].fd) == -1) {
+            r = -1;
+        }
+    }
+
+    // 2. Nomes finais (só depois de os dados estarem no disco)
+    for (int i = 0; i < l->num; i++) {
+        if (r == -1 || da_nome(&l->pendentes[i]) == -1) {
+            r = -1;
+            escrita_cancela(&l->pendentes[i]);
+        }
+    }
+
+    // 3. Entradas das diretorias: um fsync por diretoria
+    num_vistos = 0;
+    for (int i = 0; i < l->num && vistos != NULL; i++) {
+        int nova;
+
+        if (l->pendentes[i].dirfd == -1 || fstat(l->pendentes[i].dirfd, &st) == -1) {
+            continue;
+        }
+        nova = 1;
+        for (int j = 0; nova && j < num_vistos; j++) {
+            nova = vistos[j].st_dev != st.st_dev || vistos[j].st_ino != st.st_ino;
+        }
+        if (nova) {
+            vistos[num_vistos++] = st;
+            if (fsync(l->pendentes[i].dirfd) == -1) {
+                r = -1;
+            }
+        }
+    }
+
+    for (int i = 0; i < l->num; i++) {
+        liberta_escrita(&l->pendentes[i]);
+    }
+    free(vistos);
+    free(l->pendentes);
+    l->pendentes = NULL;
+    l->num = l->capacidade = 0;
+    return r;
+}
+
+/// @brief Garante a durabilidade de dados acrescentados a um ficheiro.
+/// @param fd Ficheiro alterado.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+int durabilidade_acrescento(int fd) {
+    return modo_atual == DURABILIDADE_NENHUMA ? 0 : fdatasync(fd);
+}
+
+/// @brief Modo de durabilidade atual.
+modo_durabilidade durabilidade_atual(void) {
+    return modo_atual;
+}
+
+/// @brief Muda o modo de durabilidade.
+/// @param nome Nome do modo.
+/// @return 0 em caso de sucesso, -1 se o nome não for conhecido.
+int durabilidade_define(const char *nome) {
+    for (int m = DURABILIDADE_NENHUMA; m <= DURABILIDADE_TOTAL; m++) {
+        if (strcmp(nome, nome_durabilidade((modo_durabilidade)m)) == 0) {
+            modo_atual = (modo_durabilidade)m;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/// @brief Nome de um modo de durabilidade.
+const char *nome_durabilidade(modo_durabilidade modo) {
+    switch (modo) {
+        case DURABILIDADE_NENHUMA: return "nenhuma";
+        case DURABILIDADE_TOTAL:   return "total";
+        default:                   return "lote";
+    }
+}
@@ -0,0 +1,139 @@
+/**
+ * @file durabilidade.h
+ * @brief Escrita atómica e durável de ficheiros, com sincronização em lote.
+ *
+ * Os dados são escritos num ficheiro temporário (O_TMPFILE, sem nome) na
+ * diretoria do destino, que só passa a ter o nome final (linkat + renameat)
+ * depois de completo: uma falha a meio nunca deixa um destino escrito em
+ * parte. A sincronização com o disco depende do modo escolhido com
+ * `set durabilidade`:
+ * - nenhuma: sem fsync (a substituição continua atómica);
+ * - lote: as escritas de um mesmo comando são guardadas e sincronizadas de
+ *   uma só vez (a escrita de todas é iniciada com sync_file_range antes do
+ *   fdatasync de cada uma, e há um fsync por diretoria);
+ * - total: fdatasync do ficheiro e fsync da diretoria em cada escrita.
+ *
+ * @date 2025
+ */
+
+#ifndef DURABILIDADE_H
+#define DURABILIDADE_H
+
+#include <sys/types.h>
+
+/**
+ * @brief Nível de durabilidade das escritas.
+ */
+typedef enum {
+    DURABILIDADE_NENHUMA,
+    DURABILIDADE_LOTE,
+    DURABILIDADE_TOTAL
+} modo_durabilidade;
+
+/**
+ * @brief Escrita de um ficheiro ainda sem o nome final.
+ */
+typedef struct {
+    int fd;                 ///< ficheiro onde os dados devem ser escritos
+    int dirfd;              ///< diretoria do destino
+    char *nome;             ///< nome do destino dentro da diretoria
+    char *temporario;       ///< nome temporário (só sem suporte para O_TMPFILE)
+    int criado;             ///< 1 se o ficheiro foi criado agora; 0 se é o temporário de uma escrita anterior
+} escrita_atomica;
+
+/**
+ * @brief Escritas concluídas à espera de serem sincronizadas e ganharem o nome final.
+ *
+ * Cada comando usa o seu lote (iniciado com LOTE_ESCRITAS_VAZIO), por isso
+ * comandos em threads diferentes não interferem.
+ */
+typedef struct {
+    escrita_atomica *pendentes;
+    int num, capacidade;
+} lote_escritas;
+
+/// Lote sem escritas.
+#define LOTE_ESCRITAS_VAZIO { NULL, 0, 0 }
+
+/**
+ * @brief Começa a escrita de um ficheiro.
+ * @param e Escrita a preencher.
+ * @param destino Caminho final do ficheiro.
+ * @param tamanho Tamanho previsto, reservado com fallocate (0 não reserva).
+ * @return 0 em caso de sucesso, -1 em caso de erro (errno indica a causa).
+ */
+int escrita_inicia(escrita_atomica *e, const char *destino, off_t tamanho);
+
+/**
+ * @brief Começa (ou continua) a escrita de um ficheiro num temporário com
+ * nome fixo, ".<nome><sufixo>", que sobrevive a uma interrupção.
+ *
+ * Usado pelas cópias que podem ser retomadas: o temporário não é truncado.
+ * Se ainda não existir, é criado e e->criado fica a 1 (não há nada para
+ * retomar).
+ * @param e Escrita a preencher.
+ * @param destino Caminho final do ficheiro.
+ * @param sufixo Sufixo do nome temporário.
+ * @return 0 em caso de sucesso, -1 em caso de erro (errno indica a causa).
+ */
+int escrita_inicia_nomeada(escrita_atomica *e, const char *destino, const char *sufixo);
+
+/**
+ * @brief Fecha uma escrita sem a concluir nem apagar o temporário, para
+ * poder ser retomada mais tarde.
+ * @param e Escrita.
+ */
+void escrita_suspende(escrita_atomica *e);
+
+/**
+ * @brief Abandona uma escrita: o destino não é alterado.
+ * @param e Escrita.
+ */
+void escrita_cancela(escrita_atomica *e);
+
+/**
+ * @brief Conclui uma escrita já completa.
+ *
+ * Nos modos nenhuma e total o destino é substituído de imediato; no modo
+ * lote a escrita fica no lote até lote_sincroniza (ou até o lote encher).
+ * @param l Lote do comando.
+ * @param e Escrita (deixa de poder ser usada).
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int lote_conclui(lote_escritas *l, escrita_atomica *e);
+
+/**
+ * @brief Sincroniza todas as escritas do lote e dá-lhes o nome final.
+ * @param l Lote.
+ * @return 0 em caso de sucesso, -1 se alguma escrita falhar.
+ */
+int lote_sincroniza(lote_escritas *l);
+
+/**
+ * @brief Garante a durabilidade de dados acrescentados a um ficheiro existente.
+ * @param fd Ficheiro alterado.
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int durabilidade_acrescento(int fd);
+
+/**
+ * @brief Devolve o modo de durabilidade atual.
+ * @return Modo atual.
+ */
+modo_durabilidade durabilidade_atual(void);
+
+/**
+ * @brief Muda o modo de durabilidade.
+ * @param nome "nenhuma", "lote" ou "total".
+ * @return 0 em caso de sucesso, -1 se o nome não for conhecido.
+ */
+int durabilidade_define(const char *nome);
+
+/**
+ * @brief Devolve o nome de um modo de durabilidade.
+ * @param modo Modo.
+ * @return String constante com o nome.
+ */
+const char *nome_durabilidade(modo_durabilidade modo);
+
+#endif // DURABILIDADE_H
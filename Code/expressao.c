@@ -0,0 +1,1416 @@
+/**
+ * @file expressao.c
+ * @brief Implementação das expressões regulares.
+ *
+ * A árvore da expressão é construída numa arena e compilada de trás para a
+ * frente: cada nó é compilado já a saber qual é o estado seguinte, por isso
+ * não há listas de saídas por ligar. Os estados do NFA que importam para o
+ * DFA são os que consomem um byte, os de aceitação e as âncoras `$` (que só
+ * se resolvem no fim da linha).
+ *
+ * A procura não é ancorada: em cada passo o fecho do estado inicial é
+ * acrescentado ao conjunto, como se a expressão começasse por `.*`. Um
+ * estado do DFA é "final" se já aceita (a linha corresponde) ou se nunca
+ * poderá aceitar (o resto da linha não precisa de ser lido).
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "expressao.h"
+#include "arena.h"
+
+/// Número máximo de estados do NFA (limita as repetições como `{1000}`).
+#define MAX_ESTADOS_NFA 100000
+
+/// Maior contador aceite em `{m,n}`.
+#define MAX_REPETICOES 1000
+
+/// @brief Conjunto de bytes, um bit por valor.
+typedef struct {
+    uint64_t b[4];
+} conjunto_bytes;
+
+static inline void conjunto_poe(conjunto_bytes *c, unsigned char x) {
+    c->b[x >> 6] |= 1ULL << (x & 63);
+}
+
+static inline int conjunto_tem(const conjunto_bytes *c, unsigned char x) {
+    return (c->b[x >> 6] >> (x & 63)) & 1;
+}
+
+static int conjunto_conta(const conjunto_bytes *c) {
+    return __builtin_popcountll(c->b[0]) + __builtin_popcountll(c->b[1]) +
+           __builtin_popcountll(c->b[2]) + __builtin_popcountll(c->b[3]);
+}
+
+static inline int e_letra(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static inline unsigned char minuscula(unsigned char c) {
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+/// @brief Acrescenta às letras do conjunto a outra caixa.
+static void junta_caixas(conjunto_bytes *c) {
+    for (int x = 'a'; x <= 'z'; x++) {
+        if (conjunto_tem(c, x) || conjunto_tem(c, x - ('a' - 'A'))) {
+            conjunto_poe(c, x);
+            conjunto_poe(c, x - ('a' - 'A'));
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+/* Árvore                                                                  */
+/* ---------------------------------------------------------------------- */
+
+typedef enum {
+    NO_VAZIO,       ///< corresponde ao texto vazio
+    NO_BYTES,       ///< um byte de um conjunto
+    NO_CONCAT,      ///< a seguido de b
+    NO_ALTERNA,     ///< a ou b
+    NO_REPETE,      ///< a entre min e max vezes (max -1: sem limite)
+    NO_INICIO,      ///< ^
+    NO_FIM          ///< $
+} tipo_no;
+
+/// @brief Nó da árvore de uma expressão.
+typedef struct no {
+    tipo_no tipo;
+    conjunto_bytes bytes;
+    struct no *a, *b;
+    int min, max;
+} no;
+
+/// @brief Estado da análise de um padrão.
+typedef struct {
+    const unsigned char *p;
+    int sem_maiusculas;
+    arena *ar;
+    const char *erro;
+} analise_expressao;
+
+static no *novo_no(analise_expressao *an, tipo_no tipo, no *a, no *b) {
+    no *n = arena_aloca(an->ar, sizeof(no));
+
+    if (n == NULL) {
+        an->erro = "memória insuficiente";
+        return NULL;
+    }
+    memset(n, 0, sizeof(*n));
+    n->tipo = tipo;
+    n->a = a;
+    n->b = b;
+    return n;
+}
+
+/// @brief Cria um nó com um único byte (e a outra caixa, se for o caso).
+static no *no_byte(analise_expressao *an, unsigned char c) {
+    no *n = novo_no(an, NO_BYTES, NULL, NULL);
+
+    if (n != NULL) {
+        conjunto_poe(&n->bytes, c);
+        if (an->sem_maiusculas) {
+            junta_caixas(&n->bytes);
+        }
+    }
+    return n;
+}
+
+/// @brief Acrescenta a um conjunto uma classe com nome ([:alpha:], ...).
+/// @return 0 em caso de sucesso, -1 se o nome não for conhecido.
+static int classe_nomeada(conjunto_bytes *c, const char *nome, size_t n) {
+    for (int x = 0; x < 256; x++) {
+        int tem;
+
+        if (n == 5 && strncmp(nome, "alpha", 5) == 0) {
+            tem = e_letra(x);
+        } else if (n == 5 && strncmp(nome, "digit", 5) == 0) {
+            tem = x >= '0' && x <= '9';
+        } else if (n == 5 && strncmp(nome, "alnum", 5) == 0) {
+            tem = e_letra(x) || (x >= '0' && x <= '9');
+        } else if (n == 5 && strncmp(nome, "space", 5) == 0) {
+            tem = x == ' ' || (x >= '\t' && x <= '\r');
+        } else if (n == 5 && strncmp(nome, "upper", 5) == 0) {
+            tem = x >= 'A' && x <= 'Z';
+        } else if (n == 5 && strncmp(nome, "lower", 5) == 0) {
+            tem = x >= 'a' && x <= 'z';
+        } else if (n == 5 && strncmp(nome, "punct", 5) == 0) {
+            tem = x > ' ' && x < 127 && !e_letra(x) && !(x >= '0' && x <= '9');
+        } else if (n == 6 && strncmp(nome, "xdigit", 6) == 0) {
+            tem = (x >= '0' && x <= '9') || (x >= 'a' && x <= 'f') || (x >= 'A' && x <= 'F');
+        } else {
+            return -1;
+        }
+        if (tem) {
+            conjunto_poe(c, x);
+        }
+    }
+    return 0;
+}
+
+/// @brief Complementa um conjunto de caracteres ASCII, sem incluir o '\\n'.
+static void complementa_ascii(conjunto_bytes *c) {
+    c->b[0] = ~c->b[0] & ~(1ULL << '\n');
+    c->b[1] = ~c->b[1];
+    c->b[2] = c->b[3] = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Caracteres UTF-8                                                        */
+/* ---------------------------------------------------------------------- */
+
+/// Maior ponto de código Unicode.
+#define MAX_CARACTER 0x10FFFF
+
+/// Pontos de código reservados para o UTF-16 (nunca aparecem em UTF-8 válido).
+#define SUBSTITUTOS_INICIO 0xD800
+#define SUBSTITUTOS_FIM 0xDFFF
+
+/// @brief Intervalo de pontos de código.
+typedef struct {
+    uint32_t de, ate;
+} intervalo_caracteres;
+
+/// @brief Caracteres de uma classe: os ASCII num conjunto de bytes, os outros em intervalos.
+typedef struct {
+    conjunto_bytes ascii;
+    intervalo_caracteres *intervalos;   ///< na arena da análise
+    int num, cap;
+} classe_caracteres;
+
+/// @brief Descodifica um carácter UTF-8 bem formado.
+/// @param p Bytes (terminados em '\\0').
+/// @param c Ponto de código.
+/// @return Número de bytes do carácter, ou 0 se a sequência for inválida.
+static int le_utf8(const unsigned char *p, uint32_t *c) {
+    static const uint32_t minimo[] = { 0, 0, 0x80, 0x800, 0x10000 };
+    int n = p[0] < 0x80 ? 1 : p[0] >= 0xC2 && p[0] <= 0xDF ? 2 :
+            p[0] >= 0xE0 && p[0] <= 0xEF ? 3 : p[0] >= 0xF0 && p[0] <= 0xF4 ? 4 : 0;
+
+    if (n <= 1) {
+        *c = p[0];
+        return n;
+    }
+    *c = p[0] & (0x7F >> n);
+    for (int i = 1; i < n; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+        *c = (*c << 6) | (p[i] & 0x3F);
+    }
+    if (*c < minimo[n] || *c > MAX_CARACTER || (*c >= SUBSTITUTOS_INICIO && *c <= SUBSTITUTOS_FIM)) {
+        return 0;
+    }
+    return n;
+}
+
+/// @brief Codifica um ponto de código em UTF-8.
+/// @return Número de bytes escritos em s.
+static int escreve_utf8(uint32_t c, unsigned char *s) {
+    if (c < 0x80) {
+        s[0] = c;
+        return 1;
+    }
+    if (c < 0x800) {
+        s[0] = 0xC0 | c >> 6;
+        s[1] = 0x80 | (c & 0x3F);
+        return 2;
+    }
+    if (c < 0x10000) {
+        s[0] = 0xE0 | c >> 12;
+        s[1] = 0x80 | (c >> 6 & 0x3F);
+        s[2] = 0x80 | (c & 0x3F);
+        return 3;
+    }
+    s[0] = 0xF0 | c >> 18;
+    s[1] = 0x80 | (c >> 12 & 0x3F);
+    s[2] = 0x80 | (c >> 6 & 0x3F);
+    s[3] = 0x80 | (c & 0x3F);
+    return 4;
+}
+
+/// @brief Lê um carácter (um byte ASCII ou uma sequência UTF-8) do padrão.
+/// @return 0 em caso de sucesso, -1 se não for UTF-8 válido.
+static int le_caracter(analise_expressao *an, uint32_t *c) {
+    int n = le_utf8(an->p, c);
+
+    if (n == 0) {
+        an->erro = "carácter UTF-8 inválido numa classe";
+        return -1;
+    }
+    an->p += n;
+    return 0;
+}
+
+/// @brief Acrescenta os caracteres de [de, ate] a uma classe.
+/// @return 0 em caso de sucesso, -1 se faltar memória.
+static int classe_acrescenta(analise_expressao *an, classe_caracteres *cl, uint32_t de, uint32_t ate) {
+    for (uint32_t x = de; x <= ate && x < 0x80; x++) {
+        conjunto_poe(&cl->ascii, x);
+    }
+    if (ate < 0x80) {
+        return 0;
+    }
+    if (cl->num == cl->cap) {
+        // A arena não tem realloc: o array antigo fica para trás
+        int cap = cl->cap == 0 ? 8 : cl->cap * 2;
+        intervalo_caracteres *maior = arena_aloca(an->ar, cap * sizeof(intervalo_caracteres));
+
+        if (maior == NULL) {
+            an->erro = "memória insuficiente";
+            return -1;
+        }
+        if (cl->num > 0) {
+            memcpy(maior, cl->intervalos, cl->num * sizeof(intervalo_caracteres));
+        }
+        cl->intervalos = maior;
+        cl->cap = cap;
+    }
+    cl->intervalos[cl->num++] = (intervalo_caracteres){ de < 0x80 ? 0x80 : de, ate };
+    return 0;
+}
+
+static int compara_intervalos(const void *a, const void *b) {
+    const intervalo_caracteres *x = a, *y = b;
+
+    return x->de < y->de ? -1 : x->de > y->de;
+}
+
+/// @brief Acrescenta [de, ate] a uma lista, sem os pontos de código substitutos.
+static void poe_sem_substitutos(intervalo_caracteres *lista, int *n, uint32_t de, uint32_t ate) {
+    if (de > SUBSTITUTOS_FIM || ate < SUBSTITUTOS_INICIO) {
+        lista[(*n)++] = (intervalo_caracteres){ de, ate };
+        return;
+    }
+    if (de < SUBSTITUTOS_INICIO) {
+        lista[(*n)++] = (intervalo_caracteres){ de, SUBSTITUTOS_INICIO - 1 };
+    }
+    if (ate > SUBSTITUTOS_FIM) {
+        lista[(*n)++] = (intervalo_caracteres){ SUBSTITUTOS_FIM + 1, ate };
+    }
+}
+
+/// @brief Ordena e junta os intervalos não ASCII de uma classe.
+/// @param negada Se diferente de 0, ficam os caracteres não ASCII que não estão na classe.
+/// @return 0 em caso de sucesso, -1 se faltar memória.
+static int classe_normaliza(analise_expressao *an, classe_caracteres *cl, int negada) {
+    intervalo_caracteres *lista = arena_aloca(an->ar, (cl->num + 2) * sizeof(intervalo_caracteres));
+    uint32_t proximo = 0x80;
+    int k = 0, n = 0;
+
+    if (lista == NULL) {
+        an->erro = "memória insuficiente";
+        return -1;
+    }
+    if (cl->num > 0) {
+        qsort(cl->intervalos, cl->num, sizeof(intervalo_caracteres), compara_intervalos);
+    }
+    for (int i = 0; i < cl->num; i++) {
+        if (k > 0 && cl->intervalos[i].de <= cl->intervalos[k - 1].ate + 1) {
+            if (cl->intervalos[i].ate > cl->intervalos[k - 1].ate) {
+                cl->intervalos[k - 1].ate = cl->intervalos[i].ate;
+            }
+        } else {
+            cl->intervalos[k++] = cl->intervalos[i];
+        }
+    }
+    for (int i = 0; i < k; i++) {
+        if (!negada) {
+            poe_sem_substitutos(lista, &n, cl->intervalos[i].de, cl->intervalos[i].ate);
+        } else if (cl->intervalos[i].de > proximo) {
+            poe_sem_substitutos(lista, &n, proximo, cl->intervalos[i].de - 1);
+        }
+        proximo = cl->intervalos[i].ate + 1;
+    }
+    if (negada && proximo <= MAX_CARACTER) {
+        poe_sem_substitutos(lista, &n, proximo, MAX_CARACTER);
+    }
+    cl->intervalos = lista;
+    cl->num = cl->cap = n;
+    return 0;
+}
+
+/// @brief Acrescenta às alternativas as sequências de bytes UTF-8 dos
+/// caracteres de [de, ate] (não ASCII, sem substitutos).
+/// @return 0 em caso de sucesso, -1 se faltar memória.
+/// @details O intervalo é partido até cada parte ser um produto de
+/// intervalos de bytes: os extremos têm o mesmo número de bytes e, a partir
+/// do primeiro byte em que diferem, cobrem todos os bytes de continuação.
+static int sequencias_utf8(analise_expressao *an, uint32_t de, uint32_t ate, no **alternativas) {
+    static const uint32_t ultimo[] = { 0x7F, 0x7FF, 0xFFFF };
+    unsigned char a[4], b[4];
+    no *seq = NULL;
+    int n;
+
+    for (int i = 0; i < 3; i++) {
+        if (de <= ultimo[i] && ate > ultimo[i]) {
+            return sequencias_utf8(an, de, ultimo[i], alternativas) == -1 ? -1 :
+                   sequencias_utf8(an, ultimo[i] + 1, ate, alternativas);
+        }
+    }
+    for (int i = 1; i < 4; i++) {
+        uint32_t m = (1u << (6 * i)) - 1;
+
+        if ((de & ~m) != (ate & ~m)) {
+            if ((de & m) != 0) {
+                return sequencias_utf8(an, de, de | m, alternativas) == -1 ? -1 :
+                       sequencias_utf8(an, (de | m) + 1, ate, alternativas);
+            }
+            if ((ate & m) != m) {
+                return sequencias_utf8(an, de, (ate & ~m) - 1, alternativas) == -1 ? -1 :
+                       sequencias_utf8(an, ate & ~m, ate, alternativas);
+            }
+        }
+    }
+
+    n = escreve_utf8(de, a);
+    escreve_utf8(ate, b);
+    for (int i = 0; i < n; i++) {
+        no *byte = novo_no(an, NO_BYTES, NULL, NULL);
+
+        if (byte == NULL) {
+            return -1;
+        }
+        for (unsigned x = a[i]; x <= b[i]; x++) {
+            conjunto_poe(&byte->bytes, x);
+        }
+        seq = seq == NULL ? byte : novo_no(an, NO_CONCAT, seq, byte);
+        if (seq == NULL) {
+            return -1;
+        }
+    }
+    *alternativas = *alternativas == NULL ? seq : novo_no(an, NO_ALTERNA, *alternativas, seq);
+    return *alternativas == NULL ? -1 : 0;
+}
+
+/// @brief Constrói o nó de uma classe: um byte para os caracteres ASCII e,
+/// em alternativa, as sequências UTF-8 dos outros.
+/// @param negada Se diferente de 0, o nó corresponde aos caracteres que não
+/// estão na classe (exceto o '\\n').
+static no *no_classe(analise_expressao *an, classe_caracteres *cl, int negada) {
+    no *ascii, *alternativas = NULL;
+
+    if (an->sem_maiusculas) {
+        junta_caixas(&cl->ascii);
+    }
+    if (negada) {
+        complementa_ascii(&cl->ascii);
+    }
+    if (classe_normaliza(an, cl, negada) == -1 || (ascii = novo_no(an, NO_BYTES, NULL, NULL)) == NULL) {
+        return NULL;
+    }
+    ascii->bytes = cl->ascii;
+    if (cl->num == 0) {
+        return ascii;           // só caracteres ASCII: um único byte
+    }
+    for (int i = 0; i < cl->num; i++) {
+        if (sequencias_utf8(an, cl->intervalos[i].de, cl->intervalos[i].ate, &alternativas) == -1) {
+            return NULL;
+        }
+    }
+    return conjunto_conta(&cl->ascii) == 0 ? alternativas : novo_no(an, NO_ALTERNA, ascii, alternativas);
+}
+
+/// @brief Lê uma expressão entre parênteses retos (o '[' já foi lido).
+static no *le_classe(analise_expressao *an) {
+    classe_caracteres cl;
+    int negada = 0, primeiro = 1;
+
+    memset(&cl, 0, sizeof(cl));
+    if (*an->p == '^') {
+        negada = 1;
+        an->p++;
+    }
+    while (*an->p != '\0' && (*an->p != ']' || primeiro)) {
+        uint32_t c, ultimo;
+
+        primeiro = 0;
+        if (an->p[0] == '[' && an->p[1] == ':') {
+            const char *nome = (const char *)an->p + 2;
+            const char *fim = strstr(nome, ":]");
+
+            if (fim == NULL || classe_nomeada(&cl.ascii, nome, fim - nome) == -1) {
+                an->erro = "classe de caracteres inválida";
+                return NULL;
+            }
+            an->p = (const unsigned char *)fim + 2;
+            continue;
+        }
+        if (le_caracter(an, &c) == -1) {
+            return NULL;
+        }
+        ultimo = c;
+        if (an->p[0] == '-' && an->p[1] != '\0' && an->p[1] != ']') {
+            an->p++;
+            if (le_caracter(an, &ultimo) == -1) {
+                return NULL;
+            }
+            if (ultimo < c) {
+                an->erro = "intervalo inválido";
+                return NULL;
+            }
+        }
+        if (classe_acrescenta(an, &cl, c, ultimo) == -1) {
+            return NULL;
+        }
+    }
+    if (*an->p != ']') {
+        an->erro = "falta um ']'";
+        return NULL;
+    }
+    an->p++;
+    return no_classe(an, &cl, negada);
+}
+
+/// @brief Indica se '\\' seguido do carácter c é um escape suportado (um carácter especial protegido).
+/// @details As letras e os dígitos (\\b, \\1, ...) e \\<, \\>, \\` e \\' têm
+/// outros significados noutros grep, por isso não passam a literais.
+static int escape_literal(unsigned char c) {
+    return c > ' ' && c < 127 && !e_letra(c) && !(c >= '0' && c <= '9') && strchr("<>`'", c) == NULL;
+}
+
+static no *le_alternativa(analise_expressao *an);
+
+/// @brief Lê um átomo: grupo, classe, '.', âncora, escape ou carácter literal.
+static no *le_atomo(analise_expressao *an) {
+    unsigned char c = *an->p++;
+    classe_caracteres cl;
+    uint32_t cp;
+    int tamanho;
+    no *n;
+
+    memset(&cl, 0, sizeof(cl));
+    switch (c) {
+    case '(':
+        n = le_alternativa(an);
+        if (n != NULL && *an->p != ')') {
+            an->erro = "falta um ')'";
+            return NULL;
+        }
+        an->p++;
+        return n;
+    case '[':
+        return le_classe(an);
+    case '.':
+        return no_classe(an, &cl, 1);
+    case '^':
+        return novo_no(an, NO_INICIO, NULL, NULL);
+    case '$':
+        return novo_no(an, NO_FIM, NULL, NULL);
+    case '\\':
+        c = *an->p++;
+        if (c == '\0') {
+            an->erro = "'\\' no fim do padrão";
+            return NULL;
+        }
+        if (c == 'd' || c == 'D' || c == 'w' || c == 'W' || c == 's' || c == 'S') {
+            unsigned char m = minuscula(c);
+
+            classe_nomeada(&cl.ascii, m == 'd' ? "digit" : m == 's' ? "space" : "alnum", 5);
+            if (m == 'w') {
+                conjunto_poe(&cl.ascii, '_');
+            }
+            return no_classe(an, &cl, c != m);
+        }
+        if (!escape_literal(c)) {
+            an->erro = "escape não suportado (só se pode proteger um carácter especial)";
+            return NULL;
+        }
+        return no_byte(an, c);
+    default:
+        // Um carácter UTF-8 é um só átomo ("é+" repete o carácter inteiro)
+        tamanho = c >= 0x80 ? le_utf8(an->p - 1, &cp) : 1;
+        n = no_byte(an, c);
+        for (int i = 1; n != NULL && i < tamanho; i++) {
+            no *b = no_byte(an, *an->p++);
+
+            n = b == NULL ? NULL : novo_no(an, NO_CONCAT, n, b);
+        }
+        return n;
+    }
+}
+
+/// @brief Lê um número de uma repetição {m,n}.
+/// @return O número, ou -1 se não houver dígitos.
+static int le_numero(analise_expressao *an) {
+    int v = 0;
+
+    if (*an->p < '0' || *an->p > '9') {
+        return -1;
+    }
+    while (*an->p >= '0' && *an->p <= '9') {
+        if (v <= MAX_REPETICOES) {
+            v = v * 10 + (*an->p - '0');
+        }
+        an->p++;
+    }
+    return v;
+}
+
+/// @brief Lê um átomo seguido de operadores de repetição.
+static no *le_repeticao(analise_expressao *an) {
+    no *n = le_atomo(an);
+
+    while (n != NULL) {
+        int min, max;
+
+        if (*an->p == '*') {
+            min = 0;
+            max = -1;
+        } else if (*an->p == '+') {
+            min = 1;
+            max = -1;
+        } else if (*an->p == '?') {
+            min = 0;
+            max = 1;
+        } else if (*an->p == '{' && an->p[1] >= '0' && an->p[1] <= '9') {
+            an->p++;
+            min = max = le_numero(an);
+            if (*an->p == ',') {
+                an->p++;
+                max = *an->p == '}' ? -1 : le_numero(an);
+            }
+            if (*an->p != '}' || (max != -1 && max < min) || min > MAX_REPETICOES || max > MAX_REPETICOES) {
+                an->erro = "repetição inválida";
+                return NULL;
+            }
+        } else {
+            break;
+        }
+        an->p++;
+        n = novo_no(an, NO_REPETE, n, NULL);
+        if (n != NULL) {
+            n->min = min;
+            n->max = max;
+        }
+    }
+    return n;
+}
+
+/// @brief Lê uma sequência de repetições até '|', ')' ou o fim.
+static no *le_sequencia(analise_expressao *an) {
+    no *n = NULL;
+
+    while (*an->p != '\0' && *an->p != '|' && *an->p != ')') {
+        no *r = le_repeticao(an);
+
+        if (r == NULL) {
+            return NULL;
+        }
+        n = n == NULL ? r : novo_no(an, NO_CONCAT, n, r);
+        if (n == NULL) {
+            return NULL;
+        }
+    }
+    return n != NULL ? n : novo_no(an, NO_VAZIO, NULL, NULL);
+}
+
+/// @brief Lê alternativas separadas por '|'.
+static no *le_alternativa(analise_expressao *an) {
+    no *n = le_sequencia(an);
+
+    while (n != NULL && *an->p == '|') {
+        no *b;
+
+        an->p++;
+        b = le_sequencia(an);
+        n = b == NULL ? NULL : novo_no(an, NO_ALTERNA, n, b);
+    }
+    return n;
+}
+
+/// @brief Constrói a árvore de um padrão literal (-F).
+static no *arvore_literal(analise_expressao *an) {
+    no *n = NULL;
+
+    for (; *an->p != '\0'; an->p++) {
+        no *b = no_byte(an, *an->p);
+
+        if (b == NULL) {
+            return NULL;
+        }
+        n = n == NULL ? b : novo_no(an, NO_CONCAT, n, b);
+        if (n == NULL) {
+            return NULL;
+        }
+    }
+    return n != NULL ? n : novo_no(an, NO_VAZIO, NULL, NULL);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Literais obrigatórios                                                   */
+/* ---------------------------------------------------------------------- */
+
+/// @brief Conjunto de literais candidato (na arena da análise).
+typedef struct {
+    int num;
+    unsigned char *texto[EXPRESSAO_MAX_LITERAIS];
+    size_t tamanho[EXPRESSAO_MAX_LITERAIS];
+} candidatos;
+
+/// @brief Indica se um nó é um byte literal (com -i, uma letra nas duas caixas).
+static int byte_literal(const no *n, int sem_maiusculas, unsigned char *c) {
+    int total;
+
+    if (n->tipo != NO_BYTES) {
+        return 0;
+    }
+    total = conjunto_conta(&n->bytes);
+    for (int x = 0; x < 256; x++) {
+        if (conjunto_tem(&n->bytes, x)) {
+            *c = sem_maiusculas ? minuscula(x) : x;
+            return total == 1 || (sem_maiusculas && total == 2 && e_letra(x) &&
+                                  conjunto_tem(&n->bytes, x ^ 0x20));
+        }
+    }
+    return 0;
+}
+
+/// @brief Acrescenta a lista os nós de uma cadeia de concatenações (ou de alternativas).
+static int achata(const no *n, tipo_no tipo, const no **lista, int num, int max) {
+    if (n->tipo == tipo) {
+        num = achata(n->a, tipo, lista, num, max);
+        return num < 0 ? num : achata(n->b, tipo, lista, num, max);
+    }
+    if (num >= max) {
+        return -1;
+    }
+    lista[num] = n;
+    return num + 1;
+}
+
+/// @brief Escreve em buf o texto de um nó que é só uma sequência de bytes literais.
+/// @return Tamanho do texto, ou -1 se o nó não for literal.
+static long texto_literal(const no *n, int sem_maiusculas, unsigned char *buf, size_t max) {
+    unsigned char c;
+    long a, b;
+
+    switch (n->tipo) {
+    case NO_VAZIO:
+        return 0;
+    case NO_BYTES:
+        if (!byte_literal(n, sem_maiusculas, &c) || max < 1) {
+            return -1;
+        }
+        buf[0] = c;
+        return 1;
+    case NO_CONCAT:
+        a = texto_literal(n->a, sem_maiusculas, buf, max);
+        if (a < 0) {
+            return -1;
+        }
+        b = texto_literal(n->b, sem_maiusculas, buf + a, max - a);
+        return b < 0 ? -1 : a + b;
+    default:
+        return -1;
+    }
+}
+
+/// @brief Tamanho do literal mais curto de um conjunto (0 se estiver vazio).
+static size_t mais_curto(const candidatos *c) {
+    size_t m = 0;
+
+    for (int i = 0; i < c->num; i++) {
+        if (i == 0 || c->tamanho[i] < m) {
+            m = c->tamanho[i];
+        }
+    }
+    return m;
+}
+
+/// @brief Indica se o conjunto a é um filtro melhor do que b.
+static int melhor(const candidatos *a, const candidatos *b) {
+    size_t ma = mais_curto(a), mb = mais_curto(b);
+
+    return ma > mb || (ma == mb && a->num > 0 && a->num < b->num);
+}
+
+/// @brief Calcula literais que aparecem em todas as correspondências de um nó.
+/// @details Numa concatenação, cada sequência de bytes literais é candidata, e
+/// também os literais de cada parte; fica o conjunto cujo literal mais curto é
+/// maior. Numa alternativa, todos os ramos têm de ter literais.
+static void obrigatorios(const no *n, analise_expressao *an, candidatos *res) {
+    const no *partes[256];
+    int num;
+    unsigned char c;
+
+    res->num = 0;
+    switch (n->tipo) {
+    case NO_BYTES:
+        if (byte_literal(n, an->sem_maiusculas, &c) && (res->texto[0] = arena_aloca(an->ar, 1)) != NULL) {
+            res->texto[0][0] = c;
+            res->tamanho[0] = 1;
+            res->num = 1;
+        }
+        return;
+    case NO_REPETE:
+        if (n->min >= 1) {
+            obrigatorios(n->a, an, res);
+        }
+        return;
+    case NO_ALTERNA:
+        num = achata(n, NO_ALTERNA, partes, 0, 256);
+        for (int i = 0; i < num; i++) {
+            candidatos ramo;
+
+            obrigatorios(partes[i], an, &ramo);
+            if (ramo.num == 0 || res->num + ramo.num > EXPRESSAO_MAX_LITERAIS) {
+                res->num = 0;
+                return;
+            }
+            for (int k = 0; k < ramo.num; k++) {
+                res->texto[res->num] = ramo.texto[k];
+                res->tamanho[res->num++] = ramo.tamanho[k];
+            }
+        }
+        return;
+    case NO_CONCAT:
+        num = achata(n, NO_CONCAT, partes, 0, 256);
+        for (int i = 0; i < num; i++) {
+            candidatos cand;
+            int fim = i;
+
+            // Sequência de bytes literais a começar em i
+            while (fim < num && byte_literal(partes[fim], an->sem_maiusculas, &c)) {
+                fim++;
+            }
+            if (fim > i) {
+                cand.num = 0;
+                cand.texto[0] = arena_aloca(an->ar, fim - i);
+                if (cand.texto[0] != NULL) {
+                    for (int k = i; k < fim; k++) {
+                        byte_literal(partes[k], an->sem_maiusculas, &cand.texto[0][k - i]);
+                    }
+                    cand.tamanho[0] = fim - i;
+                    cand.num = 1;
+                }
+                i = fim - 1;
+            } else {
+                obrigatorios(partes[i], an, &cand);
+            }
+            if (melhor(&cand, res)) {
+                *res = cand;
+            }
+        }
+        return;
+    default:
+        return;
+    }
+}
+
+/// @brief Escolhe os literais da expressão a partir da árvore.
+/// @return Conjunto escolhido (num 0 se não compensar filtrar) e se é exato.
+static int escolhe_literais(const no *raiz, analise_expressao *an, candidatos *res) {
+    const no *ramos[EXPRESSAO_MAX_LITERAIS];
+    int num = achata(raiz, NO_ALTERNA, ramos, 0, EXPRESSAO_MAX_LITERAIS);
+    unsigned char buf[4096];
+
+    // Exata: todos os ramos são literais não vazios
+    res->num = 0;
+    for (int i = 0; i < num; i++) {
+        long t = texto_literal(ramos[i], an->sem_maiusculas, buf, sizeof(buf));
+
+        if (t <= 0 || (res->texto[i] = arena_aloca(an->ar, t)) == NULL) {
+            res->num = 0;
+            break;
+        }
+        memcpy(res->texto[i], buf, t);
+        res->tamanho[i] = t;
+        res->num++;
+    }
+    if (res->num > 0) {
+        return 1;
+    }
+
+    // Senão, literais que têm de aparecer, se forem pelo menos de 2 bytes
+    obrigatorios(raiz, an, res);
+    if (mais_curto(res) < 2) {
+        res->num = 0;
+    }
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* NFA                                                                     */
+/* ---------------------------------------------------------------------- */
+
+typedef enum {
+    E_BYTES,        ///< consome um byte do conjunto e vai para x
+    E_DIVIDE,       ///< vai para x e para y
+    E_INICIO,       ///< vai para x se estiver no início da linha
+    E_FIM,          ///< vai para x se estiver no fim da linha
+    E_ACEITA
+} tipo_estado;
+
+/// @brief Estado do NFA.
+typedef struct {
+    unsigned char tipo;
+    int x, y;
+    int conjunto;   ///< índice em conjuntos (E_BYTES)
+} estado_nfa;
+
+struct expressao {
+    estado_nfa *estados;
+    int num_estados, cap_estados;
+    conjunto_bytes *conjuntos;
+    int num_conjuntos, cap_conjuntos;
+    int inicio;
+    unsigned char classe[256];      ///< classe de cada byte
+    int num_classes;
+    literais_expressao literais;
+    unsigned char *texto_literais;  ///< memória dos literais
+};
+
+/// @brief Acrescenta um estado ao NFA.
+/// @return Índice do estado, ou -1 se o NFA for demasiado grande.
+static int novo_estado(expressao *e, tipo_estado tipo, int x, int y) {
+    if (e->num_estados == e->cap_estados) {
+        int cap = e->cap_estados == 0 ? 64 : e->cap_estados * 2;
+        estado_nfa *novos;
+
+        if (e->num_estados >= MAX_ESTADOS_NFA ||
+            (novos = realloc(e->estados, cap * sizeof(estado_nfa))) == NULL) {
+            return -1;
+        }
+        e->estados = novos;
+        e->cap_estados = cap;
+    }
+    e->estados[e->num_estados] = (estado_nfa){ tipo, x, y, -1 };
+    return e->num_estados++;
+}
+
+/// @brief Acrescenta um estado que consome um byte do conjunto.
+static int estado_bytes(expressao *e, const conjunto_bytes *c, int seguinte) {
+    int s;
+
+    if (e->num_conjuntos == e->cap_conjuntos) {
+        int cap = e->cap_conjuntos == 0 ? 64 : e->cap_conjuntos * 2;
+        conjunto_bytes *novos = realloc(e->conjuntos, cap * sizeof(conjunto_bytes));
+
+        if (novos == NULL) {
+            return -1;
+        }
+        e->conjuntos = novos;
+        e->cap_conjuntos = cap;
+    }
+    s = novo_estado(e, E_BYTES, seguinte, -1);
+    if (s != -1) {
+        e->conjuntos[e->num_conjuntos] = *c;
+        e->estados[s].conjunto = e->num_conjuntos++;
+    }
+    return s;
+}
+
+/// @brief Compila um nó para estados que continuam em seguinte.
+/// @return Estado de entrada do nó, ou -1 se o NFA for demasiado grande.
+static int compila_no(expressao *e, const no *n, int seguinte) {
+    int s, r;
+
+    if (seguinte == -1) {
+        return -1;
+    }
+    switch (n->tipo) {
+    case NO_VAZIO:
+        return seguinte;
+    case NO_BYTES:
+        return estado_bytes(e, &n->bytes, seguinte);
+    case NO_CONCAT:
+        return compila_no(e, n->a, compila_no(e, n->b, seguinte));
+    case NO_ALTERNA:
+        s = compila_no(e, n->a, seguinte);
+        r = compila_no(e, n->b, seguinte);
+        return s == -1 || r == -1 ? -1 : novo_estado(e, E_DIVIDE, s, r);
+    case NO_INICIO:
+        return novo_estado(e, E_INICIO, seguinte, -1);
+    case NO_FIM:
+        return novo_estado(e, E_FIM, seguinte, -1);
+    case NO_REPETE:
+        r = seguinte;
+        if (n->max == -1) {
+            // a*: o estado de divisão volta a si próprio depois de a
+            // (compila_no pode mudar e->estados de sítio com realloc)
+            s = novo_estado(e, E_DIVIDE, -1, seguinte);
+            r = s == -1 ? -1 : compila_no(e, n->a, s);
+            if (r == -1) {
+                return -1;
+            }
+            e->estados[s].x = r;
+            r = s;
+        } else {
+            // a{0,k}: k opcionais encaixados, (a(a(a)?)?)?
+            for (int k = n->min; k < n->max && r != -1; k++) {
+                s = compila_no(e, n->a, r);
+                r = s == -1 ? -1 : novo_estado(e, E_DIVIDE, s, seguinte);
+            }
+        }
+        for (int k = 0; k < n->min && r != -1; k++) {
+            r = compila_no(e, n->a, r);
+        }
+        return r;
+    }
+    return -1;
+}
+
+/// @brief Agrupa os bytes que nenhum conjunto do NFA distingue.
+static void calcula_classes(expressao *e) {
+    unsigned char nova[256];
+    conjunto_bytes fim_linha = { { 0, 0, 0, 0 } };
+
+    memset(e->classe, 0, sizeof(e->classe));
+    e->num_classes = 1;
+    conjunto_poe(&fim_linha, '\n');
+    for (int i = -1; i < e->num_conjuntos; i++) {
+        const conjunto_bytes *c = i < 0 ? &fim_linha : &e->conjuntos[i];
+        short mapa[256][2];
+        int n = 0;
+
+        memset(mapa, -1, sizeof(mapa));
+        for (int x = 0; x < 256; x++) {
+            int t = conjunto_tem(c, x);
+
+            if (mapa[e->classe[x]][t] == -1) {
+                mapa[e->classe[x]][t] = n++;
+            }
+            nova[x] = mapa[e->classe[x]][t];
+        }
+        memcpy(e->classe, nova, sizeof(nova));
+        e->num_classes = n;
+    }
+}
+
+/// @brief Compila um ou mais padrões.
+/// @param padroes Padrões.
+/// @param n Número de padrões.
+/// @param opcoes EXPRESSAO_LITERAL e/ou EXPRESSAO_SEM_MAIUSCULAS.
+/// @param erro Buffer para a descrição do erro.
+/// @param tamanho_erro Tamanho do buffer.
+/// @return Expressão compilada, ou NULL se algum padrão for inválido.
+expressao *expressao_compila(char *padroes[], int n, int opcoes, char *erro, size_t tamanho_erro) {
+    arena ar = ARENA_VAZIA;
+    analise_expressao an = { NULL, (opcoes & EXPRESSAO_SEM_MAIUSCULAS) != 0, &ar, NULL };
+    expressao *e = calloc(1, sizeof(expressao));
+    no *raiz = NULL;
+    candidatos lit;
+    size_t total = 0;
+
+    if (e == NULL) {
+        snprintf(erro, tamanho_erro, "memória insuficiente");
+        return NULL;
+    }
+    for (int i = 0; i < n && an.erro == NULL; i++) {
+        no *r;
+
+        an.p = (const unsigned char *)padroes[i];
+        r = (opcoes & EXPRESSAO_LITERAL) ? arvore_literal(&an) : le_alternativa(&an);
+        if (r != NULL && *an.p == ')') {
+            an.erro = "')' sem '('";
+        } else if (r != NULL) {
+            raiz = raiz == NULL ? r : novo_no(&an, NO_ALTERNA, raiz, r);
+        }
+        if (r == NULL && an.erro == NULL) {
+            an.erro = "memória insuficiente";
+        }
+    }
+
+    if (an.erro == NULL) {
+        e->inicio = compila_no(e, raiz, novo_estado(e, E_ACEITA, -1, -1));
+        if (e->inicio == -1) {
+            an.erro = "expressão demasiado grande";
+        }
+    }
+    if (an.erro != NULL) {
+        snprintf(erro, tamanho_erro, "%s", an.erro);
+        arena_liberta(&ar);
+        expressao_liberta(e);
+        return NULL;
+    }
+    calcula_classes(e);
+
+    // Copiar os literais da arena para a expressão
+    e->literais.exata = escolhe_literais(raiz, &an, &lit);
+    e->literais.sem_maiusculas = an.sem_maiusculas;
+    for (int i = 0; i < lit.num; i++) {
+        total += lit.tamanho[i];
+    }
+    if (lit.num > 0 && (e->texto_literais = malloc(total)) != NULL) {
+        unsigned char *p = e->texto_literais;
+
+        for (int i = 0; i < lit.num; i++) {
+            memcpy(p, lit.texto[i], lit.tamanho[i]);
+            e->literais.texto[i] = p;
+            e->literais.tamanho[i] = lit.tamanho[i];
+            p += lit.tamanho[i];
+        }
+        e->literais.num = lit.num;
+    }
+    arena_liberta(&ar);
+    return e;
+}
+
+/// @brief Liberta uma expressão.
+/// @param e Expressão.
+void expressao_liberta(expressao *e) {
+    if (e == NULL) {
+        return;
+    }
+    free(e->estados);
+    free(e->conjuntos);
+    free(e->texto_literais);
+    free(e);
+}
+
+/// @brief Devolve os literais obrigatórios da expressão.
+/// @param e Expressão.
+/// @return Literais.
+const literais_expressao *expressao_literais(const expressao *e) {
+    return &e->literais;
+}
+
+/* ---------------------------------------------------------------------- */
+/* DFA preguiçoso                                                          */
+/* ---------------------------------------------------------------------- */
+
+/// @brief Estado do DFA: um conjunto ordenado de estados do NFA.
+typedef struct {
+    size_t lista;           ///< posição da lista em automato.listas
+    int num;                ///< estados do NFA na lista
+    unsigned char inicio;   ///< estado do início da linha
+    unsigned char aceita;   ///< a linha já corresponde
+    unsigned char aceita_fim;   ///< a linha corresponde se acabar aqui
+} estado_dfa;
+
+struct automato {
+    const expressao *e;
+    estado_dfa *estados;
+    int num_estados, cap_estados;
+    int32_t *transicoes;    ///< num_classes por estado; -1 se ainda não foi calculada
+    unsigned char *final;   ///< 1 se o estado aceita ou nunca poderá aceitar
+    int *listas;            ///< listas de estados do NFA de todos os estados
+    size_t num_listas, cap_listas;
+    int *tabela;            ///< dispersão lista → estado (-1 livre)
+    int cap_tabela;
+    int inicio_linha;
+    int pode_avancar;       ///< o fecho do estado inicial consome bytes
+    // Temporários do fecho, com um por estado do NFA
+    int *pilha, *lista;
+    unsigned *marca;
+    unsigned geracao;
+};
+
+static int compara_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/// @brief Calcula o fecho (pelas transições sem consumo) de um conjunto de estados.
+/// @param sementes Estados de partida.
+/// @param n Número de sementes.
+/// @param bol 1 no início da linha (as âncoras ^ passam).
+/// @param eol 1 no fim da linha (as âncoras $ passam).
+/// @return Número de estados em a->lista (ordenados): E_BYTES, E_ACEITA e,
+/// sem eol, E_FIM.
+static int fecho(automato *a, const int *sementes, int n, int bol, int eol) {
+    const estado_nfa *nfa = a->e->estados;
+    int topo = 0, k = 0;
+
+    if (++a->geracao == 0) {
+        memset(a->marca, 0, a->e->num_estados * sizeof(unsigned));
+        a->geracao = 1;
+    }
+    for (int i = 0; i < n; i++) {
+        if (a->marca[sementes[i]] != a->geracao) {
+            a->marca[sementes[i]] = a->geracao;
+            a->pilha[topo++] = sementes[i];
+        }
+    }
+    while (topo > 0) {
+        int s = a->pilha[--topo];
+        int seguintes[2], num_seguintes = 0;
+
+        switch (nfa[s].tipo) {
+        case E_BYTES:
+        case E_ACEITA:
+            a->lista[k++] = s;
+            break;
+        case E_DIVIDE:
+            seguintes[num_seguintes++] = nfa[s].x;
+            seguintes[num_seguintes++] = nfa[s].y;
+            break;
+        case E_INICIO:
+            if (bol) {
+                seguintes[num_seguintes++] = nfa[s].x;
+            }
+            break;
+        case E_FIM:
+            if (eol) {
+                seguintes[num_seguintes++] = nfa[s].x;
+            } else {
+                a->lista[k++] = s;
+            }
+            break;
+        }
+        for (int i = 0; i < num_seguintes; i++) {
+            if (a->marca[seguintes[i]] != a->geracao) {
+                a->marca[seguintes[i]] = a->geracao;
+                a->pilha[topo++] = seguintes[i];
+            }
+        }
+    }
+    qsort(a->lista, k, sizeof(int), compara_int);
+    return k;
+}
+
+/// @brief Indica se uma lista tem algum estado de um tipo.
+static int lista_tem(const automato *a, const int *lista, int n, tipo_estado tipo) {
+    for (int i = 0; i < n; i++) {
+        if (a->e->estados[lista[i]].tipo == tipo) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static unsigned dispersao(const int *lista, int n, int inicio) {
+    unsigned h = 2166136261u ^ inicio;
+
+    for (int i = 0; i < n; i++) {
+        h = (h ^ (unsigned)lista[i]) * 16777619u;
+    }
+    return h;
+}
+
+/// @brief Memória usada pela cache de estados.
+static size_t memoria_automato(const automato *a) {
+    return (size_t)a->cap_estados * (sizeof(estado_dfa) + a->e->num_classes * sizeof(int32_t) + 1) +
+           a->cap_listas * sizeof(int) + a->cap_tabela * sizeof(int);
+}
+
+/// @brief Esvazia a cache de estados.
+static void esvazia(automato *a) {
+    a->num_estados = 0;
+    a->num_listas = 0;
+    memset(a->tabela, -1, a->cap_tabela * sizeof(int));
+}
+
+/// @brief Procura o estado do DFA de uma lista; se não existir, cria-o.
+/// @param lista Estados do NFA (ordenados; pode ser a->lista).
+/// @return Índice do estado, ou -1 se faltar memória.
+static int estado_de(automato *a, const int *lista, int n, int inicio) {
+    unsigned h = dispersao(lista, n, inicio);
+    int ncls = a->e->num_classes;
+    estado_dfa *d;
+    int i, s;
+
+    for (i = h & (a->cap_tabela - 1); a->tabela[i] != -1; i = (i + 1) & (a->cap_tabela - 1)) {
+        d = &a->estados[a->tabela[i]];
+        if (d->num == n && d->inicio == inicio && memcmp(a->listas + d->lista, lista, n * sizeof(int)) == 0) {
+            return a->tabela[i];
+        }
+    }
+
+    // Estado novo: reservar espaço
+    if (a->num_estados == a->cap_estados) {
+        int cap = a->cap_estados * 2;
+        estado_dfa *e = realloc(a->estados, cap * sizeof(estado_dfa));
+        int32_t *t = e == NULL ? NULL : realloc(a->transicoes, (size_t)cap * ncls * sizeof(int32_t));
+        unsigned char *f = t == NULL ? NULL : realloc(a->final, cap);
+
+        if (e != NULL) {
+            a->estados = e;
+        }
+        if (t != NULL) {
+            a->transicoes = t;
+        }
+        if (f == NULL) {
+            return -1;
+        }
+        a->final = f;
+        a->cap_estados = cap;
+    }
+    if (a->num_listas + n > a->cap_listas) {
+        size_t cap = (a->num_listas + n) * 2;
+        int *l = realloc(a->listas, cap * sizeof(int));
+
+        if (l == NULL) {
+            return -1;
+        }
+        a->listas = l;
+        a->cap_listas = cap;
+    }
+    if ((a->num_estados + 1) * 2 > a->cap_tabela) {
+        int cap = a->cap_tabela * 2;
+        int *t = malloc(cap * sizeof(int));
+
+        if (t == NULL) {
+            return -1;
+        }
+        memset(t, -1, cap * sizeof(int));
+        for (int k = 0; k < a->num_estados; k++) {
+            d = &a->estados[k];
+            for (i = dispersao(a->listas + d->lista, d->num, d->inicio) & (cap - 1); t[i] != -1; i = (i + 1) & (cap - 1)) {
+            }
+            t[i] = k;
+        }
+        free(a->tabela);
+        a->tabela = t;
+        a->cap_tabela = cap;
+        for (i = h & (cap - 1); t[i] != -1; i = (i + 1) & (cap - 1)) {
+        }
+    }
+
+    s = a->num_estados++;
+    d = &a->estados[s];
+    memcpy(a->listas + a->num_listas, lista, n * sizeof(int));
+    d->lista = a->num_listas;
+    d->num = n;
+    d->inicio = inicio;
+    a->num_listas += n;
+    a->tabela[i] = s;
+    for (int c = 0; c < ncls; c++) {
+        a->transicoes[(size_t)s * ncls + c] = -1;
+    }
+
+    // Aceitação já, no fim da linha, ou nunca
+    d->aceita = lista_tem(a, lista, n, E_ACEITA);
+    d->aceita_fim = d->aceita;
+    if (!d->aceita && lista_tem(a, lista, n, E_FIM)) {
+        int m = fecho(a, a->listas + d->lista, n, inicio, 1);
+        d->aceita_fim = lista_tem(a, a->lista, m, E_ACEITA);
+    }
+    a->final[s] = d->aceita ||
+                  (!d->aceita_fim && !a->pode_avancar && !lista_tem(a, a->listas + d->lista, n, E_BYTES));
+    return s;
+}
+
+/// @brief Calcula a transição de um estado com um byte e guarda-a.
+/// @return Estado seguinte, ou -1 se faltar memória.
+/// @details Se a cache passar do limite, é esvaziada antes de criar o
+/// estado seguinte (a transição de s perde-se com ela).
+static int transita(automato *a, int s, unsigned char c) {
+    const expressao *e = a->e;
+    const estado_dfa *d = &a->estados[s];
+    int sementes_max = d->num + 1, n = 0, m, t;
+    int *sementes = malloc(sementes_max * sizeof(int));
+
+    if (sementes == NULL) {
+        return -1;
+    }
+    for (int i = 0; i < d->num; i++) {
+        const estado_nfa *x = &e->estados[a->listas[d->lista + i]];
+
+        if (x->tipo == E_BYTES && conjunto_tem(&e->conjuntos[x->conjunto], c)) {
+            sementes[n++] = x->x;
+        }
+    }
+    sementes[n++] = e->inicio;
+    m = fecho(a, sementes, n, 0, 0);
+    free(sementes);
+
+    if (memoria_automato(a) > AUTOMATO_MEMORIA) {
+        int *copia = malloc((m > 0 ? m : 1) * sizeof(int));
+
+        if (copia == NULL) {
+            return -1;
+        }
+        memcpy(copia, a->lista, m * sizeof(int));
+        esvazia(a);
+        a->inicio_linha = estado_de(a, a->lista, fecho(a, &e->inicio, 1, 1, 0), 1);
+        t = a->inicio_linha == -1 ? -1 : estado_de(a, copia, m, 0);
+        free(copia);
+        return t;
+    }
+    t = estado_de(a, a->lista, m, 0);
+    if (t != -1) {
+        a->transicoes[(size_t)s * e->num_classes + e->classe[c]] = t;
+    }
+    return t;
+}
+
+/// @brief Cria um autómato para uma thread.
+/// @param e Expressão.
+/// @return Autómato, ou NULL se faltar memória.
+automato *automato_cria(const expressao *e) {
+    automato *a = calloc(1, sizeof(automato));
+
+    if (a == NULL) {
+        return NULL;
+    }
+    a->e = e;
+    a->cap_estados = 16;
+    a->cap_listas = 256;
+    a->cap_tabela = 64;
+    a->estados = malloc(a->cap_estados * sizeof(estado_dfa));
+    a->transicoes = malloc((size_t)a->cap_estados * e->num_classes * sizeof(int32_t));
+    a->final = malloc(a->cap_estados);
+    a->listas = malloc(a->cap_listas * sizeof(int));
+    a->tabela = malloc(a->cap_tabela * sizeof(int));
+    a->pilha = malloc(e->num_estados * sizeof(int));
+    a->lista = malloc(e->num_estados * sizeof(int));
+    a->marca = calloc(e->num_estados, sizeof(unsigned));
+    if (a->estados == NULL || a->transicoes == NULL || a->final == NULL || a->listas == NULL ||
+        a->tabela == NULL || a->pilha == NULL || a->lista == NULL || a->marca == NULL) {
+        automato_liberta(a);
+        return NULL;
+    }
+    esvazia(a);
+
+    // Sem ^, o fecho do estado inicial fora do início da linha consome bytes
+    // e nenhum estado fica sem saída
+    a->pode_avancar = lista_tem(a, a->lista, fecho(a, &e->inicio, 1, 0, 0), E_BYTES);
+    a->inicio_linha = estado_de(a, a->lista, fecho(a, &e->inicio, 1, 1, 0), 1);
+    if (a->inicio_linha == -1) {
+        automato_liberta(a);
+        return NULL;
+    }
+    return a;
+}
+
+/// @brief Liberta um autómato.
+/// @param a Autómato.
+void automato_liberta(automato *a) {
+    if (a == NULL) {
+        return;
+    }
+    free(a->estados);
+    free(a->transicoes);
+    free(a->final);
+    free(a->listas);
+    free(a->tabela);
+    free(a->pilha);
+    free(a->lista);
+    free(a->marca);
+    free(a);
+}
+
+/// @brief Indica se uma linha contém alguma correspondência da expressão.
+/// @param a Autómato.
+/// @param linha Início da linha.
+/// @param n Tamanho da linha, sem o '\\n'.
+/// @return 1 se corresponde, 0 se não corresponde, -1 se faltar memória.
+/// @details O ciclo só faz uma consulta à tabela por byte; a transição só é
+/// calculada na primeira vez que é usada.
+int automato_linha(automato *a, const unsigned char *linha, size_t n) {
+    const unsigned char *classe = a->e->classe;
+    size_t ncls = a->e->num_classes;
+    int s = a->inicio_linha;
+
+    for (size_t i = 0; i < n && !a->final[s]; i++) {
+        int32_t t = a->transicoes[s * ncls + classe[linha[i]]];
+
+        if (t < 0) {
+            t = transita(a, s, linha[i]);
+            if (t < 0) {
+                return -1;
+            }
+        }
+        s = t;
+    }
+    return a->final[s] ? a->estados[s].aceita : a->estados[s].aceita_fim;
+}
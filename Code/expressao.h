@@ -0,0 +1,111 @@
+/**
+ * @file expressao.h
+ * @brief Expressões regulares (ERE do POSIX) compiladas para um autómato
+ * finito determinístico construído à medida que é usado.
+ *
+ * A expressão é analisada para uma árvore, compilada para um NFA de Thompson
+ * e simulada por um DFA preguiçoso: cada estado do DFA (um conjunto de
+ * estados do NFA) e cada transição só são calculados na primeira vez que são
+ * precisos, e ficam guardados. Os bytes são agrupados em classes que a
+ * expressão não distingue, por isso cada estado tem uma tabela pequena.
+ *
+ * O NFA é partilhado e só de leitura; cada thread usa o seu próprio
+ * autómato (a cache de estados do DFA). Se a cache passar de
+ * AUTOMATO_MEMORIA bytes, é esvaziada e volta a encher-se.
+ *
+ * A sintaxe é a do `grep -E`: `.`, `[...]` (com intervalos, `^` e as classes
+ * `[:alpha:]`, `[:digit:]`, `[:alnum:]`, `[:space:]`, `[:upper:]`,
+ * `[:lower:]`, `[:punct:]` e `[:xdigit:]`), `*`, `+`, `?`, `{m}`, `{m,}`,
+ * `{m,n}`, `|`, `(...)`, `^`, `$` e `\` antes de um carácter especial, mais
+ * `\d`, `\w` e `\s`. Não há referências para trás nem outros escapes (`\b`,
+ * `\<`, ... são um erro). O texto é UTF-8: `.`, as classes negadas e os
+ * caracteres não ASCII, dentro ou fora de uma classe, correspondem a uma
+ * sequência UTF-8 inteira (compilada como alternativas de intervalos de
+ * bytes); nenhum inclui o '\\n'. As classes com nome, `\d`, `\w` e `\s`
+ * só contêm caracteres ASCII.
+ *
+ * @date 2025
+ */
+
+#ifndef EXPRESSAO_H
+#define EXPRESSAO_H
+
+#include <stddef.h>
+
+/// Cada padrão é um texto literal (como `grep -F`), não uma expressão.
+#define EXPRESSAO_LITERAL 1
+
+/// Ignorar maiúsculas e minúsculas (só nas letras ASCII).
+#define EXPRESSAO_SEM_MAIUSCULAS 2
+
+/// Memória máxima da cache de estados de um autómato.
+#define AUTOMATO_MEMORIA (8UL << 20)
+
+/// Número máximo de literais devolvidos por expressao_literais.
+#define EXPRESSAO_MAX_LITERAIS 64
+
+/// @brief Expressão compilada (NFA), partilhada por todas as threads.
+typedef struct expressao expressao;
+
+/// @brief Cache de estados do DFA de uma expressão, usada por uma só thread.
+typedef struct automato automato;
+
+/**
+ * @brief Literais que aparecem em todas as linhas que correspondem a uma
+ * expressão, para procurar candidatos sem correr o autómato.
+ */
+typedef struct {
+    int num;                                        ///< 0 se não houver literais úteis
+    const unsigned char *texto[EXPRESSAO_MAX_LITERAIS];
+    size_t tamanho[EXPRESSAO_MAX_LITERAIS];
+    int exata;              ///< 1 se conter um dos literais bastar para corresponder
+    int sem_maiusculas;     ///< os literais estão em minúsculas e a comparação ignora a caixa
+} literais_expressao;
+
+/**
+ * @brief Compila um ou mais padrões (uma linha corresponde se corresponder a algum).
+ * @param padroes Padrões.
+ * @param n Número de padrões (pelo menos 1).
+ * @param opcoes EXPRESSAO_LITERAL e/ou EXPRESSAO_SEM_MAIUSCULAS.
+ * @param erro Buffer para a descrição do erro.
+ * @param tamanho_erro Tamanho do buffer.
+ * @return Expressão compilada, ou NULL se algum padrão for inválido.
+ */
+expressao *expressao_compila(char *padroes[], int n, int opcoes, char *erro, size_t tamanho_erro);
+
+/**
+ * @brief Liberta uma expressão (depois de libertar os seus autómatos).
+ * @param e Expressão.
+ */
+void expressao_liberta(expressao *e);
+
+/**
+ * @brief Devolve os literais obrigatórios da expressão.
+ * @param e Expressão.
+ * @return Literais (válidos enquanto a expressão existir).
+ */
+const literais_expressao *expressao_literais(const expressao *e);
+
+/**
+ * @brief Cria um autómato (cache de estados do DFA) para uma thread.
+ * @param e Expressão.
+ * @return Autómato, ou NULL se faltar memória.
+ */
+automato *automato_cria(const expressao *e);
+
+/**
+ * @brief Liberta um autómato.
+ * @param a Autómato.
+ */
+void automato_liberta(automato *a);
+
+/**
+ * @brief Indica se uma linha contém alguma correspondência da expressão.
+ * @param a Autómato.
+ * @param linha Início da linha.
+ * @param n Tamanho da linha, sem o '\\n'.
+ * @return 1 se corresponde, 0 se não corresponde, -1 se faltar memória.
+ */
+int automato_linha(automato *a, const unsigned char *linha, size_t n);
+
+#endif // EXPRESSAO_H
@@ -0,0 +1,225 @@
+/**
+ * @file fuzz_analisador.c
+ * @brief Fuzzing do analisador da linha de comandos.
+ *
+ * LLVMFuzzerTestOneInput serve ao libFuzzer (clang -fsanitize=fuzzer
+ * -DLIBFUZZER). Sem libFuzzer, o main deste ficheiro gera entradas
+ * aleatórias e mutações de um conjunto de linhas, ou analisa os ficheiros
+ * indicados, e corre com AddressSanitizer e UBSan (make fuzz).
+ *
+ * Em cada entrada verifica-se que a análise termina sem erros de memória,
+ * que as palavras têm o número de tokens indicado e que a expansão das
+ * variáveis funciona nos comandos sem padrões (os padrões não são expandidos,
+ * para o fuzzing não percorrer o sistema de ficheiros). A entrada é também
+ * usada como par padrão/nome (separados no primeiro '\n'): o resultado de
+ * padrao_corresponde tem de ser igual ao do fnmatch(3) quando os dois são
+ * ASCII sem '\\' e sem '/'.
+ *
+ * Utilização: fuzz_analisador [iterações | ficheiro...]
+ *
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fnmatch.h>
+#include "analisador.h"
+#include "padroes.h"
+
+/// @brief Compara padrao_corresponde com o fnmatch num par padrão/nome.
+static void compara_fnmatch(const char *dados, size_t n) {
+    const char *fim = memchr(dados, '\n', n);
+    char padrao[128], nome[128];
+    size_t np, nn;
+    padrao_compilado p;
+
+    if (fim == NULL) {
+        return;
+    }
+    np = fim - dados;
+    nn = n - np - 1;
+    if (np >= sizeof(padrao) || nn >= sizeof(nome) || nn == 0) {
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        unsigned char c = dados[i];
+        if (dados + i != fim && (c < 0x20 || c >= 0x7F || c == '\\' || c == '/')) {
+            return;
+        }
+    }
+    memcpy(padrao, dados, np);
+    padrao[np] = '\0';
+    memcpy(nome, fim + 1, nn);
+    nome[nn] = '\0';
+    // [.x.], [=x=] e [:classe:] dentro de classes não são suportados
+    if (strstr(padrao, "[.") != NULL || strstr(padrao, "[=") != NULL || strstr(padrao, "[:") != NULL) {
+        return;
+    }
+
+    padrao_compila(padrao, np, &p);
+    if (p.valido && padrao_corresponde(&p, nome) != (fnmatch(padrao, nome, FNM_PERIOD) == 0)) {
+        fprintf(stderr, "padrão '%s', nome '%s': %d (fnmatch: %d)\n",
+                padrao, nome, padrao_corresponde(&p, nome), fnmatch(padrao, nome, FNM_PERIOD) == 0);
+        abort();
+    }
+}
+
+/// @brief Analisa uma entrada e verifica o resultado.
+int LLVMFuzzerTestOneInput(const uint8_t *dados, size_t n) {
+    arena a = ARENA_VAZIA, argumentos = ARENA_VAZIA;
+    analise res;
+    size_t tokens = 0;
+
+    if (analisa_comandos((const char *)dados, n, &a, &res) == ANALISE_OK) {
+        for (const comando_analisado *c = res.comandos; c != NULL; c = c->seguinte) {
+            char **args;
+            int i = 0, padroes = 0;
+
+            for (const palavra *p = c->palavras; p != NULL; p = p->seguinte) {
+                padroes |= p->padrao;
+            }
+            if (padroes) {
+                tokens += c->num_palavras;
+                continue;
+            }
+            args = expande_argumentos(c, &argumentos, 0);
+
+            if (args == NULL) {
+                abort();
+            }
+            while (args[i] != NULL) {
+                i++;
+            }
+            if (i != c->num_palavras) {
+                abort();
+            }
+            tokens += i;
+            arena_reinicia(&argumentos);
+        }
+        // Os separadores também contam como tokens
+        if (tokens > res.num_tokens) {
+            abort();
+        }
+    }
+    arena_liberta(&a);
+    arena_liberta(&argumentos);
+    compara_fnmatch((const char *)dados, n);
+    return 0;
+}
+
+#ifndef LIBFUZZER
+
+/// Linhas de partida para as mutações.
+static const char *sementes[] = {
+    "echo 'a b' \"c $HOME\" d\\ e",
+    "ls -l | wc -l > saida; mostra saida",
+    "false && echo nao || echo \"sim $?\"",
+    "copia a b &",
+    "echo ${PATH}x $ \\\n continua # comentario",
+    "mostra < entrada >> saida",
+    "echo \"aspas\nem duas linhas\" '|' \\| \"\\$X\"",
+    "a &&\nb ||\nc |\nd",
+    "*.c\nmain.c",
+    "[a-c]?*[!x]\nbanana",
+    "*a*b*c\nxaybzc",
+    ".*\n.bashrc",
+};
+
+/// Caracteres com significado para o analisador (escolhidos com mais frequência).
+static const char especiais[] = " \t\n'\"\\$?{}#;&|<>\x01*[]!-.ab";
+
+static unsigned int semente_aleatoria = 1;
+
+static unsigned int aleatorio(void) {
+    semente_aleatoria = semente_aleatoria * 1103515245 + 12345;
+    return semente_aleatoria >> 16;
+}
+
+/// @brief Gera uma entrada: mutação de uma semente ou texto aleatório.
+static size_t gera(char *buf, size_t max) {
+    size_t n;
+
+    if (aleatorio() % 2 == 0) {
+        const char *s = sementes[aleatorio() % (sizeof(sementes) / sizeof(sementes[0]))];
+
+        n = strlen(s);
+        memcpy(buf, s, n);
+        for (unsigned int m = aleatorio() % 8; m > 0 && n > 0; m--) {
+            size_t pos = aleatorio() % n;
+
+            switch (aleatorio() % 3) {
+                case 0:         // substituir
+                    buf[pos] = especiais[aleatorio() % (sizeof(especiais) - 1)];
+                    break;
+                case 1:         // inserir
+                    if (n < max) {
+                        memmove(buf + pos + 1, buf + pos, n - pos);
+                        buf[pos] = especiais[aleatorio() % (sizeof(especiais) - 1)];
+                        n++;
+                    }
+                    break;
+                default:        // apagar
+                    memmove(buf + pos, buf + pos + 1, n - pos - 1);
+                    n--;
+                    break;
+            }
+        }
+    } else {
+        n = aleatorio() % max;
+        for (size_t i = 0; i < n; i++) {
+            buf[i] = aleatorio() % 4 == 0 ? (char)aleatorio() : especiais[aleatorio() % (sizeof(especiais) - 1)];
+        }
+    }
+    return n;
+}
+
+int main(int argc, char *argv[]) {
+    char buf[512];
+    long iteracoes = 200000;
+
+    if (argc > 1 && strspn(argv[1], "0123456789") != strlen(argv[1])) {
+        // Ficheiros indicados (por exemplo, casos encontrados pelo libFuzzer)
+        for (int i = 1; i < argc; i++) {
+            FILE *f = fopen(argv[i], "rb");
+            char *dados;
+            long n;
+
+            if (f == NULL) {
+                perror(argv[i]);
+                return 1;
+            }
+            fseek(f, 0, SEEK_END);
+            n = ftell(f);
+            rewind(f);
+            dados = malloc(n > 0 ? n : 1);
+            if (dados == NULL || fread(dados, 1, n, f) != (size_t)n) {
+                fprintf(stderr, "%s: erro de leitura\n", argv[i]);
+                return 1;
+            }
+            fclose(f);
+            LLVMFuzzerTestOneInput((const uint8_t *)dados, n);
+            free(dados);
+        }
+        printf("%d ficheiros analisados sem erros\n", argc - 1);
+        return 0;
+    }
+
+    if (argc > 1) {
+        iteracoes = atol(argv[1]);
+    }
+    for (long i = 0; i < iteracoes; i++) {
+        size_t n = gera(buf, sizeof(buf));
+        // Cópia exata para o ASan detetar leituras depois do fim
+        char *dados = malloc(n > 0 ? n : 1);
+
+        memcpy(dados, buf, n);
+        LLVMFuzzerTestOneInput((const uint8_t *)dados, n);
+        free(dados);
+    }
+    printf("%ld entradas analisadas sem erros\n", iteracoes);
+    return 0;
+}
+
+#endif // LIBFUZZER
@@ -0,0 +1,246 @@
+/**
+ * @file indice_linhas.c
+ * @brief Implementação do índice esparso de linhas.
+ *
+ * As linhas entre duas posições do índice são contadas em blocos com os
+ * kernels SIMD da contagem; só no bloco onde está a posição seguinte é que
+ * o memchr procura as quebras de linha uma a uma.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "indice_linhas.h"
+#include "contagem.h"
+
+/// Número de ficheiros guardados na cache.
+#define MAX_INDICES 16
+
+/// Tamanho dos blocos contados de uma só vez.
+#define BLOCO_INDICE (64 * 1024)
+
+/// @brief Índice de um ficheiro.
+typedef struct {
+    dev_t dispositivo;
+    ino_t inode;
+    struct timespec modificacao;
+    off_t tamanho;
+    pthread_mutex_t trinco;         ///< protege as posições
+    size_t *posicoes;               ///< posicoes[k]: início da linha k * INDICE_INTERVALO + 1
+    size_t num_posicoes, capacidade;
+    int completo;                   ///< o índice já chegou ao fim do ficheiro
+    int utilizadores;               ///< threads a usar o índice (não pode ser substituído)
+    unsigned long long ultimo_uso;
+} indice_ficheiro;
+
+static indice_ficheiro cache[MAX_INDICES];
+static int num_indices = 0;
+static unsigned long long relogio = 0;
+static pthread_mutex_t trinco_cache = PTHREAD_MUTEX_INITIALIZER;
+
+/// @brief Verifica se um índice corresponde ao ficheiro.
+static int mesmo_ficheiro(const indice_ficheiro *ind, const struct stat *st) {
+    return ind->dispositivo == st->st_dev && ind->inode == st->st_ino &&
+           ind->modificacao.tv_sec == st->st_mtim.tv_sec &&
+           ind->modificacao.tv_nsec == st->st_mtim.tv_nsec &&
+           ind->tamanho == st->st_size;
+}
+
+/// @brief Obtém o índice de um ficheiro, criando-o (ou substituindo o
+/// menos usado) se não estiver na cache.
+/// @return Índice marcado como em uso, ou NULL se todos estiverem em uso.
+static indice_ficheiro *obtem_indice(const struct stat *st) {
+    indice_ficheiro *ind = NULL;
+
+    pthread_mutex_lock(&trinco_cache);
+    for (int i = 0; i < num_indices; i++) {
+        if (mesmo_ficheiro(&cache[i], st)) {
+            ind = &cache[i];
+            break;
+        }
+    }
+    if (ind == NULL) {
+        if (num_indices < MAX_INDICES) {
+            ind = &cache[num_indices++];
+            pthread_mutex_init(&ind->trinco, NULL);
+        } else {
+            // Substituir o índice há mais tempo sem uso que não esteja em uso
+            for (int i = 0; i < MAX_INDICES; i++) {
+                if (cache[i].utilizadores == 0 &&
+                    (ind == NULL || cache[i].ultimo_uso < ind->ultimo_uso)) {
+                    ind = &cache[i];
+                }
+            }
+            if (ind == NULL) {
+                pthread_mutex_unlock(&trinco_cache);
+                return NULL;
+            }
+            free(ind->posicoes);
+        }
+        ind->dispositivo = st->st_dev;
+        ind->inode = st->st_ino;
+        ind->modificacao = st->st_mtim;
+        ind->tamanho = st->st_size;
+        ind->posicoes = NULL;
+        ind->num_posicoes = 0;
+        ind->capacidade = 0;
+        ind->completo = 0;
+    }
+    ind->utilizadores++;
+    ind->ultimo_uso = ++relogio;
+    pthread_mutex_unlock(&trinco_cache);
+    return ind;
+}
+
+/// @brief Deixa de usar um índice.
+static void larga_indice(indice_ficheiro *ind) {
+    pthread_mutex_lock(&trinco_cache);
+    ind->utilizadores--;
+    pthread_mutex_unlock(&trinco_cache);
+}
+
+/// @brief Avança n quebras de linha a partir de uma posição.
+/// @param mapa Conteúdo do ficheiro.
+/// @param tamanho Tamanho do ficheiro.
+/// @param pos Posição inicial.
+/// @param n Número de linhas a saltar.
+/// @param falta Linhas que não foi possível saltar por o ficheiro acabar.
+/// @return Posição a seguir à n-ésima quebra de linha (ou o tamanho).
+static size_t avanca_linhas(const unsigned char *mapa, size_t tamanho, size_t pos,
+                            unsigned long long n, unsigned long long *falta) {
+    // Blocos inteiros sem a quebra de linha procurada: contar com SIMD
+    while (n > 0 && pos < tamanho) {
+        size_t bloco = tamanho - pos < BLOCO_INDICE ? tamanho - pos : BLOCO_INDICE;
+        contagem c = { 0, 0, 0 };
+        int em_palavra = 0;
+
+        contagem_bloco(mapa + pos, bloco, &c, &em_palavra);
+        if (c.linhas >= n) {
+            break;
+        }
+        n -= c.linhas;
+        pos += bloco;
+    }
+    // Bloco onde a linha termina: procurar as quebras uma a uma
+    while (n > 0 && pos < tamanho) {
+        const unsigned char *q = memchr(mapa + pos, '\n', tamanho - pos);
+        if (q == NULL) {
+            pos = tamanho;
+            break;
+        }
+        pos = q - mapa + 1;
+        n--;
+    }
+    *falta = n;
+    return pos;
+}
+
+/// @brief Acrescenta posições ao índice até cobrir a posição k (ou o fim do ficheiro).
+static void estende_indice(indice_ficheiro *ind, const unsigned char *mapa, size_t k) {
+    if (ind->num_posicoes == 0) {
+        ind->capacidade = 64;
+        ind->posicoes = malloc(ind->capacidade * sizeof(size_t));
+        if (ind->posicoes == NULL) {
+            ind->capacidade = 0;
+            return;
+        }
+        ind->posicoes[ind->num_posicoes++] = 0;
+    }
+    while (ind->num_posicoes <= k && !ind->completo) {
+        unsigned long long falta;
+        size_t pos = avanca_linhas(mapa, ind->tamanho, ind->posicoes[ind->num_posicoes - 1],
+                                   INDICE_INTERVALO, &falta);
+
+        if (falta > 0 || pos == (size_t)ind->tamanho) {
+            ind->completo = 1;
+            if (falta > 0) {
+                break;
+            }
+        }
+        if (ind->num_posicoes == ind->capacidade) {
+            size_t *novas = realloc(ind->posicoes, ind->capacidade * 2 * sizeof(size_t));
+            if (novas == NULL) {
+                return;
+            }
+            ind->posicoes = novas;
+            ind->capacidade *= 2;
+        }
+        ind->posicoes[ind->num_posicoes++] = pos;
+    }
+}
+
+/// @brief Procura o início de uma linha num ficheiro mapeado.
+/// @param st Informação do ficheiro.
+/// @param mapa Conteúdo do ficheiro.
+/// @param linha Número da linha (1 é a primeira).
+/// @return Posição da linha, ou o tamanho do ficheiro se não existir.
+/// @details Usa a posição guardada mais próxima antes da linha e salta no
+/// máximo INDICE_INTERVALO - 1 linhas a partir dela.
+size_t indice_linhas_procura(const struct stat *st, const unsigned char *mapa, unsigned long long linha) {
+    size_t tamanho = st->st_size, k, pos = 0;
+    unsigned long long resto, falta;
+    indice_ficheiro *ind;
+
+    if (linha <= 1) {
+        return 0;
+    }
+    k = (linha - 1) / INDICE_INTERVALO;
+    resto = (linha - 1) % INDICE_INTERVALO;
+
+    ind = obtem_indice(st);
+    if (ind == NULL) {
+        // Cache cheia de índices em uso: procurar sem índice
+        pos = avanca_linhas(mapa, tamanho, 0, linha - 1, &falta);
+        return falta > 0 ? tamanho : pos;
+    }
+    pthread_mutex_lock(&ind->trinco);
+    estende_indice(ind, mapa, k);
+    if (ind->num_posicoes > k) {
+        pos = ind->posicoes[k];
+    } else if (ind->completo) {
+        pos = tamanho;
+        resto = 0;
+    } else {
+        // Sem memória para o índice: continuar a partir da última posição
+        k = ind->num_posicoes > 0 ? ind->num_posicoes - 1 : 0;
+        pos = ind->num_posicoes > 0 ? ind->posicoes[k] : 0;
+        resto = linha - 1 - (unsigned long long)k * INDICE_INTERVALO;
+    }
+    pthread_mutex_unlock(&ind->trinco);
+    larga_indice(ind);
+
+    pos = avanca_linhas(mapa, tamanho, pos, resto, &falta);
+    return falta > 0 ? tamanho : pos;
+}
+
+/// @brief Procura o início das últimas n linhas de um ficheiro mapeado.
+/// @param mapa Conteúdo do ficheiro.
+/// @param tamanho Tamanho do ficheiro.
+/// @param n Número de linhas.
+/// @return Posição da primeira das n últimas linhas.
+/// @details Só lê o fim do ficheiro: procura para trás com memrchr. A
+/// quebra de linha no último byte não conta como início de uma linha nova.
+size_t indice_linhas_fim(const unsigned char *mapa, size_t tamanho, unsigned long long n) {
+    size_t fim = tamanho;
+
+    if (n == 0) {
+        return tamanho;
+    }
+    if (fim > 0 && mapa[fim - 1] == '\n') {
+        fim--;
+    }
+    while (fim > 0) {
+        const unsigned char *q = memrchr(mapa, '\n', fim);
+        if (q == NULL) {
+            return 0;
+        }
+        if (--n == 0) {
+            return q - mapa + 1;
+        }
+        fim = q - mapa;
+    }
+    return 0;
+}
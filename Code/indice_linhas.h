@@ -0,0 +1,46 @@
+/**
+ * @file indice_linhas.h
+ * @brief Índice esparso de linhas de ficheiros mapeados em memória.
+ *
+ * Para cada ficheiro é guardada a posição do início de uma linha em cada
+ * INDICE_INTERVALO. O índice é construído à medida que é preciso (só até à
+ * linha pedida) e fica numa cache identificada pelo dispositivo, i-node,
+ * data de modificação e tamanho do ficheiro, por isso um segundo acesso ao
+ * mesmo ficheiro salta diretamente para perto da linha pedida.
+ *
+ * @date 2025
+ */
+
+#ifndef INDICE_LINHAS_H
+#define INDICE_LINHAS_H
+
+#include <stddef.h>
+#include <sys/stat.h>
+
+/// Número de linhas entre duas posições guardadas no índice.
+#define INDICE_INTERVALO 4096
+
+/**
+ * @brief Procura o início de uma linha num ficheiro mapeado.
+ *
+ * Pode ser chamada em simultâneo por várias threads.
+ * @param st Informação do ficheiro (identifica o índice na cache).
+ * @param mapa Conteúdo do ficheiro (st->st_size bytes).
+ * @param linha Número da linha (1 é a primeira).
+ * @return Posição do primeiro byte da linha, ou st->st_size se o ficheiro
+ * tiver menos linhas.
+ */
+size_t indice_linhas_procura(const struct stat *st, const unsigned char *mapa, unsigned long long linha);
+
+/**
+ * @brief Procura o início das últimas linhas de um ficheiro mapeado.
+ *
+ * Percorre o ficheiro de trás para a frente, sem usar o índice.
+ * @param mapa Conteúdo do ficheiro.
+ * @param tamanho Tamanho do ficheiro.
+ * @param n Número de linhas.
+ * @return Posição do primeiro byte da primeira das n últimas linhas.
+ */
+size_t indice_linhas_fim(const unsigned char *mapa, size_t tamanho, unsigned long long n);
+
+#endif // INDICE_LINHAS_H
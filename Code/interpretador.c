@@ -1,191 +1,1151 @@
-/**
- * @file interpretador.c
- * @brief Interpretador de Linha de Comandos em C
- *
- * @mainpage Projeto de Sistemas Operativos - Interpretador de Linha de Comandos
- *
- * Este projeto tem como objetivo desenvolver um interpretador de linha de comandos simples,
- * capaz de executar comandos personalizados (como `mostra` e `lista`) e comandos do sistema Unix/Linux.
- * 
- * O interpretador funciona em ciclo contínuo até ser introduzido o comando `termina`.
- * É responsável por interpretar a linha de entrada, separar argumentos, tratar comandos inválidos,
- * executar processos (com fork e execvp) e reportar o código de saída de cada comando.
- * 
- * Funcionalidades principais:
- * - Execução de comandos personalizados
- * - Execução de comandos do sistema
- * - Gestão de processos com fork e waitpid
- * - Tratamento de erros e mensagens de ajuda
- * - Separação modular do código para facilitar manutenção e extensibilidade
- *
- * O projeto foi desenvolvido no contexto da unidade curricular de Sistemas Operativos do curso de
- * Engenharia de Sistemas Informáticos no Instituto Politécnico do Cávado e do Ave (IPCA).
- *
- * @author
- * Gonçalo Santos e Rodrigo Cruz
- * 
- * @date Maio de 2025
- */
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <unistd.h>
-#include <sys/wait.h>
-#include "comandos_ficheiros.h"
-
-#define MAX_COMMAND_LENGTH 1024
-#define MAX_ARGS 64
-
-/**
- * @brief Analisa uma linha de comando e separa em argumentos.
- * @param cmd String com o comando a analisar (modificada pela função).
- * @param args Array de strings onde serão colocados os argumentos.
- * @return Número de argumentos encontrados.
- */
-int parse_command(char *cmd, char *args[]) {
-    int i = 0;
-    char *token;
-    
-    // Remover o caractere de nova linha do final, se existir
-    size_t len = strlen(cmd);
-    if (len > 0 && cmd[len-1] == '\n') {
-        cmd[len-1] = '\0';
-    }
-    
-    // Tokenizar a string por espaços
-    token = strtok(cmd, " ");
-    while (token != NULL && i < MAX_ARGS - 1) {
-        args[i++] = token;
-        token = strtok(NULL, " ");
-    }
-    args[i] = NULL;  // O último argumento deve ser NULL para exec
-    
-    return i;  // Retorna o número de argumentos
-}
-
-/**
- * @brief Executa um comando personalizado, se existir.
- * @param args Array de argumentos do comando.
- * @return Código de retorno do comando executado, ou -1 se não for personalizado.
- */
-int execute_custom_command(char *args[]) {
-    if (args[0] == NULL) {
-        return 0;
-    }
-    
-    // Verificar qual comando foi solicitado
-    if (strcmp(args[0], "mostra") == 0) {
-        if (args[1] == NULL) {
-            fprintf(stderr, "Erro: O comando 'mostra' requer um nome de ficheiro.\n");
-            return 1;
-        }
-        return mostra(args[1]);
-    }
-    else if (strcmp(args[0], "copia") == 0) {
-        if (args[1] == NULL) {
-            fprintf(stderr, "Erro: O comando 'copia' requer um nome de ficheiro.\n");
-            return 1;
-        }
-        return copia(args[1]);
-    }
-    else if (strcmp(args[0], "acrescenta") == 0) {
-        if (args[1] == NULL || args[2] == NULL) {
-            fprintf(stderr, "Erro: O comando 'acrescenta' requer dois nomes de ficheiros.\n");
-            return 1;
-        }
-        return acrescenta(args[1], args[2]);
-    }
-    else if (strcmp(args[0], "conta") == 0) {
-        if (args[1] == NULL) {
-            fprintf(stderr, "Erro: O comando 'conta' requer um nome de ficheiro.\n");
-            return 1;
-        }
-        return conta(args[1]);
-    }
-    else if (strcmp(args[0], "apaga") == 0) {
-        if (args[1] == NULL) {
-            fprintf(stderr, "Erro: O comando 'apaga' requer um nome de ficheiro.\n");
-            return 1;
-        }
-        return apaga(args[1]);
-    }
-    else if (strcmp(args[0], "informa") == 0) {
-        if (args[1] == NULL) {
-            fprintf(stderr, "Erro: O comando 'informa' requer um nome de ficheiro.\n");
-            return 1;
-        }
-        return informa(args[1]);
-    }
-    else if (strcmp(args[0], "lista") == 0) {
-        return lista(args[1]);  // args[1] pode ser NULL, a função trata isso
-    }
-    else {
-        // Se não for um comando personalizado, retorna -1
-        return -1;
-    }
-}
-
-/**
- * @brief Função principal do interpretador.
- * @return 0 ao terminar.
- */
-int main() {
-    char command[MAX_COMMAND_LENGTH];
-    char *args[MAX_ARGS];
-    pid_t pid;
-    int status;
-    
-    while (1) {
-        // Mostrar o prompt
-        printf("%% ");
-        fflush(stdout);
-        
-        // Ler o comando
-        if (fgets(command, MAX_COMMAND_LENGTH, stdin) == NULL) {
-            break;  // Sair se EOF (Ctrl+D)
-        }
-        
-        // Analisar o comando
-        parse_command(command, args);
-        
-        // Verificar se o comando é "termina"
-        if (args[0] != NULL && strcmp(args[0], "termina") == 0) {
-            break;
-        }
-        
-        // Tentar executar como comando personalizado
-        int result = execute_custom_command(args);
-        
-        if (result >= 0) {
-            // Foi um comando personalizado
-            printf("Terminou comando %s com código %d\n", args[0], result);
-        } else {
-            // Não é um comando personalizado, executar como comando do sistema
-            pid = fork();
-            
-            if (pid < 0) {
-                fprintf(stderr, "Erro: Falha ao criar um novo processo.\n");
-                continue;
-            } else if (pid == 0) {
-                // Processo filho executa o comando
-                execvp(args[0], args);
-                
-                // Se chegar aqui, houve um erro na execução
-                fprintf(stderr, "Erro: Comando '%s' não encontrado. Use 'termina' para sair.\n", args[0]);
-                exit(1);
-            } else {
-                // Processo pai espera pelo filho terminar
-                waitpid(pid, &status, 0);
-                
-                if (WIFEXITED(status)) {
-                    printf("Terminou comando %s com código %d\n", args[0], WEXITSTATUS(status));
-                } else {
-                    printf("Comando %s terminou de forma anormal\n", args[0]);
-                }
-            }
-        }
-    }
-    
-    return 0;
-}
\ No newline at end of file
+/**
+ * @file interpretador.c
+ * @brief Interpretador de Linha de Comandos em C
+ *
+ * @mainpage Projeto de Sistemas Operativos - Interpretador de Linha de Comandos
+ *
+ * Este projeto tem como objetivo desenvolver um interpretador de linha de comandos simples,
+ * capaz de executar comandos personalizados (como `mostra` e `lista`) e comandos do sistema Unix/Linux.
+ * 
+ * O interpretador funciona em ciclo contínuo até ser introduzido o comando `termina`.
+ * É responsável por interpretar a linha de entrada, separar argumentos, tratar comandos inválidos,
+ * executar processos (com fork e execvp) e reportar o código de saída de cada comando.
+ * 
+ * Funcionalidades principais:
+ * - Execução de comandos personalizados
+ * - Execução de comandos do sistema
+ * - Gestão de processos com fork e waitpid
+ * - Tratamento de erros e mensagens de ajuda
+ * - Separação modular do código para facilitar manutenção e extensibilidade
+ *
+ * O projeto foi desenvolvido no contexto da unidade curricular de Sistemas Operativos do curso de
+ * Engenharia de Sistemas Informáticos no Instituto Politécnico do Cávado e do Ave (IPCA).
+ *
+ * @author
+ * Gonçalo Santos e Rodrigo Cruz
+ * 
+ * @date Maio de 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <signal.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include "comandos_ficheiros.h"
+#include "expressao.h"
+#include "tabela_comandos.h"
+#include "cache_path.h"
+#include "lancamento.h"
+#include "pipeline.h"
+#include "trabalhos.h"
+#include "durabilidade.h"
+#include "anel_es.h"
+#include "analisador.h"
+#include "saida.h"
+#include "perfil.h"
+#include "servidor.h"
+#include "paralelo.h"
+#include "pool_threads.h"
+
+/// Valor devolvido por executa_comando quando o comando é "termina".
+#define COMANDO_TERMINA -2
+
+/// Uso do comando procura (também mostrado nos erros das opções).
+#define USO_PROCURA "procura [-i] [-v] [-c] [-l] [-n] [-F|-E] [-e padrão]... [-j N] [--stats] padrão [ficheiro...]"
+
+/// Uso do comando paralelo.
+#define USO_PARALELO "paralelo [-j N] [-k] [--stats] <comando> [argumento...] ::: <valor>..."
+
+/// Código de saída do último comando executado (o valor de $?); no modo
+/// servidor cada worker tem o seu.
+static __thread int ultimo_codigo = 0;
+
+/**
+ * @brief Lê um intervalo "A:B", "A:", ":B" ou "A".
+ * @param texto Texto do intervalo.
+ * @param inicio Valor antes dos dois pontos (omisso: omissao_inicio).
+ * @param fim Valor depois dos dois pontos (omisso: ULLONG_MAX; sem ':' é igual a inicio).
+ * @param omissao_inicio Início usado quando não é indicado.
+ * @return 0 em caso de sucesso, -1 se o texto não for um intervalo válido.
+ */
+static int le_intervalo(const char *texto, unsigned long long *inicio, unsigned long long *fim,
+                        unsigned long long omissao_inicio) {
+    char *resto;
+
+    *inicio = omissao_inicio;
+    *fim = ULLONG_MAX;
+    if (*texto != ':') {
+        if (*texto < '0' || *texto > '9') {
+            return -1;
+        }
+        *inicio = strtoull(texto, &resto, 10);
+        if (*resto == '\0') {
+            *fim = *inicio;
+            return 0;
+        }
+        texto = resto;
+    }
+    if (*texto++ != ':') {
+        return -1;
+    }
+    if (*texto != '\0') {
+        if (*texto < '0' || *texto > '9') {
+            return -1;
+        }
+        *fim = strtoull(texto, &resto, 10);
+        if (*resto != '\0') {
+            return -1;
+        }
+    }
+    return *fim < *inicio ? -1 : 0;
+}
+
+/**
+ * @brief Lê um inteiro decimal dentro de um intervalo.
+ * @param texto Texto do número (todo ele tem de ser o número).
+ * @param minimo Menor valor aceite.
+ * @param maximo Maior valor aceite.
+ * @param valor Posto com o número lido.
+ * @return 0 em caso de sucesso, -1 se o texto não for um inteiro no intervalo.
+ */
+static int le_inteiro(const char *texto, long minimo, long maximo, int *valor) {
+    char *resto;
+    long lido;
+
+    errno = 0;
+    lido = strtol(texto, &resto, 10);
+    if (resto == texto || *resto != '\0' || errno != 0 || lido < minimo || lido > maximo) {
+        return -1;
+    }
+    *valor = (int)lido;
+    return 0;
+}
+
+/**
+ * @brief Lê um número de threads (um inteiro de 1 a POOL_MAX_THREADS).
+ * @param texto Texto do número.
+ * @param num_threads Posto com o número lido.
+ * @return 0 em caso de sucesso, -1 se o texto não for um inteiro nesse intervalo.
+ */
+static int le_threads(const char *texto, int *num_threads) {
+    return le_inteiro(texto, 1, POOL_MAX_THREADS, num_threads);
+}
+
+/**
+ * @brief Lê a opção -j N (ou -jN) de um comando.
+ * @param args Argumentos do comando.
+ * @param i Posição da opção; passa para a do valor, se este vier no argumento seguinte.
+ * @param num_threads Posto com N.
+ * @return 1 se a opção é -j com um valor válido, 0 se não é a opção -j, -1 se
+ * o valor falta ou é inválido (o erro já foi escrito).
+ */
+static int le_opcao_threads(char *args[], int *i, int *num_threads) {
+    const char *valor;
+
+    if (strncmp(args[*i], "-j", 2) != 0) {
+        return 0;
+    }
+    valor = args[*i][2] != '\0' ? args[*i] + 2 : args[*i + 1];
+    if (valor == NULL) {
+        saida_erro("Erro: Falta o valor da opção '-j'.\n");
+        return -1;
+    }
+    if (le_threads(valor, num_threads) == -1) {
+        saida_erro("Erro: Valor inválido para a opção '-j': '%s' (de 1 a %d).\n", valor, POOL_MAX_THREADS);
+        return -1;
+    }
+    if (args[*i][2] == '\0') {
+        (*i)++;
+    }
+    return 1;
+}
+
+/**
+ * @brief Executa o comando 'mostra', tratando as opções -f, -n A:B, -c A:B
+ * e --tail N (sem ficheiro, mostra a entrada).
+ *
+ * Nas linhas (-n) os dois extremos estão incluídos e "-n N" é só a linha N;
+ * nos bytes (-c) o fim está excluído, por isso "-c N" é o intervalo N:N+1,
+ * só o byte N.
+ * @param args Argumentos do comando.
+ * @return Código de saída do comando.
+ */
+static int cmd_mostra(char *args[]) {
+    intervalo_mostra intervalo = { MOSTRA_TUDO, 0, ULLONG_MAX, 0 };
+    int i = 1;
+
+    for (; args[i] != NULL && args[i][0] == '-' && args[i][1] != '\0'; i++) {
+        const char *valor = args[i + 1];
+        int r = -1;
+
+        if (strcmp(args[i], "-f") == 0) {
+            intervalo.segue = 1;
+            continue;
+        }
+        if (valor == NULL) {
+            saida_erro("Erro: Falta o valor da opção '%s'.\n", args[i]);
+            return 1;
+        }
+        if (strcmp(args[i], "-n") == 0) {
+            intervalo.modo = MOSTRA_LINHAS;
+            r = le_intervalo(valor, &intervalo.inicio, &intervalo.fim, 1);
+            if (intervalo.inicio == 0) {
+                r = -1;
+            }
+        } else if (strcmp(args[i], "-c") == 0) {
+            intervalo.modo = MOSTRA_BYTES;
+            r = le_intervalo(valor, &intervalo.inicio, &intervalo.fim, 0);
+            if (r == 0 && strchr(valor, ':') == NULL && intervalo.fim < ULLONG_MAX) {
+                intervalo.fim++;        // um só valor: o byte N (o fim é excluído)
+            }
+        } else if (strcmp(args[i], "--tail") == 0) {
+            intervalo.modo = MOSTRA_FIM;
+            r = le_intervalo(valor, &intervalo.inicio, &intervalo.fim, 0);
+            r = r == 0 && intervalo.fim == intervalo.inicio ? 0 : -1;
+        } else {
+            saida_erro("Erro: Opção '%s' desconhecida. Uso: mostra [-f] [-n A:B | -c A:B | --tail N] [ficheiro]\n", args[i]);
+            return 1;
+        }
+        if (r == -1) {
+            saida_erro("Erro: Valor inválido para a opção '%s': '%s'.\n", args[i], valor);
+            return 1;
+        }
+        i++;
+    }
+    if (args[i] != NULL && args[i + 1] != NULL) {
+        saida_erro("Erro: O comando 'mostra' aceita só um ficheiro.\n");
+        return 1;
+    }
+    return mostra(args[i], &intervalo);
+}
+
+/**
+ * @brief Executa o comando 'copia'.
+ * @param args Argumentos do comando.
+ * @return Código de saída do comando.
+ */
+static int cmd_copia(char *args[]) {
+    int num_threads = 0, se_alterado = 0, i = 1, n = 0, j;
+
+    // Opções: -j N (threads para os ficheiros grandes) e --if-changed
+    for (; args[i] != NULL && args[i][0] == '-'; i++) {
+        if (strcmp(args[i], "--if-changed") == 0) {
+            se_alterado = 1;
+        } else if ((j = le_opcao_threads(args, &i, &num_threads)) != 1) {
+            if (j == 0) {
+                saida_erro("Erro: Opção '%s' desconhecida. Uso: copia [-j N] [--if-changed] <ficheiro>...\n", args[i]);
+            }
+            return 1;
+        }
+    }
+    while (args[i + n] != NULL) {
+        n++;
+    }
+    if (n == 0) {
+        saida_erro("Erro: Falta o nome do ficheiro. Uso: copia [-j N] [--if-changed] <ficheiro>...\n");
+        return 1;
+    }
+    return copia(&args[i], n, num_threads, se_alterado);
+}
+
+/**
+ * @brief Executa o comando 'acrescenta'.
+ * @param args Argumentos do comando.
+ * @return Código de saída do comando.
+ */
+static int cmd_acrescenta(char *args[]) {
+    return acrescenta(args[1], args[2]);
+}
+
+/**
+ * @brief Executa o comando 'conta', tratando as opções -j N e --stats.
+ * @param args Argumentos do comando.
+ * @return Código de saída do comando.
+ */
+static int cmd_conta(char *args[]) {
+    int num_threads = 0, estatisticas = 0, i = 1, n = 0, j;
+
+    // Opções: -j N (número de threads) e --stats
+    for (; args[i] != NULL && args[i][0] == '-'; i++) {
+        if (strcmp(args[i], "--stats") == 0) {
+            estatisticas = 1;
+        } else if ((j = le_opcao_threads(args, &i, &num_threads)) != 1) {
+            if (j == 0) {
+                saida_erro("Erro: Opção '%s' desconhecida. Uso: conta [-j N] [--stats] [ficheiro...]\n", args[i]);
+            }
+            return 1;
+        }
+    }
+    if (args[i] == NULL) {
+        // Sem ficheiros: contar a entrada (por exemplo, "ls | conta")
+        return conta(NULL, 0, num_threads, estatisticas);
+    }
+
+    // Os padrões (como *.log) já foram expandidos pelo analisador
+    while (args[i + n] != NULL) {
+        n++;
+    }
+    return conta(&args[i], n, num_threads, estatisticas);
+}
+
+/**
+ * @brief Executa o comando 'procura', tratando as opções -i, -v, -c, -l, -n,
+ * -F, -E, -e padrão, -j N e --stats.
+ * @param args Argumentos do comando.
+ * @return Código de saída do comando (0 se encontrou, 1 se não, 2 em caso de erro).
+ */
+static int cmd_procura(char *args[]) {
+    opcoes_procura o = { 0 };
+    char **fontes, **padroes, **copias;
+    int i = 1, num_fontes = 0, num_padroes = 0, n = 0, resultado, j;
+
+    for (n = 0; args[n] != NULL; n++) {
+    }
+    fontes = calloc(n, sizeof(char *));
+    if (fontes == NULL) {
+        saida_erro("Erro: Memória insuficiente.\n");
+        return 2;
+    }
+
+    // Opções: -i, -v, -c, -l, -n, -F, -E (o padrão), -e padrão, -j N e --stats
+    for (; args[i] != NULL && args[i][0] == '-' && args[i][1] != '\0'; i++) {
+        if (strcmp(args[i], "--") == 0) {
+            i++;
+            break;
+        } else if (strcmp(args[i], "-i") == 0) {
+            o.opcoes |= EXPRESSAO_SEM_MAIUSCULAS;
+        } else if (strcmp(args[i], "-F") == 0) {
+            o.opcoes |= EXPRESSAO_LITERAL;
+        } else if (strcmp(args[i], "-E") == 0) {
+            o.opcoes &= ~EXPRESSAO_LITERAL;
+        } else if (strcmp(args[i], "-v") == 0) {
+            o.inverte = 1;
+        } else if (strcmp(args[i], "-c") == 0) {
+            o.so_contagem = 1;
+        } else if (strcmp(args[i], "-l") == 0) {
+            o.so_nomes = 1;
+        } else if (strcmp(args[i], "-n") == 0) {
+            o.numeros = 1;
+        } else if (strcmp(args[i], "--stats") == 0) {
+            o.estatisticas = 1;
+        } else if (strcmp(args[i], "-e") == 0 && args[i + 1] != NULL) {
+            fontes[num_fontes++] = args[++i];
+        } else if ((j = le_opcao_threads(args, &i, &o.num_threads)) != 1) {
+            if (j == 0) {
+                saida_erro("Erro: Opção '%s' desconhecida. Uso: %s\n", args[i], USO_PROCURA);
+            }
+            free(fontes);
+            return 2;
+        }
+    }
+    if (num_fontes == 0) {
+        if (args[i] == NULL) {
+            saida_erro("Erro: Falta o padrão. Uso: %s\n", USO_PROCURA);
+            free(fontes);
+            return 2;
+        }
+        fontes[num_fontes++] = args[i++];
+    }
+
+    // Um padrão com várias linhas são vários padrões, como no grep
+    for (int k = 0; k < num_fontes; k++) {
+        for (const char *c = fontes[k]; *c != '\0'; c++) {
+            num_padroes += *c == '\n';
+        }
+        num_padroes++;
+    }
+    padroes = calloc(num_padroes, sizeof(char *));
+    copias = calloc(num_fontes, sizeof(char *));
+    num_padroes = 0;
+    for (int k = 0; padroes != NULL && copias != NULL && k < num_fontes; k++) {
+        char *c = copias[k] = strdup(fontes[k]);
+
+        if (c == NULL) {
+            break;
+        }
+        padroes[num_padroes++] = c;
+        while ((c = strchr(c, '\n')) != NULL) {
+            *c++ = '\0';
+            padroes[num_padroes++] = c;
+        }
+    }
+
+    // Sem ficheiros: procurar na entrada (por exemplo, "lista | procura txt")
+    for (n = 0; args[i + n] != NULL; n++) {
+    }
+    if (padroes == NULL || copias == NULL || (num_fontes > 0 && copias[num_fontes - 1] == NULL)) {
+        saida_erro("Erro: Memória insuficiente.\n");
+        resultado = 2;
+    } else {
+        resultado = procura(padroes, num_padroes, &args[i], n, &o);
+    }
+    for (int k = 0; copias != NULL && k < num_fontes; k++) {
+        free(copias[k]);
+    }
+    free(copias);
+    free(padroes);
+    free(fontes);
+    return resultado;
+}
+
+/**
+ * @brief Executa o comando 'resumo', tratando a opção -j N.
+ * @param args Argumentos do comando.
+ * @return Código de saída do comando.
+ */
+static int cmd_resumo(char *args[]) {
+    int num_threads = 0, i = 1, n = 0, j;
+
+    // Opção: -j N (número de threads)
+    for (; args[i] != NULL && args[i][0] == '-'; i++) {
+        if ((j = le_opcao_threads(args, &i, &num_threads)) != 1) {
+            if (j == 0) {
+                saida_erro("Erro: Opção '%s' desconhecida. Uso: resumo [-j N] <ficheiro>...\n", args[i]);
+            }
+            return 1;
+        }
+    }
+    while (args[i + n] != NULL) {
+        n++;
+    }
+    if (n == 0) {
+        saida_erro("Erro: Falta o nome do ficheiro. Uso: resumo [-j N] <ficheiro>...\n");
+        return 1;
+    }
+    return resume(&args[i], n, num_threads);
+}
+
+/**
+ * @brief Executa o comando 'paralelo', tratando as opções -j N, -k e --stats.
+ *
+ * Os argumentos antes de ":::" são o comando modelo (o primeiro que não é
+ * uma opção é o nome do comando); os que vêm depois são os valores.
+ * @param args Argumentos do comando (o ":::" é substituído por NULL).
+ * @return Número de trabalhos que falharam (no máximo 101), ou 1 em caso de erro.
+ */
+static int cmd_paralelo(char *args[]) {
+    opcoes_paralelo o = { 0 };
+    int i = 1, n = 0, separador, j;
+
+    for (; args[i] != NULL && args[i][0] == '-'; i++) {
+        if (strcmp(args[i], "-k") == 0) {
+            o.ordenado = 1;
+        } else if (strcmp(args[i], "--stats") == 0) {
+            o.estatisticas = 1;
+        } else if ((j = le_opcao_threads(args, &i, &o.num_threads)) != 1) {
+            if (j == 0) {
+                saida_erro("Erro: Opção '%s' desconhecida. Uso: %s\n", args[i], USO_PARALELO);
+            }
+            return 1;
+        }
+    }
+    for (separador = i; args[separador] != NULL && strcmp(args[separador], ":::") != 0; separador++) {
+    }
+    if (args[separador] == NULL || separador == i) {
+        saida_erro("Erro: Falta o comando ou ':::'. Uso: %s\n", USO_PARALELO);
+        return 1;
+    }
+    args[separador] = NULL;
+    while (args[separador + 1 + n] != NULL) {
+        n++;
+    }
+    return paralelo(&args[i], &args[separador + 1], n, &o);
+}
+
+/**
+ * @brief Executa o comando 'apaga', tratando as opções -r e -j N.
+ * @param args Argumentos do comando.
+ * @return Código de saída do comando.
+ */
+static int cmd_apaga(char *args[]) {
+    int recursivo = 0, num_threads = 0, i = 1, n = 0, j;
+
+    // Opções: -r (diretorias com todo o conteúdo) e -j N (número de threads)
+    for (; args[i] != NULL && args[i][0] == '-'; i++) {
+        if (strcmp(args[i], "-r") == 0 || strcmp(args[i], "-R") == 0) {
+            recursivo = 1;
+        } else if ((j = le_opcao_threads(args, &i, &num_threads)) != 1) {
+            if (j == 0) {
+                saida_erro("Erro: Opção '%s' desconhecida. Uso: apaga [-r] [-j N] <ficheiro>...\n", args[i]);
+            }
+            return 1;
+        }
+    }
+    while (args[i + n] != NULL) {
+        n++;
+    }
+    if (n == 0) {
+        saida_erro("Erro: Falta o nome do ficheiro. Uso: apaga [-r] [-j N] <ficheiro>...\n");
+        return 1;
+    }
+    return apaga(&args[i], n, recursivo, num_threads);
+}
+
+/**
+ * @brief Executa o comando 'informa', tratando as opções -R e -j N.
+ * @param args Argumentos do comando.
+ * @return Código de saída do comando.
+ */
+static int cmd_informa(char *args[]) {
+    int recursivo = 0, num_threads = 0, i = 1, n = 0, j;
+
+    // Opções: -R (conteúdo das diretorias) e -j N (número de threads)
+    for (; args[i] != NULL && args[i][0] == '-'; i++) {
+        if (strcmp(args[i], "-R") == 0) {
+            recursivo = 1;
+        } else if ((j = le_opcao_threads(args, &i, &num_threads)) != 1) {
+            if (j == 0) {
+                saida_erro("Erro: Opção '%s' desconhecida. Uso: informa [-R] [-j N] <ficheiro>...\n", args[i]);
+            }
+            return 1;
+        }
+    }
+    while (args[i + n] != NULL) {
+        n++;
+    }
+    if (n == 0) {
+        saida_erro("Erro: Falta o nome do ficheiro. Uso: informa [-R] [-j N] <ficheiro>...\n");
+        return 1;
+    }
+    return informa(&args[i], n, recursivo, num_threads);
+}
+
+/**
+ * @brief Executa o comando 'lista', tratando as opções -R, -o e -j N.
+ * @param args Argumentos do comando.
+ * @return Código de saída do comando.
+ */
+static int cmd_lista(char *args[]) {
+    int recursivo = 0, ordena = 0, num_threads = 0, i = 1, j;
+
+    // Opções: -R (recursivo), -o (ordenar) e -j N (número de threads)
+    for (; args[i] != NULL && args[i][0] == '-'; i++) {
+        if (strcmp(args[i], "-R") == 0) {
+            recursivo = 1;
+        } else if (strcmp(args[i], "-o") == 0) {
+            ordena = 1;
+        } else if ((j = le_opcao_threads(args, &i, &num_threads)) != 1) {
+            if (j == 0) {
+                saida_erro("Erro: Opção '%s' desconhecida. Uso: lista [-R] [-o] [-j N] [diretoria]\n", args[i]);
+            }
+            return 1;
+        }
+    }
+    if (args[i] != NULL && args[i + 1] != NULL) {
+        saida_erro("Erro: O comando 'lista' aceita só uma diretoria.\n");
+        return 1;
+    }
+    return lista(args[i], recursivo, ordena, num_threads);  // args[i] pode ser NULL, a função trata isso
+}
+
+/**
+ * @brief Executa o comando 'hash': mostra ou altera a cache de caminhos do PATH.
+ *
+ * Sem argumentos mostra a cache; "-r" esvazia-a; "-d nome" remove um comando;
+ * com nomes, resolve-os e guarda-os na cache.
+ * @param args Argumentos do comando.
+ * @return 0 em caso de sucesso, 1 se algum comando não for encontrado.
+ */
+static int cmd_hash(char *args[]) {
+    int resultado = 0;
+
+    if (args[1] == NULL) {
+        cache_path_mostra();
+        return 0;
+    }
+    if (strcmp(args[1], "-r") == 0) {
+        cache_path_limpa();
+        return 0;
+    }
+    if (strcmp(args[1], "-d") == 0) {
+        for (int i = 2; args[i] != NULL; i++) {
+            if (cache_path_esquece(args[i]) == -1) {
+                saida_erro("Erro: O comando '%s' não está na cache.\n", args[i]);
+                resultado = 1;
+            }
+        }
+        return resultado;
+    }
+    for (int i = 1; args[i] != NULL; i++) {
+        if (cache_path_procura(args[i]) == NULL) {
+            saida_erro("Erro: Comando '%s' não encontrado.\n", args[i]);
+            resultado = 1;
+        }
+    }
+    return resultado;
+}
+
+/**
+ * @brief Executa o comando 'set': mostra ou muda opções do interpretador.
+ *
+ * Sem argumentos mostra as opções atuais. "set spawn <mecanismo>" escolhe
+ * como são lançados os comandos do sistema (posix_spawn, vfork ou fork);
+ * "set durabilidade <modo>" escolhe como o copia e o acrescenta sincronizam
+ * os ficheiros com o disco (nenhuma, lote ou total); "set io <modo>" escolhe
+ * as chamadas de entrada/saída dos comandos de ficheiros (bloqueante ou
+ * uring), "set profundidade_io <N>" a profundidade da fila do io_uring e
+ * "set perfil on|off" se todos os comandos são medidos (ver perfil.h).
+ * @param args Argumentos do comando.
+ * @return 0 em caso de sucesso, 1 se a opção ou o valor forem inválidos.
+ */
+static int cmd_set(char *args[]) {
+    if (args[1] == NULL) {
+        saida_printf("spawn %s\n", nome_lancamento(lancamento_atual()));
+        saida_printf("durabilidade %s\n", nome_durabilidade(durabilidade_atual()));
+        saida_printf("io %s%s\n", nome_modo_es(es_modo()),
+                     es_modo() == ES_URING && !es_uring_disponivel() ? " (indisponível: a usar bloqueante)" : "");
+        saida_printf("profundidade_io %d\n", es_profundidade());
+        saida_printf("perfil %s\n", perfil_ativo() ? "on" : "off");
+        return 0;
+    }
+    if (args[2] == NULL) {
+        saida_erro("Erro: Falta o valor da opção '%s'.\n", args[1]);
+        return 1;
+    }
+    if (strcmp(args[1], "spawn") == 0) {
+        if (lancamento_define(args[2]) == -1) {
+            saida_erro("Erro: Mecanismo '%s' desconhecido (posix_spawn, vfork ou fork).\n", args[2]);
+            return 1;
+        }
+        return 0;
+    }
+    if (strcmp(args[1], "durabilidade") == 0) {
+        if (durabilidade_define(args[2]) == -1) {
+            saida_erro("Erro: Modo '%s' desconhecido (nenhuma, lote ou total).\n", args[2]);
+            return 1;
+        }
+        return 0;
+    }
+    if (strcmp(args[1], "io") == 0) {
+        if (es_define(args[2]) == -1) {
+            saida_erro("Erro: Modo '%s' desconhecido (bloqueante ou uring).\n", args[2]);
+            return 1;
+        }
+        if (es_modo() == ES_URING && !es_uring_disponivel()) {
+            saida_erro("Aviso: O io_uring não está disponível; as chamadas bloqueantes continuam a ser usadas.\n");
+        }
+        return 0;
+    }
+    if (strcmp(args[1], "profundidade_io") == 0) {
+        int profundidade;
+
+        if (le_inteiro(args[2], 1, ES_PROFUNDIDADE_MAX, &profundidade) == -1 ||
+            es_define_profundidade(profundidade) == -1) {
+            saida_erro("Erro: Profundidade inválida: '%s' (1 a %d).\n", args[2], ES_PROFUNDIDADE_MAX);
+            return 1;
+        }
+        return 0;
+    }
+    if (strcmp(args[1], "perfil") == 0 || strcmp(args[1], "profile") == 0) {
+        if (perfil_define(args[2]) == -1) {
+            saida_erro("Erro: Valor '%s' desconhecido (on ou off).\n", args[2]);
+            return 1;
+        }
+        return 0;
+    }
+    saida_erro("Erro: Opção '%s' desconhecida.\n", args[1]);
+    return 1;
+}
+
+/**
+ * @brief Executa o comando 'perfil': mostra as medições guardadas (em texto,
+ * JSON ou CSV) ou esvazia-as.
+ * @param args Argumentos do comando: [texto|json|csv|limpa].
+ * @return 0 em caso de sucesso, 1 se o formato for inválido.
+ */
+static int cmd_perfil(char *args[]) {
+    if (args[1] != NULL && strcmp(args[1], "limpa") == 0) {
+        perfil_limpa();
+        return 0;
+    }
+    if (perfil_mostra(args[1] != NULL ? args[1] : "texto") == -1) {
+        saida_erro("Erro: Formato '%s' desconhecido. Uso: perfil [texto|json|csv|limpa]\n", args[1]);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Executa o comando 'latencia': mede o custo de lançar /bin/true com
+ * cada mecanismo à medida que o heap residente cresce.
+ * @param args Argumentos do comando: [iterações] [heap máximo em MiB].
+ * @return Código de saída do comando.
+ */
+static int cmd_latencia(char *args[]) {
+    int iteracoes = 200, max_mib = 1024;
+
+    if ((args[1] != NULL && le_inteiro(args[1], 1, INT_MAX, &iteracoes) == -1) ||
+        (args[1] != NULL && args[2] != NULL && le_inteiro(args[2], 0, INT_MAX, &max_mib) == -1)) {
+        saida_erro("Erro: Valores inválidos. Uso: latencia [iterações] [heap máximo em MiB]\n");
+        return 1;
+    }
+    return latencia_lancamento(iteracoes, max_mib);
+}
+
+/**
+ * @brief Converte o número de um trabalho ("3" ou "%3").
+ * @param arg Argumento, ou NULL.
+ * @return Número do trabalho, 0 se arg for NULL, ou -1 se for inválido.
+ */
+static int numero_trabalho(const char *arg) {
+    int id;
+
+    if (arg == NULL) {
+        return 0;
+    }
+    if (le_inteiro(arg[0] == '%' ? arg + 1 : arg, 1, INT_MAX, &id) == -1) {
+        saida_erro("Erro: Número de trabalho inválido: '%s'.\n", arg);
+        return -1;
+    }
+    return id;
+}
+
+/**
+ * @brief Executa o comando 'jobs': mostra os trabalhos em fundo.
+ * @param args Argumentos do comando.
+ * @return 0.
+ */
+static int cmd_jobs(char *args[]) {
+    (void)args;
+    trabalhos_lista();
+    return 0;
+}
+
+/**
+ * @brief Executa o comando 'wait': espera por um trabalho em fundo, ou por todos.
+ * @param args Argumentos do comando: [número do trabalho].
+ * @return Código de saída do trabalho.
+ */
+static int cmd_wait(char *args[]) {
+    int id = numero_trabalho(args[1]);
+
+    return id < 0 ? 1 : trabalhos_espera(id);
+}
+
+/**
+ * @brief Executa o comando 'fg': traz um trabalho para primeiro plano.
+ * @param args Argumentos do comando: [número do trabalho].
+ * @return Código de saída do trabalho.
+ */
+static int cmd_fg(char *args[]) {
+    int id = numero_trabalho(args[1]);
+
+    return id < 0 ? 1 : trabalhos_primeiro_plano(id);
+}
+
+/// Comandos internos registados na tabela de dispersão.
+static const comando_interno comandos_internos[] = {
+    { "mostra",     cmd_mostra,     0, -1, "mostra [-f] [-n A:B | -c A:B | --tail N] [ficheiro]" },
+    { "copia",      cmd_copia,      1, -1, "copia [-j N] [--if-changed] <ficheiro>..." },
+    { "acrescenta", cmd_acrescenta, 2,  2, "acrescenta <origem> <destino>" },
+    { "conta",      cmd_conta,      0, -1, "conta [-j N] [--stats] [ficheiro...]" },
+    { "procura",    cmd_procura,    1, -1, USO_PROCURA },
+    { "resumo",     cmd_resumo,     1, -1, "resumo [-j N] <ficheiro>..." },
+    { "paralelo",   cmd_paralelo,   2, -1, USO_PARALELO },
+    { "apaga",      cmd_apaga,      1, -1, "apaga [-r] [-j N] <ficheiro>..." },
+    { "informa",    cmd_informa,    1, -1, "informa [-R] [-j N] <ficheiro>..." },
+    { "lista",      cmd_lista,      0, -1, "lista [-R] [-o] [-j N] [diretoria]" },
+    { "hash",       cmd_hash,       0, -1, "hash [-r] [-d] [comando...]" },
+    { "set",        cmd_set,        0,  2, "set [opção valor]" },
+    { "latencia",   cmd_latencia,   0,  2, "latencia [iterações] [heap máximo em MiB]" },
+    { "jobs",       cmd_jobs,       0,  0, "jobs" },
+    { "wait",       cmd_wait,       0,  1, "wait [trabalho]" },
+    { "fg",         cmd_fg,         0,  1, "fg [trabalho]" },
+    { "perfil",     cmd_perfil,     0,  1, "perfil [texto|json|csv|limpa]" },
+};
+
+/**
+ * @brief Regista os comandos internos na tabela de dispersão.
+ */
+void regista_comandos(void) {
+    for (size_t i = 0; i < sizeof(comandos_internos) / sizeof(comandos_internos[0]); i++) {
+        tabela_regista(&comandos_internos[i]);
+    }
+}
+
+/**
+ * @brief Executa um comando (ou pipeline) já separado em argumentos e reporta
+ * o código de saída de cada etapa.
+ *
+ * Precedido de "time", cada etapa é medida e a medição é mostrada no fim.
+ * @param args Argumentos do comando (terminados em NULL; reorganizados).
+ * @return Código de saída da última etapa, ou COMANDO_TERMINA se for "termina".
+ */
+int executa_comando(char *args[]) {
+    etapa_pipeline etapas[PIPELINE_MAX_ETAPAS];
+    int n = 0, tempo = 0;
+
+    // Linha vazia
+    if (args[0] == NULL) {
+        return 0;
+    }
+
+    // "time comando": medir o comando (ou pipeline) e mostrar o resultado
+    if (strcmp(args[0], "time") == 0) {
+        args++;
+        tempo = 1;
+        if (args[0] == NULL) {
+            saida_erro("Erro: Falta o comando. Uso: time <comando>\n");
+            return 1;
+        }
+    }
+
+    // Verificar se o comando é "termina"
+    if (strcmp(args[0], "termina") == 0) {
+        return COMANDO_TERMINA;
+    }
+
+    // Comando terminado em '&': lançar em fundo e voltar logo ao prompt
+    while (args[n] != NULL) {
+        n++;
+    }
+    if (args[n - 1] == operador_fundo) {
+        args[n - 1] = NULL;
+        if (n == 1) {
+            saida_erro("Erro: Falta o comando antes de '&'.\n");
+            return 1;
+        }
+        if (tempo) {
+            saida_erro("Erro: 'time' não pode ser usado com '&' (use 'set perfil on').\n");
+            return 1;
+        }
+        if (servidor_em_pedido()) {
+            saida_erro("Erro: '&' não está disponível nos pedidos ao servidor.\n");
+            return 1;
+        }
+        return trabalhos_lanca(args);
+    }
+
+    // Separar as etapas e os redirecionamentos; cada etapa é um comando
+    // interno (numa thread) ou um comando do sistema (posix_spawn, vfork ou fork)
+    n = pipeline_analisa(args, etapas);
+    if (n == -1) {
+        return 1;
+    }
+    return pipeline_executa(etapas, n, tempo);
+}
+
+/**
+ * @brief Executa uma lista de comandos, respeitando ';', '&&' e '||'.
+ *
+ * Os argumentos de cada comando (com as variáveis substituídas) são
+ * construídos na arena indicada, que é reiniciada depois de cada comando.
+ * Os trabalhos em fundo que terminam são reportados entre comandos.
+ * @param c Primeiro comando.
+ * @param argumentos Arena para os argumentos.
+ * @param parar_no_erro Se diferente de 0, para no primeiro comando que falhar
+ * (exceto antes de '&&' ou '||', que tratam a falha).
+ * @param terminar Posto a 1 se a lista terminou com "termina" ou com um erro.
+ * @return Código de saída do último comando executado.
+ */
+static int executa_lista(const comando_analisado *c, arena *argumentos, int parar_no_erro, int *terminar) {
+    int corre = 1;
+
+    for (; c != NULL; c = c->seguinte) {
+        if (corre) {
+            char **args = expande_argumentos(c, argumentos, ultimo_codigo);
+            int r;
+
+            trabalhos_recolhe(0);
+            if (args == NULL) {
+                saida_erro("Erro: Memória insuficiente.\n");
+                r = 1;
+            } else {
+                r = executa_comando(args);
+            }
+            arena_reinicia(argumentos);
+
+            if (r == COMANDO_TERMINA) {
+                *terminar = 1;
+                break;
+            }
+            ultimo_codigo = r;
+            if (r != 0 && parar_no_erro && c->liga == LIGACAO_SEQUENCIA) {
+                saida_flush();
+                saida_erro("Erro: O script parou na linha %d (código %d).\n", c->linha, r);
+                *terminar = 1;
+                break;
+            }
+        }
+        // Um comando saltado não muda o $?: em "a || b && c", c corre se a tiver sucesso
+        corre = c->liga == LIGACAO_SEQUENCIA || (c->liga == LIGACAO_E) == (ultimo_codigo == 0);
+    }
+    return ultimo_codigo;
+}
+
+/**
+ * @brief Ciclo interativo: mostra o prompt, lê e executa uma linha de cada vez.
+ *
+ * As linhas não têm limite de tamanho: são lidas com getline para um buffer
+ * que só cresce. Uma linha incompleta (aspas por fechar, '\\' ou operador
+ * no fim) continua na linha seguinte, com o prompt "> ". A linha é
+ * analisada numa arena, reiniciada em O(1) depois de executada.
+ * @return 0 ao terminar.
+ */
+static int ciclo_interativo(void) {
+    arena comandos = ARENA_VAZIA, argumentos = ARENA_VAZIA;
+    char *linha = NULL, *texto = NULL;
+    size_t capacidade_linha = 0, capacidade = 0;
+    int terminar = 0;
+
+    while (!terminar) {
+        size_t usado = 0;
+        resultado_analise r = ANALISE_INCOMPLETA;
+        analise res;
+
+        do {
+            ssize_t n;
+
+            // Mostrar o prompt (de novo, depois de reportar trabalhos em fundo
+            // que terminem enquanto se espera pela linha)
+            do {
+                saida_printf(usado == 0 ? "%% " : "> ");
+                saida_flush();
+            } while (trabalhos_espera_entrada(STDIN_FILENO) > 0);
+
+            // Ler a linha e juntá-la ao que já foi lido
+            n = getline(&linha, &capacidade_linha, stdin);
+            if (n == -1) {
+                break;  // EOF (Ctrl+D)
+            }
+            if (usado + n + 1 > capacidade) {
+                char *maior = realloc(texto, (usado + n + 1) * 2);
+                if (maior == NULL) {
+                    saida_erro("Erro: Memória insuficiente.\n");
+                    terminar = 1;
+                    break;
+                }
+                texto = maior;
+                capacidade = (usado + n + 1) * 2;
+            }
+            memcpy(texto + usado, linha, n);
+            usado += n;
+
+            arena_reinicia(&comandos);
+            r = analisa_comandos(texto, usado, &comandos, &res);
+        } while (r == ANALISE_INCOMPLETA);
+
+        if (terminar || feof(stdin) || ferror(stdin)) {
+            if (usado > 0) {
+                saida_erro("Erro: A linha terminou a meio de um comando.\n");
+            }
+            break;
+        }
+        if (r == ANALISE_ERRO) {
+            saida_erro("Erro: %s\n", res.erro);
+            ultimo_codigo = 1;
+            continue;
+        }
+        executa_lista(res.comandos, &argumentos, 0, &terminar);
+    }
+
+    // Esperar pelos trabalhos em fundo (os comandos internos correm em threads)
+    trabalhos_espera(0);
+    arena_liberta(&comandos);
+    arena_liberta(&argumentos);
+    free(linha);
+    free(texto);
+    return 0;
+}
+
+/**
+ * @brief Executa um script sem prompts, com toda a saída no mesmo buffer.
+ *
+ * O script é todo analisado antes de começar, numa só arena: um erro de
+ * sintaxe é reportado com a linha e nenhum comando é executado. Os trabalhos
+ * em fundo que ainda estiverem a correr no fim do script são esperados.
+ * @param texto Conteúdo do script (terminado em '\0').
+ * @param parar_no_erro Se diferente de 0, para no primeiro comando que falhar.
+ * @return Código de saída do último comando executado.
+ */
+static int executa_lote(char *texto, int parar_no_erro) {
+    arena comandos = ARENA_VAZIA, argumentos = ARENA_VAZIA;
+    int terminar = 0, resultado;
+    resultado_analise r;
+    analise res;
+
+    r = analisa_comandos(texto, strlen(texto), &comandos, &res);
+    if (r == ANALISE_OK) {
+        resultado = executa_lista(res.comandos, &argumentos, parar_no_erro, &terminar);
+    } else {
+        if (r == ANALISE_ERRO) {
+            saida_erro("Erro: Linha %d: %s\n", res.linha_erro, res.erro);
+        } else {
+            saida_erro("Erro: O script termina a meio de um comando (aspas por fechar?).\n");
+        }
+        resultado = 1;
+    }
+
+    // Os trabalhos em fundo ainda a correr são esperados e reportados no fim
+    trabalhos_espera(0);
+    saida_flush();
+    arena_liberta(&comandos);
+    arena_liberta(&argumentos);
+    return resultado;
+}
+
+/**
+ * @brief Executa o pedido de um cliente no modo servidor.
+ *
+ * Como executa_lote, mas cada pedido começa com $? a 0 (o worker pode ter
+ * executado outros pedidos antes).
+ * @param texto Script do pedido.
+ * @param parar_no_erro Se diferente de 0, para no primeiro comando que falhar.
+ * @return Código de saída do último comando executado.
+ */
+static int executa_pedido_cliente(char *texto, int parar_no_erro) {
+    ultimo_codigo = 0;
+    return executa_lote(texto, parar_no_erro);
+}
+
+/**
+ * @brief Lê todo o conteúdo de um descritor para um buffer terminado em '\0'.
+ * @param fd Descritor a ler.
+ * @return Buffer com o conteúdo (libertar com free), ou NULL em caso de erro.
+ */
+static char *le_tudo(int fd) {
+    struct stat st;
+    size_t capacidade = 64 * 1024, usado = 0;
+    char *texto;
+    ssize_t n;
+
+    // Para ficheiros regulares o tamanho é conhecido: uma só leitura grande
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        capacidade = st.st_size + 1;
+    }
+    texto = malloc(capacidade);
+    if (texto == NULL) {
+        return NULL;
+    }
+
+    while ((n = read(fd, texto + usado, capacidade - usado - 1)) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            free(texto);
+            return NULL;
+        }
+        usado += n;
+        if (usado + 1 == capacidade) {
+            char *maior = realloc(texto, capacidade * 2);
+            if (maior == NULL) {
+                free(texto);
+                return NULL;
+            }
+            texto = maior;
+            capacidade *= 2;
+        }
+    }
+    texto[usado] = '\0';
+    return texto;
+}
+
+/**
+ * @brief Função principal do interpretador.
+ *
+ * Opções:
+ * - -f script: executa os comandos do ficheiro, sem prompts;
+ * - -c "comando": executa só o comando indicado;
+ * - -e: em modo de script, para no primeiro comando que falhar;
+ * - --daemon socket: corre como servidor no socket indicado, com -j N
+ *   pedidos ao mesmo tempo (por omissão, o número de CPUs);
+ * - --server socket: envia o script de -c ou -f a um servidor, que o executa
+ *   com a entrada, a saída, os erros, a diretoria e o ambiente deste processo.
+ *
+ * Quando o STDIN não é um terminal, os comandos são lidos todos de uma vez
+ * e executados em modo de script.
+ * @param argc Número de argumentos.
+ * @param argv Argumentos da linha de comandos.
+ * @return 0 ao terminar no modo interativo; no modo de script (e como
+ * cliente), o código de saída do último comando.
+ */
+int main(int argc, char *argv[]) {
+    static const struct option longas[] = {
+        { "daemon", required_argument, NULL, 'd' },
+        { "server", required_argument, NULL, 's' },
+        { NULL, 0, NULL, 0 }
+    };
+    const char *script = NULL, *comando = NULL, *servidor = NULL, *daemon = NULL;
+    int parar_no_erro = 0, workers = 0, opcao, resultado;
+    char *texto;
+    
+    while ((opcao = getopt_long(argc, argv, "f:c:ej:", longas, NULL)) != -1) {
+        switch (opcao) {
+            case 'f': script = optarg; break;
+            case 'c': comando = optarg; break;
+            case 'e': parar_no_erro = 1; break;
+            case 'j':
+                if (le_threads(optarg, &workers) == -1) {
+                    saida_erro("Erro: Valor inválido para a opção '-j': '%s' (de 1 a %d).\n", optarg, POOL_MAX_THREADS);
+                    return 2;
+                }
+                break;
+            case 'd': daemon = optarg; break;
+            case 's': servidor = optarg; break;
+            default:
+                saida_erro("Uso: %s [-e] [-f script | -c comando] [--server socket]\n"
+                           "     %s --daemon socket [-j N]\n", argv[0], argv[0]);
+                return 2;
+        }
+    }
+
+    regista_comandos();
+
+    // Um comando interno a escrever num pipe cuja leitura já terminou deve
+    // receber EPIPE, em vez de o sinal terminar o interpretador
+    signal(SIGPIPE, SIG_IGN);
+
+    if (daemon != NULL) {
+        return servidor_corre(daemon, workers, executa_pedido_cliente);
+    }
+    if (servidor != NULL && comando == NULL && script == NULL) {
+        saida_erro("Erro: --server precisa de -c comando ou -f script.\n");
+        return 2;
+    }
+
+    if (comando != NULL) {
+        texto = strdup(comando);
+    } else if (script != NULL) {
+        int fd = open(script, O_RDONLY);
+        if (fd == -1) {
+            saida_erro("Erro: O script '%s' não existe ou não pode ser aberto.\n", script);
+            return 1;
+        }
+        texto = le_tudo(fd);
+        close(fd);
+    } else if (!isatty(STDIN_FILENO)) {
+        texto = le_tudo(STDIN_FILENO);
+    } else {
+        // No modo interativo o Ctrl-C termina o comando em curso e não o
+        // interpretador: o SIGINT fica bloqueado em todas as threads (os
+        // filhos repõem a máscara) e o 'mostra -f' lê-o com um signalfd
+        sigset_t interrupcao;
+
+        sigemptyset(&interrupcao);
+        sigaddset(&interrupcao, SIGINT);
+        pthread_sigmask(SIG_BLOCK, &interrupcao, NULL);
+        resultado = ciclo_interativo();
+        saida_flush();
+        return resultado;
+    }
+
+    if (texto == NULL) {
+        saida_erro("Erro: Não foi possível ler os comandos.\n");
+        return 1;
+    }
+    if (servidor != NULL) {
+        resultado = servidor_pede(servidor, texto, parar_no_erro);
+    } else {
+        resultado = executa_lote(texto, parar_no_erro);
+    }
+    free(texto);
+    return resultado;
+}
@@ -0,0 +1,286 @@
+/**
+ * @file lancamento.c
+ * @brief Implementação do lançamento de processos (posix_spawn, vfork e fork).
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <spawn.h>
+#include <time.h>
+#include <sys/wait.h>
+#include "lancamento.h"
+#include "saida.h"
+#include "ambiente.h"
+
+/// Tamanho da pilha do filho criado com clone (só é usada até ao exec).
+#define PILHA_FILHO (64 * 1024)
+
+static metodo_lancamento metodo_omissao = LANCA_POSIX_SPAWN;
+
+/// @brief Argumentos do filho criado com clone(CLONE_VM | CLONE_VFORK).
+typedef struct {
+    const char *caminho;
+    char *const *argv;
+    char *const *ambiente;
+    const int *fds;
+    volatile int erro;      ///< escrito pelo filho (memória partilhada) se o exec falhar
+} arg_filho;
+
+/// @brief No filho: coloca os descritores pedidos em 0, 1 e 2, repõe o
+/// SIGPIPE e desbloqueia os sinais (o interpretador bloqueia o SIGINT).
+static void prepara_filho(const int *fds) {
+    sigset_t vazio;
+
+    sigemptyset(&vazio);
+    signal(SIGPIPE, SIG_DFL);
+    sigprocmask(SIG_SETMASK, &vazio, NULL);
+    for (int i = 0; fds != NULL && i < 3; i++) {
+        if (fds[i] != -1 && fds[i] != i) {
+            dup2(fds[i], i);
+        }
+    }
+}
+
+/// @brief Lança com posix_spawn; os erros do exec vêm no valor de retorno.
+static pid_t lanca_posix_spawn(const char *caminho, char *const argv[], char *const ambiente[],
+                               const int *fds, int *erro) {
+    posix_spawn_file_actions_t acoes;
+    posix_spawnattr_t attr;
+    sigset_t vazio, so_pipe;
+    pid_t pid;
+    int r;
+
+    sigemptyset(&vazio);
+    sigemptyset(&so_pipe);
+    sigaddset(&so_pipe, SIGPIPE);
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setsigmask(&attr, &vazio);
+    posix_spawnattr_setsigdefault(&attr, &so_pipe);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    posix_spawn_file_actions_init(&acoes);
+    for (int i = 0; fds != NULL && i < 3; i++) {
+        if (fds[i] != -1 && fds[i] != i) {
+            posix_spawn_file_actions_adddup2(&acoes, fds[i], i);
+        }
+    }
+
+    r = posix_spawn(&pid, caminho, &acoes, &attr, argv, ambiente);
+    posix_spawn_file_actions_destroy(&acoes);
+    posix_spawnattr_destroy(&attr);
+    if (r != 0) {
+        *erro = r;
+        return -1;
+    }
+    return pid;
+}
+
+/// @brief Função executada pelo filho do clone: só faz o exec.
+static int filho_vfork(void *p) {
+    arg_filho *a = p;
+
+    prepara_filho(a->fds);
+    execve(a->caminho, a->argv, a->ambiente);
+    a->erro = errno;
+    _exit(127);
+}
+
+/// @brief Lança com clone(CLONE_VM | CLONE_VFORK): o pai fica suspenso até ao exec.
+static pid_t lanca_vfork(const char *caminho, char *const argv[], char *const ambiente[],
+                         const int *fds, int *erro) {
+    arg_filho a = { caminho, argv, ambiente, fds, 0 };
+    sigset_t todos, anterior;
+    char *pilha = malloc(PILHA_FILHO);
+    pid_t pid;
+
+    if (pilha == NULL) {
+        *erro = ENOMEM;
+        return -1;
+    }
+
+    // Bloquear os sinais para que nenhum handler corra no filho com a memória do pai
+    sigfillset(&todos);
+    pthread_sigmask(SIG_SETMASK, &todos, &anterior);
+    pid = clone(filho_vfork, pilha + PILHA_FILHO, CLONE_VM | CLONE_VFORK | SIGCHLD, &a);
+    pthread_sigmask(SIG_SETMASK, &anterior, NULL);
+    free(pilha);
+
+    if (pid == -1) {
+        *erro = errno;
+        return -1;
+    }
+    if (a.erro != 0) {
+        waitpid(pid, NULL, 0);
+        *erro = a.erro;
+        return -1;
+    }
+    return pid;
+}
+
+/// @brief Lança com fork; o errno do exec volta por um pipe com O_CLOEXEC.
+static pid_t lanca_fork(const char *caminho, char *const argv[], char *const ambiente[],
+                        const int *fds, int *erro) {
+    int canal[2], erro_filho;
+    pid_t pid;
+
+    if (pipe2(canal, O_CLOEXEC) == -1) {
+        *erro = errno;
+        return -1;
+    }
+
+    pid = fork();
+    if (pid == -1) {
+        *erro = errno;
+        close(canal[0]);
+        close(canal[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        close(canal[0]);
+        prepara_filho(fds);
+        execve(caminho, argv, ambiente);
+        erro_filho = errno;
+        if (write(canal[1], &erro_filho, sizeof(erro_filho)) < 0) {
+            // Nada a fazer: o pai verá apenas o código de saída
+        }
+        _exit(127);
+    }
+
+    // Se o exec correu bem, o pipe fecha sem dados
+    close(canal[1]);
+    if (read(canal[0], &erro_filho, sizeof(erro_filho)) == sizeof(erro_filho)) {
+        close(canal[0]);
+        waitpid(pid, NULL, 0);
+        *erro = erro_filho;
+        return -1;
+    }
+    close(canal[0]);
+    return pid;
+}
+
+/// @brief Lança um programa com o mecanismo indicado.
+/// @param caminho Caminho do executável.
+/// @param argv Argumentos terminados em NULL.
+/// @param metodo Mecanismo a usar.
+/// @param fds Descritores para 0, 1 e 2 do filho (-1 herda), ou NULL.
+/// @param erro errno da falha, se a função devolver -1.
+/// @return pid do filho, ou -1 em caso de erro.
+/// @details O filho recebe o ambiente da thread atual (ver ambiente.h).
+pid_t lanca_processo(const char *caminho, char *const argv[], metodo_lancamento metodo,
+                     const int fds[3], int *erro) {
+    char *const *ambiente = ambiente_atual();
+
+    switch (metodo) {
+        case LANCA_VFORK: return lanca_vfork(caminho, argv, ambiente, fds, erro);
+        case LANCA_FORK:  return lanca_fork(caminho, argv, ambiente, fds, erro);
+        default:          return lanca_posix_spawn(caminho, argv, ambiente, fds, erro);
+    }
+}
+
+/// @brief Mecanismo usado por omissão.
+metodo_lancamento lancamento_atual(void) {
+    return metodo_omissao;
+}
+
+/// @brief Muda o mecanismo usado por omissão.
+/// @param nome Nome do mecanismo.
+/// @return 0 em caso de sucesso, -1 se o nome não for conhecido.
+int lancamento_define(const char *nome) {
+    for (int m = LANCA_POSIX_SPAWN; m <= LANCA_FORK; m++) {
+        if (strcmp(nome, nome_lancamento((metodo_lancamento)m)) == 0) {
+            metodo_omissao = (metodo_lancamento)m;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/// @brief Nome de um mecanismo de lançamento.
+const char *nome_lancamento(metodo_lancamento metodo) {
+    switch (metodo) {
+        case LANCA_POSIX_SPAWN: return "posix_spawn";
+        case LANCA_VFORK:       return "vfork";
+        case LANCA_FORK:        return "fork";
+    }
+    return "desconhecido";
+}
+
+/// @brief Compara dois doubles (para qsort).
+static int compara_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/// @brief Mede a latência de lançamento de /bin/true para cada mecanismo e tamanho de heap.
+/// @param iteracoes Lançamentos por medição.
+/// @param max_mib Tamanho máximo do heap a testar (MiB).
+/// @return 0 em caso de sucesso, 1 em caso de erro.
+/// @details
+/// O heap é reservado com malloc e preenchido, para que as páginas fiquem
+/// residentes e o fork tenha de copiar as respetivas tabelas.
+/// Variáveis:
+/// - heap: bloco de memória que simula caches e histórico do interpretador
+/// - tempos: latência de cada lançamento, em microssegundos
+int latencia_lancamento(int iteracoes, int max_mib) {
+    static const int tamanhos[] = { 0, 64, 256, 1024, 4096 };
+    char *argv[] = { "true", NULL };
+    double *tempos = malloc(iteracoes * sizeof(double));
+
+    if (tempos == NULL) {
+        return 1;
+    }
+
+    saida_printf("%-10s %-12s %12s %10s %10s\n", "heap MiB", "método", "média µs", "p50 µs", "p99 µs");
+    for (size_t t = 0; t < sizeof(tamanhos) / sizeof(tamanhos[0]) && tamanhos[t] <= max_mib; t++) {
+        size_t bytes = (size_t)tamanhos[t] << 20;
+        char *heap = bytes > 0 ? malloc(bytes) : NULL;
+
+        if (bytes > 0 && heap == NULL) {
+            saida_erro("Erro: Não foi possível reservar %d MiB.\n", tamanhos[t]);
+            break;
+        }
+        if (heap != NULL) {
+            memset(heap, 1, bytes);
+        }
+
+        for (int m = LANCA_POSIX_SPAWN; m <= LANCA_FORK; m++) {
+            double soma = 0;
+
+            for (int i = 0; i < iteracoes; i++) {
+                struct timespec inicio, fim;
+                int erro;
+                pid_t pid;
+
+                clock_gettime(CLOCK_MONOTONIC, &inicio);
+                pid = lanca_processo("/bin/true", argv, (metodo_lancamento)m, NULL, &erro);
+                if (pid == -1) {
+                    saida_erro("Erro: Falha ao lançar /bin/true: %s\n", strerror(erro));
+                    free(heap);
+                    free(tempos);
+                    return 1;
+                }
+                waitpid(pid, NULL, 0);
+                clock_gettime(CLOCK_MONOTONIC, &fim);
+                tempos[i] = (fim.tv_sec - inicio.tv_sec) * 1e6 + (fim.tv_nsec - inicio.tv_nsec) / 1e3;
+                soma += tempos[i];
+            }
+
+            qsort(tempos, iteracoes, sizeof(double), compara_double);
+            saida_printf("%-10d %-12s %12.1f %10.1f %10.1f\n", tamanhos[t], nome_lancamento((metodo_lancamento)m),
+                   soma / iteracoes, tempos[iteracoes / 2], tempos[(iteracoes * 99) / 100]);
+        }
+        free(heap);
+    }
+
+    free(tempos);
+    return 0;
+}
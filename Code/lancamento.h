@@ -0,0 +1,74 @@
+/**
+ * @file lancamento.h
+ * @brief Lançamento de processos externos com vários mecanismos.
+ *
+ * O fork copia as tabelas de páginas do interpretador, o que fica caro à
+ * medida que o heap cresce. O posix_spawn e o clone com CLONE_VM|CLONE_VFORK
+ * partilham a memória com o pai até ao exec e têm um custo constante.
+ *
+ * O interpretador ignora SIGPIPE (para que um comando interno a escrever
+ * num pipe fechado receba EPIPE); os filhos voltam a ter a ação por omissão.
+ *
+ * @date 2025
+ */
+
+#ifndef LANCAMENTO_H
+#define LANCAMENTO_H
+
+#include <sys/types.h>
+
+/**
+ * @brief Mecanismo usado para criar o processo filho.
+ */
+typedef enum {
+    LANCA_POSIX_SPAWN,  ///< posix_spawn (por omissão)
+    LANCA_VFORK,        ///< clone(CLONE_VM | CLONE_VFORK) seguido de execv
+    LANCA_FORK          ///< fork seguido de execv (comportamento original)
+} metodo_lancamento;
+
+/**
+ * @brief Lança um programa e devolve o pid do filho sem esperar por ele.
+ *
+ * Os erros do exec (programa inexistente, sem permissões...) são devolvidos
+ * ao pai em todos os mecanismos, em vez de aparecerem como código de saída.
+ * @param caminho Caminho do executável.
+ * @param argv Argumentos (argv[0] é o nome), terminados em NULL.
+ * @param metodo Mecanismo a usar.
+ * @param fds Descritores a usar como STDIN, STDOUT e STDERR do filho (-1
+ * mantém o do interpretador), ou NULL para herdar os três.
+ * @param erro Preenchido com o errno da falha quando a função devolve -1.
+ * @return pid do filho, ou -1 em caso de erro.
+ */
+pid_t lanca_processo(const char *caminho, char *const argv[], metodo_lancamento metodo,
+                     const int fds[3], int *erro);
+
+/**
+ * @brief Devolve o mecanismo usado por omissão pelo interpretador.
+ * @return Mecanismo atual.
+ */
+metodo_lancamento lancamento_atual(void);
+
+/**
+ * @brief Muda o mecanismo usado por omissão.
+ * @param nome "posix_spawn", "vfork" ou "fork".
+ * @return 0 em caso de sucesso, -1 se o nome não for conhecido.
+ */
+int lancamento_define(const char *nome);
+
+/**
+ * @brief Devolve o nome de um mecanismo de lançamento.
+ * @param metodo Mecanismo.
+ * @return Nome do mecanismo.
+ */
+const char *nome_lancamento(metodo_lancamento metodo);
+
+/**
+ * @brief Mede a latência de lançar e esperar por /bin/true com cada mecanismo,
+ * para vários tamanhos de heap residente.
+ * @param iteracoes Número de lançamentos por medição.
+ * @param max_mib Tamanho máximo do heap a testar, em MiB.
+ * @return 0 em caso de sucesso, 1 em caso de erro.
+ */
+int latencia_lancamento(int iteracoes, int max_mib);
+
+#endif // LANCAMENTO_H
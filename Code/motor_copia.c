@@ -0,0 +1,234 @@
+/**
+ * @file motor_copia.c
+ * @brief Implementação do motor de cópia entre descritores.
+ *
+ * Cada mecanismo é tentado por ordem; quando o kernel o recusa (sistemas de
+ * ficheiros diferentes, tipo de descritor não suportado, etc.) passa-se ao
+ * seguinte. Como todos avançam a posição dos descritores, uma cópia pode
+ * começar num mecanismo e terminar noutro sem perder dados.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+#include "motor_copia.h"
+#include "saida.h"
+
+/// Tamanho máximo pedido ao kernel em cada chamada de cópia.
+#define BLOCO_KERNEL (1UL << 30)
+
+/// Tamanho do buffer do ciclo read/write (o mesmo dos comandos originais).
+#define BLOCO_BUFFER 4096
+
+/// @brief Devolve o instante atual em segundos (relógio monotónico).
+static double agora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/// @brief Indica se um erro significa "mecanismo não suportado, tentar o seguinte".
+static int erro_de_suporte(int erro) {
+    return erro == ENOSYS || erro == EXDEV || erro == EINVAL ||
+           erro == EOPNOTSUPP || erro == EBADF || erro == ETXTBSY;
+}
+
+/// @brief Tenta copiar com copy_file_range.
+/// @return 1 se chegou ao fim do ficheiro, 0 se o mecanismo não é suportado, -1 em erro.
+static int tenta_copy_file_range(int fd_src, int fd_dest, unsigned long long *bytes) {
+    ssize_t n;
+
+    while ((n = copy_file_range(fd_src, NULL, fd_dest, NULL, BLOCO_KERNEL, 0)) > 0) {
+        *bytes += n;
+    }
+    if (n == 0) {
+        // Ficheiros como os de /proc reportam tamanho 0; sem nenhum byte
+        // copiado não é seguro concluir que se chegou ao fim.
+        return *bytes > 0 ? 1 : 0;
+    }
+    return erro_de_suporte(errno) ? 0 : -1;
+}
+
+/// @brief Tenta clonar o ficheiro inteiro (reflink) com FICLONE.
+/// @details Só se aplica quando ambos os descritores estão no início e o
+/// destino está vazio, isto é, quando a cópia corresponde ao ficheiro inteiro.
+/// @return 1 se clonou, 0 se não se aplica ou não é suportado, -1 em erro.
+static int tenta_ficlone(int fd_src, int fd_dest, unsigned long long *bytes) {
+    struct stat st_src, st_dest;
+
+    if (fstat(fd_src, &st_src) == -1 || fstat(fd_dest, &st_dest) == -1) {
+        return -1;
+    }
+    if (!S_ISREG(st_src.st_mode) || !S_ISREG(st_dest.st_mode) || st_dest.st_size != 0 ||
+        lseek(fd_src, 0, SEEK_CUR) != 0 || lseek(fd_dest, 0, SEEK_CUR) != 0) {
+        return 0;
+    }
+
+    if (ioctl(fd_dest, FICLONE, fd_src) == -1) {
+        return (errno == EPERM || errno == EISDIR || erro_de_suporte(errno)) ? 0 : -1;
+    }
+
+    // O ioctl não mexe nas posições: deixá-las no fim, como os outros mecanismos
+    lseek(fd_src, st_src.st_size, SEEK_SET);
+    lseek(fd_dest, st_src.st_size, SEEK_SET);
+    *bytes += st_src.st_size;
+    return 1;
+}
+
+/// @brief Tenta copiar com sendfile (a origem tem de suportar mmap).
+/// @return 1 se chegou ao fim do ficheiro, 0 se não é suportado, -1 em erro.
+static int tenta_sendfile(int fd_src, int fd_dest, unsigned long long *bytes) {
+    ssize_t n;
+
+    while ((n = sendfile(fd_dest, fd_src, NULL, BLOCO_KERNEL)) > 0) {
+        *bytes += n;
+    }
+    if (n == 0) {
+        return *bytes > 0 ? 1 : 0;
+    }
+    return erro_de_suporte(errno) ? 0 : -1;
+}
+
+/// @brief Tenta copiar com splice (uma das pontas tem de ser um pipe).
+/// @return 1 se chegou ao fim dos dados, 0 se não se aplica, -1 em erro.
+static int tenta_splice(int fd_src, int fd_dest, unsigned long long *bytes) {
+    struct stat st_src, st_dest;
+    ssize_t n;
+
+    if (fstat(fd_src, &st_src) == -1 || fstat(fd_dest, &st_dest) == -1) {
+        return -1;
+    }
+    if (!S_ISFIFO(st_src.st_mode) && !S_ISFIFO(st_dest.st_mode)) {
+        return 0;
+    }
+
+    while ((n = splice(fd_src, NULL, fd_dest, NULL, BLOCO_KERNEL, SPLICE_F_MORE)) > 0) {
+        *bytes += n;
+    }
+    if (n == 0) {
+        return 1;
+    }
+    return erro_de_suporte(errno) ? 0 : -1;
+}
+
+/// @brief Ciclo read/write com buffer, tratando escritas parciais e EINTR.
+/// @return 1 se chegou ao fim dos dados, -1 em erro.
+static int copia_com_buffer(int fd_src, int fd_dest, unsigned long long *bytes) {
+    char buffer[BLOCO_BUFFER];
+    ssize_t n;
+
+    while ((n = read(fd_src, buffer, sizeof(buffer))) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        for (ssize_t escrito = 0; escrito < n; ) {
+            ssize_t w = write(fd_dest, buffer + escrito, n - escrito);
+            if (w < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return -1;
+            }
+            escrito += w;
+        }
+        *bytes += n;
+    }
+    return 1;
+}
+
+/// @brief Copia o resto de fd_src para fd_dest escolhendo o mecanismo mais rápido.
+/// @param fd_src Descritor de origem.
+/// @param fd_dest Descritor de destino.
+/// @param res Resultado da cópia (pode ser NULL).
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+/// @details
+/// Os mecanismos são tentados pela ordem copy_file_range, FICLONE,
+/// sendfile, splice e ciclo com buffer. O método registado é o último que
+/// transferiu dados.
+/// Variáveis:
+/// - bytes: total de bytes copiados até ao momento
+/// - r: resultado da última tentativa (1 fim, 0 não suportado, -1 erro)
+int copia_descritores(int fd_src, int fd_dest, resultado_copia *res) {
+    static int (*const mecanismos[])(int, int, unsigned long long *) = {
+        tenta_copy_file_range, tenta_ficlone, tenta_sendfile, tenta_splice, copia_com_buffer
+    };
+    unsigned long long bytes = 0;
+    metodo_copia metodo = COPIA_BUFFER;
+    double inicio = agora();
+    int r = 0;
+
+    for (int i = COPIA_COPY_FILE_RANGE; i <= COPIA_BUFFER; i++) {
+        unsigned long long antes = bytes;
+
+        r = mecanismos[i](fd_src, fd_dest, &bytes);
+        if (bytes > antes || r == 1) {
+            metodo = (metodo_copia)i;
+        }
+        if (r != 0) {
+            break;
+        }
+    }
+
+    if (res != NULL) {
+        res->metodo = metodo;
+        res->bytes = bytes;
+        res->segundos = agora() - inicio;
+    }
+    return r == 1 ? 0 : -1;
+}
+
+/// @brief Copia usando apenas o ciclo read/write com buffer.
+/// @param fd_src Descritor de origem.
+/// @param fd_dest Descritor de destino.
+/// @param res Resultado da cópia (pode ser NULL).
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+int copia_descritores_buffer(int fd_src, int fd_dest, resultado_copia *res) {
+    unsigned long long bytes = 0;
+    double inicio = agora();
+    int r = copia_com_buffer(fd_src, fd_dest, &bytes);
+
+    if (res != NULL) {
+        res->metodo = COPIA_BUFFER;
+        res->bytes = bytes;
+        res->segundos = agora() - inicio;
+    }
+    return r == 1 ? 0 : -1;
+}
+
+/// @brief Devolve o nome de um método de cópia.
+/// @param metodo Método de cópia.
+/// @return Nome do método.
+const char *nome_metodo_copia(metodo_copia metodo) {
+    switch (metodo) {
+        case COPIA_COPY_FILE_RANGE: return "copy_file_range";
+        case COPIA_FICLONE:         return "reflink (FICLONE)";
+        case COPIA_SENDFILE:        return "sendfile";
+        case COPIA_SPLICE:          return "splice";
+        case COPIA_BUFFER:          return "read/write";
+        case COPIA_PARALELA:        return "pedaços em paralelo";
+        case COPIA_IO_URING:        return "io_uring";
+    }
+    return "desconhecido";
+}
+
+/// @brief Mostra o método usado, os bytes copiados e o débito em MiB/s.
+/// @param res Resultado da cópia.
+void mostra_resultado_copia(const resultado_copia *res) {
+    double mib = res->bytes / (1024.0 * 1024.0);
+    double debito = res->segundos > 0 ? mib / res->segundos : 0;
+
+    saida_info("Método: %s, %llu bytes em %.6f s (%.1f MiB/s)\n",
+           nome_metodo_copia(res->metodo), res->bytes, res->segundos, debito);
+}
@@ -0,0 +1,69 @@
+/**
+ * @file motor_copia.h
+ * @brief Motor de cópia entre descritores usando os mecanismos mais rápidos do kernel.
+ *
+ * O motor tenta, por esta ordem, copy_file_range, reflink (FICLONE),
+ * sendfile/splice e, por fim, o ciclo read/write com buffer.
+ *
+ * @date 2025
+ */
+
+#ifndef MOTOR_COPIA_H
+#define MOTOR_COPIA_H
+
+/**
+ * @brief Mecanismo usado para efetuar a cópia.
+ */
+typedef enum {
+    COPIA_COPY_FILE_RANGE,  ///< copy_file_range (cópia feita no kernel)
+    COPIA_FICLONE,          ///< reflink em sistemas de ficheiros CoW
+    COPIA_SENDFILE,         ///< sendfile de ficheiro para descritor
+    COPIA_SPLICE,           ///< splice quando uma das pontas é um pipe
+    COPIA_BUFFER,           ///< ciclo read/write em espaço de utilizador
+    COPIA_PARALELA,         ///< pedaços copiados em paralelo (ver copia_paralela.h)
+    COPIA_IO_URING          ///< pares leitura/escrita ligados num io_uring (ver anel_es.h)
+} metodo_copia;
+
+/**
+ * @brief Resultado de uma cópia: método usado, bytes copiados e tempo gasto.
+ */
+typedef struct {
+    metodo_copia metodo;
+    unsigned long long bytes;
+    double segundos;
+} resultado_copia;
+
+/**
+ * @brief Copia tudo o que resta de fd_src (a partir da posição atual) para fd_dest.
+ * @param fd_src Descritor de origem.
+ * @param fd_dest Descritor de destino.
+ * @param res Estrutura preenchida com o resultado (pode ser NULL).
+ * @return 0 em caso de sucesso, -1 em caso de erro (errno indica a causa).
+ */
+int copia_descritores(int fd_src, int fd_dest, resultado_copia *res);
+
+/**
+ * @brief Copia usando apenas o ciclo read/write com um buffer de 4 KiB.
+ *
+ * Usado como último recurso e como referência nos benchmarks.
+ * @param fd_src Descritor de origem.
+ * @param fd_dest Descritor de destino.
+ * @param res Estrutura preenchida com o resultado (pode ser NULL).
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int copia_descritores_buffer(int fd_src, int fd_dest, resultado_copia *res);
+
+/**
+ * @brief Devolve o nome legível de um método de cópia.
+ * @param metodo Método de cópia.
+ * @return String constante com o nome.
+ */
+const char *nome_metodo_copia(metodo_copia metodo);
+
+/**
+ * @brief Mostra o método usado e o débito obtido numa cópia.
+ * @param res Resultado da cópia.
+ */
+void mostra_resultado_copia(const resultado_copia *res);
+
+#endif // MOTOR_COPIA_H
@@ -0,0 +1,466 @@
+/**
+ * @file padroes.c
+ * @brief Implementação da expansão de padrões.
+ *
+ * Cada componente compilada é um autómato com um estado por carácter do
+ * padrão (o bit i indica que os primeiros i caracteres já corresponderam);
+ * um '*' é um ciclo no estado onde aparece. Por cada byte do nome:
+ *
+ *     S = ((S & aceita[byte]) << 1) | (S & estrela)
+ *
+ * e o nome corresponde se no fim o bit final estiver ligado. Os bytes de
+ * continuação UTF-8 mantêm também os estados a seguir a um '?' ou a uma
+ * classe, para que estes correspondam a um carácter inteiro. Com mais de 63
+ * caracteres o estado ocupa várias palavras e o deslocamento passa o bit
+ * mais alto de cada palavra para a seguinte.
+ *
+ * O padrão é dividido nas componentes; as que não têm caracteres especiais
+ * são juntadas ao caminho sem ler a diretoria, e só no fim se verifica que
+ * o caminho existe.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include "padroes.h"
+#include "cache_diretorias.h"
+
+/// Protege a cache de diretorias durante uma expansão.
+static pthread_mutex_t trinco = PTHREAD_MUTEX_INITIALIZER;
+
+/// @brief Componente de um padrão já separada.
+typedef struct {
+    const char *literal;            ///< texto sem proteções, se não tiver caracteres especiais
+    int recursivo;                  ///< 1 se for "**"
+    padrao_compilado *compilado;    ///< autómato, se tiver caracteres especiais
+} componente;
+
+/// @brief Estado de uma expansão.
+typedef struct {
+    componente *componentes;
+    int num_componentes;
+    int barra_final;                ///< o padrão termina em '/': só diretorias
+    arena *a;
+    char **resultados;
+    size_t num_resultados, capacidade;
+    int erro;                       ///< 1 se faltou memória
+    char caminho[PATH_MAX];
+} expansao;
+
+static int e_continuacao(unsigned char c) {
+    return c >= 0x80 && c <= 0xBF;
+}
+
+/// @brief Indica se um texto tem caracteres especiais não protegidos.
+/// @param texto Texto.
+/// @param n Tamanho.
+/// @return 1 se tiver, 0 caso contrário.
+int tem_padrao(const char *texto, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (texto[i] == '\\') {
+            i++;
+        } else if (texto[i] == '*' || texto[i] == '?' || texto[i] == '[') {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/// @brief Lê uma classe [...] a partir do '['.
+/// @param bytes Bytes aceites pela classe (preenchido).
+/// @return Posição a seguir ao ']', ou 0 se a classe não fechar (o '[' é literal).
+static size_t le_classe(const char *texto, size_t n, size_t i, unsigned char bytes[256]) {
+    size_t j = i + 1;
+    int negada = 0, primeiro = 1;
+
+    memset(bytes, 0, 256);
+    if (j < n && (texto[j] == '!' || texto[j] == '^')) {
+        negada = 1;
+        j++;
+    }
+    for (;;) {
+        unsigned char inicio, fim;
+
+        if (j >= n) {
+            return 0;
+        }
+        if (texto[j] == ']' && !primeiro) {
+            break;
+        }
+        primeiro = 0;
+        if (texto[j] == '\\' && j + 1 < n) {
+            j++;
+        }
+        inicio = fim = (unsigned char)texto[j++];
+        if (j + 1 < n && texto[j] == '-' && texto[j + 1] != ']') {
+            j++;
+            if (texto[j] == '\\' && j + 1 < n) {
+                j++;
+            }
+            fim = (unsigned char)texto[j++];
+        }
+        for (unsigned int c = inicio; c <= fim; c++) {
+            bytes[c] = 1;
+        }
+    }
+    if (negada) {
+        for (int c = 0; c < 256; c++) {
+            // Uma classe negada começa sempre um carácter, nunca a meio de um
+            bytes[c] = !bytes[c] && !e_continuacao(c) && c != '/' && c != '\0';
+        }
+    }
+    return j + 1;
+}
+
+/// @brief Compila uma componente de um padrão.
+/// @param texto Componente.
+/// @param n Tamanho.
+/// @param p Padrão compilado.
+void padrao_compila(const char *texto, size_t n, padrao_compilado *p) {
+    unsigned char bytes[256];
+    int m = 0;
+
+    memset(p, 0, sizeof(*p));
+    for (size_t i = 0; i < n; ) {
+        int w = m / 64;
+        uint64_t bit = 1ULL << (m % 64);
+        size_t fim_classe;
+
+        if (texto[i] == '*') {
+            p->estrela[w] |= bit;
+            i++;
+            continue;
+        }
+        if (m == PADRAO_MAX_CARACTERES) {
+            return;             // mais caracteres do que qualquer nome: p->valido fica a 0
+        }
+        if (texto[i] == '?') {
+            for (int c = 1; c < 256; c++) {
+                if (!e_continuacao(c) && c != '/') {
+                    p->aceita[w][c] |= bit;
+                }
+            }
+            p->continua[(m + 1) / 64] |= 1ULL << ((m + 1) % 64);
+            i++;
+        } else if (texto[i] == '[' && (fim_classe = le_classe(texto, n, i, bytes)) != 0) {
+            for (int c = 0; c < 256; c++) {
+                if (bytes[c]) {
+                    p->aceita[w][c] |= bit;
+                }
+            }
+            p->continua[(m + 1) / 64] |= 1ULL << ((m + 1) % 64);
+            i = fim_classe;
+        } else {
+            unsigned char c;
+
+            if (texto[i] == '\\' && i + 1 < n) {
+                i++;
+            }
+            c = (unsigned char)texto[i++];
+            p->aceita[w][c] |= bit;
+            if (m == 0 && c == '.' && !(p->estrela[0] & 1)) {
+                p->ponto_explicito = 1;
+            }
+        }
+        m++;
+    }
+    p->final = m;
+    p->palavras = m / 64 + 1;
+    p->valido = 1;
+}
+
+/// @brief Compara um nome com uma componente de várias palavras.
+/// @return 1 se corresponde, 0 caso contrário.
+static int corresponde_longo(const padrao_compilado *p, const unsigned char *c) {
+    uint64_t s[PADRAO_PALAVRAS] = { 1 };
+
+    for (; *c != '\0'; c++) {
+        uint64_t transporte = 0, algum = 0;
+
+        for (int w = 0; w < p->palavras; w++) {
+            uint64_t mantidos = s[w] & (e_continuacao(*c) ? p->estrela[w] | p->continua[w] : p->estrela[w]);
+            uint64_t avancam = s[w] & p->aceita[w][*c];
+
+            s[w] = (avancam << 1) | transporte | mantidos;
+            transporte = avancam >> 63;
+            algum |= s[w];
+        }
+        if (algum == 0) {
+            return 0;
+        }
+    }
+    return (s[p->final / 64] >> (p->final % 64)) & 1;
+}
+
+/// @brief Compara um nome com uma componente compilada.
+/// @param p Padrão compilado.
+/// @param nome Nome.
+/// @return 1 se corresponde, 0 caso contrário.
+int padrao_corresponde(const padrao_compilado *p, const char *nome) {
+    const unsigned char *c = (const unsigned char *)nome;
+    uint64_t s = 1;
+
+    if (!p->valido || (nome[0] == '.' && !p->ponto_explicito)) {
+        return 0;
+    }
+    if (p->palavras > 1) {
+        return corresponde_longo(p, c);
+    }
+    for (; *c != '\0'; c++) {
+        uint64_t mantidos = s & (e_continuacao(*c) ? p->estrela[0] | p->continua[0] : p->estrela[0]);
+
+        s = ((s & p->aceita[0][*c]) << 1) | mantidos;
+        if (s == 0) {
+            return 0;
+        }
+    }
+    return (s >> p->final) & 1;
+}
+
+/// @brief Retira os '\' que protegem os caracteres de um padrão.
+/// @param padrao Padrão.
+/// @param a Arena.
+/// @return Texto sem as proteções, ou NULL se faltar memória.
+char *desprotege_padrao(const char *padrao, arena *a) {
+    char *texto = arena_aloca(a, strlen(padrao) + 1), *w = texto;
+
+    if (texto == NULL) {
+        return NULL;
+    }
+    for (const char *q = padrao; *q != '\0'; q++) {
+        if (*q == '\\' && q[1] != '\0') {
+            q++;
+        }
+        *w++ = *q;
+    }
+    *w = '\0';
+    return texto;
+}
+
+/// @brief Acrescenta um nome ao caminho a partir da posição len.
+/// @return Novo tamanho do caminho, ou -1 se ficar demasiado longo.
+static int junta(expansao *x, int len, const char *nome) {
+    size_t n = strlen(nome);
+
+    if (len > 0 && x->caminho[len - 1] != '/') {
+        if (len + 1 >= PATH_MAX) {
+            return -1;
+        }
+        x->caminho[len++] = '/';
+    }
+    if (len + n + 2 > PATH_MAX) {
+        return -1;
+    }
+    memcpy(x->caminho + len, nome, n + 1);
+    return len + n;
+}
+
+/// @brief Guarda o caminho atual nos resultados.
+static void guarda(expansao *x, int len) {
+    char *copia = arena_aloca(x->a, len + 2);
+
+    if (copia == NULL) {
+        x->erro = 1;
+        return;
+    }
+    memcpy(copia, x->caminho, len);
+    if (x->barra_final) {
+        copia[len++] = '/';
+    }
+    copia[len] = '\0';
+
+    if (x->num_resultados == x->capacidade) {
+        // A arena não tem realloc: o array antigo fica para trás até ser reiniciada
+        char **maior = arena_aloca(x->a, x->capacidade * 2 * sizeof(char *));
+
+        if (maior == NULL) {
+            x->erro = 1;
+            return;
+        }
+        memcpy(maior, x->resultados, x->num_resultados * sizeof(char *));
+        x->resultados = maior;
+        x->capacidade *= 2;
+    }
+    x->resultados[x->num_resultados++] = copia;
+}
+
+/// @brief Expande as componentes a partir de k, com o caminho já construído até len.
+/// @param verifica 1 se ainda não se sabe se o caminho existe (a última
+/// componente juntada era literal).
+static void expande_em(expansao *x, int len, int k, int verifica) {
+    const conteudo_diretoria *d;
+    const componente *c;
+
+    if (x->erro) {
+        return;
+    }
+    if (k == x->num_componentes) {
+        struct stat st;
+
+        if ((verifica && lstat(x->caminho, &st) == -1) ||
+            (x->barra_final && (stat(x->caminho, &st) == -1 || !S_ISDIR(st.st_mode)))) {
+            return;
+        }
+        guarda(x, len);
+        return;
+    }
+
+    c = &x->componentes[k];
+    if (c->literal != NULL) {
+        int novo = junta(x, len, c->literal);
+        if (novo != -1) {
+            expande_em(x, novo, k + 1, 1);
+        }
+        return;
+    }
+
+    x->caminho[len] = '\0';
+    d = cache_diretorias_obtem(x->caminho);
+    if (d == NULL) {
+        return;
+    }
+
+    if (c->recursivo) {
+        // Zero diretorias: o resto do padrão aplica-se já aqui
+        if (k + 1 < x->num_componentes) {
+            expande_em(x, len, k + 1, 0);
+        }
+        for (int i = 0; i < d->num_entradas; i++) {
+            const entrada_diretoria *e = &d->entradas[i];
+            int novo;
+
+            if (e->nome[0] == '.' || (novo = junta(x, len, e->nome)) == -1) {
+                continue;
+            }
+            // No fim do padrão, "**" corresponde a todas as entradas
+            if (k + 1 == x->num_componentes) {
+                expande_em(x, novo, k + 1, 0);
+            }
+            if (e->tipo == DT_DIR) {
+                expande_em(x, novo, k, 0);
+            }
+        }
+        return;
+    }
+
+    for (int i = 0; i < d->num_entradas; i++) {
+        const entrada_diretoria *e = &d->entradas[i];
+        int novo;
+
+        if (!padrao_corresponde(c->compilado, e->nome)) {
+            continue;
+        }
+        // Só as diretorias (ou ligações para diretorias) podem ter mais componentes
+        if (k + 1 < x->num_componentes && e->tipo != DT_DIR && e->tipo != DT_LNK) {
+            continue;
+        }
+        if ((novo = junta(x, len, e->nome)) != -1) {
+            expande_em(x, novo, k + 1, 0);
+        }
+    }
+}
+
+static int compara_caminhos(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/// @brief Separa o padrão nas componentes e compila as que têm caracteres especiais.
+/// @return 0 em caso de sucesso, -1 se faltar memória.
+static int separa_componentes(expansao *x, const char *padrao) {
+    size_t n = strlen(padrao), max = 1;
+
+    for (size_t i = 0; i < n; i++) {
+        max += padrao[i] == '/';
+    }
+    x->componentes = arena_aloca(x->a, max * sizeof(componente));
+    if (x->componentes == NULL) {
+        return -1;
+    }
+    x->barra_final = n > 0 && padrao[n - 1] == '/';
+
+    for (size_t i = 0; i < n; ) {
+        size_t fim = i;
+        componente *c = &x->componentes[x->num_componentes];
+
+        while (fim < n && padrao[fim] != '/') {
+            fim++;
+        }
+        if (fim > i) {
+            memset(c, 0, sizeof(*c));
+            if (fim - i == 2 && padrao[i] == '*' && padrao[i + 1] == '*') {
+                c->recursivo = 1;
+                // "**/**" é o mesmo que "**"
+                if (x->num_componentes > 0 && x->componentes[x->num_componentes - 1].recursivo) {
+                    i = fim + 1;
+                    continue;
+                }
+            } else if (tem_padrao(padrao + i, fim - i)) {
+                c->compilado = arena_aloca(x->a, sizeof(padrao_compilado));
+                if (c->compilado == NULL) {
+                    return -1;
+                }
+                padrao_compila(padrao + i, fim - i, c->compilado);
+            } else {
+                char *texto = arena_aloca(x->a, fim - i + 1);
+                if (texto == NULL) {
+                    return -1;
+                }
+                memcpy(texto, padrao + i, fim - i);
+                texto[fim - i] = '\0';
+                if ((c->literal = desprotege_padrao(texto, x->a)) == NULL) {
+                    return -1;
+                }
+            }
+            x->num_componentes++;
+        }
+        i = fim + 1;
+    }
+    return 0;
+}
+
+/// @brief Expande um padrão nos caminhos que lhe correspondem.
+/// @param padrao Padrão.
+/// @param a Arena.
+/// @param n Número de caminhos encontrados.
+/// @return Caminhos ordenados, ou NULL se faltar memória.
+char **expande_padrao(const char *padrao, arena *a, size_t *n) {
+    expansao *x = arena_aloca(a, sizeof(expansao));
+
+    *n = 0;
+    if (x == NULL) {
+        return NULL;
+    }
+    memset(x, 0, offsetof(expansao, caminho));
+    x->a = a;
+    x->capacidade = 16;
+    x->resultados = arena_aloca(a, x->capacidade * sizeof(char *));
+    if (x->resultados == NULL || separa_componentes(x, padrao) == -1) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&trinco);
+    cache_diretorias_arruma();
+    strcpy(x->caminho, padrao[0] == '/' ? "/" : "");
+    expande_em(x, padrao[0] == '/' ? 1 : 0, 0, 0);
+    pthread_mutex_unlock(&trinco);
+    if (x->erro) {
+        return NULL;
+    }
+
+    // As diretorias da cache estão ordenadas, por isso normalmente os
+    // resultados também (nem sempre com várias componentes: "a-b" < "a/x")
+    for (size_t i = 1; i < x->num_resultados; i++) {
+        if (strcmp(x->resultados[i - 1], x->resultados[i]) > 0) {
+            qsort(x->resultados, x->num_resultados, sizeof(char *), compara_caminhos);
+            break;
+        }
+    }
+    *n = x->num_resultados;
+    return x->resultados;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file padroes.h
+ * @brief Expansão de padrões de nomes de ficheiros (*, ?, [...] e **).
+ *
+ * Cada componente do padrão (entre '/') é compilado uma vez num autómato
+ * simulado em paralelo nos bits de uma palavra de 64 bits (Shift-And), ou
+ * de várias palavras nas componentes com mais de 63 caracteres: a
+ * comparação com um nome é uma passagem pelos seus bytes, sem retrocesso,
+ * qualquer que seja o número de '*'. As diretorias são lidas através da
+ * cache de diretorias (ver cache_diretorias.h).
+ *
+ * Regras, como no glob(3):
+ * - '*' corresponde a qualquer sequência e '?' a um carácter (UTF-8);
+ * - [abc], [a-z] e [!a-z] (ou [^a-z]) comparam um byte (sem [:classe:],
+ *   [.x.] nem [=x=]);
+ * - '**' sozinho numa componente corresponde a zero ou mais diretorias
+ *   (sem seguir ligações simbólicas); no fim do padrão, a tudo o que está
+ *   dentro da diretoria;
+ * - os nomes começados por '.' só correspondem a um padrão que comece por '.';
+ * - '\\' protege o carácter seguinte;
+ * - os resultados vêm ordenados; um padrão sem correspondências não dá
+ *   nenhum resultado.
+ *
+ * Uma componente com mais de 255 caracteres (sem contar os '*') não
+ * corresponde a nenhum nome, porque os nomes têm no máximo 255 bytes
+ * (NAME_MAX).
+ *
+ * @date 2025
+ */
+
+#ifndef PADROES_H
+#define PADROES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "arena.h"
+
+/// Número máximo de caracteres (sem contar os '*') numa componente (o NAME_MAX).
+#define PADRAO_MAX_CARACTERES 255
+
+/// Palavras de 64 bits do estado de uma componente (um bit por carácter, mais o final).
+#define PADRAO_PALAVRAS ((PADRAO_MAX_CARACTERES + 64) / 64)
+
+/**
+ * @brief Componente de um padrão, compilada.
+ *
+ * O estado do carácter i é o bit i % 64 da palavra i / 64.
+ */
+typedef struct {
+    uint64_t aceita[PADRAO_PALAVRAS][256];  ///< bit i: o carácter i do padrão aceita este byte
+    uint64_t estrela[PADRAO_PALAVRAS];      ///< bit i: há um '*' antes do carácter i
+    uint64_t continua[PADRAO_PALAVRAS];     ///< bit i: o carácter i-1 é '?' ou uma classe (absorve bytes de continuação UTF-8)
+    int palavras;           ///< palavras usadas (1 até 63 caracteres)
+    int final;              ///< número do estado final (o número de caracteres)
+    int ponto_explicito;    ///< 1 se o padrão começa por um '.' literal
+    int valido;             ///< 0 se o padrão é demasiado longo para algum nome
+} padrao_compilado;
+
+/**
+ * @brief Indica se um texto tem caracteres especiais ('*', '?' ou '[') não protegidos.
+ * @param texto Texto.
+ * @param n Tamanho do texto.
+ * @return 1 se tiver, 0 caso contrário.
+ */
+int tem_padrao(const char *texto, size_t n);
+
+/**
+ * @brief Compila uma componente de um padrão.
+ * @param texto Componente (sem '/').
+ * @param n Tamanho da componente.
+ * @param p Padrão compilado.
+ */
+void padrao_compila(const char *texto, size_t n, padrao_compilado *p);
+
+/**
+ * @brief Compara um nome com uma componente compilada.
+ * @param p Padrão compilado.
+ * @param nome Nome (sem '/').
+ * @return 1 se corresponde, 0 caso contrário.
+ */
+int padrao_corresponde(const padrao_compilado *p, const char *nome);
+
+/**
+ * @brief Expande um padrão nos caminhos que lhe correspondem.
+ *
+ * Pode ser chamada por várias threads (a expansão é feita com um trinco).
+ * @param padrao Padrão (com '\\' a proteger os caracteres literais).
+ * @param a Arena onde ficam os caminhos e o array.
+ * @param n Número de caminhos encontrados.
+ * @return Array com os caminhos, ordenados; NULL se faltar memória.
+ */
+char **expande_padrao(const char *padrao, arena *a, size_t *n);
+
+/**
+ * @brief Retira os '\\' que protegem os caracteres de um padrão.
+ * @param padrao Padrão.
+ * @param a Arena onde fica o resultado.
+ * @return Texto sem as proteções, ou NULL se faltar memória.
+ */
+char *desprotege_padrao(const char *padrao, arena *a);
+
+#endif // PADROES_H
@@ -0,0 +1,327 @@
+/**
+ * @file paralelo.c
+ * @brief Implementação do `paralelo`.
+ *
+ * Cada worker tem dois memfds (saída e erros) que reutiliza em todos os seus
+ * trabalhos: durante um trabalho, a saída e os erros da thread apontam para
+ * eles (e um comando do sistema recebe-os como STDOUT e STDERR); no fim, o
+ * conteúdo é copiado para a memória do trabalho e os memfds são esvaziados.
+ * Assim, o número de descritores abertos depende das threads e não dos
+ * trabalhos. A thread que chamou o `paralelo` escreve as saídas à medida que
+ * os trabalhos terminam.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "paralelo.h"
+#include "pipeline.h"
+#include "perfil.h"
+#include "pool_threads.h"
+#include "saida.h"
+
+/// @brief Estado partilhado por todos os trabalhos.
+typedef struct {
+    char **modelo;
+    char **valores;
+    int substitui;                  ///< 1 se algum argumento do modelo tem "{}"
+    int nulo;                       ///< /dev/null, a entrada dos trabalhos
+    int (*capturas)[2];             ///< memfds (saída e erros) de cada worker
+    pthread_mutex_t trinco;
+    pthread_cond_t terminou;
+    int *concluidos;                ///< índices dos trabalhos pela ordem em que terminaram
+    int num_concluidos;
+} contexto_paralelo;
+
+/// @brief Um trabalho: o comando para um valor.
+typedef struct {
+    contexto_paralelo *c;
+    int indice;
+    int pronto;                     ///< protegido pelo trinco do contexto
+    int codigo;
+    char **args;                    ///< argumentos do comando (usados até ao fim do pipeline)
+    execucao_pipeline *execucao;    ///< etapa já recolhida, reportada por quem escreve a saída
+    char *saida, *erros;            ///< texto capturado (libertar com free)
+    size_t tamanho_saida, tamanho_erros;
+} trabalho;
+
+/// @brief Substitui cada "{}" de um argumento pelo valor.
+/// @return Novo argumento (libertar com free), ou NULL sem memória.
+static char *substitui_valor(const char *argumento, const char *valor) {
+    size_t ocorrencias = 0, tamanho_valor = strlen(valor);
+    char *novo, *w;
+
+    for (const char *p = argumento; (p = strstr(p, "{}")) != NULL; p += 2) {
+        ocorrencias++;
+    }
+    novo = malloc(strlen(argumento) + ocorrencias * tamanho_valor + 1);
+    if (novo == NULL) {
+        return NULL;
+    }
+    w = novo;
+    for (const char *p = argumento; *p != '\0';) {
+        if (p[0] == '{' && p[1] == '}') {
+            memcpy(w, valor, tamanho_valor);
+            w += tamanho_valor;
+            p += 2;
+        } else {
+            *w++ = *p++;
+        }
+    }
+    *w = '\0';
+    return novo;
+}
+
+/// @brief Liberta os argumentos de um trabalho (os que não são do modelo).
+static void liberta_argumentos(const contexto_paralelo *c, char **args) {
+    if (args == NULL) {
+        return;
+    }
+    for (int i = 0; c->modelo[i] != NULL; i++) {
+        if (args[i] != c->modelo[i]) {
+            free(args[i]);
+        }
+    }
+    free(args);
+}
+
+/// @brief Constrói os argumentos de um trabalho a partir do modelo.
+/// @return Argumentos terminados em NULL, ou NULL sem memória.
+/// @details Os argumentos sem "{}" são os do modelo (não são copiados); se
+/// nenhum tiver "{}", o valor é acrescentado no fim.
+static char **argumentos_trabalho(const contexto_paralelo *c, char *valor) {
+    int n = 0;
+    char **args;
+
+    while (c->modelo[n] != NULL) {
+        n++;
+    }
+    args = calloc(n + 2, sizeof(char *));
+    if (args == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < n; i++) {
+        args[i] = c->modelo[i];
+        if (c->substitui && strstr(c->modelo[i], "{}") != NULL) {
+            args[i] = substitui_valor(c->modelo[i], valor);
+            if (args[i] == NULL) {
+                liberta_argumentos(c, args);
+                return NULL;
+            }
+        }
+    }
+    if (!c->substitui) {
+        args[n] = valor;
+    }
+    return args;
+}
+
+/// @brief Copia o conteúdo de um memfd para a memória e esvazia-o.
+/// @param fd memfd.
+/// @param tamanho Bytes copiados.
+/// @return Texto (libertar com free), ou NULL se o memfd estava vazio.
+static char *recolhe_captura(int fd, size_t *tamanho) {
+    struct stat st;
+    size_t lidos = 0;
+    char *texto;
+
+    *tamanho = 0;
+    if (fstat(fd, &st) == -1 || st.st_size == 0) {
+        return NULL;
+    }
+    texto = malloc(st.st_size);
+    while (texto != NULL && lidos < (size_t)st.st_size) {
+        ssize_t n = pread(fd, texto + lidos, st.st_size - lidos, lidos);
+
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        lidos += n;
+    }
+    if (ftruncate(fd, 0) == -1 || lseek(fd, 0, SEEK_SET) == -1) {
+        saida_erro("Erro: Não foi possível esvaziar a captura de um trabalho: %s.\n", strerror(errno));
+    }
+    *tamanho = texto != NULL ? lidos : 0;
+    return texto;
+}
+
+/// @brief Executa um trabalho num worker (tarefa do pool).
+/// @details O comando é um pipeline com uma só etapa; o "Terminou comando
+/// ... com código ..." é escrito depois da saída e dos erros capturados,
+/// por quem escreve a saída.
+static void executa_trabalho(void *arg) {
+    trabalho *t = arg;
+    contexto_paralelo *c = t->c;
+    int *captura = c->capturas[pool_worker_atual()];
+    int entrada = entrada_fd(), saida = saida_fd(), erro = saida_erro_fd();
+    char **args = argumentos_trabalho(c, c->valores[t->indice]);
+
+    for (int k = 0; k < 2; k++) {
+        if (captura[k] == -1) {
+            captura[k] = memfd_create(k == 0 ? "paralelo-saida" : "paralelo-erros", MFD_CLOEXEC);
+        }
+    }
+    if (args == NULL || captura[0] == -1 || captura[1] == -1) {
+        saida_erro("Erro: Não foi possível preparar o trabalho para '%s'.\n", c->valores[t->indice]);
+        t->codigo = 1;
+    } else {
+        etapa_pipeline etapa = { args, NULL, NULL, 0 };
+
+        saida_redireciona(c->nulo, captura[0]);
+        saida_define_erro(captura[1]);
+        t->execucao = pipeline_inicia(&etapa, 1, 0, perfil_ativo());
+        t->codigo = 1;
+        if (t->execucao != NULL) {
+            pipeline_recolhe(t->execucao, 0);
+            t->codigo = pipeline_codigo(t->execucao);
+        }
+        saida_flush();
+        saida_redireciona(entrada, saida);
+        saida_define_erro(erro);
+        t->saida = recolhe_captura(captura[0], &t->tamanho_saida);
+        t->erros = recolhe_captura(captura[1], &t->tamanho_erros);
+    }
+    t->args = args;
+
+    pthread_mutex_lock(&c->trinco);
+    t->pronto = 1;
+    c->concluidos[c->num_concluidos++] = t->indice;
+    pthread_cond_broadcast(&c->terminou);
+    pthread_mutex_unlock(&c->trinco);
+}
+
+/// @brief Executa o comando modelo uma vez por valor, em paralelo.
+/// @param modelo Comando e argumentos, terminados em NULL.
+/// @param valores Valores, um por trabalho.
+/// @param n Número de valores.
+/// @param o Opções.
+/// @return Número de trabalhos que falharam (no máximo PARALELO_MAX_CODIGO).
+/// @details
+/// Os trabalhos são submetidos do último para o primeiro: as submissões
+/// externas são distribuídas pelas filas e cada worker tira primeiro a
+/// tarefa mais recente da sua, por isso os trabalhos arrancam (quase) pela
+/// ordem dos valores e, com -k, poucas saídas ficam à espera das anteriores.
+/// Variáveis:
+/// - c: estado partilhado com os workers
+/// - trabalhos: um por valor
+/// - falhados: trabalhos com código de saída diferente de 0
+int paralelo(char *modelo[], char *valores[], int n, const opcoes_paralelo *o) {
+    contexto_paralelo c = { modelo, valores, 0, -1, NULL, PTHREAD_MUTEX_INITIALIZER,
+                            PTHREAD_COND_INITIALIZER, NULL, 0 };
+    trabalho *trabalhos = calloc(n, sizeof(trabalho));
+    pool_threads *pool = pool_cria(o->num_threads);
+    struct timespec inicio, fim;
+    int falhados = 0, threads = 0;
+
+    if (n == 0) {
+        free(trabalhos);
+        if (pool != NULL) {
+            pool_destroi(pool);
+        }
+        return 0;
+    }
+    for (int i = 0; modelo[i] != NULL; i++) {
+        c.substitui |= strstr(modelo[i], "{}") != NULL;
+    }
+    if (pool != NULL) {
+        threads = pool_num_threads(pool);
+        c.capturas = malloc(threads * sizeof(*c.capturas));
+    }
+    c.concluidos = malloc(n * sizeof(int));
+    c.nulo = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    if (trabalhos == NULL || pool == NULL || c.capturas == NULL || c.concluidos == NULL || c.nulo == -1) {
+        saida_erro("Erro: Não foi possível criar as threads do paralelo.\n");
+        if (pool != NULL) {
+            pool_destroi(pool);
+        }
+        if (c.nulo != -1) {
+            close(c.nulo);
+        }
+        free(c.capturas);
+        free(c.concluidos);
+        free(trabalhos);
+        return 1;
+    }
+    for (int w = 0; w < threads; w++) {
+        c.capturas[w][0] = c.capturas[w][1] = -1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    for (int i = n - 1; i >= 0; i--) {
+        trabalhos[i].c = &c;
+        trabalhos[i].indice = i;
+        pool_submete(pool, executa_trabalho, &trabalhos[i]);
+    }
+
+    // Escrever cada trabalho de uma só vez: pela ordem de fim, ou pela dos valores (-k)
+    for (int k = 0; k < n; k++) {
+        trabalho *t;
+
+        pthread_mutex_lock(&c.trinco);
+        while (o->ordenado ? !trabalhos[k].pronto : c.num_concluidos <= k) {
+            pthread_cond_wait(&c.terminou, &c.trinco);
+        }
+        t = o->ordenado ? &trabalhos[k] : &trabalhos[c.concluidos[k]];
+        pthread_mutex_unlock(&c.trinco);
+
+        if (t->tamanho_saida > 0) {
+            saida_escreve(t->saida, t->tamanho_saida);
+        }
+        if (t->tamanho_erros > 0) {
+            saida_flush();
+            escreve_tudo(saida_erro_fd(), t->erros, t->tamanho_erros);
+        }
+        if (t->execucao != NULL) {
+            pipeline_reporta(t->execucao);
+            pipeline_liberta(t->execucao);
+        }
+        liberta_argumentos(&c, t->args);
+        falhados += t->codigo != 0;
+        free(t->saida);
+        free(t->erros);
+    }
+    pool_espera(pool);
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+
+    if (o->estatisticas) {
+        double segundos = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+
+        saida_printf("%d trabalhos (%d falharam), %d threads, %.6f s (%.1f trabalhos/s)\n", n, falhados,
+                     threads, segundos, segundos > 0 ? n / segundos : 0);
+        for (int w = 0; w < threads; w++) {
+            estatisticas_worker e;
+            pool_estatisticas(pool, w, &e);
+            saida_printf("  Thread %d: %llu trabalhos (%llu roubados), %.6f s ocupada\n",
+                         w, e.tarefas, e.roubos, e.segundos_ocupado);
+        }
+    }
+
+    pool_destroi(pool);
+    for (int w = 0; w < threads; w++) {
+        for (int k = 0; k < 2; k++) {
+            if (c.capturas[w][k] != -1) {
+                close(c.capturas[w][k]);
+            }
+        }
+    }
+    close(c.nulo);
+    pthread_mutex_destroy(&c.trinco);
+    pthread_cond_destroy(&c.terminou);
+    free(c.capturas);
+    free(c.concluidos);
+    free(trabalhos);
+    return falhados < PARALELO_MAX_CODIGO ? falhados : PARALELO_MAX_CODIGO;
+}
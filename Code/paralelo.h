@@ -0,0 +1,45 @@
+/**
+ * @file paralelo.h
+ * @brief Execução do mesmo comando para muitos argumentos em paralelo (`paralelo`).
+ *
+ * Cada trabalho é o comando modelo com um dos valores (no lugar de cada "{}",
+ * ou acrescentado no fim) e é uma tarefa do pool de threads com roubo de
+ * tarefas. Um comando interno corre no próprio worker, sem criar processos;
+ * um comando do sistema é lançado pelo worker, que espera por ele, por isso
+ * nunca há mais do que N processos ao mesmo tempo. A saída e os erros de
+ * cada trabalho são capturados num memfd do worker e escritos de uma só vez
+ * quando o trabalho termina (ou pela ordem dos valores, com `-k`), com a
+ * linha "Terminou comando ... com código ..." do trabalho: as saídas de dois
+ * trabalhos nunca se misturam.
+ *
+ * @date 2025
+ */
+
+#ifndef PARALELO_H
+#define PARALELO_H
+
+/// Maior código de saída do `paralelo` (o número de trabalhos que falharam, como no GNU parallel).
+#define PARALELO_MAX_CODIGO 101
+
+/**
+ * @brief Opções do `paralelo`.
+ */
+typedef struct {
+    int num_threads;        ///< trabalhos ao mesmo tempo (0 usa o número de CPUs)
+    int ordenado;           ///< 1: saída pela ordem dos valores (-k); 0: pela ordem de fim
+    int estatisticas;       ///< 1: mostra o tempo e o trabalho de cada thread (--stats)
+} opcoes_paralelo;
+
+/**
+ * @brief Executa o comando modelo uma vez por valor, em paralelo.
+ *
+ * A entrada de cada trabalho é /dev/null.
+ * @param modelo Comando e argumentos, terminados em NULL.
+ * @param valores Valores, um por trabalho.
+ * @param n Número de valores.
+ * @param o Opções.
+ * @return Número de trabalhos que falharam (no máximo PARALELO_MAX_CODIGO).
+ */
+int paralelo(char *modelo[], char *valores[], int n, const opcoes_paralelo *o);
+
+#endif // PARALELO_H
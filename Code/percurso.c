@@ -0,0 +1,262 @@
+/**
+ * @file percurso.c
+ * @brief Implementação da leitura de diretorias e do percurso recursivo.
+ *
+ * Os nomes de cada diretoria são copiados para um único bloco de memória;
+ * durante a leitura as entradas guardam a posição do nome nesse bloco (que
+ * pode mudar de sítio com realloc) e só no fim recebem os ponteiros.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "percurso.h"
+#include "pool_threads.h"
+#include "saida.h"
+
+/// Tamanho do buffer passado ao getdents64 (milhares de entradas por chamada).
+#define TAMANHO_DIRENTS (256 * 1024)
+
+/// @brief Estado partilhado de um percurso recursivo.
+typedef struct {
+    funcao_diretoria fn;
+    void *ctx;
+    pool_threads *pool;             ///< NULL no modo não recursivo
+    unsigned long long diretorias;  ///< contadores atualizados com operações atómicas
+    unsigned long long entradas;
+    unsigned long long chamadas_stat;
+    int erros;
+} percurso;
+
+/// @brief Tarefa do pool: ler uma diretoria.
+typedef struct {
+    percurso *p;
+    char *caminho;
+    int profundidade;
+} tarefa_diretoria;
+
+static void tarefa_le_diretoria(void *arg);
+
+/// @brief Lê todas as entradas de uma diretoria aberta.
+/// @param fd Descritor da diretoria.
+/// @param d Conteúdo preenchido.
+/// @param chamadas_stat Contador de fstatat (pode ser NULL).
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+/// @details
+/// Variáveis:
+/// - buffer: registos devolvidos pelo getdents64 (struct dirent64, de tamanho variável)
+/// - usado_nomes: bytes ocupados no bloco de nomes
+int le_diretoria(int fd, conteudo_diretoria *d, unsigned long long *chamadas_stat) {
+    char *buffer = malloc(TAMANHO_DIRENTS);
+    size_t capacidade = 0, capacidade_nomes = 0, usado_nomes = 0;
+    ssize_t n;
+    int resultado = 0;
+
+    d->num_entradas = 0;
+    d->entradas = NULL;
+    d->nomes = NULL;
+    if (buffer == NULL) {
+        return -1;
+    }
+
+    while ((n = getdents64(fd, buffer, TAMANHO_DIRENTS)) > 0) {
+        for (ssize_t pos = 0; pos < n; ) {
+            struct dirent64 *e = (struct dirent64 *)(buffer + pos);
+            size_t len = strlen(e->d_name) + 1;
+            unsigned char tipo = e->d_type;
+
+            pos += e->d_reclen;
+            if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) {
+                continue;
+            }
+
+            // Sem d_type (alguns sistemas de ficheiros): um fstatat relativo à diretoria
+            if (tipo == DT_UNKNOWN) {
+                struct stat st;
+
+                if (fstatat(fd, e->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+                    tipo = IFTODT(st.st_mode);
+                }
+                if (chamadas_stat != NULL) {
+                    (*chamadas_stat)++;
+                }
+            }
+
+            if ((size_t)d->num_entradas == capacidade) {
+                entrada_diretoria *maior;
+
+                capacidade = capacidade ? capacidade * 2 : 256;
+                maior = realloc(d->entradas, capacidade * sizeof(entrada_diretoria));
+                if (maior == NULL) {
+                    resultado = -1;
+                    break;
+                }
+                d->entradas = maior;
+            }
+            if (usado_nomes + len > capacidade_nomes) {
+                char *maior;
+
+                capacidade_nomes = (usado_nomes + len) * 2 + 4096;
+                maior = realloc(d->nomes, capacidade_nomes);
+                if (maior == NULL) {
+                    resultado = -1;
+                    break;
+                }
+                d->nomes = maior;
+            }
+
+            memcpy(d->nomes + usado_nomes, e->d_name, len);
+            d->entradas[d->num_entradas].nome = (const char *)(uintptr_t)usado_nomes;
+            d->entradas[d->num_entradas].tipo = tipo;
+            d->num_entradas++;
+            usado_nomes += len;
+        }
+        if (resultado == -1) {
+            break;
+        }
+    }
+    if (n < 0) {
+        resultado = -1;
+    }
+    free(buffer);
+
+    // O bloco de nomes já não muda de sítio: converter as posições em ponteiros
+    for (int i = 0; i < d->num_entradas; i++) {
+        d->entradas[i].nome = d->nomes + (uintptr_t)d->entradas[i].nome;
+    }
+    return resultado;
+}
+
+/// @brief Liberta as entradas lidas por le_diretoria.
+/// @param d Conteúdo da diretoria.
+void liberta_diretoria(conteudo_diretoria *d) {
+    free(d->entradas);
+    free(d->nomes);
+    d->entradas = NULL;
+    d->nomes = NULL;
+    d->num_entradas = 0;
+}
+
+/// @brief Junta o caminho de uma diretoria com o nome de uma entrada.
+/// @return Caminho novo (libertar com free), ou NULL se faltar memória.
+static char *junta_caminho(const char *diretoria, const char *nome) {
+    size_t a = strlen(diretoria), b = strlen(nome);
+    int barra = a > 0 && diretoria[a - 1] != '/';
+    char *c = malloc(a + barra + b + 1);
+
+    if (c != NULL) {
+        memcpy(c, diretoria, a);
+        c[a] = '/';
+        memcpy(c + a + barra, nome, b + 1);
+    }
+    return c;
+}
+
+/// @brief Lê uma diretoria, submete as subdiretorias (se houver pool) e chama a função.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+static int processa_diretoria(percurso *p, const char *caminho, int profundidade) {
+    conteudo_diretoria d = { caminho, -1, profundidade, 0, NULL, NULL };
+    unsigned long long chamadas_stat = 0;
+    int fd = open(caminho, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    if (fd == -1) {
+        saida_erro("Erro: Não foi possível abrir a diretoria '%s'.\n", caminho);
+        __atomic_fetch_add(&p->erros, 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+    d.fd = fd;
+    if (le_diretoria(fd, &d, &chamadas_stat) == -1) {
+        saida_erro("Erro: Falha ao ler a diretoria '%s'.\n", caminho);
+        __atomic_fetch_add(&p->erros, 1, __ATOMIC_RELAXED);
+    }
+
+    // As subdiretorias são submetidas antes de chamar a função, para que
+    // outras threads as possam ir lendo entretanto
+    for (int i = 0; p->pool != NULL && i < d.num_entradas; i++) {
+        tarefa_diretoria *t;
+
+        if (d.entradas[i].tipo != DT_DIR) {
+            continue;
+        }
+        t = malloc(sizeof(tarefa_diretoria));
+        if (t == NULL || (t->caminho = junta_caminho(caminho, d.entradas[i].nome)) == NULL) {
+            free(t);
+            __atomic_fetch_add(&p->erros, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+        t->p = p;
+        t->profundidade = profundidade + 1;
+        pool_submete(p->pool, tarefa_le_diretoria, t);
+    }
+
+    p->fn(&d, p->ctx);
+
+    __atomic_fetch_add(&p->diretorias, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&p->entradas, (unsigned long long)d.num_entradas, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&p->chamadas_stat, chamadas_stat, __ATOMIC_RELAXED);
+    liberta_diretoria(&d);
+    close(fd);
+    return 0;
+}
+
+/// @brief Tarefa do pool: lê uma subdiretoria.
+static void tarefa_le_diretoria(void *arg) {
+    tarefa_diretoria *t = arg;
+
+    processa_diretoria(t->p, t->caminho, t->profundidade);
+    free(t->caminho);
+    free(t);
+}
+
+/// @brief Lê uma diretoria e, opcionalmente, todas as subdiretorias.
+/// @param raiz Caminho da diretoria inicial.
+/// @param recursivo Se diferente de 0, desce nas subdiretorias.
+/// @param num_threads Threads do pool (0 usa o número de CPUs).
+/// @param fn Função chamada para cada diretoria.
+/// @param ctx Contexto da função.
+/// @param est Estatísticas (pode ser NULL).
+/// @return 0 em caso de sucesso, -1 se a diretoria inicial não puder ser lida.
+/// @details A diretoria inicial é lida na thread atual; as restantes são
+/// tarefas do pool. Como o d_type de uma ligação simbólica é DT_LNK, as
+/// ligações para diretorias nunca são seguidas.
+int percorre_diretorias(const char *raiz, int recursivo, int num_threads,
+                        funcao_diretoria fn, void *ctx, estatisticas_percurso *est) {
+    percurso p = { fn, ctx, NULL, 0, 0, 0, 0 };
+    struct timespec inicio, fim;
+    int resultado;
+
+    if (recursivo) {
+        p.pool = pool_cria(num_threads);
+        if (p.pool == NULL) {
+            saida_erro("Erro: Não foi possível criar as threads do percurso.\n");
+            return -1;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    resultado = processa_diretoria(&p, raiz, 0);
+    if (p.pool != NULL) {
+        pool_espera(p.pool);
+        pool_destroi(p.pool);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+
+    if (est != NULL) {
+        est->diretorias = p.diretorias;
+        est->entradas = p.entradas;
+        est->chamadas_stat = p.chamadas_stat;
+        est->erros = p.erros;
+        est->segundos = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+    }
+    return resultado;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file percurso.h
+ * @brief Leitura de diretorias com getdents64 e percurso recursivo em paralelo.
+ *
+ * Cada diretoria é lida em blocos grandes com getdents64 e o tipo de cada
+ * entrada vem do d_type, sem um stat por ficheiro; só quando o sistema de
+ * ficheiros não o preenche (DT_UNKNOWN) é feito um fstatat relativo ao
+ * descritor da diretoria. No modo recursivo, cada diretoria é uma tarefa do
+ * pool de threads (com roubo de tarefas) e as subdiretorias encontradas são
+ * submetidas como novas tarefas.
+ *
+ * @date 2025
+ */
+
+#ifndef PERCURSO_H
+#define PERCURSO_H
+
+/**
+ * @brief Entrada de uma diretoria.
+ */
+typedef struct {
+    const char *nome;       ///< nome da entrada (sem o caminho)
+    unsigned char tipo;     ///< DT_REG, DT_DIR, DT_LNK, ... (nunca DT_UNKNOWN)
+} entrada_diretoria;
+
+/**
+ * @brief Conteúdo de uma diretoria, sem "." e "..".
+ */
+typedef struct {
+    const char *caminho;            ///< caminho da diretoria
+    int fd;                         ///< descritor aberto da diretoria (para fstatat, unlinkat...)
+    int profundidade;               ///< 0 para a diretoria inicial
+    int num_entradas;
+    entrada_diretoria *entradas;
+    char *nomes;                    ///< memória com os nomes (uso interno)
+} conteudo_diretoria;
+
+/**
+ * @brief Função chamada uma vez por diretoria lida.
+ *
+ * No modo recursivo pode ser chamada em simultâneo por várias threads do
+ * pool. Os dados só são válidos durante a chamada.
+ * @param d Conteúdo da diretoria.
+ * @param ctx Contexto indicado a percorre_diretorias.
+ */
+typedef void (*funcao_diretoria)(const conteudo_diretoria *d, void *ctx);
+
+/**
+ * @brief Estatísticas de um percurso.
+ */
+typedef struct {
+    unsigned long long diretorias;  ///< diretorias lidas
+    unsigned long long entradas;    ///< entradas encontradas
+    unsigned long long chamadas_stat; ///< fstatat feitos por falta de d_type
+    int erros;                      ///< diretorias que não puderam ser abertas ou lidas
+    double segundos;                ///< duração do percurso
+} estatisticas_percurso;
+
+/**
+ * @brief Lê todas as entradas de uma diretoria aberta.
+ * @param fd Descritor da diretoria.
+ * @param d Conteúdo preenchido (caminho, fd e profundidade não são alterados).
+ * @param chamadas_stat Incrementado por cada fstatat feito (pode ser NULL).
+ * @return 0 em caso de sucesso, -1 em caso de erro (libertar d na mesma).
+ */
+int le_diretoria(int fd, conteudo_diretoria *d, unsigned long long *chamadas_stat);
+
+/**
+ * @brief Liberta as entradas lidas por le_diretoria.
+ * @param d Conteúdo da diretoria.
+ */
+void liberta_diretoria(conteudo_diretoria *d);
+
+/**
+ * @brief Lê uma diretoria e, opcionalmente, todas as subdiretorias.
+ *
+ * As ligações simbólicas para diretorias não são seguidas. As diretorias
+ * que não podem ser abertas são reportadas no STDERR e contadas em erros.
+ * @param raiz Caminho da diretoria inicial.
+ * @param recursivo Se diferente de 0, desce em todas as subdiretorias.
+ * @param num_threads Threads do pool no modo recursivo (0 usa o número de CPUs).
+ * @param fn Função chamada para cada diretoria.
+ * @param ctx Contexto passado à função.
+ * @param est Estatísticas do percurso (pode ser NULL).
+ * @return 0 em caso de sucesso, -1 se a diretoria inicial não puder ser lida.
+ */
+int percorre_diretorias(const char *raiz, int recursivo, int num_threads,
+                        funcao_diretoria fn, void *ctx, estatisticas_percurso *est);
+
+#endif // PERCURSO_H
@@ -0,0 +1,330 @@
+/**
+ * @file perfil.c
+ * @brief Implementação da medição dos comandos e do anel de medições.
+ *
+ * Ler /proc/self/io é também uma leitura: os contadores lidos no início de
+ * uma medição são corrigidos com essa leitura, para que um comando que não
+ * lê nada apareça com 0 bytes e 0 leituras.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/wait.h>
+#include "perfil.h"
+#include "saida.h"
+
+static int ativo = 0;
+
+static pthread_mutex_t trinco = PTHREAD_MUTEX_INITIALIZER;
+static registo_perfil anel[PERFIL_CAPACIDADE];
+static unsigned long long num_registos = 0;    ///< total registado (o anel guarda os últimos)
+
+/// @brief Indica se todos os comandos são medidos.
+int perfil_ativo(void) {
+    return __atomic_load_n(&ativo, __ATOMIC_RELAXED);
+}
+
+/// @brief Liga ("on") ou desliga ("off") a medição de todos os comandos.
+/// @return 0 em caso de sucesso, -1 se o valor não for conhecido.
+int perfil_define(const char *valor) {
+    if (strcmp(valor, "on") == 0) {
+        __atomic_store_n(&ativo, 1, __ATOMIC_RELAXED);
+    } else if (strcmp(valor, "off") == 0) {
+        __atomic_store_n(&ativo, 0, __ATOMIC_RELAXED);
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+/// @brief Lê o valor de um campo ("rchar: 123") do texto de /proc/<pid>/io.
+static unsigned long long campo_es(const char *texto, const char *nome) {
+    const char *p = strstr(texto, nome);
+
+    return p != NULL ? strtoull(p + strlen(nome), NULL, 10) : 0;
+}
+
+/// @brief Lê os contadores de entrada/saída de um ficheiro de /proc.
+/// @param caminho "/proc/self/io", "/proc/thread-self/io" ou "/proc/<pid>/io".
+/// @param c Contadores (a zero se não puderem ser lidos).
+/// @return Bytes lidos do ficheiro (a própria leitura conta como uma), ou 0 em caso de erro.
+static size_t le_contadores(const char *caminho, contadores_es *c) {
+    char texto[512];
+    ssize_t n;
+    int fd = open(caminho, O_RDONLY | O_CLOEXEC);
+
+    memset(c, 0, sizeof(*c));
+    if (fd == -1) {
+        return 0;
+    }
+    n = read(fd, texto, sizeof(texto) - 1);
+    close(fd);
+    if (n <= 0) {
+        return 0;
+    }
+    texto[n] = '\0';
+    c->bytes_lidos = campo_es(texto, "rchar:");
+    c->bytes_escritos = campo_es(texto, "wchar:");
+    c->leituras = campo_es(texto, "syscr:");
+    c->escritas = campo_es(texto, "syscw:");
+    return n;
+}
+
+static double segundos(struct timeval t) {
+    return t.tv_sec + t.tv_usec / 1e6;
+}
+
+static double desde(const struct timespec *inicio) {
+    struct timespec agora;
+
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (agora.tv_sec - inicio->tv_sec) + (agora.tv_nsec - inicio->tv_nsec) / 1e9;
+}
+
+/// @brief Quem é medido por getrusage.
+static int quem(ambito_medicao ambito) {
+    return ambito == MEDE_THREAD ? RUSAGE_THREAD : RUSAGE_SELF;
+}
+
+/// @brief Ficheiro com os contadores de entrada/saída de um comando interno.
+static const char *ficheiro_es(ambito_medicao ambito) {
+    return ambito == MEDE_THREAD ? "/proc/thread-self/io" : "/proc/self/io";
+}
+
+/// @brief Começa a medir um comando.
+/// @param m Medição.
+/// @param ambito O que é medido.
+void perfil_inicia(medicao_perfil *m, ambito_medicao ambito) {
+    struct timespec agora;
+
+    memset(m, 0, sizeof(*m));
+    clock_gettime(CLOCK_REALTIME, &agora);
+    m->instante = agora.tv_sec + agora.tv_nsec / 1e9;
+    m->ambito = ambito;
+    if (ambito != MEDE_PROCESSO) {
+        size_t lidos = le_contadores(ficheiro_es(ambito), &m->es);
+
+        // A leitura acabada de fazer só aparece na próxima: descontá-la já
+        if (lidos > 0) {
+            m->es.bytes_lidos += lidos;
+            m->es.leituras++;
+        }
+        getrusage(quem(ambito), &m->uso);
+    }
+    // O relógio começa por último, para não medir a própria medição
+    clock_gettime(CLOCK_MONOTONIC, &m->inicio);
+}
+
+/// @brief Preenche o registo a partir de uma rusage (diferença em relação a antes, se não for NULL).
+static void preenche_uso(registo_perfil *r, const struct rusage *depois, const struct rusage *antes) {
+    r->utilizador = segundos(depois->ru_utime) - (antes != NULL ? segundos(antes->ru_utime) : 0);
+    r->sistema = segundos(depois->ru_stime) - (antes != NULL ? segundos(antes->ru_stime) : 0);
+    r->faltas_menores = depois->ru_minflt - (antes != NULL ? antes->ru_minflt : 0);
+    r->faltas_maiores = depois->ru_majflt - (antes != NULL ? antes->ru_majflt : 0);
+    r->rss_max_kib = depois->ru_maxrss;
+}
+
+/// @brief Termina a medição de um comando interno.
+/// @param m Medição iniciada na mesma thread.
+/// @param r Registo.
+void perfil_termina_interno(const medicao_perfil *m, registo_perfil *r) {
+    struct rusage uso;
+    contadores_es es;
+
+    r->real = desde(&m->inicio);
+    r->instante = m->instante;
+    r->interno = 1;
+    getrusage(quem(m->ambito), &uso);
+    le_contadores(ficheiro_es(m->ambito), &es);
+    preenche_uso(r, &uso, &m->uso);
+    r->es.bytes_lidos = es.bytes_lidos - m->es.bytes_lidos;
+    r->es.bytes_escritos = es.bytes_escritos - m->es.bytes_escritos;
+    r->es.leituras = es.leituras - m->es.leituras;
+    r->es.escritas = es.escritas - m->es.escritas;
+}
+
+/// @brief Espera que um processo termine, mede-o e recolhe-o.
+/// @param m Medição iniciada antes de lançar o processo.
+/// @param pid Processo.
+/// @param estado Estado devolvido pelo wait4.
+/// @param r Registo.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+/// @details Os contadores de /proc/<pid>/io desaparecem quando o processo é
+/// recolhido: primeiro espera-se com WNOWAIT (o processo fica zombie), depois
+/// lêem-se os contadores e só então o wait4 o recolhe com a rusage.
+int perfil_termina_processo(const medicao_perfil *m, pid_t pid, int *estado, registo_perfil *r) {
+    char caminho[64];
+    struct rusage uso;
+    siginfo_t info;
+
+    while (waitid(P_PID, pid, &info, WEXITED | WNOWAIT) == -1 && errno == EINTR) {
+    }
+    r->real = desde(&m->inicio);
+    r->instante = m->instante;
+    r->interno = 0;
+    snprintf(caminho, sizeof(caminho), "/proc/%d/io", (int)pid);
+    le_contadores(caminho, &r->es);
+
+    while (wait4(pid, estado, 0, &uso) == -1) {
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+    preenche_uso(r, &uso, NULL);
+    return 0;
+}
+
+/// @brief Guarda a linha de comando no registo, truncada sem cortar um carácter UTF-8.
+void perfil_descreve(registo_perfil *r, char *args[]) {
+    size_t usado = 0;
+
+    r->comando[0] = '\0';
+    for (int i = 0; args[i] != NULL && usado < sizeof(r->comando) - 1; i++) {
+        int n = snprintf(r->comando + usado, sizeof(r->comando) - usado, "%s%s", i > 0 ? " " : "", args[i]);
+
+        usado += n;
+    }
+    if (usado >= sizeof(r->comando)) {
+        // Truncado: retirar o último carácter se ficou incompleto
+        size_t fim = sizeof(r->comando) - 1, p = fim;
+        unsigned char l;
+
+        while (p > 0 && ((unsigned char)r->comando[p - 1] & 0xC0) == 0x80) {
+            p--;
+        }
+        l = p > 0 ? (unsigned char)r->comando[p - 1] : 0;
+        if (l >= 0xC0 && p - 1 + (l >= 0xF0 ? 4 : l >= 0xE0 ? 3 : 2) > fim) {
+            r->comando[p - 1] = '\0';
+        }
+    }
+}
+
+/// @brief Acrescenta uma medição ao anel, substituindo a mais antiga se estiver cheio.
+void perfil_regista(const registo_perfil *r) {
+    pthread_mutex_lock(&trinco);
+    anel[num_registos % PERFIL_CAPACIDADE] = *r;
+    num_registos++;
+    pthread_mutex_unlock(&trinco);
+}
+
+/// @brief Escreve uma medição numa linha.
+void perfil_mostra_registo(const registo_perfil *r) {
+    saida_printf("[tempo] %s: real %.3f s, utilizador %.3f s, sistema %.3f s, RSS máx. %ld KiB, "
+                 "lidos %llu B (%llu leituras), escritos %llu B (%llu escritas), faltas de página %ld (%ld maiores)\n",
+                 r->comando, r->real, r->utilizador, r->sistema, r->rss_max_kib,
+                 r->es.bytes_lidos, r->es.leituras, r->es.bytes_escritos, r->es.escritas,
+                 r->faltas_menores + r->faltas_maiores, r->faltas_maiores);
+}
+
+/// @brief Escreve um texto entre aspas, com os escapes do JSON.
+static void escreve_json(const char *s) {
+    saida_printf("\"");
+    for (; *s != '\0'; s++) {
+        if (*s == '"' || *s == '\\') {
+            saida_printf("\\%c", *s);
+        } else if ((unsigned char)*s < 0x20) {
+            saida_printf("\\u%04x", (unsigned char)*s);
+        } else {
+            saida_escreve(s, 1);
+        }
+    }
+    saida_printf("\"");
+}
+
+/// @brief Escreve um texto entre aspas, com as aspas duplicadas (CSV).
+static void escreve_csv(const char *s) {
+    saida_printf("\"");
+    for (; *s != '\0'; s++) {
+        saida_escreve(s, 1);
+        if (*s == '"') {
+            saida_escreve(s, 1);
+        }
+    }
+    saida_printf("\"");
+}
+
+/// @brief Escreve as medições do anel, da mais antiga para a mais recente.
+/// @param formato "texto", "json" ou "csv".
+/// @return 0 em caso de sucesso, -1 se o formato não for conhecido.
+/// @details As medições são copiadas com o trinco fechado e escritas depois,
+/// para não atrasar os comandos que terminam entretanto.
+int perfil_mostra(const char *formato) {
+    registo_perfil *copia;
+    unsigned long long primeiro;
+    int n;
+
+    if (strcmp(formato, "texto") != 0 && strcmp(formato, "json") != 0 && strcmp(formato, "csv") != 0) {
+        return -1;
+    }
+    copia = malloc(sizeof(anel));
+    if (copia == NULL) {
+        saida_erro("Erro: Memória insuficiente.\n");
+        return 0;
+    }
+    pthread_mutex_lock(&trinco);
+    n = num_registos < PERFIL_CAPACIDADE ? (int)num_registos : PERFIL_CAPACIDADE;
+    primeiro = num_registos - n;
+    for (int i = 0; i < n; i++) {
+        copia[i] = anel[(primeiro + i) % PERFIL_CAPACIDADE];
+    }
+    pthread_mutex_unlock(&trinco);
+
+    if (strcmp(formato, "json") == 0) {
+        saida_printf("[");
+        for (int i = 0; i < n; i++) {
+            const registo_perfil *r = &copia[i];
+
+            saida_printf("%s\n  {\"instante\": %.6f, \"comando\": ", i > 0 ? "," : "", r->instante);
+            escreve_json(r->comando);
+            saida_printf(", \"tipo\": \"%s\", \"codigo\": %d, \"real\": %.6f, \"utilizador\": %.6f, "
+                         "\"sistema\": %.6f, \"rss_max_kib\": %ld, \"bytes_lidos\": %llu, "
+                         "\"bytes_escritos\": %llu, \"leituras\": %llu, \"escritas\": %llu, "
+                         "\"faltas_menores\": %ld, \"faltas_maiores\": %ld}",
+                         r->interno ? "interno" : "externo", r->codigo, r->real, r->utilizador,
+                         r->sistema, r->rss_max_kib, r->es.bytes_lidos, r->es.bytes_escritos,
+                         r->es.leituras, r->es.escritas, r->faltas_menores, r->faltas_maiores);
+        }
+        saida_printf("%s]\n", n > 0 ? "\n" : "");
+    } else if (strcmp(formato, "csv") == 0) {
+        saida_printf("instante,comando,tipo,codigo,real,utilizador,sistema,rss_max_kib,"
+                     "bytes_lidos,bytes_escritos,leituras,escritas,faltas_menores,faltas_maiores\n");
+        for (int i = 0; i < n; i++) {
+            const registo_perfil *r = &copia[i];
+
+            saida_printf("%.6f,", r->instante);
+            escreve_csv(r->comando);
+            saida_printf(",%s,%d,%.6f,%.6f,%.6f,%ld,%llu,%llu,%llu,%llu,%ld,%ld\n",
+                         r->interno ? "interno" : "externo", r->codigo, r->real, r->utilizador,
+                         r->sistema, r->rss_max_kib, r->es.bytes_lidos, r->es.bytes_escritos,
+                         r->es.leituras, r->es.escritas, r->faltas_menores, r->faltas_maiores);
+        }
+    } else {
+        saida_printf("%9s %9s %9s %9s %12s %12s %8s %8s %8s %4s  %s\n", "real(s)", "utiliz.", "sistema",
+                     "RSS(KiB)", "lidos(B)", "escritos(B)", "leituras", "escritas", "faltas", "cód", "comando");
+        for (int i = 0; i < n; i++) {
+            const registo_perfil *r = &copia[i];
+
+            saida_printf("%9.3f %9.3f %9.3f %9ld %12llu %12llu %8llu %8llu %8ld %4d  %s\n",
+                         r->real, r->utilizador, r->sistema, r->rss_max_kib, r->es.bytes_lidos,
+                         r->es.bytes_escritos, r->es.leituras, r->es.escritas,
+                         r->faltas_menores + r->faltas_maiores, r->codigo, r->comando);
+        }
+    }
+    free(copia);
+    return 0;
+}
+
+/// @brief Esvazia o anel.
+void perfil_limpa(void) {
+    pthread_mutex_lock(&trinco);
+    num_registos = 0;
+    pthread_mutex_unlock(&trinco);
+}
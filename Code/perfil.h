@@ -0,0 +1,152 @@
+/**
+ * @file perfil.h
+ * @brief Medição de cada comando (tempo, memória, entrada/saída) e registo
+ * das medições num anel em memória.
+ *
+ * Com `time comando` ou `set perfil on`, cada etapa executada é medida:
+ * - comandos do sistema: a rusage do wait4 (tempos de utilizador e de
+ *   sistema, RSS máximo e faltas de página) e os contadores de
+ *   /proc/<pid>/io, lidos depois de o processo terminar e antes de ser
+ *   recolhido (waitid com WNOWAIT);
+ * - comandos internos: a diferença de getrusage e de /proc/self/io entre o
+ *   início e o fim. Um comando interno na thread do interpretador é medido
+ *   para todo o processo (inclui as threads do pool que usar); numa thread
+ *   própria (pipeline ou fundo) só essa thread é medida, porque as outras
+ *   etapas correm ao mesmo tempo. O RSS máximo é o do interpretador.
+ *
+ * O kernel não conta todas as chamadas ao sistema de um processo sem
+ * ptrace: as chamadas contadas são as de leitura e de escrita (syscr e
+ * syscw de /proc/<pid>/io).
+ *
+ * As medições ficam num anel com as últimas PERFIL_CAPACIDADE, que o
+ * comando `perfil` mostra em texto, JSON ou CSV.
+ *
+ * @date 2025
+ */
+
+#ifndef PERFIL_H
+#define PERFIL_H
+
+#include <time.h>
+#include <sys/types.h>
+#include <sys/resource.h>
+
+/// Número de medições guardadas no anel (as mais antigas são substituídas).
+#define PERFIL_CAPACIDADE 1024
+
+/// Tamanho máximo da linha de comando guardada em cada medição.
+#define PERFIL_MAX_COMANDO 128
+
+/**
+ * @brief O que é medido.
+ */
+typedef enum {
+    MEDE_PROCESSO,      ///< um processo filho (recolhido com perfil_termina_processo)
+    MEDE_INTERPRETADOR, ///< um comando interno na thread do interpretador: todo o processo
+    MEDE_THREAD         ///< um comando interno numa thread própria: só essa thread
+} ambito_medicao;
+
+/**
+ * @brief Contadores de entrada/saída de /proc/<pid>/io.
+ */
+typedef struct {
+    unsigned long long bytes_lidos;         ///< rchar
+    unsigned long long bytes_escritos;      ///< wchar
+    unsigned long long leituras;            ///< syscr
+    unsigned long long escritas;            ///< syscw
+} contadores_es;
+
+/**
+ * @brief Estado de uma medição em curso.
+ */
+typedef struct {
+    struct timespec inicio;     ///< CLOCK_MONOTONIC no início
+    double instante;            ///< início, em segundos desde 1970
+    ambito_medicao ambito;
+    struct rusage uso;          ///< getrusage no início (comandos internos)
+    contadores_es es;           ///< contadores no início (comandos internos)
+} medicao_perfil;
+
+/**
+ * @brief Resultado da medição de um comando.
+ */
+typedef struct {
+    double instante;                        ///< início, em segundos desde 1970
+    char comando[PERFIL_MAX_COMANDO];       ///< linha de comando (truncada)
+    int interno;                            ///< 1 se for um comando interno
+    int codigo;                             ///< código de saída
+    double real, utilizador, sistema;       ///< tempos em segundos
+    long rss_max_kib;                       ///< RSS máximo em KiB
+    contadores_es es;                       ///< bytes e chamadas de leitura/escrita
+    long faltas_menores, faltas_maiores;    ///< faltas de página
+} registo_perfil;
+
+/**
+ * @brief Indica se todos os comandos são medidos (`set perfil on`).
+ * @return 1 se sim, 0 caso contrário.
+ */
+int perfil_ativo(void);
+
+/**
+ * @brief Liga ou desliga a medição de todos os comandos.
+ * @param valor "on" ou "off".
+ * @return 0 em caso de sucesso, -1 se o valor não for conhecido.
+ */
+int perfil_define(const char *valor);
+
+/**
+ * @brief Começa a medir um comando.
+ * @param m Medição.
+ * @param ambito O que é medido (para um processo, só o tempo começa aqui).
+ */
+void perfil_inicia(medicao_perfil *m, ambito_medicao ambito);
+
+/**
+ * @brief Termina a medição de um comando interno (na thread que o executou).
+ * @param m Medição iniciada com MEDE_INTERPRETADOR ou MEDE_THREAD.
+ * @param r Registo preenchido (exceto comando e codigo).
+ */
+void perfil_termina_interno(const medicao_perfil *m, registo_perfil *r);
+
+/**
+ * @brief Espera que um processo termine, mede-o e recolhe-o.
+ * @param m Medição iniciada antes de lançar o processo.
+ * @param pid Processo.
+ * @param estado Estado devolvido pelo wait4.
+ * @param r Registo preenchido (exceto comando e codigo).
+ * @return 0 em caso de sucesso, -1 se o processo não puder ser recolhido.
+ */
+int perfil_termina_processo(const medicao_perfil *m, pid_t pid, int *estado, registo_perfil *r);
+
+/**
+ * @brief Guarda no registo a linha de comando, separada por espaços e truncada.
+ * @param r Registo.
+ * @param args Argumentos terminados em NULL.
+ */
+void perfil_descreve(registo_perfil *r, char *args[]);
+
+/**
+ * @brief Acrescenta uma medição ao anel.
+ * @param r Registo completo.
+ */
+void perfil_regista(const registo_perfil *r);
+
+/**
+ * @brief Escreve uma medição numa linha (usado pelo `time`).
+ * @param r Registo.
+ */
+void perfil_mostra_registo(const registo_perfil *r);
+
+/**
+ * @brief Escreve as medições do anel, da mais antiga para a mais recente.
+ * @param formato "texto", "json" ou "csv".
+ * @return 0 em caso de sucesso, -1 se o formato não for conhecido.
+ */
+int perfil_mostra(const char *formato);
+
+/**
+ * @brief Esvazia o anel.
+ */
+void perfil_limpa(void);
+
+#endif // PERFIL_H
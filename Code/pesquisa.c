@@ -0,0 +1,439 @@
+/**
+ * @file pesquisa.c
+ * @brief Implementação da procura de linhas e dos pré-filtros de literais.
+ *
+ * No Teddy, o literal k fica no balde k % 8 e cada balde é um bit. Para o
+ * byte b numa posição, lo[b & 15] & hi[b >> 4] dá os baldes com um literal
+ * que pode ter b nessa posição; com as tabelas do primeiro e do segundo byte
+ * combinadas (a segunda carregada um byte à frente), sobram poucas posições
+ * candidatas, que são confirmadas com os literais dos seus baldes. As
+ * tabelas de nibbles aceitam combinações que nenhum literal tem, mas nunca
+ * rejeitam uma posição certa.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "pesquisa.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PESQUISA_X86 1
+#endif
+
+/// Número de baldes do Teddy (um bit de um byte cada).
+#define NUM_BALDES 8
+
+/// Devolvido pelos filtros quando não há mais candidatos.
+#define SEM_CANDIDATO ((size_t)-1)
+
+typedef enum {
+    FILTRO_NENHUM,      ///< o autómato corre em todas as linhas
+    FILTRO_LITERAL,     ///< um literal, com maiúsculas
+    FILTRO_TEDDY        ///< vários literais, ou sem maiúsculas
+} tipo_filtro;
+
+struct pesquisa {
+    expressao *e;
+    const literais_expressao *lit;
+    tipo_filtro filtro;
+    int exata;                              ///< encontrar um literal basta
+    unsigned char lo[2][16], hi[2][16];     ///< tabelas de nibbles do 1.º e do 2.º byte
+    unsigned char tab[2][256];              ///< as mesmas tabelas por byte (kernel escalar)
+    unsigned char curtos;                   ///< baldes com literais de um só byte
+    int balde[NUM_BALDES][EXPRESSAO_MAX_LITERAIS];
+    int num_balde[NUM_BALDES];
+    char descricao[32];
+};
+
+typedef size_t (*kernel_literal)(const unsigned char *, size_t, const unsigned char *, size_t);
+typedef size_t (*kernel_teddy)(const pesquisa *, const unsigned char *, size_t);
+
+static inline unsigned char minuscula(unsigned char c) {
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+/// @brief Compara um literal com o texto numa posição (o literal já está
+/// em minúsculas se a comparação ignorar a caixa).
+static inline int igual(const unsigned char *texto, const unsigned char *lit, size_t m, int sem_maiusculas) {
+    if (!sem_maiusculas) {
+        return memcmp(texto, lit, m) == 0;
+    }
+    for (size_t i = 0; i < m; i++) {
+        if (minuscula(texto[i]) != lit[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/// @brief Confirma se algum literal dos baldes em bits começa na posição i.
+static inline int confirma(const pesquisa *ps, const unsigned char *p, size_t n, size_t i, unsigned bits) {
+    const literais_expressao *lit = ps->lit;
+
+    while (bits != 0) {
+        int b = __builtin_ctz(bits);
+
+        for (int k = 0; k < ps->num_balde[b]; k++) {
+            int l = ps->balde[b][k];
+
+            if (lit->tamanho[l] <= n - i && igual(p + i, lit->texto[l], lit->tamanho[l], lit->sem_maiusculas)) {
+                return 1;
+            }
+        }
+        bits &= bits - 1;
+    }
+    return 0;
+}
+
+/// @brief Teddy escalar, a partir da posição i (também usado nas caudas).
+static size_t teddy_escalar_desde(const pesquisa *ps, const unsigned char *p, size_t n, size_t i) {
+    for (; i < n; i++) {
+        unsigned bits = ps->tab[0][p[i]] & (i + 1 < n ? ps->tab[1][p[i + 1]] : ps->curtos);
+
+        if (bits != 0 && confirma(ps, p, n, i, bits)) {
+            return i;
+        }
+    }
+    return SEM_CANDIDATO;
+}
+
+static size_t teddy_escalar(const pesquisa *ps, const unsigned char *p, size_t n) {
+    return teddy_escalar_desde(ps, p, n, 0);
+}
+
+/// @brief Literal escalar: memchr para um byte, memmem para mais.
+static size_t literal_escalar(const unsigned char *lit, size_t m, const unsigned char *p, size_t n) {
+    const unsigned char *r = m == 1 ? memchr(p, lit[0], n) : memmem(p, n, lit, m);
+
+    return r != NULL ? (size_t)(r - p) : SEM_CANDIDATO;
+}
+
+#ifdef PESQUISA_X86
+
+/// @brief Literal SSE2: primeiro e último byte em 16 posições de cada vez.
+__attribute__((target("sse2")))
+static size_t literal_sse2(const unsigned char *lit, size_t m, const unsigned char *p, size_t n) {
+    const __m128i primeiro = _mm_set1_epi8(lit[0]);
+    const __m128i ultimo = _mm_set1_epi8(lit[m - 1]);
+    size_t i = 0, r;
+
+    if (m == 1) {
+        return literal_escalar(lit, m, p, n);
+    }
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        __m128i a = _mm_cmpeq_epi8(primeiro, _mm_loadu_si128((const __m128i *)(p + i)));
+        __m128i b = _mm_cmpeq_epi8(ultimo, _mm_loadu_si128((const __m128i *)(p + i + m - 1)));
+        unsigned mascara = _mm_movemask_epi8(_mm_and_si128(a, b));
+
+        while (mascara != 0) {
+            int j = __builtin_ctz(mascara);
+
+            if (memcmp(p + i + j + 1, lit + 1, m - 2) == 0) {
+                return i + j;
+            }
+            mascara &= mascara - 1;
+        }
+    }
+    r = literal_escalar(lit, m, p + i, n - i);
+    return r == SEM_CANDIDATO ? r : i + r;
+}
+
+/// @brief Literal AVX2: primeiro e último byte em 32 posições de cada vez.
+__attribute__((target("avx2")))
+static size_t literal_avx2(const unsigned char *lit, size_t m, const unsigned char *p, size_t n) {
+    const __m256i primeiro = _mm256_set1_epi8(lit[0]);
+    const __m256i ultimo = _mm256_set1_epi8(lit[m - 1]);
+    size_t i = 0, r;
+
+    if (m == 1) {
+        return literal_escalar(lit, m, p, n);
+    }
+    for (; i + m - 1 + 32 <= n; i += 32) {
+        __m256i a = _mm256_cmpeq_epi8(primeiro, _mm256_loadu_si256((const __m256i *)(p + i)));
+        __m256i b = _mm256_cmpeq_epi8(ultimo, _mm256_loadu_si256((const __m256i *)(p + i + m - 1)));
+        unsigned mascara = _mm256_movemask_epi8(_mm256_and_si256(a, b));
+
+        while (mascara != 0) {
+            int j = __builtin_ctz(mascara);
+
+            if (memcmp(p + i + j + 1, lit + 1, m - 2) == 0) {
+                return i + j;
+            }
+            mascara &= mascara - 1;
+        }
+    }
+    r = literal_escalar(lit, m, p + i, n - i);
+    return r == SEM_CANDIDATO ? r : i + r;
+}
+
+/// @brief Teddy SSSE3: 16 posições de cada vez.
+__attribute__((target("ssse3")))
+static size_t teddy_ssse3(const pesquisa *ps, const unsigned char *p, size_t n) {
+    const __m128i lo0 = _mm_loadu_si128((const __m128i *)ps->lo[0]);
+    const __m128i hi0 = _mm_loadu_si128((const __m128i *)ps->hi[0]);
+    const __m128i lo1 = _mm_loadu_si128((const __m128i *)ps->lo[1]);
+    const __m128i hi1 = _mm_loadu_si128((const __m128i *)ps->hi[1]);
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+
+    for (; i + 17 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(p + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(p + i + 1));
+        __m128i ra = _mm_and_si128(_mm_shuffle_epi8(lo0, _mm_and_si128(a, nibble)),
+                                   _mm_shuffle_epi8(hi0, _mm_and_si128(_mm_srli_epi16(a, 4), nibble)));
+        __m128i rb = _mm_and_si128(_mm_shuffle_epi8(lo1, _mm_and_si128(b, nibble)),
+                                   _mm_shuffle_epi8(hi1, _mm_and_si128(_mm_srli_epi16(b, 4), nibble)));
+        __m128i r = _mm_and_si128(ra, rb);
+        unsigned mascara = _mm_movemask_epi8(_mm_cmpeq_epi8(r, zero)) ^ 0xffff;
+
+        if (mascara != 0) {
+            unsigned char bits[16];
+
+            _mm_storeu_si128((__m128i *)bits, r);
+            do {
+                int j = __builtin_ctz(mascara);
+
+                if (confirma(ps, p, n, i + j, bits[j])) {
+                    return i + j;
+                }
+                mascara &= mascara - 1;
+            } while (mascara != 0);
+        }
+    }
+    return teddy_escalar_desde(ps, p, n, i);
+}
+
+/// @brief Teddy AVX2: 32 posições de cada vez (as tabelas repetidas nas duas metades).
+__attribute__((target("avx2")))
+static size_t teddy_avx2(const pesquisa *ps, const unsigned char *p, size_t n) {
+    const __m256i lo0 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)ps->lo[0]));
+    const __m256i hi0 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)ps->hi[0]));
+    const __m256i lo1 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)ps->lo[1]));
+    const __m256i hi1 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)ps->hi[1]));
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i + 33 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(p + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(p + i + 1));
+        __m256i ra = _mm256_and_si256(_mm256_shuffle_epi8(lo0, _mm256_and_si256(a, nibble)),
+                                      _mm256_shuffle_epi8(hi0, _mm256_and_si256(_mm256_srli_epi16(a, 4), nibble)));
+        __m256i rb = _mm256_and_si256(_mm256_shuffle_epi8(lo1, _mm256_and_si256(b, nibble)),
+                                      _mm256_shuffle_epi8(hi1, _mm256_and_si256(_mm256_srli_epi16(b, 4), nibble)));
+        __m256i r = _mm256_and_si256(ra, rb);
+        unsigned mascara = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(r, zero));
+
+        if (mascara != 0) {
+            unsigned char bits[32];
+
+            _mm256_storeu_si256((__m256i *)bits, r);
+            do {
+                int j = __builtin_ctz(mascara);
+
+                if (confirma(ps, p, n, i + j, bits[j])) {
+                    return i + j;
+                }
+                mascara &= mascara - 1;
+            } while (mascara != 0);
+        }
+    }
+    return teddy_escalar_desde(ps, p, n, i);
+}
+
+#endif // PESQUISA_X86
+
+static kernel_literal kernel_lit = literal_escalar;
+static kernel_teddy kernel_ted = teddy_escalar;
+static const char *nome_lit = "escalar";
+static const char *nome_ted = "escalar";
+static pthread_once_t kernel_once = PTHREAD_ONCE_INIT;
+
+/// @brief Escolhe os melhores kernels suportados pelo processador (executado uma vez).
+static void escolhe_kernels(void) {
+#ifdef PESQUISA_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernel_lit = literal_avx2;
+        kernel_ted = teddy_avx2;
+        nome_lit = nome_ted = "avx2";
+        return;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        kernel_lit = literal_sse2;
+        nome_lit = "sse2";
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        kernel_ted = teddy_ssse3;
+        nome_ted = "ssse3";
+    }
+#endif
+}
+
+/// @brief Marca um byte de um literal (e a outra caixa, se for o caso) numa tabela do Teddy.
+static void marca_byte(pesquisa *ps, int tabela, unsigned char c, unsigned bit) {
+    unsigned char variantes[2] = { c, c };
+    int sem_maiusculas = ps->lit->sem_maiusculas;
+
+    if (sem_maiusculas && c >= 'a' && c <= 'z') {
+        variantes[1] = c - ('a' - 'A');
+    }
+    for (int v = 0; v < 2; v++) {
+        ps->lo[tabela][variantes[v] & 15] |= bit;
+        ps->hi[tabela][variantes[v] >> 4] |= bit;
+    }
+}
+
+/// @brief Prepara as tabelas do Teddy.
+static void prepara_teddy(pesquisa *ps) {
+    const literais_expressao *lit = ps->lit;
+
+    for (int l = 0; l < lit->num; l++) {
+        int b = l % NUM_BALDES;
+        unsigned bit = 1u << b;
+
+        ps->balde[b][ps->num_balde[b]++] = l;
+        marca_byte(ps, 0, lit->texto[l][0], bit);
+        if (lit->tamanho[l] >= 2) {
+            marca_byte(ps, 1, lit->texto[l][1], bit);
+        } else {
+            // Um literal de um byte aceita qualquer segundo byte
+            for (int k = 0; k < 16; k++) {
+                ps->lo[1][k] |= bit;
+                ps->hi[1][k] |= bit;
+            }
+            ps->curtos |= bit;
+        }
+    }
+    for (int t = 0; t < 2; t++) {
+        for (int c = 0; c < 256; c++) {
+            ps->tab[t][c] = ps->lo[t][c & 15] & ps->hi[t][c >> 4];
+        }
+    }
+}
+
+/// @brief Compila os padrões e o pré-filtro.
+/// @param padroes Padrões.
+/// @param n Número de padrões.
+/// @param opcoes EXPRESSAO_LITERAL e/ou EXPRESSAO_SEM_MAIUSCULAS.
+/// @param erro Buffer para a descrição do erro.
+/// @param tamanho_erro Tamanho do buffer.
+/// @return Pesquisa compilada, ou NULL se algum padrão for inválido.
+pesquisa *pesquisa_compila(char *padroes[], int n, int opcoes, char *erro, size_t tamanho_erro) {
+    pesquisa *ps = calloc(1, sizeof(pesquisa));
+    const literais_expressao *lit;
+
+    if (ps == NULL) {
+        snprintf(erro, tamanho_erro, "memória insuficiente");
+        return NULL;
+    }
+    ps->e = expressao_compila(padroes, n, opcoes, erro, tamanho_erro);
+    if (ps->e == NULL) {
+        free(ps);
+        return NULL;
+    }
+    pthread_once(&kernel_once, escolhe_kernels);
+    lit = ps->lit = expressao_literais(ps->e);
+
+    // Um literal com '\n' nunca está dentro de uma linha: fica o autómato
+    ps->filtro = lit->num == 0 ? FILTRO_NENHUM : lit->num == 1 && !lit->sem_maiusculas ? FILTRO_LITERAL : FILTRO_TEDDY;
+    for (int l = 0; l < lit->num; l++) {
+        if (memchr(lit->texto[l], '\n', lit->tamanho[l]) != NULL) {
+            ps->filtro = FILTRO_NENHUM;
+        }
+    }
+    ps->exata = ps->filtro != FILTRO_NENHUM && lit->exata;
+    if (ps->filtro == FILTRO_TEDDY) {
+        prepara_teddy(ps);
+    }
+    snprintf(ps->descricao, sizeof(ps->descricao), "%s%s%s",
+             ps->filtro == FILTRO_NENHUM ? "autómato" : ps->filtro == FILTRO_LITERAL ? "literal " : "teddy ",
+             ps->filtro == FILTRO_NENHUM ? "" : ps->filtro == FILTRO_LITERAL ? nome_lit : nome_ted,
+             ps->filtro == FILTRO_NENHUM ? "" : ps->exata ? " (exato)" : " + autómato");
+    return ps;
+}
+
+/// @brief Liberta uma pesquisa.
+/// @param p Pesquisa.
+void pesquisa_liberta(pesquisa *p) {
+    if (p != NULL) {
+        expressao_liberta(p->e);
+        free(p);
+    }
+}
+
+/// @brief Cria o autómato de uma thread para esta pesquisa.
+/// @param p Pesquisa.
+/// @return Autómato, ou NULL se faltar memória.
+automato *pesquisa_automato(const pesquisa *p) {
+    return automato_cria(p->e);
+}
+
+/// @brief Descreve o pré-filtro escolhido para esta pesquisa.
+/// @param p Pesquisa.
+/// @return Descrição.
+const char *pesquisa_filtro(const pesquisa *p) {
+    return p->descricao;
+}
+
+/// @brief Devolve a posição do próximo candidato do pré-filtro.
+static inline size_t candidato(const pesquisa *ps, const unsigned char *p, size_t n) {
+    if (ps->filtro == FILTRO_LITERAL) {
+        return kernel_lit(ps->lit->texto[0], ps->lit->tamanho[0], p, n);
+    }
+    return kernel_ted(ps, p, n);
+}
+
+/// @brief Procura a próxima linha que corresponde.
+/// @param p Pesquisa.
+/// @param a Autómato da thread atual.
+/// @param dados Bloco de linhas.
+/// @param n Tamanho do bloco.
+/// @param desde Início de uma linha a partir da qual procurar.
+/// @param inicio Início da linha encontrada.
+/// @param fim Fim da linha encontrada.
+/// @return 1 se encontrou, 0 se não há mais linhas, -1 se faltar memória.
+/// @details Com pré-filtro, só as linhas com um candidato são vistas; sem
+/// ele, as linhas são separadas com memchr e todas passam pelo autómato.
+int pesquisa_proxima(const pesquisa *p, automato *a, const unsigned char *dados, size_t n,
+                     size_t desde, size_t *inicio, size_t *fim) {
+    size_t pos = desde;
+
+    while (pos < n) {
+        size_t ini = pos, f;
+        const unsigned char *nl;
+        int r;
+
+        if (p->filtro != FILTRO_NENHUM) {
+            size_t c = candidato(p, dados + pos, n - pos);
+            const unsigned char *antes;
+
+            if (c == SEM_CANDIDATO) {
+                return 0;
+            }
+            c += pos;
+            antes = memrchr(dados + pos, '\n', c - pos);
+            ini = antes != NULL ? (size_t)(antes - dados) + 1 : pos;
+            nl = memchr(dados + c, '\n', n - c);
+        } else {
+            nl = memchr(dados + pos, '\n', n - pos);
+        }
+        f = nl != NULL ? (size_t)(nl - dados) : n;
+
+        r = p->exata ? 1 : automato_linha(a, dados + ini, f - ini);
+        if (r != 0) {
+            *inicio = ini;
+            *fim = f;
+            return r;
+        }
+        pos = f + 1;
+    }
+    return 0;
+}
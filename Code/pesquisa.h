@@ -0,0 +1,77 @@
+/**
+ * @file pesquisa.h
+ * @brief Procura das linhas de um bloco de memória que correspondem a uma
+ * expressão, com um pré-filtro de literais vetorizado à frente do autómato.
+ *
+ * Quando a expressão tem literais obrigatórios (ver expressao_literais), o
+ * bloco é percorrido à procura desses literais e o autómato só corre nas
+ * linhas onde aparecem; se os literais forem a expressão inteira (por
+ * exemplo `procura -F erro` ou `procura 'erro|aviso'`), nem isso.
+ * - Um só literal: comparação do primeiro e do último byte em 32 (AVX2) ou
+ *   16 (SSE2) posições de cada vez, confirmando os candidatos com memcmp.
+ * - Vários literais, ou sem maiúsculas: um filtro ao estilo Teddy, em que os
+ *   literais são repartidos por 8 baldes e os dois primeiros bytes de cada
+ *   posição são classificados com pshufb sobre tabelas de nibbles (AVX2 ou
+ *   SSSE3); só as posições que caem num balde são confirmadas.
+ * Sem literais úteis, o autómato corre em todas as linhas.
+ *
+ * O kernel é escolhido em tempo de execução, como na contagem.
+ *
+ * @date 2025
+ */
+
+#ifndef PESQUISA_H
+#define PESQUISA_H
+
+#include <stddef.h>
+#include "expressao.h"
+
+/// @brief Expressão compilada com o pré-filtro, partilhada por todas as threads.
+typedef struct pesquisa pesquisa;
+
+/**
+ * @brief Compila os padrões e o pré-filtro.
+ * @param padroes Padrões (uma linha corresponde se corresponder a algum).
+ * @param n Número de padrões.
+ * @param opcoes EXPRESSAO_LITERAL e/ou EXPRESSAO_SEM_MAIUSCULAS.
+ * @param erro Buffer para a descrição do erro.
+ * @param tamanho_erro Tamanho do buffer.
+ * @return Pesquisa compilada, ou NULL se algum padrão for inválido.
+ */
+pesquisa *pesquisa_compila(char *padroes[], int n, int opcoes, char *erro, size_t tamanho_erro);
+
+/**
+ * @brief Liberta uma pesquisa (depois de libertar os seus autómatos).
+ * @param p Pesquisa.
+ */
+void pesquisa_liberta(pesquisa *p);
+
+/**
+ * @brief Cria o autómato de uma thread para esta pesquisa.
+ * @param p Pesquisa.
+ * @return Autómato (libertar com automato_liberta), ou NULL se faltar memória.
+ */
+automato *pesquisa_automato(const pesquisa *p);
+
+/**
+ * @brief Procura a próxima linha que corresponde.
+ * @param p Pesquisa.
+ * @param a Autómato da thread atual.
+ * @param dados Bloco de linhas.
+ * @param n Tamanho do bloco.
+ * @param desde Início de uma linha a partir da qual procurar.
+ * @param inicio Início da linha encontrada.
+ * @param fim Fim da linha encontrada (a posição do '\\n', ou n).
+ * @return 1 se encontrou, 0 se não há mais linhas, -1 se faltar memória.
+ */
+int pesquisa_proxima(const pesquisa *p, automato *a, const unsigned char *dados, size_t n,
+                     size_t desde, size_t *inicio, size_t *fim);
+
+/**
+ * @brief Descreve o pré-filtro escolhido para esta pesquisa.
+ * @param p Pesquisa.
+ * @return Por exemplo "literal avx2", "teddy ssse3" ou "autómato".
+ */
+const char *pesquisa_filtro(const pesquisa *p);
+
+#endif // PESQUISA_H
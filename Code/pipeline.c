@@ -0,0 +1,435 @@
+/**
+ * @file pipeline.c
+ * @brief Implementação dos pipelines e redirecionamentos.
+ *
+ * Todos os descritores criados aqui têm O_CLOEXEC, para que cada filho só
+ * fique com os que lhe são passados em 0 e 1; caso contrário, uma ponta de
+ * escrita esquecida num filho impediria a etapa seguinte de ver o fim dos
+ * dados.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <sys/pidfd.h>
+#include <sys/wait.h>
+#include "pipeline.h"
+#include "tabela_comandos.h"
+#include "cache_path.h"
+#include "lancamento.h"
+#include "saida.h"
+#include "analisador.h"
+#include "perfil.h"
+
+/// @brief Estado de uma etapa durante a execução.
+typedef struct {
+    const comando_interno *interno; ///< comando interno, ou NULL se for externo
+    char **args;
+    int entrada, saida;             ///< descritores da etapa
+    int erro;                       ///< descritor de erros (o da thread que lançou a etapa)
+    int fecha_entrada, fecha_saida; ///< 1 se os descritores foram abertos pelo pipeline
+    pthread_t thread;
+    int em_thread;                  ///< 1 se corre numa thread nova
+    pid_t pid;                      ///< pid do processo externo, ou -1
+    int fim;                        ///< pidfd ou eventfd que indica o fim (só em fundo), ou -1
+    int recolhida;                  ///< 1 depois do waitpid/pthread_join
+    int estado;                     ///< estado devolvido pelo waitpid
+    int codigo;                     ///< código de saída
+    int reporta;                    ///< 1 se deve ser reportado "Terminou comando"
+    int mede;                       ///< 1 se a etapa deve ser medida (time ou set perfil on)
+    int medida;                     ///< 1 depois de a medição estar completa
+    medicao_perfil medicao;
+    registo_perfil registo;
+} execucao_etapa;
+
+/// @brief Pipeline em execução.
+struct execucao_pipeline {
+    int n;                          ///< número de etapas
+    int por_recolher;               ///< etapas ainda não recolhidas
+    execucao_etapa x[];             ///< estado de cada etapa
+};
+
+/// @brief Indica se um argumento é um operador de pipeline ou redirecionamento.
+/// @details Os operadores são comparados pelo endereço (ver analisador.h).
+static int e_operador(const char *a) {
+    return a == operador_pipe || a == operador_entrada || a == operador_saida || a == operador_acrescenta;
+}
+
+/// @brief Divide uma lista de argumentos em etapas.
+/// @param args Argumentos terminados em NULL (reorganizados no próprio lugar).
+/// @param etapas Etapas encontradas.
+/// @return Número de etapas, ou -1 em caso de erro.
+/// @details Os argumentos normais são compactados para o início do array à
+/// medida que se avança (w <= r), e cada "|" dá lugar ao NULL que termina a etapa.
+int pipeline_analisa(char *args[], etapa_pipeline etapas[]) {
+    int n = 0, w = 0;
+    etapa_pipeline *e = &etapas[0];
+
+    memset(e, 0, sizeof(*e));
+    e->args = &args[0];
+    for (int r = 0; ; r++) {
+        char *a = args[r];
+
+        if (a == NULL || a == operador_pipe) {
+            if (&args[w] == e->args) {
+                saida_erro("Erro: Pipeline inválido: falta um comando antes ou depois de '|'.\n");
+                return -1;
+            }
+            args[w++] = NULL;
+            n++;
+            if (a == NULL) {
+                return n;
+            }
+            if (n == PIPELINE_MAX_ETAPAS) {
+                saida_erro("Erro: O pipeline tem mais de %d comandos.\n", PIPELINE_MAX_ETAPAS);
+                return -1;
+            }
+            e = &etapas[n];
+            memset(e, 0, sizeof(*e));
+            e->args = &args[w];
+        } else if (a == operador_fundo) {
+            saida_erro("Erro: '&' só pode aparecer no fim do comando.\n");
+            return -1;
+        } else if (e_operador(a)) {
+            if (args[r + 1] == NULL || e_operador(args[r + 1]) || args[r + 1] == operador_fundo) {
+                saida_erro("Erro: Falta o nome do ficheiro depois de '%s'.\n", a);
+                return -1;
+            }
+            if (a == operador_entrada) {
+                e->entrada = args[++r];
+            } else {
+                e->saida = args[++r];
+                e->acrescenta = a == operador_acrescenta;
+            }
+        } else {
+            args[w++] = a;
+        }
+    }
+}
+
+/// @brief Fecha os descritores que pertencem à etapa.
+static void fecha_descritores(execucao_etapa *x) {
+    if (x->fecha_entrada) {
+        close(x->entrada);
+    }
+    if (x->fecha_saida) {
+        close(x->saida);
+    }
+}
+
+/// @brief Corpo da thread de um comando interno: redireciona a saída da thread e executa.
+/// @details Em fundo, o fim é assinalado no eventfd da etapa.
+static void *corre_interno(void *p) {
+    execucao_etapa *x = p;
+    uint64_t um = 1;
+
+    saida_redireciona(x->entrada, x->saida);
+    saida_define_erro(x->erro);
+    if (x->mede) {
+        perfil_inicia(&x->medicao, MEDE_THREAD);
+    }
+    x->codigo = tabela_executa(x->interno, x->args);
+    saida_flush();
+    if (x->mede) {
+        perfil_termina_interno(&x->medicao, &x->registo);
+        x->medida = 1;
+    }
+    fecha_descritores(x);
+    if (x->fim != -1 && write(x->fim, &um, sizeof(um)) < 0) {
+        // O eventfd só falha se o contador transbordar, o que não acontece aqui
+    }
+    return NULL;
+}
+
+/// @brief Abre os ficheiros de redirecionamento da etapa, substituindo os descritores.
+/// @return 0 em caso de sucesso, -1 se algum ficheiro não puder ser aberto.
+static int abre_redirecionamentos(const etapa_pipeline *e, execucao_etapa *x) {
+    if (e->entrada != NULL) {
+        int fd = open(e->entrada, O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            saida_erro("Erro: O ficheiro '%s' não existe ou não pode ser aberto.\n", e->entrada);
+            return -1;
+        }
+        if (x->fecha_entrada) {
+            close(x->entrada);
+        }
+        x->entrada = fd;
+        x->fecha_entrada = 1;
+    }
+    if (e->saida != NULL) {
+        int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (e->acrescenta ? O_APPEND : O_TRUNC);
+        int fd = open(e->saida, flags, 0644);
+        if (fd == -1) {
+            saida_erro("Erro: Não foi possível abrir o ficheiro '%s' para escrita.\n", e->saida);
+            return -1;
+        }
+        if (x->fecha_saida) {
+            close(x->saida);
+        }
+        x->saida = fd;
+        x->fecha_saida = 1;
+    }
+    return 0;
+}
+
+/// @brief Lança a etapa: thread, execução na thread atual ou processo externo.
+/// @param x Estado da etapa (descritores já preparados).
+/// @param na_thread_atual 1 se um comando interno deve correr na thread atual.
+/// @param em_fundo 1 se o fim da etapa deve ser assinalado por um descritor.
+static void inicia_etapa(execucao_etapa *x, int na_thread_atual, int em_fundo) {
+    if (x->interno != NULL && na_thread_atual) {
+        int entrada_antes = entrada_fd(), saida_antes = saida_fd();
+
+        // Na thread do interpretador mede-se todo o processo (inclui o pool)
+        if (x->mede) {
+            perfil_inicia(&x->medicao, MEDE_INTERPRETADOR);
+        }
+        saida_redireciona(x->entrada, x->saida);
+        x->codigo = tabela_executa(x->interno, x->args);
+        saida_redireciona(entrada_antes, saida_antes);
+        if (x->mede) {
+            perfil_termina_interno(&x->medicao, &x->registo);
+            x->medida = 1;
+        }
+        fecha_descritores(x);
+        return;
+    }
+
+    if (x->interno != NULL) {
+        if (em_fundo) {
+            x->fim = eventfd(0, EFD_CLOEXEC);
+        }
+        x->erro = saida_erro_fd();
+        if ((em_fundo && x->fim == -1) || pthread_create(&x->thread, NULL, corre_interno, x) != 0) {
+            saida_erro("Erro: Não foi possível criar a thread de '%s'.\n", x->args[0]);
+            fecha_descritores(x);
+            x->codigo = 1;
+            return;
+        }
+        x->em_thread = 1;
+        return;
+    }
+
+    // Comando do sistema: resolver o caminho pela cache do PATH
+    const char *caminho = cache_path_procura(x->args[0]);
+    int fds[3] = { x->entrada, x->saida, saida_erro_fd() };
+    int erro = ENOENT;
+
+    if (x->mede) {
+        perfil_inicia(&x->medicao, MEDE_PROCESSO);
+    }
+    if (caminho != NULL) {
+        x->pid = lanca_processo(caminho, x->args, lancamento_atual(), fds, &erro);
+    }
+    fecha_descritores(x);
+    if (x->pid < 0) {
+        x->codigo = 1;
+        if (erro == EAGAIN || erro == ENOMEM) {
+            saida_erro("Erro: Falha ao criar um novo processo.\n");
+            x->reporta = 0;
+        } else {
+            saida_erro("Erro: Comando '%s' não encontrado. Use 'termina' para sair.\n", x->args[0]);
+        }
+        return;
+    }
+    if (em_fundo) {
+        // Sem pidfd (kernel anterior ao 5.3) a etapa só é recolhida no 'wait'
+        x->fim = pidfd_open(x->pid, 0);
+    }
+}
+
+/// @brief Lança todas as etapas de um pipeline, sem esperar que terminem.
+/// @param etapas Etapas do pipeline.
+/// @param n Número de etapas.
+/// @param em_fundo 1 para um trabalho em fundo.
+/// @param mede 1 para medir cada etapa (ver perfil.h).
+/// @return Pipeline em execução, ou NULL se faltar memória.
+/// @details
+/// As etapas são lançadas da primeira para a última; cada uma recebe a
+/// ponta de leitura do pipe da anterior. Em fundo, a entrada da primeira
+/// etapa é /dev/null (como no bash sem controlo de trabalhos), todos os
+/// comandos internos correm em threads novas e cada etapa tem um descritor
+/// (pidfd ou eventfd) que fica pronto para leitura quando ela termina.
+/// Variáveis:
+/// - x: estado de cada etapa
+/// - proxima_entrada: ponta de leitura do pipe criado para a etapa seguinte
+execucao_pipeline *pipeline_inicia(etapa_pipeline etapas[], int n, int em_fundo, int mede) {
+    execucao_pipeline *p = calloc(1, sizeof(execucao_pipeline) + n * sizeof(execucao_etapa));
+    int entrada_padrao = entrada_fd(), saida_padrao = saida_fd();
+    int proxima_entrada = entrada_padrao, fecha_proxima = 0;
+    execucao_etapa *x;
+
+    if (p == NULL) {
+        saida_erro("Erro: Memória insuficiente.\n");
+        return NULL;
+    }
+    x = p->x;
+    if (em_fundo) {
+        proxima_entrada = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        fecha_proxima = proxima_entrada != -1;
+    }
+
+    // A saída dos processos filhos tem de aparecer depois do que já está no buffer
+    saida_flush();
+
+    for (int i = 0; i < n; i++) {
+        x[i].args = etapas[i].args;
+        x[i].interno = tabela_procura(etapas[i].args[0]);
+        x[i].pid = -1;
+        x[i].fim = -1;
+        x[i].reporta = 1;
+        x[i].mede = mede;
+        x[i].entrada = proxima_entrada;
+        x[i].fecha_entrada = fecha_proxima;
+        x[i].saida = saida_padrao;
+        proxima_entrada = entrada_padrao;
+        fecha_proxima = 0;
+
+        if (i < n - 1) {
+            int fds[2];
+
+            if (pipe2(fds, O_CLOEXEC) == -1) {
+                saida_erro("Erro: Não foi possível criar o pipe: %s\n", strerror(errno));
+                fecha_descritores(&x[i]);
+                x[i].codigo = 1;
+                x[i].reporta = 0;
+                n = i + 1;
+                break;
+            }
+            x[i].saida = fds[1];
+            x[i].fecha_saida = 1;
+            proxima_entrada = fds[0];
+            fecha_proxima = 1;
+        }
+
+        if (abre_redirecionamentos(&etapas[i], &x[i]) == -1) {
+            fecha_descritores(&x[i]);
+            x[i].codigo = 1;
+            continue;
+        }
+        inicia_etapa(&x[i], !em_fundo && i == n - 1, em_fundo);
+    }
+
+    p->n = n;
+    p->por_recolher = n;
+    return p;
+}
+
+/// @brief Número de etapas do pipeline.
+int pipeline_num_etapas(const execucao_pipeline *p) {
+    return p->n;
+}
+
+/// @brief Descritor que fica pronto para leitura quando a etapa termina.
+/// @return pidfd ou eventfd, ou -1 se a etapa não o tiver.
+int pipeline_descritor_fim(const execucao_pipeline *p, int i) {
+    return p->x[i].recolhida ? -1 : p->x[i].fim;
+}
+
+/// @brief Recolhe uma etapa (waitpid ou pthread_join), esperando se ainda estiver a correr.
+/// @param p Pipeline em execução.
+/// @param i Índice da etapa.
+/// @return Número de etapas que faltam recolher.
+int pipeline_recolhe(execucao_pipeline *p, int i) {
+    execucao_etapa *x = &p->x[i];
+
+    if (x->recolhida) {
+        return p->por_recolher;
+    }
+    if (x->em_thread) {
+        pthread_join(x->thread, NULL);
+    } else if (x->pid > 0) {
+        if (x->mede && perfil_termina_processo(&x->medicao, x->pid, &x->estado, &x->registo) == 0) {
+            x->medida = 1;
+        } else {
+            while (waitpid(x->pid, &x->estado, 0) == -1 && errno == EINTR) {
+            }
+        }
+        if (WIFEXITED(x->estado)) {
+            x->codigo = WEXITSTATUS(x->estado);
+        } else {
+            x->codigo = 128 + (WIFSIGNALED(x->estado) ? WTERMSIG(x->estado) : 0);
+        }
+    }
+    if (x->fim != -1) {
+        close(x->fim);
+        x->fim = -1;
+    }
+    if (x->medida) {
+        perfil_descreve(&x->registo, x->args);
+        x->registo.codigo = x->codigo;
+        perfil_regista(&x->registo);
+    }
+    x->recolhida = 1;
+    return --p->por_recolher;
+}
+
+/// @brief Escreve "Terminou comando ..." para cada etapa, pela ordem do pipeline.
+void pipeline_reporta(const execucao_pipeline *p) {
+    for (int i = 0; i < p->n; i++) {
+        const execucao_etapa *x = &p->x[i];
+
+        if (!x->reporta) {
+            continue;
+        }
+        if (x->pid > 0 && !WIFEXITED(x->estado)) {
+            saida_printf("Comando %s terminou de forma anormal\n", x->args[0]);
+        } else {
+            saida_printf("Terminou comando %s com código %d\n", x->args[0], x->codigo);
+        }
+    }
+}
+
+/// @brief Escreve a medição de cada etapa medida, pela ordem do pipeline.
+void pipeline_mostra_tempos(const execucao_pipeline *p) {
+    for (int i = 0; i < p->n; i++) {
+        if (p->x[i].medida) {
+            perfil_mostra_registo(&p->x[i].registo);
+        }
+    }
+}
+
+/// @brief Código de saída do pipeline (o da última etapa).
+int pipeline_codigo(const execucao_pipeline *p) {
+    return p->x[p->n - 1].codigo;
+}
+
+/// @brief Liberta um pipeline já recolhido.
+void pipeline_liberta(execucao_pipeline *p) {
+    free(p);
+}
+
+/// @brief Executa as etapas em simultâneo e reporta o código de cada uma.
+/// @param etapas Etapas do pipeline.
+/// @param n Número de etapas.
+/// @param tempo 1 para medir e mostrar o tempo de cada etapa (`time`).
+/// @return Código de saída da última etapa.
+/// @details Só depois de todas as etapas terminarem é que os códigos são
+/// reportados, para não se misturarem com a saída das etapas.
+int pipeline_executa(etapa_pipeline etapas[], int n, int tempo) {
+    execucao_pipeline *p = pipeline_inicia(etapas, n, 0, tempo || perfil_ativo());
+    int codigo;
+
+    if (p == NULL) {
+        return 1;
+    }
+    for (int i = 0; i < p->n; i++) {
+        pipeline_recolhe(p, i);
+    }
+    pipeline_reporta(p);
+    if (tempo) {
+        pipeline_mostra_tempos(p);
+    }
+    codigo = pipeline_codigo(p);
+    pipeline_liberta(p);
+    return codigo;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file pipeline.h
+ * @brief Pipelines (|) e redirecionamentos (<, >, >>) de comandos.
+ *
+ * Cada etapa de um pipeline é um comando do sistema, lançado com o
+ * mecanismo atual e com os descritores ligados por pipe2, ou um comando
+ * interno, executado numa thread do próprio interpretador com a entrada e a
+ * saída da thread apontadas para o pipe. Assim, em `mostra big.log | conta`
+ * os dados passam do ficheiro para o pipe dentro do kernel (sendfile/splice)
+ * sem nenhuma cópia extra em espaço de utilizador.
+ *
+ * @date 2025
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+/// Número máximo de etapas num pipeline.
+#define PIPELINE_MAX_ETAPAS 32
+
+/**
+ * @brief Uma etapa de um pipeline, já sem os operadores de redirecionamento.
+ */
+typedef struct {
+    char **args;            ///< argumentos do comando, terminados em NULL
+    const char *entrada;    ///< ficheiro indicado com '<', ou NULL
+    const char *saida;      ///< ficheiro indicado com '>' ou '>>', ou NULL
+    int acrescenta;         ///< 1 se a saída foi indicada com '>>'
+} etapa_pipeline;
+
+/**
+ * @brief Divide uma lista de argumentos em etapas.
+ *
+ * Os operadores "|", "<", ">" e ">>" são os do analisador (comparados pelo
+ * endereço, por isso um "|" entre aspas é um argumento). O array é reorganizado
+ * no próprio lugar: cada etapa fica com os seus argumentos terminados em NULL.
+ * @param args Argumentos terminados em NULL (modificado).
+ * @param etapas Array com PIPELINE_MAX_ETAPAS posições.
+ * @return Número de etapas, ou -1 se o pipeline for inválido (o erro é mostrado).
+ */
+int pipeline_analisa(char *args[], etapa_pipeline etapas[]);
+
+/**
+ * @brief Pipeline em execução (opaco).
+ */
+typedef struct execucao_pipeline execucao_pipeline;
+
+/**
+ * @brief Lança todas as etapas sem esperar que terminem.
+ *
+ * Com em_fundo, a primeira etapa lê de /dev/null, todos os comandos internos
+ * correm em threads novas e cada etapa tem um descritor de fim (ver
+ * pipeline_descritor_fim), para ser recolhida de forma assíncrona.
+ * @param etapas Etapas do pipeline (os argumentos têm de existir até ao fim).
+ * @param n Número de etapas.
+ * @param em_fundo 1 para um trabalho em fundo, 0 para um comando normal.
+ * @param mede 1 para medir cada etapa; as medições são guardadas no anel
+ * do perfil quando a etapa é recolhida.
+ * @return Pipeline em execução, ou NULL em caso de erro.
+ */
+execucao_pipeline *pipeline_inicia(etapa_pipeline etapas[], int n, int em_fundo, int mede);
+
+/**
+ * @brief Devolve o número de etapas de um pipeline em execução.
+ * @param p Pipeline.
+ * @return Número de etapas.
+ */
+int pipeline_num_etapas(const execucao_pipeline *p);
+
+/**
+ * @brief Devolve o descritor que fica pronto para leitura quando a etapa
+ * termina (pidfd de um processo ou eventfd de uma thread).
+ * @param p Pipeline.
+ * @param i Índice da etapa.
+ * @return Descritor, ou -1 se a etapa não tiver (já terminou ou não arrancou).
+ */
+int pipeline_descritor_fim(const execucao_pipeline *p, int i);
+
+/**
+ * @brief Recolhe uma etapa (waitpid ou pthread_join), esperando se ainda
+ * estiver a correr. Recolher uma etapa já recolhida não faz nada.
+ * @param p Pipeline.
+ * @param i Índice da etapa.
+ * @return Número de etapas que ainda faltam recolher.
+ */
+int pipeline_recolhe(execucao_pipeline *p, int i);
+
+/**
+ * @brief Escreve "Terminou comando ... com código ..." para cada etapa.
+ * @param p Pipeline já recolhido.
+ */
+void pipeline_reporta(const execucao_pipeline *p);
+
+/**
+ * @brief Escreve a medição de cada etapa medida (formato do `time`).
+ * @param p Pipeline já recolhido.
+ */
+void pipeline_mostra_tempos(const execucao_pipeline *p);
+
+/**
+ * @brief Devolve o código de saída do pipeline (o da última etapa).
+ * @param p Pipeline já recolhido.
+ * @return Código de saída.
+ */
+int pipeline_codigo(const execucao_pipeline *p);
+
+/**
+ * @brief Liberta um pipeline já recolhido.
+ * @param p Pipeline.
+ */
+void pipeline_liberta(execucao_pipeline *p);
+
+/**
+ * @brief Executa as etapas em simultâneo e reporta o código de cada uma.
+ *
+ * A primeira etapa lê da entrada da thread atual e a última escreve na saída
+ * da thread atual, exceto quando são redirecionadas. Um comando interno na
+ * última etapa corre na própria thread; os restantes correm em threads novas.
+ * @param etapas Etapas do pipeline.
+ * @param n Número de etapas.
+ * @param tempo 1 para medir e mostrar cada etapa no fim (`time`); com 0,
+ * as etapas só são medidas com `set perfil on`.
+ * @return Código de saída da última etapa.
+ */
+int pipeline_executa(etapa_pipeline etapas[], int n, int tempo);
+
+#endif // PIPELINE_H
@@ -0,0 +1,323 @@
+/**
+ * @file pool_threads.c
+ * @brief Implementação do pool de threads com roubo de tarefas.
+ *
+ * Cada fila é protegida pelo seu próprio mutex, pelo que o dono e os ladrões
+ * só competem quando mexem na mesma fila. Os workers sem trabalho dormem numa
+ * variável de condição e são acordados quando há tarefas disponíveis.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include "pool_threads.h"
+#include "saida.h"
+
+/// Capacidade inicial de cada fila (cresce quando necessário).
+#define CAPACIDADE_INICIAL 64
+
+/// @brief Tarefa guardada numa fila.
+typedef struct {
+    tarefa_pool fn;
+    void *arg;
+} tarefa;
+
+/// @brief Fila dupla de um worker (buffer circular).
+typedef struct {
+    pthread_mutex_t mutex;
+    tarefa *itens;
+    size_t capacidade;
+    size_t inicio;      ///< índice da tarefa mais antiga (lado dos ladrões)
+    size_t tamanho;
+} fila_worker;
+
+/// @brief Estado de um worker.
+typedef struct {
+    pool_threads *pool;
+    int indice;
+    pthread_t thread;
+    fila_worker fila;
+    estatisticas_worker estatisticas;
+} worker;
+
+struct pool_threads {
+    int num_threads;
+    int num_workers;                ///< workers alocados (pode exceder num_threads se a criação falhar)
+    worker *workers;
+    pthread_mutex_t mutex;          ///< protege o sono dos workers e a espera
+    pthread_cond_t ha_trabalho;     ///< sinalizada quando são submetidas tarefas
+    pthread_cond_t terminou;        ///< sinalizada quando pendentes chega a 0
+    unsigned long disponiveis;      ///< tarefas nas filas (acesso atómico)
+    unsigned long pendentes;        ///< tarefas submetidas e ainda não concluídas
+    unsigned int proxima_fila;      ///< distribuição circular de submissões externas
+    int erro;                       ///< descritor de erros de quem criou o pool
+    int terminar;
+};
+
+/// Worker associado à thread atual (NULL fora do pool).
+static __thread worker *worker_atual = NULL;
+
+/// @brief Instante atual em segundos.
+static double agora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/// @brief Coloca uma tarefa no fim da fila, aumentando-a se estiver cheia.
+/// @return 0 em caso de sucesso, -1 se a fila estava cheia e não pôde crescer.
+static int fila_insere(fila_worker *f, tarefa t) {
+    pthread_mutex_lock(&f->mutex);
+    if (f->tamanho == f->capacidade) {
+        size_t nova = f->capacidade * 2;
+        tarefa *itens = malloc(nova * sizeof(tarefa));
+
+        if (itens == NULL) {
+            pthread_mutex_unlock(&f->mutex);
+            return -1;
+        }
+        for (size_t i = 0; i < f->tamanho; i++) {
+            itens[i] = f->itens[(f->inicio + i) % f->capacidade];
+        }
+        free(f->itens);
+        f->itens = itens;
+        f->capacidade = nova;
+        f->inicio = 0;
+    }
+    f->itens[(f->inicio + f->tamanho) % f->capacidade] = t;
+    f->tamanho++;
+    pthread_mutex_unlock(&f->mutex);
+    return 0;
+}
+
+/// @brief Tira uma tarefa da fila: do fim (dono) ou do início (ladrão).
+/// @return 1 se obteve uma tarefa, 0 se a fila estava vazia.
+static int fila_retira(fila_worker *f, tarefa *t, int do_inicio) {
+    int obteve = 0;
+
+    pthread_mutex_lock(&f->mutex);
+    if (f->tamanho > 0) {
+        if (do_inicio) {
+            *t = f->itens[f->inicio];
+            f->inicio = (f->inicio + 1) % f->capacidade;
+        } else {
+            *t = f->itens[(f->inicio + f->tamanho - 1) % f->capacidade];
+        }
+        f->tamanho--;
+        obteve = 1;
+    }
+    pthread_mutex_unlock(&f->mutex);
+    return obteve;
+}
+
+/// @brief Procura trabalho: primeiro na própria fila, depois nas dos outros.
+static int obtem_tarefa(worker *w, tarefa *t) {
+    pool_threads *pool = w->pool;
+
+    if (fila_retira(&w->fila, t, 0)) {
+        return 1;
+    }
+    for (int k = 1; k < pool->num_threads; k++) {
+        worker *vitima = &pool->workers[(w->indice + k) % pool->num_threads];
+        if (fila_retira(&vitima->fila, t, 1)) {
+            w->estatisticas.roubos++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/// @brief Conta uma tarefa como concluída e acorda quem espera se era a última.
+static void conclui_tarefa(pool_threads *pool) {
+    if (__atomic_sub_fetch(&pool->pendentes, 1, __ATOMIC_SEQ_CST) == 0) {
+        pthread_mutex_lock(&pool->mutex);
+        pthread_cond_broadcast(&pool->terminou);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+}
+
+/// @brief Ciclo principal de cada worker.
+static void *ciclo_worker(void *arg) {
+    worker *w = arg;
+    pool_threads *pool = w->pool;
+    tarefa t;
+
+    worker_atual = w;
+    saida_define_erro(pool->erro);
+    for (;;) {
+        if (obtem_tarefa(w, &t)) {
+            double inicio = agora();
+
+            __atomic_sub_fetch(&pool->disponiveis, 1, __ATOMIC_SEQ_CST);
+            t.fn(t.arg);
+            w->estatisticas.tarefas++;
+            w->estatisticas.segundos_ocupado += agora() - inicio;
+            conclui_tarefa(pool);
+            continue;
+        }
+
+        // Sem trabalho: dormir até haver tarefas ou o pool terminar
+        pthread_mutex_lock(&pool->mutex);
+        while (__atomic_load_n(&pool->disponiveis, __ATOMIC_SEQ_CST) == 0 && !pool->terminar) {
+            pthread_cond_wait(&pool->ha_trabalho, &pool->mutex);
+        }
+        if (pool->terminar && __atomic_load_n(&pool->disponiveis, __ATOMIC_SEQ_CST) == 0) {
+            pthread_mutex_unlock(&pool->mutex);
+            break;
+        }
+        pthread_mutex_unlock(&pool->mutex);
+    }
+    return NULL;
+}
+
+/// @brief Cria o pool e arranca os workers.
+/// @param num_threads Número de workers (<= 0 usa o número de CPUs; no
+/// máximo POOL_MAX_THREADS).
+/// @return Pool criado, ou NULL se faltar memória ou nenhuma thread arrancar.
+pool_threads *pool_cria(int num_threads) {
+    pool_threads *pool = calloc(1, sizeof(pool_threads));
+
+    if (pool == NULL) {
+        return NULL;
+    }
+    if (num_threads <= 0) {
+        num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if (num_threads <= 0) {
+            num_threads = 1;
+        }
+    }
+    if (num_threads > POOL_MAX_THREADS) {
+        num_threads = POOL_MAX_THREADS;
+    }
+
+    pool->num_threads = num_threads;
+    pool->num_workers = num_threads;
+    pool->erro = saida_erro_fd();
+    pool->workers = calloc(num_threads, sizeof(worker));
+    if (pool->workers == NULL) {
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->ha_trabalho, NULL);
+    pthread_cond_init(&pool->terminou, NULL);
+
+    for (int i = 0; i < num_threads; i++) {
+        worker *w = &pool->workers[i];
+        w->pool = pool;
+        w->indice = i;
+        pthread_mutex_init(&w->fila.mutex, NULL);
+        w->fila.capacidade = CAPACIDADE_INICIAL;
+        w->fila.itens = malloc(CAPACIDADE_INICIAL * sizeof(tarefa));
+        if (w->fila.itens == NULL) {
+            // Nenhuma thread arrancou: libertar só as filas já iniciadas
+            pool->num_threads = 0;
+            pool->num_workers = i + 1;
+            pool_destroi(pool);
+            return NULL;
+        }
+    }
+    for (int i = 0; i < num_threads; i++) {
+        if (pthread_create(&pool->workers[i].thread, NULL, ciclo_worker, &pool->workers[i]) != 0) {
+            // Continuar com os workers que arrancaram
+            pool->num_threads = i;
+            break;
+        }
+    }
+    if (pool->num_threads == 0) {
+        pool_destroi(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+/// @brief Submete uma tarefa ao pool.
+/// @param pool Pool.
+/// @param fn Função a executar.
+/// @param arg Argumento da função.
+/// @details
+/// A partir de um worker, a tarefa vai para a fila do próprio worker (os
+/// outros roubam-na se estiverem livres); de fora, as tarefas são
+/// distribuídas pelas filas em sequência. Se a fila não puder crescer por
+/// falta de memória, a tarefa corre logo na thread atual.
+void pool_submete(pool_threads *pool, tarefa_pool fn, void *arg) {
+    tarefa t = { fn, arg };
+    fila_worker *f;
+
+    if (worker_atual != NULL && worker_atual->pool == pool) {
+        f = &worker_atual->fila;
+    } else {
+        unsigned int i = __atomic_fetch_add(&pool->proxima_fila, 1, __ATOMIC_RELAXED);
+        f = &pool->workers[i % pool->num_threads].fila;
+    }
+
+    // Os contadores sobem antes da inserção para nunca ficarem negativos
+    __atomic_add_fetch(&pool->pendentes, 1, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&pool->disponiveis, 1, __ATOMIC_SEQ_CST);
+    if (fila_insere(f, t) == -1) {
+        __atomic_sub_fetch(&pool->disponiveis, 1, __ATOMIC_SEQ_CST);
+        t.fn(t.arg);
+        conclui_tarefa(pool);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pthread_cond_signal(&pool->ha_trabalho);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+/// @brief Espera que todas as tarefas terminem.
+/// @param pool Pool.
+void pool_espera(pool_threads *pool) {
+    pthread_mutex_lock(&pool->mutex);
+    while (__atomic_load_n(&pool->pendentes, __ATOMIC_SEQ_CST) > 0) {
+        pthread_cond_wait(&pool->terminou, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+/// @brief Termina os workers e liberta a memória do pool.
+/// @param pool Pool.
+void pool_destroi(pool_threads *pool) {
+    int criados = pool->num_threads;
+
+    pool_espera(pool);
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->terminar = 1;
+    pthread_cond_broadcast(&pool->ha_trabalho);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (int i = 0; i < criados; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+    for (int i = 0; i < pool->num_workers; i++) {
+        pthread_mutex_destroy(&pool->workers[i].fila.mutex);
+        free(pool->workers[i].fila.itens);
+    }
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->ha_trabalho);
+    pthread_cond_destroy(&pool->terminou);
+    free(pool->workers);
+    free(pool);
+}
+
+/// @brief Número de workers do pool.
+int pool_num_threads(const pool_threads *pool) {
+    return pool->num_threads;
+}
+
+/// @brief Índice do worker atual, ou -1 fora do pool.
+int pool_worker_atual(void) {
+    return worker_atual != NULL ? worker_atual->indice : -1;
+}
+
+/// @brief Copia as estatísticas de um worker.
+void pool_estatisticas(const pool_threads *pool, int worker, estatisticas_worker *e) {
+    *e = pool->workers[worker].estatisticas;
+}
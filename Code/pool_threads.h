@@ -0,0 +1,83 @@
+/**
+ * @file pool_threads.h
+ * @brief Pool de threads com roubo de tarefas (work stealing).
+ *
+ * Cada worker tem a sua própria fila: tira tarefas do fim da sua fila e,
+ * quando fica sem trabalho, rouba do início da fila de outro worker. As
+ * tarefas podem submeter novas tarefas (por exemplo, subdiretorias).
+ *
+ * @date 2025
+ */
+
+#ifndef POOL_THREADS_H
+#define POOL_THREADS_H
+
+/**
+ * @brief Função executada por uma tarefa.
+ */
+typedef void (*tarefa_pool)(void *arg);
+
+/**
+ * @brief Estatísticas de um worker, escritas apenas pelo próprio worker.
+ */
+typedef struct {
+    unsigned long long tarefas;   ///< tarefas executadas
+    unsigned long long roubos;    ///< tarefas roubadas a outros workers
+    double segundos_ocupado;      ///< tempo gasto a executar tarefas
+} estatisticas_worker;
+
+typedef struct pool_threads pool_threads;
+
+/// Número máximo de workers de um pool (pedidos maiores ficam com este).
+#define POOL_MAX_THREADS 1024
+
+/**
+ * @brief Cria um pool de threads.
+ * @param num_threads Número de workers (0 ou negativo usa o número de CPUs;
+ * no máximo POOL_MAX_THREADS).
+ * @return Pool criado, ou NULL se faltar memória ou nenhuma thread arrancar.
+ */
+pool_threads *pool_cria(int num_threads);
+
+/**
+ * @brief Submete uma tarefa. Pode ser chamada a partir de uma tarefa.
+ * @param pool Pool de destino.
+ * @param fn Função a executar.
+ * @param arg Argumento passado à função.
+ */
+void pool_submete(pool_threads *pool, tarefa_pool fn, void *arg);
+
+/**
+ * @brief Espera até que todas as tarefas submetidas (e as que estas criaram) terminem.
+ * @param pool Pool.
+ */
+void pool_espera(pool_threads *pool);
+
+/**
+ * @brief Termina os workers e liberta o pool (espera pelas tarefas pendentes).
+ * @param pool Pool a destruir.
+ */
+void pool_destroi(pool_threads *pool);
+
+/**
+ * @brief Devolve o número de workers do pool.
+ * @param pool Pool.
+ * @return Número de workers.
+ */
+int pool_num_threads(const pool_threads *pool);
+
+/**
+ * @brief Devolve o índice do worker que está a executar a tarefa atual.
+ * @return Índice entre 0 e pool_num_threads()-1, ou -1 fora de um worker.
+ */
+int pool_worker_atual(void);
+
+/**
+ * @brief Obtém as estatísticas de um worker.
+ * @param pool Pool.
+ * @param worker Índice do worker.
+ * @param e Estrutura preenchida com as estatísticas.
+ */
+void pool_estatisticas(const pool_threads *pool, int worker, estatisticas_worker *e);
+
+#endif // POOL_THREADS_H
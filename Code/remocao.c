@@ -0,0 +1,344 @@
+/**
+ * @file remocao.c
+ * @brief Implementação da remoção em paralelo.
+ *
+ * Cada diretoria a remover é um nó com o descritor aberto e um contador de
+ * trabalho pendente: 1 enquanto é lida, mais 1 por subdiretoria submetida.
+ * Quando o contador chega a 0, o descritor é fechado, a diretoria é removida
+ * com unlinkat(descritor do pai, nome, AT_REMOVEDIR) e o contador do pai é
+ * decrementado. O descritor só fica aberto enquanto houver subdiretorias por
+ * remover, e o pool tira primeiro as tarefas mais recentes de cada fila, por
+ * isso o número de descritores abertos acompanha a profundidade da árvore.
+ *
+ * Se uma diretoria falhar, os seus antecessores ficam marcados e não se tenta
+ * removê-los (o erro já foi reportado, e o rmdir daria ENOTEMPTY).
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <dirent.h>
+#include "remocao.h"
+#include "percurso.h"
+#include "pool_threads.h"
+#include "saida.h"
+
+/// @brief Estado de uma remoção.
+typedef struct {
+    pool_threads *pool;
+    int recursivo;
+    resultado_remocao *resultados;  ///< um por caminho, ou NULL para escrever os erros
+    unsigned long long ficheiros, diretorias;
+    int erros;
+} remocao;
+
+/// @brief Diretoria a remover.
+typedef struct no_remocao {
+    remocao *r;
+    struct no_remocao *pai;     ///< NULL para um caminho indicado pelo utilizador
+    int indice;                 ///< caminho indicado de que faz parte
+    int fd;                     ///< descritor da diretoria, ou -1
+    int pendentes;              ///< leitura (1) e subdiretorias por remover
+    int falhou;                 ///< 1 se algum descendente não foi removido
+    char nome[];                ///< nome no pai (ou o caminho, se não houver pai)
+} no_remocao;
+
+/// @brief Conjunto de caminhos removidos por uma tarefa.
+typedef struct {
+    remocao *r;
+    char **caminhos;
+    int inicio;                 ///< índice do primeiro caminho
+    int n;
+} lote_caminhos;
+
+static void tarefa_diretoria(void *arg);
+
+/// @brief Conta entradas removidas no total e no caminho indicado (atómico).
+static void conta_removidas(remocao *r, int indice, unsigned long long ficheiros, unsigned long long diretorias) {
+    __atomic_fetch_add(&r->ficheiros, ficheiros, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&r->diretorias, diretorias, __ATOMIC_RELAXED);
+    if (r->resultados != NULL) {
+        __atomic_fetch_add(&r->resultados[indice].ficheiros, ficheiros, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&r->resultados[indice].diretorias, diretorias, __ATOMIC_RELAXED);
+    }
+}
+
+/// @brief Conta uma falha no total e no caminho indicado; o primeiro errno fica guardado.
+static void conta_falha(remocao *r, int indice, int erro) {
+    __atomic_fetch_add(&r->erros, 1, __ATOMIC_RELAXED);
+    if (r->resultados != NULL) {
+        int zero = 0;
+
+        __atomic_fetch_add(&r->resultados[indice].erros, 1, __ATOMIC_RELAXED);
+        __atomic_compare_exchange_n(&r->resultados[indice].erro, &zero, erro, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+    }
+}
+
+/// @brief Constrói o caminho de um nó (só para as mensagens de erro).
+static void caminho_no(const no_remocao *no, char *buf, size_t tamanho) {
+    if (no->pai == NULL) {
+        snprintf(buf, tamanho, "%s", no->nome);
+        return;
+    }
+    caminho_no(no->pai, buf, tamanho);
+    if (strlen(buf) + 1 < tamanho) {
+        strncat(buf, "/", tamanho - strlen(buf) - 1);
+        strncat(buf, no->nome, tamanho - strlen(buf) - 1);
+    }
+}
+
+/// @brief Reporta um erro (errno) num nó, ou numa entrada dele se nome não for NULL.
+static void erro_no(const no_remocao *no, const char *nome, const char *mensagem) {
+    char caminho[4096];
+    int erro = errno;
+
+    conta_falha(no->r, no->indice, erro);
+    if (no->r->resultados != NULL) {
+        return;
+    }
+    caminho_no(no, caminho, sizeof(caminho));
+    if (nome != NULL && strlen(caminho) + 1 < sizeof(caminho)) {
+        strncat(caminho, "/", sizeof(caminho) - strlen(caminho) - 1);
+        strncat(caminho, nome, sizeof(caminho) - strlen(caminho) - 1);
+    }
+    saida_erro("Erro: %s '%s': %s.\n", mensagem, caminho, strerror(erro));
+}
+
+/// @brief Cria um nó e submete-o ao pool.
+/// @param indice Caminho indicado de que faz parte.
+/// @return 0 em caso de sucesso, -1 se faltar memória.
+static int submete_diretoria(remocao *r, no_remocao *pai, int indice, const char *nome) {
+    size_t n = strlen(nome) + 1;
+    no_remocao *no = malloc(sizeof(no_remocao) + n);
+
+    if (no == NULL) {
+        return -1;
+    }
+    no->r = r;
+    no->pai = pai;
+    no->indice = indice;
+    no->fd = -1;
+    no->pendentes = 1;
+    no->falhou = 0;
+    memcpy(no->nome, nome, n);
+    if (pai != NULL) {
+        __atomic_fetch_add(&pai->pendentes, 1, __ATOMIC_RELAXED);
+    }
+    pool_submete(r->pool, tarefa_diretoria, no);
+    return 0;
+}
+
+/// @brief Termina uma parte do trabalho de um nó; o último remove a diretoria.
+static void conclui(no_remocao *no, int falhou) {
+    while (no != NULL) {
+        no_remocao *pai = no->pai;
+
+        if (falhou) {
+            __atomic_store_n(&no->falhou, 1, __ATOMIC_RELAXED);
+        }
+        if (__atomic_sub_fetch(&no->pendentes, 1, __ATOMIC_ACQ_REL) > 0) {
+            return;
+        }
+
+        // Todo o conteúdo foi tratado: remover a própria diretoria
+        if (no->fd != -1) {
+            close(no->fd);
+        }
+        falhou = __atomic_load_n(&no->falhou, __ATOMIC_RELAXED);
+        if (!falhou) {
+            if (unlinkat(pai != NULL ? pai->fd : AT_FDCWD, no->nome, AT_REMOVEDIR) == 0) {
+                conta_removidas(no->r, no->indice, 0, 1);
+            } else {
+                erro_no(no, NULL, "Não foi possível remover a diretoria");
+                falhou = 1;
+            }
+        }
+        free(no);
+        no = pai;
+    }
+}
+
+/// @brief Tarefa do pool: remove o conteúdo de uma diretoria.
+static void tarefa_diretoria(void *arg) {
+    no_remocao *no = arg;
+    remocao *r = no->r;
+    conteudo_diretoria d = { no->nome, -1, 0, 0, NULL, NULL };
+    unsigned long long ficheiros = 0;
+    int falhou = 0;
+
+    no->fd = openat(no->pai != NULL ? no->pai->fd : AT_FDCWD, no->nome,
+                    O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (no->fd == -1) {
+        erro_no(no, NULL, "Não foi possível abrir a diretoria");
+        conclui(no, 1);
+        return;
+    }
+    if (le_diretoria(no->fd, &d, NULL) == -1) {
+        erro_no(no, NULL, "Falha ao ler a diretoria");
+        falhou = 1;
+    }
+
+    for (int i = 0; i < d.num_entradas; i++) {
+        const entrada_diretoria *e = &d.entradas[i];
+
+        if (e->tipo != DT_DIR) {
+            if (unlinkat(no->fd, e->nome, 0) == 0) {
+                ficheiros++;
+                continue;
+            }
+            if (errno != EISDIR) {
+                erro_no(no, e->nome, "Não foi possível remover");
+                falhou = 1;
+                continue;
+            }
+            // Passou a ser uma diretoria depois de lida: tratar como tal
+        }
+        if (submete_diretoria(r, no, no->indice, e->nome) == -1) {
+            errno = ENOMEM;
+            erro_no(no, e->nome, "Não foi possível remover");
+            falhou = 1;
+        }
+    }
+
+    conta_removidas(r, no->indice, ficheiros, 0);
+    liberta_diretoria(&d);
+    conclui(no, falhou);
+}
+
+/// @brief Indica se o último componente de um caminho é "." ou "..", ou se é "/".
+static int caminho_protegido(const char *c) {
+    size_t n = strlen(c);
+    const char *base;
+
+    while (n > 1 && c[n - 1] == '/') {
+        n--;
+    }
+    if (n == 1 && c[0] == '/') {
+        return 1;
+    }
+    base = c + n;
+    while (base > c && base[-1] != '/') {
+        base--;
+    }
+    return (c + n - base == 1 && base[0] == '.') || (c + n - base == 2 && base[0] == '.' && base[1] == '.');
+}
+
+/// @brief Remove um caminho indicado pelo utilizador.
+/// @param indice Posição do caminho.
+static void remove_caminho(remocao *r, int indice, const char *c) {
+    if (caminho_protegido(c)) {
+        conta_falha(r, indice, EINVAL);
+        if (r->resultados == NULL) {
+            saida_erro("Erro: O caminho '%s' não pode ser removido.\n", c);
+        }
+        return;
+    }
+    if (unlink(c) == 0) {
+        conta_removidas(r, indice, 1, 0);
+        return;
+    }
+
+    // Só agora se vê porque falhou
+    if (errno == EISDIR && r->recursivo) {
+        if (submete_diretoria(r, NULL, indice, c) == 0) {
+            return;
+        }
+        errno = ENOMEM;
+    }
+    conta_falha(r, indice, errno);
+    if (r->resultados != NULL) {
+        return;
+    }
+    if (errno == ENOENT) {
+        saida_erro("Erro: O ficheiro '%s' não existe.\n", c);
+    } else if (errno == EISDIR) {
+        saida_erro("Erro: '%s' é uma diretoria (use apaga -r).\n", c);
+    } else {
+        saida_erro("Erro: Não foi possível remover o ficheiro '%s': %s.\n", c, strerror(errno));
+    }
+}
+
+/// @brief Tarefa do pool: remove um lote de caminhos.
+static void tarefa_lote(void *arg) {
+    lote_caminhos *l = arg;
+
+    for (int i = 0; i < l->n; i++) {
+        remove_caminho(l->r, l->inicio + i, l->caminhos[i]);
+    }
+    free(l);
+}
+
+/// @brief Remove ficheiros e, com recursivo, diretorias com todo o conteúdo.
+/// @param caminhos Caminhos.
+/// @param n Número de caminhos.
+/// @param recursivo Se diferente de 0, remove também as diretorias.
+/// @param num_threads Threads do pool (0 usa o número de CPUs).
+/// @param resultados Um por caminho, ou NULL para escrever os erros no STDERR.
+/// @param est Estatísticas.
+/// @return 0 se tudo foi removido, -1 se algum caminho falhou.
+int remove_caminhos(char *caminhos[], int n, int recursivo, int num_threads,
+                    resultado_remocao resultados[], estatisticas_remocao *est) {
+    remocao r = { NULL, recursivo, resultados, 0, 0, 0 };
+    struct timespec inicio, fim;
+
+    memset(est, 0, sizeof(*est));
+    if (resultados != NULL) {
+        memset(resultados, 0, n * sizeof(resultado_remocao));
+    }
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    if (recursivo || n >= REMOCAO_MIN_PARALELO) {
+        r.pool = pool_cria(num_threads);
+        if (r.pool == NULL) {
+            if (resultados == NULL) {
+                saida_erro("Erro: Não foi possível criar as threads da remoção.\n");
+            }
+            for (int i = 0; i < n; i++) {
+                conta_falha(&r, i, ENOMEM);
+            }
+            est->erros = n;
+            return -1;
+        }
+    }
+
+    if (r.pool == NULL) {
+        for (int i = 0; i < n; i++) {
+            remove_caminho(&r, i, caminhos[i]);
+        }
+    } else {
+        for (int i = 0; i < n; i += REMOCAO_CAMINHOS_TAREFA) {
+            lote_caminhos *l = malloc(sizeof(lote_caminhos));
+
+            if (l == NULL) {
+                // Os caminhos que faltam não são removidos
+                if (resultados == NULL) {
+                    saida_erro("Erro: Memória insuficiente.\n");
+                }
+                for (; i < n; i++) {
+                    conta_falha(&r, i, ENOMEM);
+                }
+                break;
+            }
+            l->r = &r;
+            l->caminhos = caminhos + i;
+            l->inicio = i;
+            l->n = n - i < REMOCAO_CAMINHOS_TAREFA ? n - i : REMOCAO_CAMINHOS_TAREFA;
+            pool_submete(r.pool, tarefa_lote, l);
+        }
+        pool_espera(r.pool);
+        pool_destroi(r.pool);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+
+    est->ficheiros = r.ficheiros;
+    est->diretorias = r.diretorias;
+    est->erros = r.erros;
+    est->segundos = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+    return r.erros == 0 ? 0 : -1;
+}
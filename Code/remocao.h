@@ -0,0 +1,63 @@
+/**
+ * @file remocao.h
+ * @brief Remoção de muitos ficheiros e de árvores de diretorias em paralelo.
+ *
+ * Cada caminho é removido com um único unlink; só quando este falha é que o
+ * errno diz porquê (não existe, é uma diretoria, ...), sem um stat antes.
+ * No modo recursivo, cada diretoria é uma tarefa do pool de threads: é lida
+ * com getdents64, os ficheiros são removidos com unlinkat relativo ao seu
+ * descritor e as subdiretorias são submetidas como novas tarefas. Uma
+ * diretoria é removida (unlinkat com AT_REMOVEDIR) pela tarefa que terminar
+ * em último lugar: a sua ou a da última subdiretoria. As ligações simbólicas
+ * são removidas e nunca seguidas.
+ *
+ * @date 2025
+ */
+
+#ifndef REMOCAO_H
+#define REMOCAO_H
+
+/// Com menos caminhos do que isto (e sem -r), a remoção é feita na thread atual.
+#define REMOCAO_MIN_PARALELO 4096
+
+/// Caminhos removidos por cada tarefa do pool, no modo não recursivo.
+#define REMOCAO_CAMINHOS_TAREFA 1024
+
+/**
+ * @brief Estatísticas de uma remoção.
+ */
+typedef struct {
+    unsigned long long ficheiros;   ///< entradas removidas que não são diretorias
+    unsigned long long diretorias;  ///< diretorias removidas
+    int erros;                      ///< caminhos que não puderam ser removidos
+    double segundos;                ///< duração da remoção
+} estatisticas_remocao;
+
+/**
+ * @brief Resultado da remoção de um dos caminhos indicados.
+ */
+typedef struct {
+    unsigned long long ficheiros;   ///< entradas removidas que não são diretorias
+    unsigned long long diretorias;  ///< diretorias removidas (o caminho e as subdiretorias)
+    int erros;                      ///< entradas que não puderam ser removidas
+    int erro;                       ///< errno da primeira falha (EINVAL: "." , ".." ou "/")
+} resultado_remocao;
+
+/**
+ * @brief Remove ficheiros e, com recursivo, diretorias com todo o conteúdo.
+ *
+ * Sem resultados, os erros são reportados no STDERR; com resultados, nada é
+ * escrito e cada caminho fica com as suas contagens e o errno da primeira
+ * falha. "." e ".." (e "/") nunca são removidos.
+ * @param caminhos Caminhos a remover.
+ * @param n Número de caminhos.
+ * @param recursivo Se diferente de 0, remove também as diretorias.
+ * @param num_threads Threads do pool (0 usa o número de CPUs).
+ * @param resultados Um resultado por caminho (preenchidos), ou NULL.
+ * @param est Estatísticas (preenchidas).
+ * @return 0 se tudo foi removido, -1 se algum caminho falhou.
+ */
+int remove_caminhos(char *caminhos[], int n, int recursivo, int num_threads,
+                    resultado_remocao resultados[], estatisticas_remocao *est);
+
+#endif // REMOCAO_H
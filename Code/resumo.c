@@ -0,0 +1,299 @@
+/**
+ * @file resumo.c
+ * @brief Implementação dos resumos de ficheiros.
+ *
+ * O XXH64 segue a especificação de referência (os valores de teste
+ * XXH64("", 0) = ef46db3751d8e999 e XXH64("abc", 0) = 44bc2cf5ad770999).
+ * Cada pedaço de um ficheiro é uma tarefa do pool que escreve só o seu
+ * resumo, como na contagem; a junção é feita no fim, pela ordem dos pedaços.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <endian.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "resumo.h"
+#include "cache_resumos.h"
+#include "pool_threads.h"
+
+#define PRIMO1 0x9E3779B185EBCA87ULL
+#define PRIMO2 0xC2B2AE3D27D4EB4FULL
+#define PRIMO3 0x165667B19E3779F9ULL
+#define PRIMO4 0x85EBCA77C2B2AE63ULL
+#define PRIMO5 0x27D4EB2F165667C5ULL
+
+static inline uint64_t roda(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t le64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return le64toh(v);
+}
+
+static inline uint32_t le32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return le32toh(v);
+}
+
+/// @brief Mistura 8 bytes num acumulador.
+static inline uint64_t ronda(uint64_t acc, uint64_t v) {
+    acc += v * PRIMO2;
+    return roda(acc, 31) * PRIMO1;
+}
+
+/// @brief Junta um dos quatro acumuladores ao resultado.
+static inline uint64_t junta(uint64_t h, uint64_t acc) {
+    h ^= ronda(0, acc);
+    return h * PRIMO1 + PRIMO4;
+}
+
+/// @brief Calcula o XXH64 de um bloco de memória.
+/// @param dados Início do bloco.
+/// @param n Tamanho do bloco em bytes.
+/// @param semente Semente do hash.
+/// @return Resumo do bloco.
+/// @details Os quatro acumuladores não dependem uns dos outros, por isso o
+/// processador executa as quatro rondas de cada iteração em paralelo.
+uint64_t resumo_dados(const void *dados, size_t n, uint64_t semente) {
+    const unsigned char *p = dados;
+    const unsigned char *fim = p + n;
+    uint64_t h;
+
+    if (n >= 32) {
+        const unsigned char *limite = fim - 32;
+        uint64_t v1 = semente + PRIMO1 + PRIMO2;
+        uint64_t v2 = semente + PRIMO2;
+        uint64_t v3 = semente;
+        uint64_t v4 = semente - PRIMO1;
+
+        do {
+            v1 = ronda(v1, le64(p));
+            v2 = ronda(v2, le64(p + 8));
+            v3 = ronda(v3, le64(p + 16));
+            v4 = ronda(v4, le64(p + 24));
+            p += 32;
+        } while (p <= limite);
+
+        h = roda(v1, 1) + roda(v2, 7) + roda(v3, 12) + roda(v4, 18);
+        h = junta(h, v1);
+        h = junta(h, v2);
+        h = junta(h, v3);
+        h = junta(h, v4);
+    } else {
+        h = semente + PRIMO5;
+    }
+    h += n;
+
+    // Resto: 8, 4 e 1 bytes de cada vez
+    for (; p + 8 <= fim; p += 8) {
+        h ^= ronda(0, le64(p));
+        h = roda(h, 27) * PRIMO1 + PRIMO4;
+    }
+    if (p + 4 <= fim) {
+        h ^= (uint64_t)le32(p) * PRIMO1;
+        h = roda(h, 23) * PRIMO2 + PRIMO3;
+        p += 4;
+    }
+    for (; p < fim; p++) {
+        h ^= *p * PRIMO5;
+        h = roda(h, 11) * PRIMO1;
+    }
+
+    h ^= h >> 33;
+    h *= PRIMO2;
+    h ^= h >> 29;
+    h *= PRIMO3;
+    h ^= h >> 32;
+    return h;
+}
+
+/// @brief Estado do resumo de um ficheiro que tem de ser lido.
+typedef struct {
+    pedido_resumo *p;
+    struct stat st;             ///< informação antes da leitura (chave da cache)
+    unsigned char *mapa;
+    int num_pedacos;
+    uint64_t *pedacos;          ///< um resumo por pedaço, escrito só pela sua tarefa
+} ficheiro_resumo;
+
+/// @brief Tarefa do pool: um pedaço de um ficheiro mapeado.
+typedef struct {
+    ficheiro_resumo *f;
+    int pedaco;
+} tarefa_resumo;
+
+/// @brief Executa uma tarefa de resumo num worker do pool.
+static void executa_tarefa_resumo(void *arg) {
+    tarefa_resumo *t = arg;
+    ficheiro_resumo *f = t->f;
+    size_t inicio = (size_t)t->pedaco * RESUMO_PEDACO;
+    size_t n = f->st.st_size - inicio < RESUMO_PEDACO ? f->st.st_size - inicio : RESUMO_PEDACO;
+
+    f->pedacos[t->pedaco] = resumo_dados(f->mapa + inicio, n, 0);
+}
+
+/// @brief Abre um ficheiro e, com usa_cache, procura-o na cache; se não estiver, mapeia-o.
+/// @return 1 se o ficheiro tem de ser lido, 0 se o resumo já está no pedido
+/// (da cache ou de um ficheiro vazio), -1 em caso de erro.
+static int prepara(ficheiro_resumo *f, int usa_cache) {
+    pedido_resumo *p = f->p;
+    int fd = open(p->nome, O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1 || fstat(fd, &f->st) == -1) {
+        p->erro = errno;
+        if (fd != -1) {
+            close(fd);
+        }
+        return -1;
+    }
+    if (!S_ISREG(f->st.st_mode)) {
+        p->erro = EINVAL;
+        close(fd);
+        return -1;
+    }
+    p->tamanho = f->st.st_size;
+    if (usa_cache && cache_resumos_procura(&f->st, &p->resumo)) {
+        p->origem = RESUMO_CACHE;
+        close(fd);
+        return 0;
+    }
+    if (f->st.st_size == 0) {
+        p->resumo = resumo_dados("", 0, 0);
+        p->origem = RESUMO_CALCULADO;
+        close(fd);
+        return 0;
+    }
+
+    f->mapa = mmap(NULL, f->st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (f->mapa == MAP_FAILED) {
+        f->mapa = NULL;
+        p->erro = errno;
+        return -1;
+    }
+    madvise(f->mapa, f->st.st_size, MADV_SEQUENTIAL);
+    f->num_pedacos = (int)((f->st.st_size + RESUMO_PEDACO - 1) / RESUMO_PEDACO);
+    f->pedacos = calloc(f->num_pedacos, sizeof(uint64_t));
+    if (f->pedacos == NULL) {
+        munmap(f->mapa, f->st.st_size);
+        f->mapa = NULL;
+        p->erro = ENOMEM;
+        return -1;
+    }
+    return 1;
+}
+
+/// @brief Junta os resumos dos pedaços de um ficheiro e, com usa_cache, guarda-o na cache.
+static void conclui(ficheiro_resumo *f, int usa_cache) {
+    pedido_resumo *p = f->p;
+
+    if (f->num_pedacos == 1) {
+        p->resumo = f->pedacos[0];
+    } else {
+        for (int i = 0; i < f->num_pedacos; i++) {
+            f->pedacos[i] = htole64(f->pedacos[i]);
+        }
+        p->resumo = resumo_dados(f->pedacos, f->num_pedacos * sizeof(uint64_t), f->st.st_size);
+    }
+    p->origem = RESUMO_CALCULADO;
+    if (usa_cache) {
+        cache_resumos_guarda(&f->st, p->resumo);
+    }
+    munmap(f->mapa, f->st.st_size);
+    free(f->pedacos);
+}
+
+/// @brief Calcula o resumo de vários ficheiros regulares.
+/// @param pedidos Pedidos (com nome preenchido).
+/// @param n Número de pedidos.
+/// @param num_threads Threads do pool (0 usa o número de CPUs).
+/// @param usa_cache Se diferente de 0, usa e atualiza a cache persistente.
+/// @return Número de pedidos que falharam.
+/// @details
+/// Primeiro cada ficheiro é procurado na cache, se for usada (só um open e
+/// um fstat); os que faltam são mapeados e divididos em pedaços, e todos os
+/// pedaços correm juntos no pool. Se tudo estava na cache, o pool nem é
+/// criado.
+/// Variáveis:
+/// - fich: estado dos ficheiros que têm de ser lidos
+/// - tarefas: uma por pedaço
+int resumo_ficheiros(pedido_resumo pedidos[], int n, int num_threads, int usa_cache) {
+    ficheiro_resumo *fich = calloc(n > 0 ? n : 1, sizeof(ficheiro_resumo));
+    tarefa_resumo *tarefas;
+    pool_threads *pool;
+    int num_fich = 0, num_tarefas = 0, falhas = 0, t = 0;
+
+    if (fich == NULL) {
+        for (int i = 0; i < n; i++) {
+            pedidos[i].origem = RESUMO_ERRO;
+            pedidos[i].erro = ENOMEM;
+        }
+        return n;
+    }
+
+    for (int i = 0; i < n; i++) {
+        pedidos[i].origem = RESUMO_ERRO;
+        pedidos[i].erro = 0;
+        pedidos[i].tamanho = 0;
+        fich[num_fich].p = &pedidos[i];
+        switch (prepara(&fich[num_fich], usa_cache)) {
+        case 1:
+            num_tarefas += fich[num_fich].num_pedacos;
+            num_fich++;
+            break;
+        case -1:
+            falhas++;
+            break;
+        }
+    }
+
+    if (num_fich > 0) {
+        tarefas = calloc(num_tarefas, sizeof(tarefa_resumo));
+        pool = tarefas != NULL ? pool_cria(num_threads) : NULL;
+        if (tarefas == NULL) {
+            for (int i = 0; i < num_fich; i++) {
+                fich[i].p->erro = ENOMEM;
+                munmap(fich[i].mapa, fich[i].st.st_size);
+                free(fich[i].pedacos);
+            }
+            falhas += num_fich;
+        } else {
+            // Sem threads, os pedaços são resumidos na thread atual
+            for (int i = 0; i < num_fich; i++) {
+                for (int k = 0; k < fich[i].num_pedacos; k++, t++) {
+                    tarefas[t].f = &fich[i];
+                    tarefas[t].pedaco = k;
+                    if (pool != NULL) {
+                        pool_submete(pool, executa_tarefa_resumo, &tarefas[t]);
+                    } else {
+                        executa_tarefa_resumo(&tarefas[t]);
+                    }
+                }
+            }
+            if (pool != NULL) {
+                pool_espera(pool);
+                pool_destroi(pool);
+            }
+            for (int i = 0; i < num_fich; i++) {
+                conclui(&fich[i], usa_cache);
+            }
+            free(tarefas);
+            if (usa_cache) {
+                cache_resumos_grava();
+            }
+        }
+    }
+
+    free(fich);
+    return falhas;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file resumo.h
+ * @brief Resumos (digests) do conteúdo de ficheiros, para comparar ficheiros
+ * sem os ler byte a byte.
+ *
+ * O resumo é o XXH64, um hash não criptográfico de 64 bits que processa 32
+ * bytes por iteração em quatro acumuladores independentes. Os ficheiros são
+ * lidos com mmap; os que têm mais de RESUMO_PEDACO bytes são divididos em
+ * pedaços resumidos em paralelo no pool de threads, e o resumo do ficheiro é
+ * o XXH64 dos resumos dos pedaços (em little-endian), com o tamanho do
+ * ficheiro como semente. Assim o resultado não depende do número de threads,
+ * e para ficheiros até RESUMO_PEDACO bytes é igual ao do `xxhsum -H64`.
+ *
+ * Quem o pede (o interpretador) guarda os resumos numa cache persistente
+ * (ver cache_resumos.h), por isso um ficheiro que não mudou não volta a ser
+ * lido. Sem o pedir, nada é lido nem escrito fora dos próprios ficheiros.
+ *
+ * O XXH64 deteta alterações acidentais, mas não resiste a colisões
+ * construídas de propósito.
+ *
+ * @date 2025
+ */
+
+#ifndef RESUMO_H
+#define RESUMO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Ficheiros maiores do que isto são divididos em pedaços deste tamanho.
+#define RESUMO_PEDACO (16UL << 20)
+
+/**
+ * @brief De onde veio o resumo de um ficheiro.
+ */
+typedef enum {
+    RESUMO_ERRO,        ///< não foi possível calcular (ver erro)
+    RESUMO_CALCULADO,   ///< o ficheiro foi lido
+    RESUMO_CACHE        ///< o resumo estava na cache
+} origem_resumo;
+
+/**
+ * @brief Pedido de resumo de um ficheiro.
+ */
+typedef struct {
+    const char *nome;           ///< caminho do ficheiro (preenchido pelo chamador)
+    uint64_t resumo;            ///< resumo do conteúdo
+    unsigned long long tamanho; ///< tamanho do ficheiro
+    origem_resumo origem;
+    int erro;                   ///< errno da falha (EINVAL se não for um ficheiro regular)
+} pedido_resumo;
+
+/**
+ * @brief Calcula o XXH64 de um bloco de memória.
+ * @param dados Início do bloco.
+ * @param n Tamanho do bloco em bytes.
+ * @param semente Semente do hash.
+ * @return Resumo do bloco.
+ */
+uint64_t resumo_dados(const void *dados, size_t n, uint64_t semente);
+
+/**
+ * @brief Calcula o resumo de vários ficheiros regulares.
+ *
+ * Os resumos são calculados no pool de threads (criado só se houver algum a
+ * calcular). Com usa_cache, os que estão na cache não leem o ficheiro e os
+ * calculados são guardados nela (no disco, em $XDG_CACHE_HOME). Os erros
+ * não são reportados: ficam em cada pedido.
+ * @param pedidos Pedidos (com nome preenchido).
+ * @param n Número de pedidos.
+ * @param num_threads Threads do pool (0 usa o número de CPUs).
+ * @param usa_cache Se diferente de 0, usa e atualiza a cache persistente.
+ * @return Número de pedidos que falharam.
+ */
+int resumo_ficheiros(pedido_resumo pedidos[], int n, int num_threads, int usa_cache);
+
+#endif // RESUMO_H
@@ -0,0 +1,298 @@
+/**
+ * @file saida.c
+ * @brief Implementação da escrita com buffer por thread.
+ *
+ * O buffer de cada thread é criado na primeira escrita e libertado (depois
+ * de esvaziado) quando a thread termina.
+ *
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include "saida.h"
+
+/// Tamanho do buffer de cada thread.
+#define TAMANHO_BUFFER (64 * 1024)
+
+/// @brief Estado da saída de uma thread.
+typedef struct {
+    int fd;
+    int entrada;
+    int redirecionada;      ///< a saída não é o STDOUT do interpretador
+    size_t usado;
+    char dados[TAMANHO_BUFFER];
+} buffer_saida;
+
+/// Descritor das mensagens de erro da thread atual.
+static __thread int erro_thread = STDERR_FILENO;
+
+static pthread_key_t chave_saida;
+static pthread_once_t chave_once = PTHREAD_ONCE_INIT;
+
+/// @brief Esvazia e liberta o buffer de uma thread que terminou.
+static void liberta_buffer(void *p) {
+    buffer_saida *b = p;
+
+    escreve_tudo(b->fd, b->dados, b->usado);
+    free(b);
+}
+
+/// @brief Cria a chave das variáveis por thread (executado uma vez).
+static void cria_chave(void) {
+    pthread_key_create(&chave_saida, liberta_buffer);
+}
+
+/// @brief Devolve o buffer da thread atual, criando-o se necessário.
+static buffer_saida *buffer_atual(void) {
+    buffer_saida *b;
+
+    pthread_once(&chave_once, cria_chave);
+    b = pthread_getspecific(chave_saida);
+    if (b == NULL) {
+        b = malloc(sizeof(buffer_saida));
+        if (b == NULL) {
+            return NULL;
+        }
+        b->fd = STDOUT_FILENO;
+        b->entrada = STDIN_FILENO;
+        b->redirecionada = 0;
+        b->usado = 0;
+        pthread_setspecific(chave_saida, b);
+    }
+    return b;
+}
+
+/// @brief Escreve n bytes num descritor, tratando escritas parciais e EINTR.
+/// @param fd Descritor.
+/// @param dados Dados.
+/// @param n Número de bytes.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+int escreve_tudo(int fd, const void *dados, size_t n) {
+    const char *p = dados;
+
+    while (n > 0) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        p += w;
+        n -= w;
+    }
+    return 0;
+}
+
+/// @brief Escreve vários blocos num descritor com writev, repetindo enquanto
+/// a escrita for parcial.
+/// @param fd Descritor.
+/// @param iov Blocos a escrever (é alterado).
+/// @param n Número de blocos.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+int escreve_vetor(int fd, struct iovec *iov, int n) {
+    while (n > 0) {
+        ssize_t w = writev(fd, iov, n);
+        if (w < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        // Saltar os blocos já escritos e avançar no bloco escrito em parte
+        while (n > 0 && (size_t)w >= iov->iov_len) {
+            w -= iov->iov_len;
+            iov++;
+            n--;
+        }
+        if (n > 0) {
+            iov->iov_base = (char *)iov->iov_base + w;
+            iov->iov_len -= w;
+        }
+    }
+    return 0;
+}
+
+/// @brief Esvazia o buffer da thread atual.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+int saida_flush(void) {
+    buffer_saida *b = buffer_atual();
+    int r;
+
+    if (b == NULL || b->usado == 0) {
+        return 0;
+    }
+    r = escreve_tudo(b->fd, b->dados, b->usado);
+    b->usado = 0;
+    return r;
+}
+
+/// @brief Escreve dados na saída da thread atual.
+/// @param dados Dados.
+/// @param n Número de bytes.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+/// @details Blocos maiores do que o buffer não são copiados: são escritos
+/// diretamente, juntamente com o que já estava no buffer, num só writev.
+int saida_escreve(const void *dados, size_t n) {
+    buffer_saida *b = buffer_atual();
+
+    if (b == NULL) {
+        return escreve_tudo(STDOUT_FILENO, dados, n);
+    }
+    if (n >= TAMANHO_BUFFER) {
+        struct iovec iov[2] = { { b->dados, b->usado }, { (void *)dados, n } };
+
+        b->usado = 0;
+        return escreve_vetor(b->fd, iov[0].iov_len > 0 ? iov : iov + 1, iov[0].iov_len > 0 ? 2 : 1);
+    }
+    if (b->usado + n > TAMANHO_BUFFER && saida_flush() == -1) {
+        return -1;
+    }
+    memcpy(b->dados + b->usado, dados, n);
+    b->usado += n;
+    return 0;
+}
+
+/// @brief Escreve texto formatado na saída da thread atual.
+/// @param formato Formato do printf.
+/// @return 0 em caso de sucesso, -1 em caso de erro.
+int saida_printf(const char *formato, ...) {
+    buffer_saida *b = buffer_atual();
+    va_list ap;
+    int n;
+
+    if (b == NULL) {
+        return -1;
+    }
+
+    // Tentar formatar diretamente no espaço livre do buffer
+    va_start(ap, formato);
+    n = vsnprintf(b->dados + b->usado, TAMANHO_BUFFER - b->usado, formato, ap);
+    va_end(ap);
+    if (n < 0) {
+        return -1;
+    }
+    if ((size_t)n < TAMANHO_BUFFER - b->usado) {
+        b->usado += n;
+        return 0;
+    }
+
+    // Não coube: formatar para memória temporária
+    {
+        char *texto = malloc(n + 1);
+        int r;
+
+        if (texto == NULL) {
+            return -1;
+        }
+        va_start(ap, formato);
+        vsnprintf(texto, n + 1, formato, ap);
+        va_end(ap);
+        r = saida_escreve(texto, n);
+        free(texto);
+        return r;
+    }
+}
+
+/// @brief Muda o descritor de destino da thread atual.
+/// @param fd Novo descritor.
+void saida_define_fd(int fd) {
+    buffer_saida *b = buffer_atual();
+
+    if (b != NULL) {
+        saida_flush();
+        b->fd = fd;
+    }
+}
+
+/// @brief Descritor de destino da thread atual.
+/// @return Descritor.
+int saida_fd(void) {
+    buffer_saida *b = buffer_atual();
+
+    return b != NULL ? b->fd : STDOUT_FILENO;
+}
+
+/// @brief Escreve uma mensagem informativa na saída, ou nos erros se esta estiver redirecionada.
+/// @param formato Formato do printf.
+void saida_info(const char *formato, ...) {
+    buffer_saida *b = buffer_atual();
+    char texto[1024];
+    va_list ap;
+    int n;
+
+    va_start(ap, formato);
+    n = vsnprintf(texto, sizeof(texto), formato, ap);
+    va_end(ap);
+    if (n < 0) {
+        return;
+    }
+    if ((size_t)n >= sizeof(texto)) {
+        n = sizeof(texto) - 1;
+    }
+    if (b != NULL && b->redirecionada) {
+        escreve_tudo(erro_thread, texto, n);
+    } else {
+        saida_escreve(texto, n);
+    }
+}
+
+/// @brief Define os descritores de entrada e saída da thread atual.
+/// @param entrada Descritor de entrada.
+/// @param saida Descritor de saída.
+void saida_redireciona(int entrada, int saida) {
+    buffer_saida *b = buffer_atual();
+
+    if (b != NULL) {
+        saida_flush();
+        b->fd = saida;
+        b->entrada = entrada;
+        b->redirecionada = saida != STDOUT_FILENO;
+    }
+}
+
+/// @brief Descritor de entrada da thread atual.
+/// @return Descritor.
+int entrada_fd(void) {
+    buffer_saida *b = buffer_atual();
+
+    return b != NULL ? b->entrada : STDIN_FILENO;
+}
+
+/// @brief Escreve uma mensagem de erro no descritor de erros da thread atual.
+/// @param formato Formato do printf.
+/// @details Tal como o STDERR, não tem buffer: a mensagem é escrita logo.
+void saida_erro(const char *formato, ...) {
+    char texto[1024];
+    va_list ap;
+    int n;
+
+    va_start(ap, formato);
+    n = vsnprintf(texto, sizeof(texto), formato, ap);
+    va_end(ap);
+    if (n < 0) {
+        return;
+    }
+    if ((size_t)n >= sizeof(texto)) {
+        n = sizeof(texto) - 1;
+    }
+    escreve_tudo(erro_thread, texto, n);
+}
+
+/// @brief Muda o descritor de erros da thread atual.
+/// @param fd Novo descritor.
+void saida_define_erro(int fd) {
+    erro_thread = fd;
+}
+
+/// @brief Descritor de erros da thread atual.
+/// @return Descritor.
+int saida_erro_fd(void) {
+    return erro_thread;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file saida.h
+ * @brief Escrita com buffer para a saída dos comandos.
+ *
+ * Todos os comandos escrevem através deste módulo, em vez de misturarem
+ * printf com write. Cada thread tem o seu próprio buffer e o seu próprio
+ * descritor de destino (por omissão o STDOUT), e as mensagens de erro vão
+ * para o descritor de erros da thread (por omissão o STDERR), o que permite
+ * ao servidor (ver servidor.h) entregar a saída e os erros de cada comando
+ * ao cliente que o pediu.
+ *
+ * @date 2025
+ */
+
+#ifndef SAIDA_H
+#define SAIDA_H
+
+#include <stddef.h>
+#include <sys/uio.h>
+
+/**
+ * @brief Escreve dados na saída da thread atual.
+ * @param dados Dados a escrever.
+ * @param n Número de bytes.
+ * @return 0 em caso de sucesso, -1 se a escrita falhar.
+ */
+int saida_escreve(const void *dados, size_t n);
+
+/**
+ * @brief Escreve texto formatado (como printf) na saída da thread atual.
+ * @param formato Formato do printf.
+ * @return 0 em caso de sucesso, -1 se a escrita falhar.
+ */
+int saida_printf(const char *formato, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * @brief Escreve no descritor tudo o que está no buffer da thread atual.
+ * @return 0 em caso de sucesso, -1 se a escrita falhar.
+ */
+int saida_flush(void);
+
+/**
+ * @brief Muda o descritor de destino da thread atual (esvazia o buffer antes).
+ * @param fd Novo descritor.
+ */
+void saida_define_fd(int fd);
+
+/**
+ * @brief Devolve o descritor de destino da thread atual.
+ * @return Descritor de destino.
+ */
+int saida_fd(void);
+
+/**
+ * @brief Escreve uma mensagem informativa (por exemplo "copiado com sucesso").
+ *
+ * Vai para a saída da thread, exceto quando esta foi redirecionada para um
+ * pipe ou ficheiro: nesse caso vai para o descritor de erros, para não se
+ * misturar com os dados.
+ * @param formato Formato do printf.
+ */
+void saida_info(const char *formato, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * @brief Escreve uma mensagem de erro (como fprintf para o STDERR) no
+ * descritor de erros da thread atual, sem buffer.
+ * @param formato Formato do printf.
+ */
+void saida_erro(const char *formato, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * @brief Muda o descritor de erros da thread atual.
+ *
+ * As threads criadas para um comando (etapas de pipelines, workers dos
+ * pools) herdam o descritor de erros da thread que as criou.
+ * @param fd Novo descritor.
+ */
+void saida_define_erro(int fd);
+
+/**
+ * @brief Devolve o descritor de erros da thread atual (por omissão o STDERR).
+ * @return Descritor de erros.
+ */
+int saida_erro_fd(void);
+
+/**
+ * @brief Define os descritores de entrada e saída da thread atual.
+ *
+ * Usado para correr comandos internos dentro de pipelines e com
+ * redirecionamentos. Os descritores diferentes de STDIN/STDOUT são
+ * considerados redirecionados.
+ * @param entrada Descritor de onde os comandos leem quando não recebem ficheiro.
+ * @param saida Descritor para onde vai a saída.
+ */
+void saida_redireciona(int entrada, int saida);
+
+/**
+ * @brief Devolve o descritor de entrada da thread atual (por omissão o STDIN).
+ * @return Descritor de entrada.
+ */
+int entrada_fd(void);
+
+/**
+ * @brief Escreve n bytes num descritor, repetindo enquanto a escrita for parcial.
+ * @param fd Descritor.
+ * @param dados Dados a escrever.
+ * @param n Número de bytes.
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int escreve_tudo(int fd, const void *dados, size_t n);
+
+/**
+ * @brief Escreve vários blocos num descritor com writev, repetindo enquanto
+ * a escrita for parcial.
+ * @param fd Descritor.
+ * @param iov Blocos a escrever (é alterado).
+ * @param n Número de blocos.
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int escreve_vetor(int fd, struct iovec *iov, int n);
+
+#endif // SAIDA_H
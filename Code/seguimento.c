@@ -0,0 +1,244 @@
+/**
+ * @file seguimento.c
+ * @brief Implementação do seguimento de ficheiros com inotify, epoll e signalfd.
+ *
+ * São vigiados o ficheiro (escritas, truncagem, remoção e mudança de nome) e
+ * a diretoria onde está (criação de um ficheiro novo com o mesmo nome). Os
+ * dados novos são copiados de uma só vez com o motor de cópia
+ * (sendfile/splice), por muito que o ficheiro tenha crescido entre eventos.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/signalfd.h>
+#include "seguimento.h"
+#include "motor_copia.h"
+#include "saida.h"
+
+/// Eventos vigiados no próprio ficheiro.
+#define EVENTOS_FICHEIRO (IN_MODIFY | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF)
+
+/// Eventos vigiados na diretoria (um ficheiro novo com o mesmo nome).
+#define EVENTOS_DIRETORIA (IN_CREATE | IN_MOVED_TO)
+
+/// Origem de um evento do epoll.
+enum { EVENTO_INOTIFY, EVENTO_SINAL, EVENTO_SAIDA };
+
+/// @brief Estado do seguimento de um ficheiro.
+typedef struct {
+    const char *caminho;
+    const char *nome;           ///< nome do ficheiro dentro da diretoria
+    int fd;                     ///< ficheiro atual (o antigo fica aberto se o nome for removido)
+    off_t posicao;              ///< próximo byte a mostrar
+    int notificacoes;           ///< descritor do inotify
+    int vigia_ficheiro;         ///< watch do ficheiro (-1 se não houver)
+} seguimento;
+
+/// @brief Copia para a saída tudo o que o ficheiro atual tem depois da posição.
+/// @return 0 em caso de sucesso, -1 se a escrita falhar.
+/// @details Se o ficheiro ficou mais pequeno do que a posição, foi truncado:
+/// volta a mostrar desde o início.
+static int drena(seguimento *s) {
+    struct stat st;
+
+    if (fstat(s->fd, &st) == -1) {
+        return 0;
+    }
+    if (st.st_size < s->posicao) {
+        saida_erro("mostra: O ficheiro '%s' foi truncado.\n", s->caminho);
+        s->posicao = 0;
+    }
+    if (st.st_size == s->posicao) {
+        return 0;
+    }
+    if (lseek(s->fd, s->posicao, SEEK_SET) == -1) {
+        return 0;
+    }
+    saida_flush();
+    if (copia_descritores(s->fd, saida_fd(), NULL) == -1 && errno == EPIPE) {
+        return -1;
+    }
+    s->posicao = lseek(s->fd, 0, SEEK_CUR);
+    return 0;
+}
+
+/// @brief Verifica se o nome passou a apontar para outro ficheiro (rotação)
+/// e, nesse caso, passa a seguir o ficheiro novo.
+/// @return 0 em caso de sucesso, -1 se a escrita falhar.
+/// @details O ficheiro antigo é lido até ao fim antes de ser fechado, para
+/// não perder o que foi escrito entre a última leitura e a rotação. A
+/// comparação de dispositivo e i-node é a mesma que o 'acrescenta' faz.
+static int verifica_rotacao(seguimento *s) {
+    struct stat st_nome, st_fd;
+    int novo;
+
+    if (stat(s->caminho, &st_nome) == -1) {
+        return 0;   // removido: continuar a ler o antigo até aparecer um novo
+    }
+    if (fstat(s->fd, &st_fd) == 0 &&
+        st_nome.st_ino == st_fd.st_ino && st_nome.st_dev == st_fd.st_dev) {
+        return 0;
+    }
+
+    novo = open(s->caminho, O_RDONLY | O_CLOEXEC);
+    if (novo == -1) {
+        return 0;
+    }
+    if (drena(s) == -1) {
+        close(novo);
+        return -1;
+    }
+    close(s->fd);
+    saida_erro("mostra: O ficheiro '%s' foi substituído; a seguir o novo ficheiro.\n", s->caminho);
+    if (s->vigia_ficheiro != -1) {
+        inotify_rm_watch(s->notificacoes, s->vigia_ficheiro);
+    }
+    s->fd = novo;
+    s->posicao = 0;
+    s->vigia_ficheiro = inotify_add_watch(s->notificacoes, s->caminho, EVENTOS_FICHEIRO);
+    return 0;
+}
+
+/// @brief Lê todos os eventos pendentes do inotify.
+/// @return 1 se algum evento pode indicar uma rotação, 0 caso contrário.
+static int le_notificacoes(seguimento *s) {
+    char buffer[64 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int rotacao = 0;
+    ssize_t n;
+
+    while ((n = read(s->notificacoes, buffer, sizeof(buffer))) > 0) {
+        for (char *p = buffer; p < buffer + n; ) {
+            const struct inotify_event *e = (const struct inotify_event *)p;
+
+            if (e->wd == s->vigia_ficheiro) {
+                if (e->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_ATTRIB)) {
+                    rotacao = 1;
+                }
+                if (e->mask & IN_IGNORED) {
+                    s->vigia_ficheiro = -1;    // o kernel removeu o watch
+                }
+            } else if (e->len > 0 && strcmp(e->name, s->nome) == 0) {
+                rotacao = 1;                   // um ficheiro novo com o mesmo nome
+            }
+            p += sizeof(struct inotify_event) + e->len;
+        }
+    }
+    return rotacao;
+}
+
+/// @brief Espera por eventos e mostra os dados novos até um Ctrl-C ou até a
+/// saída deixar de ter leitor.
+static void ciclo_seguimento(seguimento *s, int ep) {
+    // O ficheiro pode ter crescido antes de o watch existir
+    if (drena(s) == -1) {
+        return;
+    }
+    for (;;) {
+        struct epoll_event eventos[4];
+        int n = epoll_wait(ep, eventos, 4, -1), rotacao = 0;
+
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        for (int i = 0; i < n; i++) {
+            if (eventos[i].data.u32 != EVENTO_INOTIFY) {
+                return;     // Ctrl-C ou leitor da saída fechado
+            }
+            rotacao |= le_notificacoes(s);
+        }
+        // Primeiro o que foi acrescentado ao ficheiro atual, depois a rotação
+        if (drena(s) == -1 || (rotacao && verifica_rotacao(s) == -1) || drena(s) == -1) {
+            return;
+        }
+    }
+}
+
+/// @brief Mostra tudo o que for acrescentado a um ficheiro, até um Ctrl-C.
+/// @param caminho Caminho do ficheiro.
+/// @param fd Descritor aberto do ficheiro (é fechado no fim).
+/// @param posicao Posição a partir da qual mostrar.
+/// @return 0 em caso de sucesso, 1 em caso de erro.
+/// @details
+/// Sem alterações no ficheiro a thread fica bloqueada no epoll_wait, sem
+/// gastar CPU. O epoll junta três origens:
+/// - o inotify, com o ficheiro e a diretoria onde está;
+/// - um signalfd para o SIGINT (só recebe o sinal se estiver bloqueado, como
+///   no modo interativo; caso contrário o Ctrl-C termina o interpretador);
+/// - a saída, quando é um pipe, para terminar logo que o leitor desaparecer.
+int segue_ficheiro(const char *caminho, int fd, off_t posicao) {
+    seguimento s = { caminho, NULL, fd, posicao, -1, -1 };
+    char diretoria[PATH_MAX];
+    const char *barra = strrchr(caminho, '/');
+    struct epoll_event ev;
+    sigset_t interrupcao;
+    int ep, sinais, resultado = 0;
+
+    // Diretoria e nome do ficheiro
+    if (barra == NULL) {
+        strcpy(diretoria, ".");
+        s.nome = caminho;
+    } else {
+        snprintf(diretoria, sizeof(diretoria), "%.*s", barra == caminho ? 1 : (int)(barra - caminho), caminho);
+        s.nome = barra + 1;
+    }
+
+    sigemptyset(&interrupcao);
+    sigaddset(&interrupcao, SIGINT);
+    s.notificacoes = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    sinais = signalfd(-1, &interrupcao, SFD_NONBLOCK | SFD_CLOEXEC);
+    ep = epoll_create1(EPOLL_CLOEXEC);
+    if (s.notificacoes != -1) {
+        s.vigia_ficheiro = inotify_add_watch(s.notificacoes, caminho, EVENTOS_FICHEIRO);
+    }
+
+    if (sinais == -1 || ep == -1 || s.vigia_ficheiro == -1 ||
+        inotify_add_watch(s.notificacoes, diretoria, EVENTOS_DIRETORIA) == -1) {
+        saida_erro("Erro: Não foi possível seguir o ficheiro '%s'.\n", caminho);
+        resultado = 1;
+    } else {
+        // Um Ctrl-C anterior (por exemplo, a um comando externo) ficou pendente
+        // enquanto o SIGINT estava bloqueado: descartá-lo antes de começar
+        while (sigtimedwait(&interrupcao, NULL, &(struct timespec){ 0, 0 }) > 0) {
+        }
+
+        ev.events = EPOLLIN;
+        ev.data.u32 = EVENTO_INOTIFY;
+        epoll_ctl(ep, EPOLL_CTL_ADD, s.notificacoes, &ev);
+        ev.data.u32 = EVENTO_SINAL;
+        epoll_ctl(ep, EPOLL_CTL_ADD, sinais, &ev);
+        // EPOLLERR chega sempre: num pipe, indica que o leitor fechou (falha
+        // para terminais e ficheiros, que não são suportados pelo epoll)
+        ev.events = 0;
+        ev.data.u32 = EVENTO_SAIDA;
+        epoll_ctl(ep, EPOLL_CTL_ADD, saida_fd(), &ev);
+
+        ciclo_seguimento(&s, ep);
+    }
+
+    if (ep != -1) {
+        close(ep);
+    }
+    if (sinais != -1) {
+        close(sinais);
+    }
+    if (s.notificacoes != -1) {
+        close(s.notificacoes);
+    }
+    close(s.fd);
+    return resultado;
+}
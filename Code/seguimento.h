@@ -0,0 +1,30 @@
+/**
+ * @file seguimento.h
+ * @brief Seguimento de ficheiros que crescem (mostra -f), com inotify e epoll.
+ *
+ * Em vez de reler o ficheiro periodicamente, a thread fica parada num
+ * epoll_wait até o inotify indicar uma alteração. Tal como o `tail -F`, a
+ * rotação (o nome passa a apontar para outro i-node) e a truncagem são
+ * detetadas e o seguimento continua no ficheiro novo.
+ *
+ * @date 2025
+ */
+
+#ifndef SEGUIMENTO_H
+#define SEGUIMENTO_H
+
+#include <sys/types.h>
+
+/**
+ * @brief Mostra na saída da thread tudo o que for acrescentado a um ficheiro.
+ *
+ * Termina com um Ctrl-C (SIGINT lido por um signalfd, se estiver bloqueado)
+ * ou quando a saída deixar de ter leitor.
+ * @param caminho Caminho do ficheiro (usado para detetar a rotação).
+ * @param fd Descritor aberto do ficheiro (passa a pertencer a esta função).
+ * @param posicao Posição a partir da qual mostrar.
+ * @return 0 em caso de sucesso, 1 em caso de erro.
+ */
+int segue_ficheiro(const char *caminho, int fd, off_t posicao);
+
+#endif // SEGUIMENTO_H
@@ -0,0 +1,526 @@
+/**
+ * @file servidor.c
+ * @brief Implementação do servidor e do cliente do modo servidor.
+ *
+ * Protocolo (uma ligação por pedido):
+ * - o cliente envia um cabecalho_pedido, o texto (com o '\0') e o ambiente
+ *   (entradas "NOME=valor" seguidas, cada uma com o seu '\0'); a primeira
+ *   mensagem leva os quatro descritores em SCM_RIGHTS;
+ * - o servidor responde com o código de saída (int32_t) e fecha a ligação.
+ *
+ * A thread principal só lê pedidos: as ligações são não bloqueantes e um
+ * pedido pode chegar em vários bocados, por isso cada ligação guarda o que
+ * já recebeu. Quando o pedido está completo, a ligação sai do epoll e passa
+ * para o worker que o executa.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include "servidor.h"
+#include "pool_threads.h"
+#include "ambiente.h"
+#include "saida.h"
+
+/// Identifica os pedidos desta versão do protocolo ("ITP1").
+#define PEDIDO_MAGICO 0x31505449u
+
+/// Opção do pedido: parar no primeiro comando que falhar (-e).
+#define PEDIDO_PARAR_NO_ERRO 1u
+
+/// Tamanho máximo do texto de um pedido.
+#define MAX_TEXTO (64UL << 20)
+
+/// Tamanho máximo do ambiente de um pedido.
+#define MAX_AMBIENTE (1UL << 20)
+
+/// Eventos tratados por cada epoll_wait.
+#define MAX_EVENTOS 64
+
+/// Descritores passados pelo cliente, por esta ordem.
+enum { D_ENTRADA, D_SAIDA, D_ERROS, D_DIRETORIA, NUM_DESCRITORES };
+
+/// @brief Início de cada pedido.
+typedef struct {
+    uint32_t magico;
+    uint32_t opcoes;
+    uint32_t mascara;               ///< umask do cliente
+    uint32_t tamanho_texto;         ///< inclui o '\0'
+    uint32_t tamanho_ambiente;
+} cabecalho_pedido;
+
+/// @brief Ligação de um cliente: o pedido a ser recebido e, depois, executado.
+typedef struct {
+    int fd;
+    int fds[NUM_DESCRITORES];
+    int num_fds;
+    cabecalho_pedido cabecalho;
+    size_t recebidos;               ///< bytes recebidos (cabeçalho e corpo)
+    char *corpo;                    ///< texto seguido do ambiente
+    char **ambiente;
+    executa_pedido executa;
+} ligacao;
+
+/// 1 enquanto a thread executa um pedido.
+static __thread int em_pedido = 0;
+
+/// 1 depois de a thread ter a sua própria diretoria atual e umask.
+static __thread int isolada = 0;
+
+/// Marcas do socket de escuta e do signalfd no epoll (as ligações usam o seu endereço).
+static int marca_escuta, marca_sinais;
+
+/// @brief Indica se a thread atual está a executar um pedido.
+/// @return 1 dentro de um pedido, 0 caso contrário.
+int servidor_em_pedido(void) {
+    return em_pedido;
+}
+
+/// @brief Fecha os descritores e liberta uma ligação.
+static void liberta_ligacao(ligacao *l) {
+    for (int i = 0; i < l->num_fds; i++) {
+        close(l->fds[i]);
+    }
+    close(l->fd);
+    free(l->ambiente);
+    free(l->corpo);
+    free(l);
+}
+
+/// @brief Guarda os descritores que vieram numa mensagem (os que sobram são fechados).
+static void guarda_descritores(ligacao *l, struct msghdr *m) {
+    for (struct cmsghdr *c = CMSG_FIRSTHDR(m); c != NULL; c = CMSG_NXTHDR(m, c)) {
+        int n;
+
+        if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        n = (c->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (int i = 0; i < n; i++) {
+            int fd;
+
+            memcpy(&fd, CMSG_DATA(c) + i * sizeof(int), sizeof(int));
+            if (l->num_fds < NUM_DESCRITORES) {
+                l->fds[l->num_fds++] = fd;
+            } else {
+                close(fd);
+            }
+        }
+    }
+}
+
+/// @brief Separa o ambiente do corpo num array terminado em NULL.
+/// @return 0 em caso de sucesso, -1 se o pedido for inválido.
+static int prepara_pedido(ligacao *l) {
+    const cabecalho_pedido *c = &l->cabecalho;
+    char *ambiente = l->corpo + c->tamanho_texto;
+    size_t n = 0;
+
+    if (l->num_fds != NUM_DESCRITORES || c->tamanho_texto == 0 || l->corpo[c->tamanho_texto - 1] != '\0' ||
+        (c->tamanho_ambiente > 0 && ambiente[c->tamanho_ambiente - 1] != '\0')) {
+        return -1;
+    }
+    for (size_t i = 0; i < c->tamanho_ambiente; i++) {
+        n += ambiente[i] == '\0';
+    }
+    l->ambiente = malloc((n + 1) * sizeof(char *));
+    if (l->ambiente == NULL) {
+        return -1;
+    }
+    n = 0;
+    for (size_t i = 0; i < c->tamanho_ambiente; i += strlen(ambiente + i) + 1) {
+        l->ambiente[n++] = ambiente + i;
+    }
+    l->ambiente[n] = NULL;
+    return 0;
+}
+
+/// @brief Lê o que houver de um pedido.
+/// @return 1 se o pedido está completo, 0 se faltam dados, -1 se a ligação
+/// fechou ou o pedido é inválido.
+static int recebe(ligacao *l) {
+    const size_t cabecalho = sizeof(cabecalho_pedido);
+
+    for (;;) {
+        union {
+            struct cmsghdr alinhamento;
+            char dados[CMSG_SPACE(sizeof(int) * NUM_DESCRITORES)];
+        } controlo;
+        struct iovec iov;
+        struct msghdr m = { 0 };
+        ssize_t n;
+
+        if (l->recebidos < cabecalho) {
+            iov.iov_base = (char *)&l->cabecalho + l->recebidos;
+            iov.iov_len = cabecalho - l->recebidos;
+        } else {
+            const cabecalho_pedido *c = &l->cabecalho;
+            size_t corpo = (size_t)c->tamanho_texto + c->tamanho_ambiente;
+
+            if (l->corpo == NULL) {
+                if (c->magico != PEDIDO_MAGICO || c->tamanho_texto > MAX_TEXTO ||
+                    c->tamanho_ambiente > MAX_AMBIENTE || (l->corpo = malloc(corpo + 1)) == NULL) {
+                    return -1;
+                }
+            }
+            if (l->recebidos - cabecalho == corpo) {
+                return prepara_pedido(l) == 0 ? 1 : -1;
+            }
+            iov.iov_base = l->corpo + (l->recebidos - cabecalho);
+            iov.iov_len = corpo - (l->recebidos - cabecalho);
+        }
+
+        m.msg_iov = &iov;
+        m.msg_iovlen = 1;
+        m.msg_control = controlo.dados;
+        m.msg_controllen = sizeof(controlo.dados);
+        n = recvmsg(l->fd, &m, MSG_CMSG_CLOEXEC);
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        }
+        if (n <= 0) {
+            return -1;
+        }
+        guarda_descritores(l, &m);
+        l->recebidos += n;
+    }
+}
+
+/// @brief Executa um pedido num worker e responde ao cliente.
+/// @param arg Ligação (ligacao), libertada no fim.
+/// @details O worker usa os descritores, o ambiente, a diretoria atual e a
+/// umask do cliente e volta aos seus no fim. A diretoria atual e a umask
+/// são do processo, por isso na primeira vez o worker separa-as das outras
+/// threads com unshare(CLONE_FS); as threads que os comandos criarem herdam
+/// as do worker.
+static void executa_pedido_worker(void *arg) {
+    ligacao *l = arg;
+    int32_t codigo = 2;
+
+    saida_define_erro(l->fds[D_ERROS]);
+    if (!isolada && unshare(CLONE_FS) == 0) {
+        isolada = 1;
+    }
+    if (!isolada) {
+        saida_erro("Erro: O servidor não conseguiu isolar a diretoria atual: %s.\n", strerror(errno));
+    } else if (fchdir(l->fds[D_DIRETORIA]) == -1) {
+        saida_erro("Erro: O servidor não conseguiu mudar para a diretoria atual: %s.\n", strerror(errno));
+    } else {
+        umask(l->cabecalho.mascara & 0777);
+        ambiente_define(l->ambiente);
+        saida_redireciona(l->fds[D_ENTRADA], l->fds[D_SAIDA]);
+        em_pedido = 1;
+        codigo = l->executa(l->corpo, (l->cabecalho.opcoes & PEDIDO_PARAR_NO_ERRO) != 0);
+        em_pedido = 0;
+        saida_flush();
+        saida_redireciona(STDIN_FILENO, STDOUT_FILENO);
+        ambiente_define(NULL);
+    }
+    saida_define_erro(STDERR_FILENO);
+
+    // O cliente pode já ter desistido: não há nada a fazer se o envio falhar
+    send(l->fd, &codigo, sizeof(codigo), MSG_NOSIGNAL);
+    liberta_ligacao(l);
+}
+
+/// @brief Aceita as ligações pendentes e junta-as ao epoll.
+static void aceita(int escuta, int ep, executa_pedido executa) {
+    for (;;) {
+        struct epoll_event ev = { .events = EPOLLIN };
+        struct ucred cred;
+        socklen_t tamanho = sizeof(cred);
+        ligacao *l;
+        int fd = accept4(escuta, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (fd == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            return;
+        }
+
+        // Só o mesmo utilizador (ou o root) pode executar comandos no servidor
+        if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &tamanho) == -1 ||
+            (cred.uid != geteuid() && cred.uid != 0)) {
+            close(fd);
+            continue;
+        }
+        l = calloc(1, sizeof(ligacao));
+        if (l == NULL) {
+            close(fd);
+            continue;
+        }
+        l->fd = fd;
+        l->executa = executa;
+        ev.data.ptr = l;
+        if (epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev) == -1) {
+            liberta_ligacao(l);
+        }
+    }
+}
+
+/// @brief Cria o socket de escuta, substituindo um socket antigo sem servidor.
+/// @return Descritor, ou -1 em caso de erro (já reportado).
+static int cria_escuta(const char *caminho) {
+    struct sockaddr_un endereco = { .sun_family = AF_UNIX };
+    mode_t mascara;
+    int fd, r;
+
+    if (strlen(caminho) >= sizeof(endereco.sun_path)) {
+        saida_erro("Erro: O caminho do socket '%s' é demasiado longo.\n", caminho);
+        return -1;
+    }
+    strcpy(endereco.sun_path, caminho);
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        saida_erro("Erro: Não foi possível criar o socket: %s.\n", strerror(errno));
+        return -1;
+    }
+
+    // Um socket que já existe só é substituído se ninguém estiver à escuta
+    if (access(caminho, F_OK) == 0) {
+        int teste = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+        if (teste != -1 && connect(teste, (struct sockaddr *)&endereco, sizeof(endereco)) == 0) {
+            saida_erro("Erro: Já há um servidor à escuta em '%s'.\n", caminho);
+            close(teste);
+            close(fd);
+            return -1;
+        }
+        if (teste != -1) {
+            close(teste);
+        }
+        unlink(caminho);
+    }
+
+    // Só o dono pode ligar-se ao socket
+    mascara = umask(0077);
+    r = bind(fd, (struct sockaddr *)&endereco, sizeof(endereco));
+    umask(mascara);
+    if (r == -1 || listen(fd, SOMAXCONN) == -1) {
+        saida_erro("Erro: Não foi possível escutar em '%s': %s.\n", caminho, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/// @brief Corre o servidor até receber SIGINT ou SIGTERM.
+/// @param caminho Caminho do socket.
+/// @param num_workers Pedidos executados ao mesmo tempo (0 usa o número de CPUs).
+/// @param executa Função que executa cada pedido.
+/// @return 0 ao terminar, 1 se o socket não puder ser criado.
+/// @details
+/// Os sinais de fim são bloqueados antes de criar os workers (que herdam a
+/// máscara) e lidos por um signalfd no mesmo epoll das ligações. Ao
+/// terminar, o servidor deixa de aceitar ligações e espera pelos pedidos
+/// em execução.
+/// Variáveis:
+/// - escuta: socket de escuta
+/// - sinais: signalfd do SIGINT e do SIGTERM
+/// - ep: epoll do socket de escuta, do signalfd e das ligações a ler
+int servidor_corre(const char *caminho, int num_workers, executa_pedido executa) {
+    struct epoll_event ev = { .events = EPOLLIN }, eventos[MAX_EVENTOS];
+    pool_threads *pool;
+    sigset_t fim;
+    int escuta, sinais, ep, terminar = 0;
+
+    sigemptyset(&fim);
+    sigaddset(&fim, SIGINT);
+    sigaddset(&fim, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &fim, NULL);
+
+    escuta = cria_escuta(caminho);
+    if (escuta == -1) {
+        return 1;
+    }
+    sinais = signalfd(-1, &fim, SFD_CLOEXEC);
+    ep = epoll_create1(EPOLL_CLOEXEC);
+    pool = pool_cria(num_workers);
+    if (sinais == -1 || ep == -1 || pool == NULL) {
+        saida_erro("Erro: Não foi possível iniciar o servidor.\n");
+        unlink(caminho);
+        return 1;
+    }
+    ev.data.ptr = &marca_escuta;
+    epoll_ctl(ep, EPOLL_CTL_ADD, escuta, &ev);
+    ev.data.ptr = &marca_sinais;
+    epoll_ctl(ep, EPOLL_CTL_ADD, sinais, &ev);
+    saida_info("Servidor à escuta em '%s' (%d workers).\n", caminho, pool_num_threads(pool));
+    saida_flush();
+
+    while (!terminar) {
+        int n = epoll_wait(ep, eventos, MAX_EVENTOS, -1);
+
+        for (int i = 0; i < n; i++) {
+            void *p = eventos[i].data.ptr;
+            ligacao *l = p;
+            int r;
+
+            if (p == &marca_escuta) {
+                aceita(escuta, ep, executa);
+                continue;
+            }
+            if (p == &marca_sinais) {
+                terminar = 1;
+                continue;
+            }
+            r = recebe(l);
+            if (r != 0) {
+                epoll_ctl(ep, EPOLL_CTL_DEL, l->fd, NULL);
+            }
+            if (r == -1) {
+                liberta_ligacao(l);
+            } else if (r == 1) {
+                pool_submete(pool, executa_pedido_worker, l);
+            }
+        }
+    }
+
+    // As ligações ainda a meio de um pedido fecham com o processo
+    close(escuta);
+    unlink(caminho);
+    saida_info("Servidor a terminar: à espera dos pedidos em curso.\n");
+    saida_flush();
+    pool_destroi(pool);
+    close(sinais);
+    close(ep);
+    return 0;
+}
+
+/// @brief Envia um script a um servidor e espera pelo código de saída.
+/// @param caminho Caminho do socket.
+/// @param texto Script a executar.
+/// @param parar_no_erro Se diferente de 0, o servidor para no primeiro comando que falhar.
+/// @return Código de saída do script, ou 2 se o servidor não puder ser usado.
+/// @details O pedido é montado num só buffer e enviado com um sendmsg (mais
+/// os que forem precisos se o socket aceitar só uma parte); o primeiro leva
+/// a entrada, a saída e os erros deste processo e a diretoria atual.
+int servidor_pede(const char *caminho, const char *texto, int parar_no_erro) {
+    struct sockaddr_un endereco = { .sun_family = AF_UNIX };
+    cabecalho_pedido c = { PEDIDO_MAGICO, parar_no_erro ? PEDIDO_PARAR_NO_ERRO : 0, 0, 0, 0 };
+    char **ambiente = ambiente_atual();
+    size_t total, enviados = 0, recebidos = 0;
+    int32_t codigo;
+    char *pedido, *w;
+    int fd, diretoria, descritores[NUM_DESCRITORES];
+    mode_t mascara = umask(0);
+
+    umask(mascara);
+    c.mascara = mascara;
+    c.tamanho_texto = strlen(texto) + 1;
+    for (char **v = ambiente; *v != NULL; v++) {
+        c.tamanho_ambiente += strlen(*v) + 1;
+    }
+    if (c.tamanho_texto > MAX_TEXTO || c.tamanho_ambiente > MAX_AMBIENTE ||
+        strlen(caminho) >= sizeof(endereco.sun_path)) {
+        saida_erro("Erro: O pedido ou o caminho do socket é demasiado grande.\n");
+        return 2;
+    }
+
+    // Cabeçalho, texto e ambiente num só buffer
+    total = sizeof(c) + c.tamanho_texto + c.tamanho_ambiente;
+    pedido = malloc(total);
+    if (pedido == NULL) {
+        saida_erro("Erro: Memória insuficiente.\n");
+        return 2;
+    }
+    memcpy(pedido, &c, sizeof(c));
+    w = pedido + sizeof(c);
+    memcpy(w, texto, c.tamanho_texto);
+    w += c.tamanho_texto;
+    for (char **v = ambiente; *v != NULL; v++) {
+        size_t n = strlen(*v) + 1;
+
+        memcpy(w, *v, n);
+        w += n;
+    }
+
+    strcpy(endereco.sun_path, caminho);
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    diretoria = open(".", O_PATH | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1 || diretoria == -1 || connect(fd, (struct sockaddr *)&endereco, sizeof(endereco)) == -1) {
+        saida_erro("Erro: Não foi possível ligar ao servidor '%s': %s.\n", caminho, strerror(errno));
+        if (fd != -1) {
+            close(fd);
+        }
+        if (diretoria != -1) {
+            close(diretoria);
+        }
+        free(pedido);
+        return 2;
+    }
+    descritores[D_ENTRADA] = STDIN_FILENO;
+    descritores[D_SAIDA] = STDOUT_FILENO;
+    descritores[D_ERROS] = STDERR_FILENO;
+    descritores[D_DIRETORIA] = diretoria;
+
+    while (enviados < total) {
+        union {
+            struct cmsghdr alinhamento;
+            char dados[CMSG_SPACE(sizeof(descritores))];
+        } controlo;
+        struct iovec iov = { pedido + enviados, total - enviados };
+        struct msghdr m = { .msg_iov = &iov, .msg_iovlen = 1 };
+        ssize_t n;
+
+        if (enviados == 0) {
+            struct cmsghdr *cm;
+
+            m.msg_control = controlo.dados;
+            m.msg_controllen = sizeof(controlo.dados);
+            cm = CMSG_FIRSTHDR(&m);
+            cm->cmsg_level = SOL_SOCKET;
+            cm->cmsg_type = SCM_RIGHTS;
+            cm->cmsg_len = CMSG_LEN(sizeof(descritores));
+            memcpy(CMSG_DATA(cm), descritores, sizeof(descritores));
+        }
+        n = sendmsg(fd, &m, MSG_NOSIGNAL);
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        if (n == -1) {
+            break;
+        }
+        enviados += n;
+    }
+    close(diretoria);
+    free(pedido);
+
+    // Esperar pelo código de saída (o servidor escreve a saída diretamente)
+    while (enviados == total && recebidos < sizeof(codigo)) {
+        ssize_t n = recv(fd, (char *)&codigo + recebidos, sizeof(codigo) - recebidos, 0);
+
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        recebidos += n;
+    }
+    close(fd);
+    if (recebidos < sizeof(codigo)) {
+        saida_erro("Erro: O servidor '%s' terminou sem responder.\n", caminho);
+        return 2;
+    }
+    return codigo;
+}
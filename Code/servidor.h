@@ -0,0 +1,63 @@
+/**
+ * @file servidor.h
+ * @brief Modo servidor: um interpretador persistente que executa os pedidos
+ * de vários clientes ao mesmo tempo, através de um socket AF_UNIX.
+ *
+ * Cada pedido é um script (o texto de -c ou de -f), o ambiente, a umask e
+ * quatro descritores passados com SCM_RIGHTS: a entrada, a saída e os erros
+ * do cliente e a sua diretoria atual. A thread principal do servidor espera
+ * por ligações e pedidos num epoll; um pedido completo passa para um pool de
+ * workers, que o executa com os descritores do cliente (ver saida.h), o seu
+ * ambiente (ver ambiente.h) e a sua diretoria atual e umask (cada worker faz
+ * unshare(CLONE_FS) para as ter só para si), e responde com o código de
+ * saída. Os comandos internos correm no servidor sem criar processos, e as
+ * caches (PATH, nomes dos utilizadores, diretorias, resumos) ficam quentes de
+ * um pedido para o outro.
+ *
+ * Só são aceites clientes com o mesmo utilizador do servidor (ou o root), e
+ * o socket é criado só com permissões para o dono. As opções de `set` são
+ * do processo e, por isso, valem para todos os clientes; os trabalhos em
+ * fundo ('&') não estão disponíveis nos pedidos.
+ *
+ * @date 2025
+ */
+
+#ifndef SERVIDOR_H
+#define SERVIDOR_H
+
+/**
+ * @brief Função que executa o texto de um pedido (como o modo de script).
+ * @param texto Script (terminado em '\0'; pode ser alterado).
+ * @param parar_no_erro Se diferente de 0, para no primeiro comando que falhar.
+ * @return Código de saída do último comando.
+ */
+typedef int (*executa_pedido)(char *texto, int parar_no_erro);
+
+/**
+ * @brief Corre o servidor até receber SIGINT ou SIGTERM.
+ * @param caminho Caminho do socket (um socket antigo sem servidor é substituído).
+ * @param num_workers Número de pedidos executados ao mesmo tempo (0 usa o número de CPUs).
+ * @param executa Função que executa cada pedido.
+ * @return 0 ao terminar, 1 se o socket não puder ser criado.
+ */
+int servidor_corre(const char *caminho, int num_workers, executa_pedido executa);
+
+/**
+ * @brief Envia um script a um servidor e espera pelo fim (o cliente).
+ *
+ * A saída e os erros dos comandos são escritos pelo servidor diretamente
+ * nos descritores do cliente.
+ * @param caminho Caminho do socket.
+ * @param texto Script a executar.
+ * @param parar_no_erro Se diferente de 0, o servidor para no primeiro comando que falhar.
+ * @return Código de saída do script, ou 2 se o servidor não puder ser usado.
+ */
+int servidor_pede(const char *caminho, const char *texto, int parar_no_erro);
+
+/**
+ * @brief Indica se a thread atual está a executar um pedido de um cliente.
+ * @return 1 dentro de um pedido, 0 caso contrário.
+ */
+int servidor_em_pedido(void);
+
+#endif // SERVIDOR_H
@@ -0,0 +1,85 @@
+/**
+ * @file tabela_comandos.c
+ * @brief Implementação da tabela de comandos internos (endereçamento aberto).
+ *
+ * O número de comandos é pequeno e conhecido, por isso a tabela tem tamanho
+ * fixo (potência de 2) e fica sempre com menos de metade das posições
+ * ocupadas, o que mantém as sondagens curtas.
+ *
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "tabela_comandos.h"
+#include "saida.h"
+
+/// Número de posições da tabela (potência de 2).
+#define TAMANHO_TABELA 64
+
+static const comando_interno *tabela[TAMANHO_TABELA];
+static int ocupadas = 0;
+
+/// @brief Função de dispersão FNV-1a.
+static unsigned int dispersao(const char *s) {
+    unsigned int h = 2166136261u;
+
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/// @brief Regista um comando interno.
+/// @param cmd Descrição do comando.
+/// @return 0 em caso de sucesso, -1 se a tabela estiver cheia.
+int tabela_regista(const comando_interno *cmd) {
+    unsigned int i = dispersao(cmd->nome) & (TAMANHO_TABELA - 1);
+
+    while (tabela[i] != NULL) {
+        if (strcmp(tabela[i]->nome, cmd->nome) == 0) {
+            tabela[i] = cmd;
+            return 0;
+        }
+        i = (i + 1) & (TAMANHO_TABELA - 1);
+    }
+    if (ocupadas >= TAMANHO_TABELA / 2) {
+        return -1;
+    }
+    tabela[i] = cmd;
+    ocupadas++;
+    return 0;
+}
+
+/// @brief Procura um comando interno pelo nome.
+/// @param nome Nome do comando.
+/// @return Descrição do comando, ou NULL.
+const comando_interno *tabela_procura(const char *nome) {
+    unsigned int i = dispersao(nome) & (TAMANHO_TABELA - 1);
+
+    while (tabela[i] != NULL) {
+        if (strcmp(tabela[i]->nome, nome) == 0) {
+            return tabela[i];
+        }
+        i = (i + 1) & (TAMANHO_TABELA - 1);
+    }
+    return NULL;
+}
+
+/// @brief Verifica o número de argumentos e executa um comando interno.
+/// @param cmd Descrição do comando.
+/// @param args Argumentos do comando.
+/// @return Código de saída do comando.
+int tabela_executa(const comando_interno *cmd, char *args[]) {
+    int num_args = 0;
+
+    while (args[num_args + 1] != NULL) {
+        num_args++;
+    }
+    if (num_args < cmd->min_args || (cmd->max_args >= 0 && num_args > cmd->max_args)) {
+        saida_erro("Erro: Número de argumentos inválido para '%s'. Uso: %s\n", cmd->nome, cmd->uso);
+        return 1;
+    }
+    return cmd->funcao(args);
+}
@@ -0,0 +1,55 @@
+/**
+ * @file tabela_comandos.h
+ * @brief Registo dos comandos internos numa tabela de dispersão.
+ *
+ * A tabela usa endereçamento aberto com sondagem linear e associa o nome de
+ * cada comando à função que o executa, ao número de argumentos aceite e à
+ * mensagem de uso.
+ *
+ * @date 2025
+ */
+
+#ifndef TABELA_COMANDOS_H
+#define TABELA_COMANDOS_H
+
+/**
+ * @brief Função que executa um comando interno.
+ * @param args Argumentos do comando (args[0] é o nome), terminados em NULL.
+ * @return Código de saída do comando.
+ */
+typedef int (*funcao_comando)(char *args[]);
+
+/**
+ * @brief Descrição de um comando interno.
+ */
+typedef struct {
+    const char *nome;       ///< nome do comando
+    funcao_comando funcao;  ///< função que o executa
+    int min_args;           ///< número mínimo de argumentos (sem contar o nome)
+    int max_args;           ///< número máximo de argumentos, ou -1 se ilimitado
+    const char *uso;        ///< mensagem de uso
+} comando_interno;
+
+/**
+ * @brief Regista um comando interno (substitui um registo com o mesmo nome).
+ * @param cmd Descrição do comando (tem de existir enquanto a tabela for usada).
+ * @return 0 em caso de sucesso, -1 se a tabela estiver cheia.
+ */
+int tabela_regista(const comando_interno *cmd);
+
+/**
+ * @brief Procura um comando interno pelo nome.
+ * @param nome Nome do comando.
+ * @return Descrição do comando, ou NULL se não for um comando interno.
+ */
+const comando_interno *tabela_procura(const char *nome);
+
+/**
+ * @brief Verifica o número de argumentos e executa um comando interno.
+ * @param cmd Descrição do comando.
+ * @param args Argumentos (args[0] é o nome), terminados em NULL.
+ * @return Código de saída do comando, ou 1 se o número de argumentos for inválido.
+ */
+int tabela_executa(const comando_interno *cmd, char *args[]);
+
+#endif // TABELA_COMANDOS_H
@@ -0,0 +1,120 @@
+/**
+ * @file teste_mostra.c
+ * @brief Testes dos intervalos do `mostra` (-n, -c e --tail), executados
+ * pelo próprio interpretador.
+ *
+ * Escreve um ficheiro conhecido e, para cada caso, corre
+ * `interpretador -c "mostra ..."` e confirma que a saída começa pela parte
+ * esperada, seguida da mensagem de sucesso (ou que o comando falha, nos
+ * intervalos inválidos). O ficheiro é mostrado diretamente e pela entrada
+ * (`mostra ... < ficheiro`), que é lida em fluxo.
+ *
+ * Utilização: teste_mostra [interpretador]
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/// Conteúdo do ficheiro de teste: bytes 0 a 10 na linha 1, 11 a 14 na linha 2.
+#define CONTEUDO "0123456789\nabc\nxyz\n"
+
+/// Mensagem escrita pelo mostra depois do conteúdo.
+#define SUCESSO "\n\nFicheiro mostrado com sucesso.\n"
+
+/// @brief Caso de teste: opções do mostra e parte esperada (NULL se deve falhar).
+typedef struct {
+    const char *opcoes;
+    const char *esperado;
+} caso;
+
+static const caso casos[] = {
+    { "-c 5", "5" },
+    { "-c 0", "0" },
+    { "-c 11", "a" },
+    { "-c 5:7", "56" },
+    { "-c 12:", "bc\nxyz\n" },
+    { "-c :3", "012" },
+    { "-c 100", "" },
+    { "-n 2", "abc\n" },
+    { "-n 2:3", "abc\nxyz\n" },
+    { "-n :1", "0123456789\n" },
+    { "--tail 1", "xyz\n" },
+    { "-c 7:5", NULL },
+    { "-n 0", NULL },
+    { "-c x", NULL },
+};
+
+static const char *interpretador = "./interpretador";
+
+/// @brief Corre um comando no interpretador e lê a saída.
+/// @param comando Comando a passar com -c.
+/// @param redirecao Redirecionamento da shell que lança o interpretador ("" se nenhum).
+/// @param saida Buffer da saída.
+/// @param tamanho Tamanho do buffer.
+/// @return Código de saída do interpretador, ou -1 se não pôde ser executado.
+static int executa(const char *comando, const char *redirecao, char *saida, size_t tamanho) {
+    char linha[512];
+    size_t n;
+    FILE *f;
+    int estado;
+
+    snprintf(linha, sizeof(linha), "%s -c '%s' %s 2>/dev/null", interpretador, comando, redirecao);
+    f = popen(linha, "r");
+    if (f == NULL) {
+        return -1;
+    }
+    n = fread(saida, 1, tamanho - 1, f);
+    saida[n] = '\0';
+    estado = pclose(f);
+    return WIFEXITED(estado) ? WEXITSTATUS(estado) : -1;
+}
+
+/// @brief Verifica um caso, com o ficheiro indicado ou pela entrada.
+/// @return 0 se passou, 1 se falhou.
+static int verifica(const caso *c, const char *ficheiro, int pela_entrada) {
+    char comando[256], redirecao[300], saida[4096], esperado[256];
+    int falhou;
+
+    snprintf(comando, sizeof(comando), "mostra %s%s%s", c->opcoes, pela_entrada ? "" : " ", pela_entrada ? "" : ficheiro);
+    snprintf(redirecao, sizeof(redirecao), "%s%s", pela_entrada ? "< " : "", pela_entrada ? ficheiro : "");
+    executa(comando, redirecao, saida, sizeof(saida));
+
+    if (c->esperado == NULL) {
+        falhou = strstr(saida, "Terminou comando mostra com código 1") == NULL;
+    } else {
+        snprintf(esperado, sizeof(esperado), "%s%s", c->esperado, SUCESSO);
+        falhou = strncmp(saida, esperado, strlen(esperado)) != 0;
+    }
+    printf("%-8s %-22s %s\n", falhou ? "FALHOU" : "ok", c->opcoes, pela_entrada ? "(entrada)" : "");
+    return falhou;
+}
+
+int main(int argc, char *argv[]) {
+    char ficheiro[] = "/tmp/teste_mostra_XXXXXX";
+    int fd, falhas = 0;
+
+    if (argc > 1) {
+        interpretador = argv[1];
+    }
+    fd = mkstemp(ficheiro);
+    if (fd == -1 || write(fd, CONTEUDO, strlen(CONTEUDO)) != (ssize_t)strlen(CONTEUDO)) {
+        perror("teste_mostra");
+        return 1;
+    }
+    close(fd);
+
+    for (size_t i = 0; i < sizeof(casos) / sizeof(casos[0]); i++) {
+        falhas += verifica(&casos[i], ficheiro, 0);
+        falhas += verifica(&casos[i], ficheiro, 1);
+    }
+    unlink(ficheiro);
+
+    printf("%d falhas em %zu casos.\n", falhas, 2 * sizeof(casos) / sizeof(casos[0]));
+    return falhas == 0 ? 0 : 1;
+}
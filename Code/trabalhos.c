@@ -0,0 +1,361 @@
+/**
+ * @file trabalhos.c
+ * @brief Implementação da tabela de trabalhos em fundo.
+ *
+ * Cada etapa em fundo tem um descritor de fim (pidfd ou eventfd) registado
+ * no epoll com o número da posição na tabela e o índice da etapa. Quando
+ * todas as etapas de um trabalho foram recolhidas, o trabalho é reportado
+ * ("Terminou comando ... com código ...") e a posição fica livre.
+ *
+ * A tabela é protegida por um mutex, porque os comandos 'jobs', 'wait' e
+ * 'fg' também podem correr numa thread (dentro de um pipeline): o estado
+ * dos trabalhos e o número de ativos só são lidos com o mutex fechado. O
+ * epoll_wait é feito fora do mutex; um evento já tratado por outra thread é
+ * reconhecido por a etapa já não ter descritor de fim.
+ *
+ * @date 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include "trabalhos.h"
+#include "pipeline.h"
+#include "saida.h"
+#include "analisador.h"
+#include "perfil.h"
+
+/// Número máximo de trabalhos em fundo ao mesmo tempo.
+#define MAX_TRABALHOS 64
+
+/// Identificador do descritor de entrada nos eventos do epoll.
+#define EVENTO_ENTRADA UINT64_MAX
+
+/// Número máximo de eventos tratados por cada epoll_wait.
+#define MAX_EVENTOS 16
+
+/// @brief Trabalho em fundo.
+typedef struct {
+    int ativo;                  ///< 1 enquanto tiver etapas por recolher
+    unsigned long ordem;        ///< ordem de lançamento (o 'fg' sem número usa o mais recente)
+    char *descricao;            ///< linha de comando, para o 'jobs'
+    char **args;                ///< cópia dos argumentos (um único bloco)
+    execucao_pipeline *exec;
+    int codigo;                 ///< código de saída, depois de concluído
+} trabalho;
+
+static pthread_mutex_t trinco = PTHREAD_MUTEX_INITIALIZER;
+static trabalho tabela[MAX_TRABALHOS];
+static int num_ativos = 0;
+static unsigned long proxima_ordem = 1;
+static int epoll_trabalhos = -1;
+static int ultimo_codigo = 0;
+
+/// @brief Copia os argumentos para um único bloco e constrói a descrição do comando.
+/// @param args Argumentos terminados em NULL.
+/// @param descricao Linha de comando com os argumentos separados por espaços (libertar com free).
+/// @return Cópia dos argumentos (libertar com free), ou NULL se faltar memória.
+static char **copia_argumentos(char *args[], char **descricao) {
+    size_t n = 0, texto = 0;
+    char **copia, *p;
+
+    for (; args[n] != NULL; n++) {
+        texto += strlen(args[n]) + 1;
+    }
+    copia = malloc((n + 1) * sizeof(char *) + texto);
+    *descricao = malloc(texto + 1);
+    if (copia == NULL || *descricao == NULL) {
+        free(copia);
+        free(*descricao);
+        return NULL;
+    }
+
+    p = (char *)(copia + n + 1);
+    (*descricao)[0] = '\0';
+    for (size_t i = 0; i < n; i++) {
+        size_t len = strlen(args[i]) + 1;
+
+        // Os operadores são comparados pelo endereço: ficam os originais
+        if (e_operador_analisador(args[i])) {
+            copia[i] = args[i];
+        } else {
+            copia[i] = memcpy(p, args[i], len);
+            p += len;
+        }
+        if (i > 0) {
+            strcat(*descricao, " ");
+        }
+        strcat(*descricao, args[i]);
+    }
+    copia[n] = NULL;
+    return copia;
+}
+
+/// @brief Reporta um trabalho cujas etapas já foram todas recolhidas e liberta a posição.
+/// @return Código de saída do trabalho.
+static int conclui(int t) {
+    trabalho *tr = &tabela[t];
+
+    saida_printf("[%d] Concluído: %s\n", t + 1, tr->descricao);
+    pipeline_reporta(tr->exec);
+    tr->codigo = pipeline_codigo(tr->exec);
+    ultimo_codigo = tr->codigo;
+
+    pipeline_liberta(tr->exec);
+    free(tr->args);
+    free(tr->descricao);
+    tr->exec = NULL;
+    tr->args = NULL;
+    tr->descricao = NULL;
+    tr->ativo = 0;
+    num_ativos--;
+    return tr->codigo;
+}
+
+/// @brief Recolhe a etapa indicada por um evento do epoll (com o mutex fechado).
+/// @return Posição do trabalho, se este ficou com todas as etapas recolhidas; -1 caso contrário.
+static int trata_evento(uint64_t dados) {
+    int t = (int)(dados >> 32), i = (int)(dados & 0xffffffffu);
+
+    if (!tabela[t].ativo || pipeline_descritor_fim(tabela[t].exec, i) == -1) {
+        return -1;  // já tratado por outra thread
+    }
+    // Fechar o descritor (dentro do pipeline_recolhe) retira-o do epoll
+    return pipeline_recolhe(tabela[t].exec, i) == 0 ? t : -1;
+}
+
+/// @brief Descritor do epoll, se houver trabalhos por recolher (lido com o mutex fechado).
+/// @return Descritor do epoll, ou -1 se não houver trabalhos ativos.
+static int epoll_ativo(void) {
+    int ep;
+
+    pthread_mutex_lock(&trinco);
+    ep = num_ativos > 0 ? epoll_trabalhos : -1;
+    pthread_mutex_unlock(&trinco);
+    return ep;
+}
+
+/// @brief Espera por eventos e recolhe as etapas que terminaram.
+/// @param espera_ms Tempo máximo de espera em milissegundos (-1 sem limite).
+/// @param entrada_pronta Posto a 1 se chegou um evento do descritor de entrada (pode ser NULL).
+/// @param antes Texto a escrever antes do primeiro trabalho reportado (pode ser NULL).
+/// @return Número de trabalhos concluídos e reportados.
+static int processa_eventos(int espera_ms, int *entrada_pronta, const char *antes) {
+    struct epoll_event eventos[MAX_EVENTOS];
+    int ep, n, concluidos = 0;
+
+    pthread_mutex_lock(&trinco);
+    ep = epoll_trabalhos;
+    pthread_mutex_unlock(&trinco);
+    if (ep == -1) {
+        return 0;
+    }
+    n = epoll_wait(ep, eventos, MAX_EVENTOS, espera_ms);
+    if (n <= 0) {
+        return 0;  // sem eventos, ou interrompido por um sinal
+    }
+
+    pthread_mutex_lock(&trinco);
+    for (int k = 0; k < n; k++) {
+        int t;
+
+        if (eventos[k].data.u64 == EVENTO_ENTRADA) {
+            if (entrada_pronta != NULL) {
+                *entrada_pronta = 1;
+            }
+            continue;
+        }
+        t = trata_evento(eventos[k].data.u64);
+        if (t >= 0) {
+            if (concluidos++ == 0 && antes != NULL) {
+                saida_printf("%s", antes);
+            }
+            conclui(t);
+        }
+    }
+    pthread_mutex_unlock(&trinco);
+    return concluidos;
+}
+
+/// @brief Estado de uma posição da tabela (lido com o mutex fechado).
+/// @param t Posição do trabalho.
+/// @param codigo Posto com o código de saída do trabalho (o último, se t for -1).
+/// @return 1 se o trabalho estiver ativo (com t = -1: se houver algum), 0 caso contrário.
+static int trabalho_ativo(int t, int *codigo) {
+    int r;
+
+    pthread_mutex_lock(&trinco);
+    if (t == -1) {
+        r = num_ativos > 0;
+        *codigo = ultimo_codigo;
+    } else {
+        r = tabela[t].ativo;
+        *codigo = tabela[t].codigo;
+    }
+    pthread_mutex_unlock(&trinco);
+    return r;
+}
+
+/// @brief Lança um comando em fundo.
+/// @param args Argumentos sem o '&' final.
+/// @return 0 em caso de sucesso, 1 em caso de erro.
+/// @details
+/// Os argumentos são copiados, porque a linha lida pode ser reutilizada
+/// antes de o trabalho terminar. As etapas que nem chegaram a arrancar
+/// (comando não encontrado, ficheiro inexistente) são recolhidas logo.
+int trabalhos_lanca(char *args[]) {
+    etapa_pipeline etapas[PIPELINE_MAX_ETAPAS];
+    trabalho *tr;
+    int t, n, restantes;
+
+    pthread_mutex_lock(&trinco);
+    for (t = 0; t < MAX_TRABALHOS && tabela[t].ativo; t++) {
+    }
+    if (t == MAX_TRABALHOS) {
+        pthread_mutex_unlock(&trinco);
+        saida_erro("Erro: Demasiados trabalhos em fundo (máximo %d).\n", MAX_TRABALHOS);
+        return 1;
+    }
+    if (epoll_trabalhos == -1 && (epoll_trabalhos = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+        pthread_mutex_unlock(&trinco);
+        saida_erro("Erro: Não foi possível criar o epoll: %s\n", strerror(errno));
+        return 1;
+    }
+
+    tr = &tabela[t];
+    tr->args = copia_argumentos(args, &tr->descricao);
+    if (tr->args == NULL) {
+        pthread_mutex_unlock(&trinco);
+        saida_erro("Erro: Memória insuficiente.\n");
+        return 1;
+    }
+    n = pipeline_analisa(tr->args, etapas);
+    if (n != -1) {
+        // Antes de arrancar, para aparecer antes de qualquer saída do trabalho
+        saida_printf("[%d] %s\n", t + 1, tr->descricao);
+    }
+    if (n == -1 || (tr->exec = pipeline_inicia(etapas, n, 1, perfil_ativo())) == NULL) {
+        free(tr->args);
+        free(tr->descricao);
+        pthread_mutex_unlock(&trinco);
+        return 1;
+    }
+    tr->ativo = 1;
+    tr->ordem = proxima_ordem++;
+    num_ativos++;
+
+    restantes = pipeline_num_etapas(tr->exec);
+    for (int i = 0; i < pipeline_num_etapas(tr->exec); i++) {
+        struct epoll_event ev = { .events = EPOLLIN, .data.u64 = ((uint64_t)t << 32) | (uint32_t)i };
+        int fd = pipeline_descritor_fim(tr->exec, i);
+
+        if (fd == -1 || epoll_ctl(epoll_trabalhos, EPOLL_CTL_ADD, fd, &ev) == -1) {
+            restantes = pipeline_recolhe(tr->exec, i);
+        }
+    }
+    if (restantes == 0) {
+        conclui(t);
+    }
+    pthread_mutex_unlock(&trinco);
+    return 0;
+}
+
+/// @brief Recolhe as etapas que terminaram e reporta os trabalhos concluídos.
+/// @param espera_ms Tempo máximo de espera (0 não espera, -1 sem limite).
+/// @return Número de trabalhos concluídos.
+int trabalhos_recolhe(int espera_ms) {
+    if (epoll_ativo() == -1) {
+        return 0;
+    }
+    return processa_eventos(espera_ms, NULL, NULL);
+}
+
+/// @brief Espera até o descritor ter dados, reportando os trabalhos que terminarem.
+/// @param fd Descritor de entrada.
+/// @return Número de trabalhos reportados (0 quando o descritor está pronto).
+/// @details O relatório começa numa linha nova, porque o prompt já foi escrito.
+int trabalhos_espera_entrada(int fd) {
+    struct epoll_event ev = { .events = EPOLLIN, .data.u64 = EVENTO_ENTRADA };
+    int ep = epoll_ativo(), pronta = 0, concluidos = 0;
+
+    // O epoll, depois de criado, nunca é fechado
+    if (ep == -1 || epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        return 0;
+    }
+    while (!pronta && concluidos == 0) {
+        concluidos = processa_eventos(-1, &pronta, "\n");
+    }
+    epoll_ctl(ep, EPOLL_CTL_DEL, fd, NULL);
+    return concluidos;
+}
+
+/// @brief Mostra os trabalhos que ainda estão a correr.
+void trabalhos_lista(void) {
+    trabalhos_recolhe(0);
+
+    pthread_mutex_lock(&trinco);
+    for (int t = 0; t < MAX_TRABALHOS; t++) {
+        if (tabela[t].ativo) {
+            saida_printf("[%d] A correr  %s\n", t + 1, tabela[t].descricao);
+        }
+    }
+    pthread_mutex_unlock(&trinco);
+}
+
+/// @brief Espera que um trabalho, ou todos, terminem.
+/// @param id Número do trabalho, ou 0 para todos.
+/// @return Código de saída do trabalho, ou 1 se não existir.
+int trabalhos_espera(int id) {
+    int t = id - 1, codigo;
+
+    if (id == 0) {
+        while (trabalho_ativo(-1, &codigo)) {
+            processa_eventos(-1, NULL, NULL);
+        }
+        return codigo;
+    }
+
+    if (t < 0 || t >= MAX_TRABALHOS || !trabalho_ativo(t, &codigo)) {
+        saida_erro("Erro: O trabalho %d não existe.\n", id);
+        return 1;
+    }
+    while (trabalho_ativo(t, &codigo)) {
+        processa_eventos(-1, NULL, NULL);
+    }
+    return codigo;
+}
+
+/// @brief Traz um trabalho para primeiro plano: mostra-o e espera que termine.
+/// @param id Número do trabalho, ou 0 para o mais recente.
+/// @return Código de saída do trabalho, ou 1 se não existir.
+/// @details Sem controlo de terminal (grupos de processos, SIGTSTP), trazer
+/// para primeiro plano é esperar pelo trabalho a partir do prompt.
+int trabalhos_primeiro_plano(int id) {
+    pthread_mutex_lock(&trinco);
+    if (id == 0) {
+        unsigned long mais_recente = 0;
+
+        for (int t = 0; t < MAX_TRABALHOS; t++) {
+            if (tabela[t].ativo && tabela[t].ordem > mais_recente) {
+                mais_recente = tabela[t].ordem;
+                id = t + 1;
+            }
+        }
+        if (id == 0) {
+            pthread_mutex_unlock(&trinco);
+            saida_erro("Erro: Não há trabalhos em fundo.\n");
+            return 1;
+        }
+    }
+    if (id > 0 && id <= MAX_TRABALHOS && tabela[id - 1].ativo) {
+        saida_printf("%s\n", tabela[id - 1].descricao);
+        saida_flush();
+    }
+    pthread_mutex_unlock(&trinco);
+    return trabalhos_espera(id);
+}
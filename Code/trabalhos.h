@@ -0,0 +1,59 @@
+/**
+ * @file trabalhos.h
+ * @brief Trabalhos em fundo (comandos terminados em '&') e tabela de trabalhos.
+ *
+ * Os processos e threads dos trabalhos não são esperados com waitpid
+ * bloqueante: cada etapa tem um pidfd (processos) ou um eventfd (comandos
+ * internos em threads) registado num epoll, e o interpretador recolhe as que
+ * terminaram entre comandos e enquanto espera pela linha seguinte.
+ *
+ * @date 2025
+ */
+
+#ifndef TRABALHOS_H
+#define TRABALHOS_H
+
+/**
+ * @brief Lança um comando (ou pipeline) em fundo e regista-o na tabela.
+ * @param args Argumentos, já sem o '&' final, terminados em NULL (são copiados).
+ * @return 0 em caso de sucesso, 1 em caso de erro.
+ */
+int trabalhos_lanca(char *args[]);
+
+/**
+ * @brief Recolhe as etapas que terminaram e reporta os trabalhos concluídos.
+ * @param espera_ms Tempo máximo de espera (0 não espera, -1 espera por um evento).
+ * @return Número de trabalhos concluídos.
+ */
+int trabalhos_recolhe(int espera_ms);
+
+/**
+ * @brief Espera até o descritor ter dados para ler, reportando entretanto os
+ * trabalhos que terminarem (usado antes de ler cada linha no modo interativo).
+ * @param fd Descritor de entrada.
+ * @return Número de trabalhos reportados (0 quando o descritor está pronto).
+ */
+int trabalhos_espera_entrada(int fd);
+
+/**
+ * @brief Mostra os trabalhos que ainda estão a correr (comando 'jobs').
+ */
+void trabalhos_lista(void);
+
+/**
+ * @brief Espera que um trabalho, ou todos, terminem (comando 'wait').
+ * @param id Número do trabalho, ou 0 para todos.
+ * @return Código de saída do trabalho (ou do último a terminar), ou 1 se o
+ * trabalho não existir.
+ */
+int trabalhos_espera(int id);
+
+/**
+ * @brief Traz um trabalho para primeiro plano (comando 'fg'): mostra-o e
+ * espera que termine.
+ * @param id Número do trabalho, ou 0 para o mais recente.
+ * @return Código de saída do trabalho, ou 1 se não existir.
+ */
+int trabalhos_primeiro_plano(int id);
+
+#endif // TRABALHOS_H